@@ -35,7 +35,7 @@ uint8_t xdata_memory[1024] = {0};
  * @param none
  * @return none
  ******************************************************************************/
-static int emcs51_core_read_code_cb(uint16_t addr, uint8_t *data, uint16_t len)
+static int emcs51_core_read_code_cb(emcs51_core_t *core, void *user, uint16_t addr, uint8_t *data, uint16_t len)
 {
     if (addr + len > sizeof(code_memory))
     {
@@ -47,7 +47,7 @@ static int emcs51_core_read_code_cb(uint16_t addr, uint8_t *data, uint16_t len)
     return EMCS51_OK;
 }
 
-static int emcs51_P0_write_data_cb(uint8_t addr, uint8_t data)
+static int emcs51_P0_write_data_cb(emcs51_core_t *core, void *user, uint8_t addr, uint8_t data)
 {
     printf("[main] P0 write data: 0x%02X\r\n", data);
 
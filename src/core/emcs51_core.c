@@ -1,5 +1,70 @@
 #include "emcs51.h"
 
+// 观察点位图测试，map 为 uint32_t 数组
+#define EMCS51_CORE_WATCH_BIT(map, n) ((map)[(n) >> 5] & ((uint32_t)1 << ((n) & 31)))
+
+// 直接地址所属空间
+#define EMCS51_CORE_DATA_SPACE(addr) (((addr) < 0x80) ? EMCS51_SPACE_IRAM : EMCS51_SPACE_SFR)
+
+#if EMCS51_SELF_PROFILE
+#ifndef EMCS51_SELF_PROFILE_TICKS
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+typedef uint64_t emcs51_self_profile_ticks_t;
+#define EMCS51_SELF_PROFILE_TICKS() __rdtsc()
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__TARGET_ARCH_7_M) || defined(__TARGET_ARCH_7E_M)
+// DWT CYCCNT 为32位，差值按32位计算，单次回调不会超过一个回绕周期
+typedef uint32_t emcs51_self_profile_ticks_t;
+#define EMCS51_SELF_PROFILE_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define EMCS51_SELF_PROFILE_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define EMCS51_SELF_PROFILE_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+#define EMCS51_SELF_PROFILE_TICKS() EMCS51_SELF_PROFILE_DWT_CYCCNT
+#elif defined(__aarch64__)
+// 通用定时器虚拟计数，用户态可读
+typedef uint64_t emcs51_self_profile_ticks_t;
+static inline uint64_t emcs51_self_profile_cntvct(void)
+{
+    uint64_t cnt;
+
+    __asm__ volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(cnt));
+    return cnt;
+}
+#define EMCS51_SELF_PROFILE_TICKS() emcs51_self_profile_cntvct()
+#else
+#include <time.h>
+typedef uint64_t emcs51_self_profile_ticks_t;
+#if defined(CLOCK_MONOTONIC)
+// clock() 为微秒级的CPU时间，无法测量单个处理函数，使用纳秒单调时钟
+static inline uint64_t emcs51_self_profile_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+#define EMCS51_SELF_PROFILE_TICKS() emcs51_self_profile_ns()
+#else
+#define EMCS51_SELF_PROFILE_TICKS() ((uint64_t)clock())
+#endif
+#endif
+#else
+typedef uint64_t emcs51_self_profile_ticks_t;
+#endif
+
+// 统计一次用户回调，call 为完整的调用语句
+#define EMCS51_SELF_PROFILE_CALL(core, cb, call)                                                                    \
+    do                                                                                                              \
+    {                                                                                                               \
+        emcs51_self_profile_ticks_t self_profile_t0 = (emcs51_self_profile_ticks_t)EMCS51_SELF_PROFILE_TICKS();     \
+        call;                                                                                                       \
+        (core)->self_profile.cb_count[(cb)]++;                                                                      \
+        (core)->self_profile.cb_ticks[(cb)] +=                                                                      \
+            (emcs51_self_profile_ticks_t)((emcs51_self_profile_ticks_t)EMCS51_SELF_PROFILE_TICKS() - self_profile_t0); \
+    } while (0)
+#else
+#define EMCS51_SELF_PROFILE_CALL(core, cb, call) call
+#endif
+
 /*******************************************************************************
  * @brief 初始化核心
  * @param core 核心结构体指针
@@ -16,7 +81,39 @@ void emcs51_core_init(emcs51_core_t *core, emcs51_core_config_t *config)
 
     memset(core, 0, sizeof(emcs51_core_t));
 
+    core->code_type = config->code_type;
     core->read_code_cb = config->read_code_cb;
+    core->user = config->user;
+
+    if (core->code_type == EMCS51_CODE_BUFFER)
+    {
+        core->code_buffer = config->code_buffer;
+        core->code_len = config->code_len;
+        core->code_bank_sfr = config->code_bank_sfr;
+        core->code_bank_mask = config->code_bank_mask;
+        core->code_bank_shift = config->code_bank_shift;
+        core->code_banks = config->code_banks;
+        core->code_bank_count = config->code_bank_count;
+        core->code_bank_len = config->code_bank_len;
+    }
+    else
+    {
+        core->code_type = EMCS51_CODE_CALLBACK;
+    }
+
+    core->code_page[0] = core->code_buffer;
+    core->code_page_len[0] = (core->code_len < EMCS51_CODE_BANK_WINDOW) ? core->code_len : EMCS51_CODE_BANK_WINDOW;
+    emcs51_core_update_code_bank(core);
+    core->xdata_page_shift = EMCS51_XDATA_PAGE_SHIFT_DEFAULT;
+    core->xdata_region_count = 1;
+    core->pdata_page_sfr = (config->pdata_page_sfr != 0) ? config->pdata_page_sfr : EMCS51_PDATA_PAGE_SFR_DEFAULT;
+    core->dps_write_mask = 0xFF;
+    core->dptr1_addr = EMCS51_DPTR1_ADDR;
+    core->clocks_per_cycle = EMCS51_CLOCKS_PER_CYCLE_DEFAULT;
+
+#if EMCS51_SELF_PROFILE
+    emcs51_core_self_profile_reset(core);
+#endif
 }
 
 /*******************************************************************************
@@ -142,177 +239,1185 @@ void emcs51_core_inst_dump(emcs51_core_t *core)
     printf("[EMCS51][inst_dump] ==================================================\r\n");
 }
 
+#if EMCS51_SELF_PROFILE
 /*******************************************************************************
- * @brief 设置XDATA区内存
+ * @brief 清零自剖析计数，Cortex-M 上同时启用 DWT 周期计数器
  * @param core 核心结构体指针
- * @param xdata_ram XDATA区内存指针
- * @param xdata_ram_size XDATA区内存大小
  * @return none
  ******************************************************************************/
-void emcs51_core_set_xdata_ram(emcs51_core_t *core, uint8_t *xdata_ram, uint32_t xdata_ram_size)
+void emcs51_core_self_profile_reset(emcs51_core_t *core)
 {
     if (core == NULL)
         return;
 
-    core->xdata_ram = xdata_ram;
-    core->xdata_ram_size = xdata_ram_size;
+    memset(&core->self_profile, 0, sizeof(emcs51_self_profile_t));
+
+#ifdef EMCS51_SELF_PROFILE_DWT_CYCCNT
+    EMCS51_SELF_PROFILE_DEMCR |= (1UL << 24); // TRCENA
+    EMCS51_SELF_PROFILE_DWT_CTRL |= 1UL;      // CYCCNTENA
+#endif
 }
 
 /*******************************************************************************
- * @brief 复位核心
+ * @brief 打印自剖析结果：按处理函数总耗时降序列出操作码，以及用户回调的耗时
  * @param core 核心结构体指针
  * @return none
+ * @details 耗时单位为主机时钟（rdtsc/DWT CYCCNT/cntvct_el0，其它主机为纳秒），处理函数的耗时包括其中调用的用户回调
  ******************************************************************************/
-void emcs51_core_reset(emcs51_core_t *core)
+void emcs51_core_self_profile_dump(emcs51_core_t *core)
 {
+    static const char *const cb_names[EMCS51_SELF_PROFILE_CB_COUNT] = {
+        "read_data_cb", "write_data_cb", "read_code_cb", "xdata read_cb", "xdata write_cb",
+    };
+    const emcs51_self_profile_t *sp;
+    uint8_t order[256];
+    uint64_t handler_ticks = 0;
+    uint64_t handler_count = 0;
+
     if (core == NULL)
         return;
 
-    memset(&core->reg, 0, sizeof(emcs51_core_reg_t));
+    sp = &core->self_profile;
+
+    // 插入排序，按耗时降序，耗时相同（时钟粗糙时常为0）按执行次数降序
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t j = i;
+
+        handler_ticks += sp->op_ticks[i];
+        handler_count += sp->op_count[i];
+
+        while ((j > 0) && ((sp->op_ticks[order[j - 1]] < sp->op_ticks[i]) ||
+                           ((sp->op_ticks[order[j - 1]] == sp->op_ticks[i]) && (sp->op_count[order[j - 1]] < sp->op_count[i]))))
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+
+        order[j] = (uint8_t)i;
+    }
+
+    printf("[EMCS51][self_profile] ==================================================\r\n");
+    printf("[EMCS51][self_profile] op  %-28s %14s %16s %9s %6s\r\n", "mnemonic", "count", "ticks", "ticks/op", "%");
+
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint8_t op = order[i];
+        const char *mnemonic = core->inst_def[op].mnemonic;
+
+        if (sp->op_count[op] == 0)
+            continue;
+
+        printf("[EMCS51][self_profile] %02X  %-28s %14llu %16llu %9.1f %6.2f\r\n", op, mnemonic ? mnemonic : "?",
+               (unsigned long long)sp->op_count[op], (unsigned long long)sp->op_ticks[op],
+               (double)sp->op_ticks[op] / (double)sp->op_count[op],
+               (handler_ticks != 0) ? (100.0 * (double)sp->op_ticks[op] / (double)handler_ticks) : 0.0);
+    }
+
+    printf("[EMCS51][self_profile] --------------------------------------------------\r\n");
+
+    for (uint32_t i = 0; i < EMCS51_SELF_PROFILE_CB_COUNT; i++)
+    {
+        if (sp->cb_count[i] == 0)
+            continue;
+
+        printf("[EMCS51][self_profile]     %-28s %14llu %16llu %9.1f\r\n", cb_names[i], (unsigned long long)sp->cb_count[i],
+               (unsigned long long)sp->cb_ticks[i], (double)sp->cb_ticks[i] / (double)sp->cb_count[i]);
+    }
+
+    printf("[EMCS51][self_profile]     %-28s %14llu %16llu\r\n", "handlers", (unsigned long long)handler_count,
+           (unsigned long long)handler_ticks);
+
+    // 取指、译码、分派以及跟踪、剖析等的开销
+    if (sp->run_ticks >= handler_ticks)
+    {
+        printf("[EMCS51][self_profile]     %-28s %14s %16llu %9.1f\r\n", "run overhead", "", (unsigned long long)(sp->run_ticks - handler_ticks),
+               (handler_count != 0) ? ((double)(sp->run_ticks - handler_ticks) / (double)handler_count) : 0.0);
+    }
+
+    printf("[EMCS51][self_profile] ==================================================\r\n");
 }
+#endif // EMCS51_SELF_PROFILE
 
 /*******************************************************************************
- * @brief 执行单条指令
+ * @brief 按区域填写XDATA页表
+ * @param core  核心结构体指针
+ * @param index 区域序号
+ * @return none
+ ******************************************************************************/
+static void emcs51_core_apply_xdata_region(emcs51_core_t *core, uint8_t index)
+{
+    emcs51_xdata_region_t *region = &core->xdata_regions[index];
+    uint32_t end = region->start + region->len;
+
+    if ((region->type == EMCS51_XDATA_UNMAPPED) || (region->len == 0))
+        return;
+
+    if (end > 0x10000)
+        end = 0x10000;
+
+    for (uint32_t page_addr = region->start; page_addr < end; page_addr += 0x100)
+    {
+        uint32_t page = page_addr >> 8;
+        uint8_t *mem = NULL;
+
+        // 只有整页都在区域内才走快速路径，间接模式下 xdata_ram 总是走慢速路径
+        if ((region->type != EMCS51_XDATA_MMIO) && ((page_addr + 0x100) <= end) && !((index == 0) && core->xdata_ram_indirect))
+            mem = &region->mem[page_addr - region->start];
+
+        // 被观察的页走慢速路径，由 emcs51_watch_access() 检查
+        core->xdata_page_region[page] = index + 1;
+        core->xdata_rd[page] = EMCS51_CORE_WATCH_BIT(core->watch_xdata_rd, page) ? NULL : mem;
+        core->xdata_wr[page] = ((region->type == EMCS51_XDATA_RAM) && !EMCS51_CORE_WATCH_BIT(core->watch_xdata_wr, page)) ? mem : NULL;
+    }
+}
+
+/*******************************************************************************
+ * @brief 重建XDATA页表，后映射的区域覆盖先映射的区域
  * @param core 核心结构体指针
  * @return none
  ******************************************************************************/
-void emcs51_core_inc(emcs51_core_t *core)
+void emcs51_core_rebuild_xdata_map(emcs51_core_t *core)
 {
-    int err;
-    uint8_t opcode = 0;
+    memset(core->xdata_rd, 0, sizeof(core->xdata_rd));
+    memset(core->xdata_wr, 0, sizeof(core->xdata_wr));
+    memset(core->xdata_page_region, 0, sizeof(core->xdata_page_region));
+
+    for (uint8_t i = 0; i < core->xdata_region_count; i++)
+        emcs51_core_apply_xdata_region(core, i);
+}
+
+/*******************************************************************************
+ * @brief 设置XDATA区内存
+ * @param core 核心结构体指针
+ * @param xdata_ram XDATA区内存指针
+ * @param xdata_ram_size XDATA区内存大小
+ * @return none
+ * @details 映射到 0x0000 起始的0号区域，快照和脏页标记只针对这块内存；
+ *          用 emcs51_core_map_xdata 映射的其它区域保持不变
+ ******************************************************************************/
+void emcs51_core_set_xdata_ram(emcs51_core_t *core, uint8_t *xdata_ram, uint32_t xdata_ram_size)
+{
+    emcs51_xdata_region_t *region;
 
     if (core == NULL)
-    {
         return;
-    }
 
-    if (core->err < 0)
+    if (xdata_ram_size > 0x10000)
+        xdata_ram_size = 0x10000;
+
+    region = &core->xdata_regions[0];
+
+    // 间接模式下0号区域不在页表中，换成同样大小的另一块内存只需更新区域
+    if (core->xdata_ram_indirect && (xdata_ram != NULL) && (xdata_ram_size == core->xdata_ram_size) && (region->type == EMCS51_XDATA_RAM))
     {
+        core->xdata_ram = xdata_ram;
+        region->mem = xdata_ram;
+        emcs51_core_clear_xdata_dirty(core);
         return;
     }
 
-    // printf("[EMCS51_core] pc: 0x%04X\r\n", core->reg.pc);
+    core->xdata_ram = xdata_ram;
+    core->xdata_ram_size = xdata_ram_size;
 
-    err = core->read_code_cb(core->reg.pc, &opcode, 1);
-    if (err < 0)
+    memset(region, 0, sizeof(emcs51_xdata_region_t));
+
+    if ((xdata_ram != NULL) && (xdata_ram_size > 0))
     {
-        core->err = err;
-        return;
+        region->type = EMCS51_XDATA_RAM;
+        region->len = xdata_ram_size;
+        region->mem = xdata_ram;
     }
 
-    // printf("[EMCS51_core] opcode: 0x%02X\r\n", opcode);
+    emcs51_core_rebuild_xdata_map(core);
+    emcs51_core_clear_xdata_dirty(core);
+}
 
-    // read instruction operands
-    emcs51_inst_def_t *inst_def = &core->inst_def[opcode];
+/*******************************************************************************
+ * @brief 设置 xdata_ram 的间接模式
+ * @param core     核心结构体指针
+ * @param indirect 非0时 xdata_ram 的访问都走慢速路径，emcs51_core_set_xdata_ram()
+ *                 换成同样大小的另一块内存时不再重建页表
+ * @return none
+ * @details 供需要频繁切换XDATA区的场合使用，如lane引擎的回退执行
+ ******************************************************************************/
+void emcs51_core_set_xdata_ram_indirect(emcs51_core_t *core, uint8_t indirect)
+{
+    if (core == NULL)
+        return;
 
-    if ((inst_def->mnemonic == NULL) || (inst_def->cycles == 0))
-    {
-        printf("[EMCS51_core] unknown opcode: 0x%02X\r\n", opcode);
-        core->err = EMCS51_ERR_UNKNOWN_INST;
+    core->xdata_ram_indirect = indirect;
+    emcs51_core_rebuild_xdata_map(core);
+}
+
+/*******************************************************************************
+ * @brief 映射一段XDATA区域
+ * @param core   核心结构体指针
+ * @param region 区域描述，内容被复制，起始地址须256字节对齐
+ * @return emcs51_err_t
+ * @details 页表以256字节为单位，一页只属于一个区域，后映射的区域覆盖先映射的区域；
+ *          区域不足一页的部分（如只有几个寄存器的外设）仍占用整页，页内区域以外的地址按未映射处理
+ ******************************************************************************/
+int emcs51_core_map_xdata(emcs51_core_t *core, const emcs51_xdata_region_t *region)
+{
+    if (core == NULL)
+        return EMCS51_ERR_CORE_NULL;
+
+    if ((region == NULL) || (region->start & 0xFF) || (region->start >= 0x10000) || (region->len == 0))
+        return EMCS51_ERR;
+
+    if ((region->type == EMCS51_XDATA_UNMAPPED) || (region->type > EMCS51_XDATA_MMIO))
+        return EMCS51_ERR;
+
+    if ((region->type != EMCS51_XDATA_MMIO) && (region->mem == NULL))
+        return EMCS51_ERR;
+
+    if (core->xdata_region_count >= EMCS51_XDATA_REGION_MAX)
+        return EMCS51_ERR;
+
+    core->xdata_regions[core->xdata_region_count] = *region;
+    emcs51_core_apply_xdata_region(core, core->xdata_region_count);
+    core->xdata_region_count++;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 取消 emcs51_core_map_xdata 映射的所有区域，只保留 xdata_ram
+ * @param core 核心结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_core_unmap_xdata(emcs51_core_t *core)
+{
+    if (core == NULL)
         return;
-    }
 
-    // printf("[EMCS51_core] mnemonic: %s\r\n", inst_def->mnemonic);
+    core->xdata_region_count = 1;
+    emcs51_core_rebuild_xdata_map(core);
+}
 
-    err = core->read_code_cb(core->reg.pc + 1, (uint8_t *)core->operands, inst_def->length);
-    if (err < 0)
-    {
-        core->err = err;
+/*******************************************************************************
+ * @brief 设置访问未映射XDATA地址时的行为
+ * @param core 核心结构体指针
+ * @param mode emcs51_xdata_unmapped_modes_t
+ * @return none
+ ******************************************************************************/
+void emcs51_core_set_xdata_unmapped(emcs51_core_t *core, uint8_t mode)
+{
+    if (core == NULL)
         return;
-    }
 
-    // printf("[EMCS51_core] pc: 0x%04X opcode: 0x%02X mnemonic: %s\r\n", core->reg.pc, opcode, inst_def->mnemonic);
+    core->xdata_unmapped_mode = mode;
+}
 
-    // execute instruction
-    if (inst_def->exec_cb != NULL)
+/*******************************************************************************
+ * @brief 设置XDATA区脏页大小
+ * @param core      核心结构体指针
+ * @param page_size 脏页大小，2的幂，64 ~ 65536 字节
+ * @return emcs51_err_t
+ * @details 修改页大小会清空已有的脏页标记，之后的快照需要完整拷贝一次
+ ******************************************************************************/
+int emcs51_core_set_xdata_page_size(emcs51_core_t *core, uint32_t page_size)
+{
+    uint8_t shift;
+
+    if (core == NULL)
+        return EMCS51_ERR_CORE_NULL;
+
+    for (shift = EMCS51_XDATA_PAGE_SHIFT_MIN; shift <= EMCS51_XDATA_PAGE_SHIFT_MAX; shift++)
     {
-        emcs51_inst_exec_event_t event = {
-            .opcode = opcode,
-            .core = core,
-            .inst_def = inst_def,
-        };
-        inst_def->exec_cb(&event);
+        if (page_size == ((uint32_t)1 << shift))
+        {
+            core->xdata_page_shift = shift;
+            emcs51_core_clear_xdata_dirty(core);
+            core->xdata_dirty_owner = NULL;
+            return EMCS51_OK;
+        }
     }
 
-    if (((uint16_t)core->reg.pc + 1 + inst_def->length) > 0xFFFF)
-    {
-        core->err = EMCS51_ERR_CODE_OUT_OF_RANGE;
+    return EMCS51_ERR;
+}
+
+/*******************************************************************************
+ * @brief 清除XDATA区脏页标记
+ * @param core 核心结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_core_clear_xdata_dirty(emcs51_core_t *core)
+{
+    if (core == NULL)
         return;
-    }
 
-    // instruction execution completed
+    memset(core->xdata_dirty, 0, sizeof(core->xdata_dirty));
+    core->xdata_dirty_pages = 0;
+}
 
-    if (core->is_jumped == false)
-        core->reg.pc += (1 + inst_def->length);
+/*******************************************************************************
+ * @brief 标记XDATA脏页并通知钩子
+ ******************************************************************************/
+static void emcs51_core_xdata_written(emcs51_core_t *core, uint16_t addr, uint8_t data)
+{
+    EMCS51_TRACE_WRITE(core, EMCS51_SPACE_XDATA, addr, data);
 
-    if (core->is_jumped)
-    {
-        core->is_jumped = false;
+    if (core->hook && core->hook->write_cb)
+        core->hook->write_cb(core->hook->ctx, core, EMCS51_SPACE_XDATA, addr, data);
 
-        // printf("[EMCS51_core] jump to 0x%04X\r\n", core->reg.pc);
+    // 脏页只针对 xdata_ram
+    if (addr >= core->xdata_ram_size)
+        return;
+
+    uint32_t page = (uint32_t)addr >> core->xdata_page_shift;
+    uint32_t mask = (uint32_t)1 << (page & 31);
+
+    if ((core->xdata_dirty[page >> 5] & mask) == 0)
+    {
+        core->xdata_dirty[page >> 5] |= mask;
+        core->xdata_dirty_pages++;
     }
 }
 
 /*******************************************************************************
- * @brief 读取通用寄存器R0~R7
+ * @brief 标记一段 xdata_ram 为脏页，供绕过 emcs51_core_write_xdata() 的批量写入使用
  * @param core 核心结构体指针
- * @param n    寄存器编号
- * @param data 读取的数据
- * @return emcs51_err_t
+ * @param addr 起始地址
+ * @param len  长度
+ * @return none
  ******************************************************************************/
-int emcs51_core_read_GPR(emcs51_core_t *core, uint8_t n, uint8_t *data)
+void emcs51_core_mark_xdata_dirty(emcs51_core_t *core, uint16_t addr, uint32_t len)
 {
-    uint8_t reg_bank = core->reg.rs;
+    uint32_t end = (uint32_t)addr + len;
+    uint32_t page;
 
-    if (n > 7)
-        return EMCS51_ERR;
+    if (end > core->xdata_ram_size)
+        end = core->xdata_ram_size;
 
-    uint8_t iram_addr = (reg_bank * 8) + n;
+    if ((len == 0) || (addr >= end))
+        return;
 
-    *data = core->data_ram[iram_addr];
+    for (page = (uint32_t)addr >> core->xdata_page_shift; page <= ((end - 1) >> core->xdata_page_shift); page++)
+    {
+        uint32_t mask = (uint32_t)1 << (page & 31);
 
-    return EMCS51_OK;
+        if ((core->xdata_dirty[page >> 5] & mask) == 0)
+        {
+            core->xdata_dirty[page >> 5] |= mask;
+            core->xdata_dirty_pages++;
+        }
+    }
 }
 
 /*******************************************************************************
- * @brief 写入通用寄存器R0~R7
- * @param core 核心结构体指针
- * @param n    寄存器编号
- * @param data 写入的数据
- * @return emcs51_err_t
+ * @brief 查找XDATA地址所在区域
+ * @param core   核心结构体指针
+ * @param addr   XDATA地址
+ * @param offset 输出区域内偏移
+ * @return 区域指针，未映射返回NULL
  ******************************************************************************/
-int emcs51_core_write_GPR(emcs51_core_t *core, uint8_t n, uint8_t data)
+static emcs51_xdata_region_t *emcs51_core_find_xdata_region(emcs51_core_t *core, uint16_t addr, uint32_t *offset)
 {
-    uint8_t reg_bank = core->reg.rs;
+    uint8_t index = core->xdata_page_region[addr >> 8];
+    emcs51_xdata_region_t *region;
 
-    if (n > 7)
-        return EMCS51_ERR;
+    if (index == 0)
+        return NULL;
 
-    uint8_t iram_addr = (reg_bank * 8) + n;
+    region = &core->xdata_regions[index - 1];
+    *offset = (uint32_t)addr - region->start;
 
-    core->data_ram[iram_addr] = data;
+    if (*offset >= region->len)
+        return NULL;
 
-    return EMCS51_OK;
+    return region;
 }
 
-int emcs51_core_read_DPTR(emcs51_core_t *core, uint16_t *data)
+/*******************************************************************************
+ * @brief 读取XDATA区的慢速路径：外设、未映射、不足一页及被观察的页
+ ******************************************************************************/
+static int emcs51_core_read_xdata_slow(emcs51_core_t *core, uint16_t addr, uint8_t *data)
 {
+    emcs51_xdata_region_t *region;
+    emcs51_core_hook_t *hook = core->hook;
+    uint32_t offset = 0;
+    int err;
 
-    uint8_t DPH_data = core->data_ram[0x82];
-    uint8_t DPL_data = core->data_ram[0x83];
+    region = emcs51_core_find_xdata_region(core, addr, &offset);
 
-    *data = ((uint16_t)DPH_data << 8) | DPL_data;
+    if (region == NULL)
+    {
+        if ((core->xdata_unmapped_mode == EMCS51_XDATA_UNMAPPED_WRAP) && (core->xdata_ram_size > 0))
+        {
+            *data = core->xdata_ram[addr % core->xdata_ram_size];
+            return EMCS51_OK;
+        }
+
+        if (core->xdata_unmapped_mode == EMCS51_XDATA_UNMAPPED_ERROR)
+            return EMCS51_ERR_XDATA_OUT_OF_RANGE;
+
+        *data = 0xFF;
+        return EMCS51_OK;
+    }
+
+    if (region->type != EMCS51_XDATA_MMIO)
+    {
+        *data = region->mem[offset];
+        return EMCS51_OK;
+    }
+
+    emcs51_input_t input = {
+        .cycle = core->cycles,
+        .type = EMCS51_INPUT_XDATA_READ,
+        .addr = addr,
+        .data = 0xFF,
+    };
+
+    if (hook && hook->replay_cb && (hook->replay_cb(hook->ctx, core, &input) > 0))
+    {
+        *data = input.data;
+        return EMCS51_OK;
+    }
+
+    if (region->read_cb != NULL)
+    {
+        EMCS51_SELF_PROFILE_CALL(core, EMCS51_SELF_PROFILE_CB_XDATA_READ, err = region->read_cb(core, region->ctx, addr, &input.data));
+        if (err < 0)
+            return err;
+    }
+
+    if (hook && hook->record_cb)
+        hook->record_cb(hook->ctx, core, &input);
+
+    *data = input.data;
 
     return EMCS51_OK;
 }
 
-int emcs51_core_write_DPTR(emcs51_core_t *core, uint16_t data)
+/*******************************************************************************
+ * @brief 读取XDATA区
+ * @param core 核心结构体指针
+ * @param addr XDATA地址
+ * @param data 读取的数据
+ * @return emcs51_err_t
+ * @details 主机内存页直接读取；外设区域的读取值视为外部输入，可被记录和回放
+ ******************************************************************************/
+int emcs51_core_read_xdata(emcs51_core_t *core, uint16_t addr, uint8_t *data)
 {
-    uint8_t DPH_data = (data >> 8) & 0xFF;
-    uint8_t DPL_data = data & 0xFF;
+    const uint8_t *page = core->xdata_rd[addr >> 8];
+    int err;
+
+    if (page != NULL)
+    {
+        *data = page[addr & 0xFF];
+        return EMCS51_OK;
+    }
+
+    err = emcs51_core_read_xdata_slow(core, addr, data);
+
+    if ((err >= 0) && EMCS51_CORE_WATCH_BIT(core->watch_xdata_rd, addr >> 8))
+        emcs51_watch_access(core, EMCS51_SPACE_XDATA, EMCS51_WATCH_READ, addr, *data, *data);
 
-    core->data_ram[0x82] = DPH_data;
-    core->data_ram[0x83] = DPL_data;
+    return err;
+}
+
+/*******************************************************************************
+ * @brief 写入XDATA区的慢速路径
+ ******************************************************************************/
+static int emcs51_core_write_xdata_slow(emcs51_core_t *core, uint16_t addr, uint8_t data)
+{
+    emcs51_xdata_region_t *region;
+    uint32_t offset = 0;
+    int err;
+
+    region = emcs51_core_find_xdata_region(core, addr, &offset);
+
+    if (region == NULL)
+    {
+        if ((core->xdata_unmapped_mode == EMCS51_XDATA_UNMAPPED_WRAP) && (core->xdata_ram_size > 0))
+        {
+            addr = (uint16_t)(addr % core->xdata_ram_size);
+            core->xdata_ram[addr] = data;
+            emcs51_core_xdata_written(core, addr, data);
+            return EMCS51_OK;
+        }
+
+        if (core->xdata_unmapped_mode == EMCS51_XDATA_UNMAPPED_ERROR)
+            return EMCS51_ERR_XDATA_OUT_OF_RANGE;
+
+        return EMCS51_OK;
+    }
+
+    switch (region->type)
+    {
+    case EMCS51_XDATA_RAM:
+        region->mem[offset] = data;
+        break;
+
+    case EMCS51_XDATA_MMIO:
+        if (region->write_cb != NULL)
+        {
+            EMCS51_SELF_PROFILE_CALL(core, EMCS51_SELF_PROFILE_CB_XDATA_WRITE, err = region->write_cb(core, region->ctx, addr, data));
+            if (err < 0)
+                return err;
+        }
+        break;
+
+    default: // ROM
+        return EMCS51_OK;
+    }
+
+    emcs51_core_xdata_written(core, addr, data);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 不经过外设回调和观察点读取XDATA当前值，外设和未映射地址返回0xFF
+ * @param core 核心结构体指针
+ * @param addr XDATA地址
+ * @return 当前值
+ ******************************************************************************/
+uint8_t emcs51_core_peek_xdata(emcs51_core_t *core, uint16_t addr)
+{
+    emcs51_xdata_region_t *region;
+    uint32_t offset = 0;
+
+    region = emcs51_core_find_xdata_region(core, addr, &offset);
+
+    if (region == NULL)
+    {
+        if ((core->xdata_unmapped_mode == EMCS51_XDATA_UNMAPPED_WRAP) && (core->xdata_ram_size > 0))
+            return core->xdata_ram[addr % core->xdata_ram_size];
+
+        return 0xFF;
+    }
+
+    if (region->type == EMCS51_XDATA_MMIO)
+        return 0xFF;
+
+    return region->mem[offset];
+}
+
+/*******************************************************************************
+ * @brief 不经过外设回调和观察点写入XDATA主机内存（包括ROM），供调试器使用
+ * @param core 核心结构体指针
+ * @param addr XDATA地址
+ * @param data 写入的数据
+ * @return emcs51_err_t，外设和未映射地址返回 EMCS51_ERR_XDATA_OUT_OF_RANGE
+ ******************************************************************************/
+int emcs51_core_poke_xdata(emcs51_core_t *core, uint16_t addr, uint8_t data)
+{
+    emcs51_xdata_region_t *region;
+    uint32_t offset = 0;
+
+    region = emcs51_core_find_xdata_region(core, addr, &offset);
+
+    if (region == NULL)
+    {
+        if ((core->xdata_unmapped_mode != EMCS51_XDATA_UNMAPPED_WRAP) || (core->xdata_ram_size == 0))
+            return EMCS51_ERR_XDATA_OUT_OF_RANGE;
+
+        addr = (uint16_t)(addr % core->xdata_ram_size);
+        core->xdata_ram[addr] = data;
+    }
+    else if (region->type == EMCS51_XDATA_MMIO)
+    {
+        return EMCS51_ERR_XDATA_OUT_OF_RANGE;
+    }
+    else
+    {
+        region->mem[offset] = data;
+    }
+
+    emcs51_core_xdata_written(core, addr, data);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 写入XDATA区，并标记所在脏页
+ * @param core 核心结构体指针
+ * @param addr XDATA地址
+ * @param data 写入的数据
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_core_write_xdata(emcs51_core_t *core, uint16_t addr, uint8_t data)
+{
+    uint8_t *page = core->xdata_wr[addr >> 8];
+    uint8_t old_value;
+    int err;
+
+    if (page != NULL)
+    {
+        page[addr & 0xFF] = data;
+        emcs51_core_xdata_written(core, addr, data);
+        return EMCS51_OK;
+    }
+
+    if (!EMCS51_CORE_WATCH_BIT(core->watch_xdata_wr, addr >> 8))
+        return emcs51_core_write_xdata_slow(core, addr, data);
+
+    old_value = emcs51_core_peek_xdata(core, addr);
+
+    err = emcs51_core_write_xdata_slow(core, addr, data);
+    if (err >= 0)
+        emcs51_watch_access(core, EMCS51_SPACE_XDATA, EMCS51_WATCH_WRITE, addr, old_value, data);
+
+    return err;
+}
+
+/*******************************************************************************
+ * @brief 读取DATA区（直接寻址），注册了读取回调的地址视为外部输入
+ * @param core 核心结构体指针
+ * @param addr 直接地址
+ * @param data 读取的数据
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_core_read_data(emcs51_core_t *core, uint8_t addr, uint8_t *data)
+{
+    emcs51_read_data_cb_t read_data_cb = core->read_data_cb[addr];
+    emcs51_core_hook_t *hook = core->hook;
+    int err;
+
+    if (read_data_cb == NULL)
+    {
+        *data = core->data_ram[addr];
+
+        if (EMCS51_CORE_WATCH_BIT(core->watch_data_rd, addr))
+            emcs51_watch_access(core, EMCS51_CORE_DATA_SPACE(addr), EMCS51_WATCH_READ, addr, *data, *data);
+
+        return EMCS51_OK;
+    }
+
+    emcs51_input_t input = {
+        .cycle = core->cycles,
+        .type = EMCS51_INPUT_SFR_READ,
+        .addr = addr,
+        .data = core->data_ram[addr],
+    };
+
+    if (hook && hook->replay_cb && (hook->replay_cb(hook->ctx, core, &input) > 0))
+    {
+        *data = input.data;
+        return EMCS51_OK;
+    }
+
+    EMCS51_SELF_PROFILE_CALL(core, EMCS51_SELF_PROFILE_CB_READ_DATA, err = read_data_cb(core, core->user, addr, &input.data));
+    if (err < 0)
+        return err;
+
+    if (hook && hook->record_cb)
+        hook->record_cb(hook->ctx, core, &input);
+
+    *data = input.data;
+
+    if (EMCS51_CORE_WATCH_BIT(core->watch_data_rd, addr))
+        emcs51_watch_access(core, EMCS51_CORE_DATA_SPACE(addr), EMCS51_WATCH_READ, addr, *data, *data);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 写入DATA区（直接寻址），先调用写入回调再更新DATA区
+ * @param core 核心结构体指针
+ * @param addr 直接地址
+ * @param data 写入的数据
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_core_write_data(emcs51_core_t *core, uint8_t addr, uint8_t data)
+{
+    emcs51_write_data_cb_t write_data_cb = core->write_data_cb[addr];
+
+    // 未实现的DPS位读回为0，dps_sfr 为0时掩码为0xFF
+    if (addr == core->dps_sfr)
+        data &= core->dps_write_mask;
+
+    if (write_data_cb)
+        EMCS51_SELF_PROFILE_CALL(core, EMCS51_SELF_PROFILE_CB_WRITE_DATA, write_data_cb(core, core->user, addr, data));
+
+    if (EMCS51_CORE_WATCH_BIT(core->watch_data_wr, addr))
+        emcs51_watch_access(core, EMCS51_CORE_DATA_SPACE(addr), EMCS51_WATCH_WRITE, addr, core->data_ram[addr], data);
+
+    core->data_ram[addr] = data;
+    EMCS51_TRACE_WRITE(core, EMCS51_CORE_DATA_SPACE(addr), addr, data);
+
+    if ((addr == core->code_bank_sfr) && (addr != 0))
+        emcs51_core_update_code_bank(core);
+
+    if (core->hook && core->hook->write_cb)
+        core->hook->write_cb(core->hook->ctx, core, EMCS51_CORE_DATA_SPACE(addr), addr, data);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 设置核心钩子
+ * @param core 核心结构体指针
+ * @param hook 钩子结构体指针，NULL 表示移除
+ * @return none
+ ******************************************************************************/
+void emcs51_core_set_hook(emcs51_core_t *core, emcs51_core_hook_t *hook)
+{
+    if (core == NULL)
+        return;
+
+    core->hook = hook;
+}
+
+/*******************************************************************************
+ * @brief 设置异步输入生效回调，外设模型在此回调中更新自身状态
+ * @param core     核心结构体指针
+ * @param input_cb 回调函数
+ * @return none
+ ******************************************************************************/
+void emcs51_core_set_input_cb(emcs51_core_t *core, emcs51_input_cb_t input_cb)
+{
+    if (core == NULL)
+        return;
+
+    core->input_cb = input_cb;
+}
+
+/*******************************************************************************
+ * @brief 产生异步外部输入（中断、串口接收字节等）
+ * @param core 核心结构体指针
+ * @param type 输入类型 emcs51_input_types_t
+ * @param addr 输入地址
+ * @param data 输入数据
+ * @return emcs51_err_t
+ * @details 输入会被记录并通过 input_cb 生效；回放期间输入来自日志，此处的输入被丢弃
+ ******************************************************************************/
+int emcs51_core_raise_input(emcs51_core_t *core, uint8_t type, uint16_t addr, uint8_t data)
+{
+    emcs51_core_hook_t *hook;
+
+    if (core == NULL)
+        return EMCS51_ERR_CORE_NULL;
+
+    if (!EMCS51_INPUT_IS_ASYNC(type))
+        return EMCS51_ERR;
+
+    hook = core->hook;
+
+    emcs51_input_t input = {
+        .cycle = core->cycles,
+        .type = type,
+        .addr = addr,
+        .data = data,
+    };
+
+    if (hook && hook->replay_cb && (hook->replay_cb(hook->ctx, core, &input) > 0))
+        return EMCS51_OK;
+
+    if (hook && hook->record_cb)
+        hook->record_cb(hook->ctx, core, &input);
+
+    if (core->input_cb)
+        core->input_cb(core, core->user, &input);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 复位核心
+ * @param core 核心结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_core_reset(emcs51_core_t *core)
+{
+    if (core == NULL)
+        return;
+
+    memset(&core->reg, 0, sizeof(emcs51_core_reg_t));
+}
+
+/*******************************************************************************
+ * @brief 读取code区存储器
+ * @param core 核心结构体指针
+ * @param addr code地址
+ * @param data 读取的数据
+ * @param len  读取长度
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_core_read_code(emcs51_core_t *core, uint16_t addr, uint8_t *data, uint16_t len)
+{
+    int err;
+
+    if (core->code_type == EMCS51_CODE_BUFFER)
+    {
+        uint32_t page = (uint32_t)addr >> 15;
+
+        // 跨越公共区与分组窗口边界时逐字节读取
+        if ((len > 1) && ((((uint32_t)addr + len - 1) >> 15) != page))
+        {
+            for (uint16_t i = 0; i < len; i++)
+            {
+                err = emcs51_core_read_code(core, (uint16_t)(addr + i), &data[i], 1);
+
+                if (err < 0)
+                    return err;
+            }
+
+            return EMCS51_OK;
+        }
+
+        if (((uint32_t)(addr & 0x7FFF) + len) > core->code_page_len[page])
+            return EMCS51_ERR_CODE_OUT_OF_RANGE;
+
+        memcpy(data, &core->code_page[page][addr & 0x7FFF], len);
+
+        return EMCS51_OK;
+    }
+
+    EMCS51_SELF_PROFILE_CALL(core, EMCS51_SELF_PROFILE_CB_READ_CODE, err = core->read_code_cb(core, core->user, addr, data, len));
+
+    return err;
+}
+
+/*******************************************************************************
+ * @brief 读取code区单个字节，取指和MOVC查表使用
+ * @param core 核心结构体指针
+ * @param addr code区地址
+ * @param data 读取的数据
+ * @return emcs51_err_t
+ * @details code区为缓冲区时直接查页表，不经过 memcpy 和回调
+ ******************************************************************************/
+int emcs51_core_read_code_byte(emcs51_core_t *core, uint16_t addr, uint8_t *data)
+{
+    int err;
+
+    if (core->code_type == EMCS51_CODE_BUFFER)
+    {
+        uint32_t page = (uint32_t)addr >> 15;
+
+        if ((uint32_t)(addr & 0x7FFF) >= core->code_page_len[page])
+            return EMCS51_ERR_CODE_OUT_OF_RANGE;
+
+        *data = core->code_page[page][addr & 0x7FFF];
+
+        return EMCS51_OK;
+    }
+
+    EMCS51_SELF_PROFILE_CALL(core, EMCS51_SELF_PROFILE_CB_READ_CODE, err = core->read_code_cb(core, core->user, addr, data, 1));
+
+    return err;
+}
+
+/*******************************************************************************
+ * @brief 按分组SFR的当前值更新分组窗口页
+ * @param core 核心结构体指针
+ * @return none
+ * @details 分组SFR被写入、快照恢复等直接改写data_ram之后调用；
+ *          回调访问code区时，回调需自行根据分组SFR选择分组
+ ******************************************************************************/
+void emcs51_core_update_code_bank(emcs51_core_t *core)
+{
+    uint32_t base;
+
+    if (core == NULL)
+        return;
+
+    core->code_page[1] = NULL;
+    core->code_page_len[1] = 0;
+
+    if (core->code_bank_sfr == 0)
+    {
+        core->code_bank = 0;
+        base = EMCS51_CODE_BANK_WINDOW;
+    }
+    else
+    {
+        core->code_bank = (uint8_t)((core->data_ram[core->code_bank_sfr] & core->code_bank_mask) >> core->code_bank_shift);
+
+        if (core->code_banks != NULL)
+        {
+            if (core->code_bank < core->code_bank_count)
+            {
+                core->code_page[1] = core->code_banks[core->code_bank];
+                core->code_page_len[1] = core->code_bank_len;
+            }
+
+            return;
+        }
+
+        base = ((uint32_t)core->code_bank << 16) + EMCS51_CODE_BANK_WINDOW;
+    }
+
+    if ((core->code_buffer != NULL) && (core->code_len > base))
+    {
+        core->code_page[1] = core->code_buffer + base;
+        core->code_page_len[1] = core->code_len - base;
+
+        if (core->code_page_len[1] > EMCS51_CODE_BANK_WINDOW)
+            core->code_page_len[1] = EMCS51_CODE_BANK_WINDOW;
+    }
+}
+
+/*******************************************************************************
+ * @brief 执行单条指令
+ * @param core 核心结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_core_inc(emcs51_core_t *core)
+{
+    int err;
+    uint8_t opcode = 0;
+    uint16_t inst_pc;
+#if EMCS51_TRACE_ENABLE || EMCS51_PROFILE_ENABLE
+    uint64_t inst_cycles;
+#endif
+
+    if (core == NULL)
+    {
+        return;
+    }
+
+    if (core->err < 0)
+    {
+        return;
+    }
+
+    // printf("[EMCS51_core] pc: 0x%04X\r\n", core->reg.pc);
+
+    err = emcs51_core_read_code_byte(core, core->reg.pc, &opcode);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    // printf("[EMCS51_core] opcode: 0x%02X\r\n", opcode);
+
+    // read instruction operands
+    emcs51_inst_def_t *inst_def = &core->inst_def[opcode];
+
+    if ((inst_def->mnemonic == NULL) || (inst_def->cycles == 0))
+    {
+        printf("[EMCS51_core] unknown opcode: 0x%02X\r\n", opcode);
+        core->err = EMCS51_ERR_UNKNOWN_INST;
+        return;
+    }
+
+    // printf("[EMCS51_core] mnemonic: %s\r\n", inst_def->mnemonic);
+
+    err = emcs51_core_read_code(core, core->reg.pc + 1, (uint8_t *)core->operands, inst_def->length);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    // printf("[EMCS51_core] pc: 0x%04X opcode: 0x%02X mnemonic: %s\r\n", core->reg.pc, opcode, inst_def->mnemonic);
+
+    inst_pc = core->reg.pc;
+#if EMCS51_TRACE_ENABLE || EMCS51_PROFILE_ENABLE
+    inst_cycles = core->cycles;
+#endif
+
+    // execute instruction
+    if (inst_def->exec_cb != NULL)
+    {
+        emcs51_inst_exec_event_t event = {
+            .opcode = opcode,
+            .core = core,
+            .inst_def = inst_def,
+        };
+#if EMCS51_SELF_PROFILE
+        emcs51_self_profile_ticks_t t0 = (emcs51_self_profile_ticks_t)EMCS51_SELF_PROFILE_TICKS();
+
+        inst_def->exec_cb(&event);
+
+        core->self_profile.op_count[opcode]++;
+        core->self_profile.op_ticks[opcode] += (emcs51_self_profile_ticks_t)((emcs51_self_profile_ticks_t)EMCS51_SELF_PROFILE_TICKS() - t0);
+#else
+        inst_def->exec_cb(&event);
+#endif
+    }
+
+    if (((uint16_t)core->reg.pc + 1 + inst_def->length) > 0xFFFF)
+    {
+        core->err = EMCS51_ERR_CODE_OUT_OF_RANGE;
+        return;
+    }
+
+    // instruction execution completed
+
+    if (core->is_jumped == false)
+        core->reg.pc += (1 + inst_def->length);
+
+    core->inst_count++;
+    core->cycles += inst_def->cycles;
+
+    if (core->is_jumped)
+    {
+        core->is_jumped = false;
+        core->cycles += inst_def->cycles_jump;
+
+        // printf("[EMCS51_core] jump to 0x%04X\r\n", core->reg.pc);
+    }
+
+    // 断点处的指令未执行
+    if (core->err == EMCS51_ERR_BREAKPOINT)
+        return;
+
+#if EMCS51_TRACE_ENABLE
+    if (core->trace != NULL)
+        emcs51_trace_inst(core->trace, inst_pc, opcode, inst_def->length, inst_cycles);
+#endif
+
+#if EMCS51_PROFILE_ENABLE
+    if (core->profile != NULL)
+        emcs51_profile_inst(core->profile, inst_pc, opcode, (uint32_t)(core->cycles - inst_cycles));
+#endif
+
+    if (core->coverage != NULL)
+        emcs51_coverage_inst(core->coverage, inst_pc, opcode, (uint8_t)(1 + inst_def->length));
+}
+
+/*******************************************************************************
+ * @brief 连续执行指令，直到消耗指定的机器周期或出错
+ * @param core   核心结构体指针
+ * @param cycles 本次最多执行的机器周期数
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_core_run(emcs51_core_t *core, uint64_t cycles)
+{
+    uint64_t end;
+
+    if (core == NULL)
+        return EMCS51_ERR_CORE_NULL;
+
+    end = core->cycles + cycles;
+
+#if EMCS51_SELF_PROFILE
+    emcs51_self_profile_ticks_t t0 = (emcs51_self_profile_ticks_t)EMCS51_SELF_PROFILE_TICKS();
+
+    while ((core->cycles < end) && (core->err >= 0))
+        emcs51_core_inc(core);
+
+    core->self_profile.run_ticks += (emcs51_self_profile_ticks_t)((emcs51_self_profile_ticks_t)EMCS51_SELF_PROFILE_TICKS() - t0);
+
+    return (core->err < 0) ? core->err : EMCS51_OK;
+#else
+    while (core->cycles < end)
+    {
+        emcs51_core_inc(core);
+        if (core->err < 0)
+            return core->err;
+    }
+
+    return EMCS51_OK;
+#endif
+}
+
+/*******************************************************************************
+ * @brief 已执行的振荡器时钟数
+ * @param core 核心结构体指针
+ * @return cycles * clocks_per_cycle
+ ******************************************************************************/
+uint64_t emcs51_core_clocks(emcs51_core_t *core)
+{
+    return core->cycles * core->clocks_per_cycle;
+}
+
+/*******************************************************************************
+ * @brief 读取通用寄存器R0~R7
+ * @param core 核心结构体指针
+ * @param n    寄存器编号
+ * @param data 读取的数据
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_core_read_GPR(emcs51_core_t *core, uint8_t n, uint8_t *data)
+{
+    uint8_t reg_bank = core->reg.rs;
+
+    if (n > 7)
+        return EMCS51_ERR;
+
+    uint8_t iram_addr = (reg_bank * 8) + n;
+
+    *data = core->data_ram[iram_addr];
+
+    if (EMCS51_CORE_WATCH_BIT(core->watch_data_rd, iram_addr))
+        emcs51_watch_access(core, EMCS51_SPACE_IRAM, EMCS51_WATCH_READ, iram_addr, *data, *data);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 写入通用寄存器R0~R7
+ * @param core 核心结构体指针
+ * @param n    寄存器编号
+ * @param data 写入的数据
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_core_write_GPR(emcs51_core_t *core, uint8_t n, uint8_t data)
+{
+    uint8_t reg_bank = core->reg.rs;
+
+    if (n > 7)
+        return EMCS51_ERR;
+
+    uint8_t iram_addr = (reg_bank * 8) + n;
+
+    if (EMCS51_CORE_WATCH_BIT(core->watch_data_wr, iram_addr))
+        emcs51_watch_access(core, EMCS51_SPACE_IRAM, EMCS51_WATCH_WRITE, iram_addr, core->data_ram[iram_addr], data);
+
+    core->data_ram[iram_addr] = data;
+    EMCS51_TRACE_WRITE(core, EMCS51_SPACE_IRAM, iram_addr, data);
+
+    if (core->hook && core->hook->write_cb)
+        core->hook->write_cb(core->hook->ctx, core, EMCS51_SPACE_IRAM, iram_addr, data);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 当前DPTR的DPL地址
+ * @details 单DPTR时 dps_sel_mask 为0，总是 DPTR0
+ ******************************************************************************/
+static uint8_t emcs51_core_dptr_addr(emcs51_core_t *core)
+{
+    return (core->data_ram[core->dps_sfr] & core->dps_sel_mask) ? core->dptr1_addr : EMCS51_DPTR0_ADDR;
+}
+
+int emcs51_core_read_DPTR(emcs51_core_t *core, uint16_t *data)
+{
+    uint8_t dpl = emcs51_core_dptr_addr(core);
+    uint8_t DPL_data = core->data_ram[dpl];
+    uint8_t DPH_data = core->data_ram[dpl + 1];
+
+    *data = ((uint16_t)DPH_data << 8) | DPL_data;
+
+    if (EMCS51_CORE_WATCH_BIT(core->watch_data_rd, dpl) || EMCS51_CORE_WATCH_BIT(core->watch_data_rd, dpl + 1))
+    {
+        emcs51_watch_access(core, EMCS51_SPACE_SFR, EMCS51_WATCH_READ, dpl, DPL_data, DPL_data);
+        emcs51_watch_access(core, EMCS51_SPACE_SFR, EMCS51_WATCH_READ, dpl + 1, DPH_data, DPH_data);
+    }
+
+    return EMCS51_OK;
+}
+
+int emcs51_core_write_DPTR(emcs51_core_t *core, uint16_t data)
+{
+    uint8_t DPH_data = (data >> 8) & 0xFF;
+    uint8_t DPL_data = data & 0xFF;
+    uint8_t dpl = emcs51_core_dptr_addr(core);
+
+    if (EMCS51_CORE_WATCH_BIT(core->watch_data_wr, dpl) || EMCS51_CORE_WATCH_BIT(core->watch_data_wr, dpl + 1))
+    {
+        emcs51_watch_access(core, EMCS51_SPACE_SFR, EMCS51_WATCH_WRITE, dpl, core->data_ram[dpl], DPL_data);
+        emcs51_watch_access(core, EMCS51_SPACE_SFR, EMCS51_WATCH_WRITE, dpl + 1, core->data_ram[dpl + 1], DPH_data);
+    }
+
+    core->data_ram[dpl] = DPL_data;
+    core->data_ram[dpl + 1] = DPH_data;
+    EMCS51_TRACE_WRITE(core, EMCS51_SPACE_SFR, dpl, DPL_data);
+    EMCS51_TRACE_WRITE(core, EMCS51_SPACE_SFR, dpl + 1, DPH_data);
+
+    if (core->hook && core->hook->write_cb)
+    {
+        core->hook->write_cb(core->hook->ctx, core, EMCS51_SPACE_SFR, dpl, DPL_data);
+        core->hook->write_cb(core->hook->ctx, core, EMCS51_SPACE_SFR, dpl + 1, DPH_data);
+    }
 
     return EMCS51_OK;
 }
@@ -6,10 +6,86 @@
 #include <string.h>
 #include "core/emcs51_inst.h"
 
-typedef int (*emcs51_read_code_cb_t)(uint16_t addr, uint8_t *data, uint16_t len);
+struct EMCS51_CORE;
 
-typedef int (*emcs51_write_data_cb_t)(uint8_t addr, uint8_t data);
-typedef int (*emcs51_read_data_cb_t)(uint8_t addr, uint8_t *data);
+// 所有回调都带有核心指针和实例的用户上下文 core->user，外设状态无需放在全局变量中
+typedef int (*emcs51_read_code_cb_t)(struct EMCS51_CORE *core, void *user, uint16_t addr, uint8_t *data, uint16_t len);
+
+typedef int (*emcs51_write_data_cb_t)(struct EMCS51_CORE *core, void *user, uint8_t addr, uint8_t data);
+typedef int (*emcs51_read_data_cb_t)(struct EMCS51_CORE *core, void *user, uint8_t addr, uint8_t *data);
+
+typedef enum EMCS51_SPACE_TYPES
+{
+    EMCS51_SPACE_CODE = 0, // code区
+    EMCS51_SPACE_IRAM,     // 内部RAM，直接寻址0x00~0x7F及间接寻址
+    EMCS51_SPACE_SFR,      // 特殊功能寄存器，直接寻址0x80~0xFF
+    EMCS51_SPACE_XDATA,    // 外部RAM
+} emcs51_space_types_t;
+
+typedef enum EMCS51_INPUT_TYPES
+{
+    EMCS51_INPUT_SFR_READ = 0, // 同步：read_data_cb 返回的值
+    EMCS51_INPUT_XDATA_READ,   // 同步：外部XDATA外设返回的值
+    EMCS51_INPUT_IRQ = 0x80,   // 异步：中断请求
+    EMCS51_INPUT_UART_RX,      // 异步：串口接收字节
+    EMCS51_INPUT_PORT,         // 异步：端口引脚变化
+    EMCS51_INPUT_USER,         // 异步：用户自定义
+} emcs51_input_types_t;
+
+#define EMCS51_INPUT_IS_ASYNC(type) (((type) & 0x80) != 0)
+
+// 外部输入，所有使运行结果不可复现的值都经由此结构
+typedef struct EMCS51_INPUT
+{
+    uint64_t cycle; // 输入发生时的机器周期计数
+    uint8_t type;   // emcs51_input_types_t
+    uint16_t addr;  // SFR/XDATA地址，中断号等
+    uint8_t data;
+} emcs51_input_t;
+
+// XDATA外设（MMIO）回调，ctx 为映射时传入的外设上下文，addr 为完整的XDATA地址
+typedef int (*emcs51_xdata_read_cb_t)(struct EMCS51_CORE *core, void *ctx, uint16_t addr, uint8_t *data);
+typedef int (*emcs51_xdata_write_cb_t)(struct EMCS51_CORE *core, void *ctx, uint16_t addr, uint8_t data);
+
+typedef enum EMCS51_XDATA_REGION_TYPES
+{
+    EMCS51_XDATA_UNMAPPED = 0, // 未映射
+    EMCS51_XDATA_RAM,          // 主机内存，可读写
+    EMCS51_XDATA_ROM,          // 主机内存，只读，写入被忽略
+    EMCS51_XDATA_MMIO,         // 外设回调
+} emcs51_xdata_region_types_t;
+
+typedef enum EMCS51_XDATA_UNMAPPED_MODES
+{
+    EMCS51_XDATA_UNMAPPED_IGNORE = 0, // 忽略写入，读取返回0xFF
+    EMCS51_XDATA_UNMAPPED_WRAP,       // 按 xdata_ram_size 取模访问 xdata_ram（地址线未全部译码）
+    EMCS51_XDATA_UNMAPPED_ERROR,      // 返回 EMCS51_ERR_XDATA_OUT_OF_RANGE，核心停止
+} emcs51_xdata_unmapped_modes_t;
+
+typedef struct EMCS51_XDATA_REGION
+{
+    uint8_t type;   // emcs51_xdata_region_types_t
+    uint32_t start; // 起始地址，256字节对齐
+    uint32_t len;   // 长度，不足一页的部分走慢速路径
+    uint8_t *mem;   // RAM/ROM 的主机内存
+    emcs51_xdata_read_cb_t read_cb;
+    emcs51_xdata_write_cb_t write_cb;
+    void *ctx;
+} emcs51_xdata_region_t;
+
+#define EMCS51_XDATA_REGION_MAX 8 // 包括 xdata_ram 所在的0号区域
+
+typedef void (*emcs51_input_cb_t)(struct EMCS51_CORE *core, void *user, const emcs51_input_t *input);
+
+// 核心钩子，供回放/调试模块观察外部输入和存储器写入
+typedef struct EMCS51_CORE_HOOK
+{
+    // 返回1表示输入已由回放提供（异步输入则表示应丢弃），不再调用用户回调
+    int (*replay_cb)(void *ctx, struct EMCS51_CORE *core, emcs51_input_t *input);
+    void (*record_cb)(void *ctx, struct EMCS51_CORE *core, const emcs51_input_t *input);
+    void (*write_cb)(void *ctx, struct EMCS51_CORE *core, uint8_t space, uint16_t addr, uint8_t data);
+    void *ctx;
+} emcs51_core_hook_t;
 
 typedef enum EMCS51_CODE_TYPES
 {
@@ -22,7 +98,20 @@ typedef struct EMCS51_CORE_CONFIG
 {
     emcs51_code_types_t code_type;
     emcs51_read_code_cb_t read_code_cb;
-    uint8_t *code_buffer;
+    const uint8_t *code_buffer; // EMCS51_CODE_BUFFER：只读code区，可在多个实例间共享
+    uint32_t code_len;          // code_buffer 大小
+
+    // 分组code区（EMCS51_CODE_BUFFER），0x0000~0x7FFF 为公共区，0x8000~0xFFFF 为分组窗口
+    uint8_t code_bank_sfr;              // 选择分组的SFR地址，0 表示不分组
+    uint8_t code_bank_mask;             // 分组号所在位，例如 P1 低两位为 0x03
+    uint8_t code_bank_shift;            // 分组号右移位数
+    const uint8_t *const *code_banks;   // 各分组窗口的内容，NULL 表示第n组位于 code_buffer 的 n*0x10000+0x8000 处
+    uint8_t code_bank_count;            // code_banks 的分组数
+    uint32_t code_bank_len;             // code_banks 中每组的有效长度，不超过 0x8000
+
+    uint8_t pdata_page_sfr; // MOVX @Ri 的高8位地址来源，0 表示 P2，部分型号为 MPAGE 等专用SFR
+
+    void *user; // 实例的用户上下文，传给所有回调
 
 } emcs51_core_config_t;
 
@@ -52,6 +141,45 @@ typedef struct EMCS51_CORE_REG
 
 } emcs51_core_reg_t;
 
+#define EMCS51_XDATA_PAGE_SHIFT_MIN 6     // 最小脏页 64 字节
+#define EMCS51_XDATA_PAGE_SHIFT_MAX 16    // 最大脏页 64 KiB
+#define EMCS51_XDATA_PAGE_SHIFT_DEFAULT 8 // 默认脏页 256 字节
+#define EMCS51_CODE_BANK_WINDOW 0x8000 // 分组窗口起始地址
+#define EMCS51_PDATA_PAGE_SFR_DEFAULT 0xA0 // P2
+#define EMCS51_DPTR0_ADDR 0x82 // DPL, DPH
+#define EMCS51_DPTR1_ADDR 0x84 // DPL1, DPH1 (AT89S52, DS89C4x0)
+
+// 自剖析构建：统计每个操作码处理函数和用户回调耗费的主机时钟，用于优化仿真器本身。
+// 时钟源 x86 为 rdtsc，Cortex-M3/M4/M7 为 DWT CYCCNT，AArch64 为 cntvct_el0，其它主机为 CLOCK_MONOTONIC 纳秒，
+// 可定义 EMCS51_SELF_PROFILE_TICKS() 替换
+#ifndef EMCS51_SELF_PROFILE
+#define EMCS51_SELF_PROFILE 0
+#endif
+
+#if EMCS51_SELF_PROFILE
+typedef enum EMCS51_SELF_PROFILE_CBS
+{
+    EMCS51_SELF_PROFILE_CB_READ_DATA = 0, // read_data_cb
+    EMCS51_SELF_PROFILE_CB_WRITE_DATA,    // write_data_cb
+    EMCS51_SELF_PROFILE_CB_READ_CODE,     // read_code_cb
+    EMCS51_SELF_PROFILE_CB_XDATA_READ,    // XDATA区域 read_cb
+    EMCS51_SELF_PROFILE_CB_XDATA_WRITE,   // XDATA区域 write_cb
+    EMCS51_SELF_PROFILE_CB_COUNT,
+} emcs51_self_profile_cbs_t;
+
+typedef struct EMCS51_SELF_PROFILE_STATS
+{
+    uint64_t op_count[256];
+    uint64_t op_ticks[256]; // exec_cb 的耗时，包括其中调用的用户回调
+    uint64_t cb_count[EMCS51_SELF_PROFILE_CB_COUNT];
+    uint64_t cb_ticks[EMCS51_SELF_PROFILE_CB_COUNT];
+    uint64_t run_ticks; // emcs51_core_run() 的总耗时，减去处理函数即为取指、分派等开销
+} emcs51_self_profile_t;
+#endif
+#define EMCS51_CLOCKS_PER_CYCLE_DEFAULT 12 // 标准8051，一个机器周期12个时钟
+
+#define EMCS51_XDATA_DIRTY_WORDS ((0x10000 >> EMCS51_XDATA_PAGE_SHIFT_MIN) / 32)
+
 typedef struct EMCS51_CORE
 {
     int err;
@@ -61,8 +189,46 @@ typedef struct EMCS51_CORE
     uint8_t *xdata_ram;
     uint32_t xdata_ram_size;
 
+    // XDATA脏页标记，见 emcs51_core_write_xdata()
+    uint8_t xdata_page_shift;
+    uint32_t xdata_dirty_pages;                       // 上次清除以来标记的页数
+    uint32_t xdata_dirty[EMCS51_XDATA_DIRTY_WORDS];   // 每页一位
+    const void *xdata_dirty_owner;                    // 脏页标记所相对的快照
+
+    // XDATA页表，每页256字节：主机内存中的页指向页首，
+    // 其它情况（ROM写入、外设、不足一页和未映射的页）为NULL，走慢速路径
+    uint8_t *xdata_rd[256];
+    uint8_t *xdata_wr[256];
+    uint8_t xdata_page_region[256];                   // 区域序号加1，0 表示未映射
+    emcs51_xdata_region_t xdata_regions[EMCS51_XDATA_REGION_MAX]; // [0] 为 0x0000 起始的 xdata_ram
+    uint8_t xdata_region_count;
+    uint8_t xdata_unmapped_mode;                      // emcs51_xdata_unmapped_modes_t
+    uint8_t pdata_page_sfr;                           // MOVX @Ri 的页寄存器
+    uint8_t xdata_ram_indirect;                       // 非0时 xdata_ram 不进页表，见 emcs51_core_set_xdata_ram_indirect()
+
+    // 双DPTR：DPS 中的 dps_sel_mask 位选择位于 dptr1_addr 的 DPTR1，见 emcs51_derivative_init()
+    uint8_t dps_sfr;
+    uint8_t dptr1_addr;     // DPL1，其后为 DPH1
+    uint8_t dps_sel_mask;   // 0 表示单DPTR
+    uint8_t dps_write_mask; // 已实现的DPS位，其它位读回为0
+    const struct EMCS51_DERIVATIVE *derivative;
+
     emcs51_core_reg_t reg;
+    emcs51_code_types_t code_type;
     emcs51_read_code_cb_t read_code_cb;
+    const uint8_t *code_buffer;
+
+    // 取指按 addr >> 15 选择页，以 addr & 0x7FFF 索引：[0] 公共区，[1] 当前分组，
+    // 切换分组只需改写 code_page[1]
+    const uint8_t *code_page[2];
+    uint32_t code_page_len[2];
+    uint8_t code_bank_sfr;
+    uint8_t code_bank_mask;
+    uint8_t code_bank_shift;
+    uint8_t code_bank; // 当前分组号
+    const uint8_t *const *code_banks;
+    uint8_t code_bank_count;
+    uint32_t code_bank_len;
 
     emcs51_inst_def_t inst_def[256];
     emcs51_write_data_cb_t write_data_cb[256];
@@ -71,6 +237,31 @@ typedef struct EMCS51_CORE
 
     uint32_t code_len;
 
+    uint64_t inst_count; // 已执行指令数
+    uint64_t cycles;     // 已执行机器周期数
+
+    uint8_t clocks_per_cycle; // 每个机器周期的振荡器时钟数，1T 型号为1，见 emcs51_core_clocks()
+
+    void *user;
+
+    emcs51_core_hook_t *hook;
+    emcs51_input_cb_t input_cb; // 异步输入生效回调
+    struct EMCS51_BREAK *brk;   // 断点，见 emcs51_break_init()
+
+    // 观察点位图，未设置观察点时访问只多一次位测试，见 emcs51_watch_init()
+    uint32_t watch_data_rd[8];  // DATA区 0x00~0xFF，每字节一位
+    uint32_t watch_data_wr[8];
+    uint32_t watch_xdata_rd[8]; // XDATA区每页一位，被观察的页不走快速路径
+    uint32_t watch_xdata_wr[8];
+    struct EMCS51_WATCH *watch;
+    struct EMCS51_TRACE *trace;       // 执行跟踪，见 emcs51_trace_init()
+    struct EMCS51_PROFILE *profile;   // 按地址剖析，见 emcs51_profile_init()
+    struct EMCS51_COVERAGE *coverage; // 覆盖率，见 emcs51_coverage_init()
+
+#if EMCS51_SELF_PROFILE
+    emcs51_self_profile_t self_profile;
+#endif
+
     uint8_t is_jumped;
 } emcs51_core_t;
 
@@ -79,11 +270,42 @@ void emcs51_core_inst_add(emcs51_core_t *core, uint8_t opcode, emcs51_inst_def_t
 void emcs51_core_inst_add_range(emcs51_core_t *core, uint8_t start, uint8_t len, emcs51_inst_def_t *inst_def);
 void emcs51_core_reg_add(emcs51_core_t *core, uint8_t addr, emcs51_write_data_cb_t write_data_cb, emcs51_read_data_cb_t read_data_cb);
 void emcs51_core_inst_dump(emcs51_core_t *core);
+#if EMCS51_SELF_PROFILE
+void emcs51_core_self_profile_reset(emcs51_core_t *core);
+void emcs51_core_self_profile_dump(emcs51_core_t *core);
+#endif
 
 void emcs51_core_set_xdata_ram(emcs51_core_t *core, uint8_t *xdata_ram, uint32_t xdata_ram_size);
+void emcs51_core_set_xdata_ram_indirect(emcs51_core_t *core, uint8_t indirect);
+int emcs51_core_set_xdata_page_size(emcs51_core_t *core, uint32_t page_size);
+void emcs51_core_clear_xdata_dirty(emcs51_core_t *core);
+void emcs51_core_mark_xdata_dirty(emcs51_core_t *core, uint16_t addr, uint32_t len);
+
+int emcs51_core_map_xdata(emcs51_core_t *core, const emcs51_xdata_region_t *region);
+void emcs51_core_rebuild_xdata_map(emcs51_core_t *core);
+void emcs51_core_unmap_xdata(emcs51_core_t *core);
+void emcs51_core_set_xdata_unmapped(emcs51_core_t *core, uint8_t mode);
+
+int emcs51_core_read_xdata(emcs51_core_t *core, uint16_t addr, uint8_t *data);
+int emcs51_core_write_xdata(emcs51_core_t *core, uint16_t addr, uint8_t data);
+uint8_t emcs51_core_peek_xdata(emcs51_core_t *core, uint16_t addr);
+int emcs51_core_poke_xdata(emcs51_core_t *core, uint16_t addr, uint8_t data);
+
+int emcs51_core_read_data(emcs51_core_t *core, uint8_t addr, uint8_t *data);
+int emcs51_core_write_data(emcs51_core_t *core, uint8_t addr, uint8_t data);
+
+void emcs51_core_set_hook(emcs51_core_t *core, emcs51_core_hook_t *hook);
+void emcs51_core_set_input_cb(emcs51_core_t *core, emcs51_input_cb_t input_cb);
+int emcs51_core_raise_input(emcs51_core_t *core, uint8_t type, uint16_t addr, uint8_t data);
 
 void emcs51_core_reset(emcs51_core_t *core);
 void emcs51_core_inc(emcs51_core_t *core);
+int emcs51_core_run(emcs51_core_t *core, uint64_t cycles);
+uint64_t emcs51_core_clocks(emcs51_core_t *core);
+
+void emcs51_core_update_code_bank(emcs51_core_t *core);
+int emcs51_core_read_code(emcs51_core_t *core, uint16_t addr, uint8_t *data, uint16_t len);
+int emcs51_core_read_code_byte(emcs51_core_t *core, uint16_t addr, uint8_t *data);
 
 int emcs51_core_read_GPR(emcs51_core_t *core, uint8_t n, uint8_t *data);
 int emcs51_core_write_GPR(emcs51_core_t *core, uint8_t n, uint8_t data);
@@ -21,6 +21,7 @@ typedef struct EMCS51_INST_DEF
     const char *mnemonic;          // instruction mnemonic
     uint8_t length;                // operands length
     uint8_t cycles;                // execution cycles
+    uint8_t cycles_jump;           // extra cycles when the instruction jumps (taken conditional branch)
     emcs51_inst_exec_cb_t exec_cb; // execution callback
 } emcs51_inst_def_t;
 
@@ -0,0 +1,200 @@
+#include "emcs51.h"
+
+// 结束基本块的指令：全部转移、调用和返回，条件转移无论是否成立
+static const uint8_t emcs51_coverage_branch[256] = {
+    [0x01] = 1, [0x02] = 1, [0x10] = 1, [0x11] = 1, [0x12] = 1, [0x20] = 1, [0x21] = 1, [0x22] = 1,
+    [0x30] = 1, [0x31] = 1, [0x32] = 1, [0x40] = 1, [0x41] = 1, [0x50] = 1, [0x51] = 1, [0x60] = 1,
+    [0x61] = 1, [0x70] = 1, [0x71] = 1, [0x73] = 1, [0x80] = 1, [0x81] = 1, [0x91] = 1, [0xA1] = 1,
+    [0xB1] = 1, [0xB4] = 1, [0xB5] = 1, [0xB6] = 1, [0xB7] = 1, [0xB8] = 1, [0xB9] = 1, [0xBA] = 1,
+    [0xBB] = 1, [0xBC] = 1, [0xBD] = 1, [0xBE] = 1, [0xBF] = 1, [0xC1] = 1, [0xD1] = 1, [0xD5] = 1,
+    [0xD8] = 1, [0xD9] = 1, [0xDA] = 1, [0xDB] = 1, [0xDC] = 1, [0xDD] = 1, [0xDE] = 1, [0xDF] = 1,
+    [0xE1] = 1, [0xF1] = 1,
+};
+
+// 块地址的哈希，乘法散列使相邻地址分散到整个计数表
+static inline uint16_t emcs51_coverage_hash(uint16_t addr)
+{
+    return (uint16_t)(((uint32_t)addr * 0x9E3779B1u) >> 16);
+}
+
+/*******************************************************************************
+ * @brief 开始记录覆盖率，之后 emcs51_core_inc() 每执行一条指令调用 emcs51_coverage_inst()
+ * @param cov       覆盖率结构体指针
+ * @param core      核心结构体指针
+ * @param edges     边计数表，由调用者提供，如 libFuzzer 的 extra counters；NULL 表示不记录边
+ * @param edge_size 计数表大小，2的幂
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_coverage_init(emcs51_coverage_t *cov, emcs51_core_t *core, uint8_t *edges, uint32_t edge_size)
+{
+    if ((cov == NULL) || (core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    if ((edges != NULL) && ((edge_size == 0) || ((edge_size & (edge_size - 1)) != 0)))
+        return EMCS51_ERR;
+
+    memset(cov, 0, sizeof(emcs51_coverage_t));
+
+    cov->core = core;
+    cov->edges = edges;
+    cov->edge_mask = (edges != NULL) ? (edge_size - 1) : 0;
+
+    emcs51_coverage_reset(cov);
+
+    core->coverage = cov;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 从核心上移除，已记录的数据保留
+ * @param cov 覆盖率结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_coverage_deinit(emcs51_coverage_t *cov)
+{
+    if (cov->core->coverage == cov)
+        cov->core->coverage = NULL;
+}
+
+/*******************************************************************************
+ * @brief 清空已执行地址和边计数
+ * @param cov 覆盖率结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_coverage_reset(emcs51_coverage_t *cov)
+{
+    memset(cov->exec, 0, sizeof(cov->exec));
+
+    if (cov->edges != NULL)
+        memset(cov->edges, 0, cov->edge_mask + 1);
+
+    emcs51_coverage_begin(cov);
+}
+
+/*******************************************************************************
+ * @brief 开始一次新的执行，如恢复快照之后，下一条边不与上次执行的最后一块相连
+ * @param cov 覆盖率结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_coverage_begin(emcs51_coverage_t *cov)
+{
+    cov->prev = (uint16_t)(emcs51_coverage_hash(cov->core->reg.pc) >> 1);
+}
+
+/*******************************************************************************
+ * @brief 记录一条已执行的指令，由 emcs51_core_inc() 调用
+ * @param cov    覆盖率结构体指针
+ * @param pc     指令地址
+ * @param opcode 操作码
+ * @param length 指令长度
+ * @return none
+ ******************************************************************************/
+void emcs51_coverage_inst(emcs51_coverage_t *cov, uint16_t pc, uint8_t opcode, uint8_t length)
+{
+    uint16_t cur;
+    uint32_t index;
+
+    for (uint32_t addr = pc; (addr < (uint32_t)pc + length) && (addr <= 0xFFFF); addr++)
+        cov->exec[addr >> 5] |= (uint32_t)1 << (addr & 31);
+
+    if (!emcs51_coverage_branch[opcode] || (cov->edges == NULL))
+        return;
+
+    // 新块从转移之后的PC开始：条件转移成立与不成立是不同的边
+    cur = emcs51_coverage_hash(cov->core->reg.pc);
+    index = (uint32_t)(cur ^ cov->prev) & cov->edge_mask;
+
+    if (cov->edges[index] != 0xFF)
+        cov->edges[index]++;
+
+    cov->prev = (uint16_t)(cur >> 1);
+}
+
+/*******************************************************************************
+ * @brief code区地址是否已执行
+ * @param cov  覆盖率结构体指针
+ * @param addr code区地址
+ * @return 已执行为1
+ ******************************************************************************/
+uint8_t emcs51_coverage_hit(const emcs51_coverage_t *cov, uint16_t addr)
+{
+    return (uint8_t)((cov->exec[addr >> 5] >> (addr & 31)) & 1);
+}
+
+static uint32_t emcs51_coverage_popcount(uint32_t v)
+{
+    v = v - ((v >> 1) & 0x55555555u);
+    v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+
+    return (((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+}
+
+/*******************************************************************************
+ * @brief 已执行的code区字节数
+ * @param cov 覆盖率结构体指针
+ * @return 字节数
+ ******************************************************************************/
+uint32_t emcs51_coverage_count(const emcs51_coverage_t *cov)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < sizeof(cov->exec) / sizeof(cov->exec[0]); i++)
+        count += emcs51_coverage_popcount(cov->exec[i]);
+
+    return count;
+}
+
+/*******************************************************************************
+ * @brief 计数非0的边数
+ * @param cov 覆盖率结构体指针
+ * @return 边数，哈希冲突的边只计一次
+ ******************************************************************************/
+uint32_t emcs51_coverage_edge_count(const emcs51_coverage_t *cov)
+{
+    uint32_t count = 0;
+
+    if (cov->edges == NULL)
+        return 0;
+
+    for (uint32_t i = 0; i <= cov->edge_mask; i++)
+        count += (cov->edges[i] != 0);
+
+    return count;
+}
+
+/*******************************************************************************
+ * @brief 输出已执行的地址区间，每行 "起始-结束"，结束地址包含在内
+ * @param cov      覆盖率结构体指针
+ * @param write_cb 输出回调
+ * @param user     回调参数
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_coverage_ranges(const emcs51_coverage_t *cov, emcs51_coverage_write_cb_t write_cb, void *user)
+{
+    char line[16];
+    uint32_t start = 0;
+    uint8_t in_range = 0;
+
+    for (uint32_t addr = 0; addr <= 0x10000; addr++)
+    {
+        uint8_t hit = (addr <= 0xFFFF) ? emcs51_coverage_hit(cov, (uint16_t)addr) : 0;
+
+        if (hit && !in_range)
+        {
+            start = addr;
+            in_range = 1;
+        }
+        else if (!hit && in_range)
+        {
+            int len = snprintf(line, sizeof(line), "%04X-%04X\n", (unsigned)start, (unsigned)(addr - 1));
+
+            if (write_cb(user, (const uint8_t *)line, (uint32_t)len) != len)
+                return EMCS51_ERR_STREAM;
+
+            in_range = 0;
+        }
+    }
+
+    return EMCS51_OK;
+}
@@ -0,0 +1,38 @@
+#ifndef EMCS51_COVERAGE_H
+#define EMCS51_COVERAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core/emcs51_core.h"
+
+#define EMCS51_COVERAGE_MAP_SIZE_DEFAULT 0x10000 // 边计数表的默认大小
+
+// 覆盖率：记录已执行的code区字节，并按AFL的方式对转移边计数。
+// 每条转移指令（包括未成立的条件转移）之后开始一个新的块，边为 (上一块, 新块) 的哈希
+typedef struct EMCS51_COVERAGE
+{
+    emcs51_core_t *core;
+
+    uint32_t exec[0x10000 / 32]; // 已执行的code区字节，每字节一位
+
+    uint8_t *edges; // 边计数，饱和于 0xFF，NULL 表示只记录地址
+    uint32_t edge_mask;
+    uint16_t prev; // 上一块的哈希右移1位，使 A->B 与 B->A 不同
+} emcs51_coverage_t;
+
+// 与 emcs51_record_write_cb_t 相同，返回写入的字节数
+typedef int (*emcs51_coverage_write_cb_t)(void *user, const uint8_t *data, uint32_t len);
+
+int emcs51_coverage_init(emcs51_coverage_t *cov, emcs51_core_t *core, uint8_t *edges, uint32_t edge_size);
+void emcs51_coverage_deinit(emcs51_coverage_t *cov);
+void emcs51_coverage_reset(emcs51_coverage_t *cov);
+void emcs51_coverage_begin(emcs51_coverage_t *cov);
+
+void emcs51_coverage_inst(emcs51_coverage_t *cov, uint16_t pc, uint8_t opcode, uint8_t length);
+
+uint8_t emcs51_coverage_hit(const emcs51_coverage_t *cov, uint16_t addr);
+uint32_t emcs51_coverage_count(const emcs51_coverage_t *cov);
+uint32_t emcs51_coverage_edge_count(const emcs51_coverage_t *cov);
+int emcs51_coverage_ranges(const emcs51_coverage_t *cov, emcs51_coverage_write_cb_t write_cb, void *user);
+
+#endif // EMCS51_COVERAGE_H
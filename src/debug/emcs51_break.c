@@ -0,0 +1,239 @@
+#include "emcs51.h"
+
+/*******************************************************************************
+ * @brief 回调函数：被替换操作码的执行入口，只在断点地址处检查条件
+ * @param event 指令执行事件结构体指针
+ * @return none
+ * @details 命中时不执行原指令并设置 EMCS51_ERR_BREAKPOINT，emcs51_core_run() 随即返回；
+ *          emcs51_core_inc() 之后照常累加的周期和指令数在此预先扣除，pc 保持在断点地址
+ ******************************************************************************/
+static void emcs51_break_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    emcs51_core_t *core = event->core;
+    emcs51_break_t *brk = core->brk;
+    uint16_t pc = core->reg.pc;
+
+    for (uint32_t i = 0; i < EMCS51_BREAK_MAX; i++)
+    {
+        emcs51_breakpoint_t *bp = &brk->bp[i];
+
+        if ((bp->used == 0) || (bp->addr != pc))
+            continue;
+
+        if (brk->resume && (brk->resume_pc == pc))
+            break;
+
+        if (bp->cond_cb && (bp->cond_cb(core, bp->ctx) == 0))
+            continue;
+
+        bp->hits++;
+        if (bp->hits <= bp->ignore_count)
+            continue;
+
+        brk->hit = (int8_t)i;
+        brk->resume = 0;
+
+        core->err = EMCS51_ERR_BREAKPOINT;
+        core->is_jumped = true;
+        core->cycles -= (uint64_t)event->inst_def->cycles + event->inst_def->cycles_jump;
+        core->inst_count--;
+        return;
+    }
+
+    brk->resume = 0;
+    brk->exec_cb[event->opcode](event);
+}
+
+/*******************************************************************************
+ * @brief 按引用计数替换或恢复分派项
+ ******************************************************************************/
+static void emcs51_break_patch(emcs51_break_t *brk)
+{
+    emcs51_core_t *core = brk->core;
+
+    for (uint32_t opcode = 0; opcode < 256; opcode++)
+    {
+        emcs51_inst_def_t *inst_def = &core->inst_def[opcode];
+        uint8_t want = (brk->refs[opcode] || brk->refs_all) && (inst_def->exec_cb != NULL);
+
+        if (want && (brk->exec_cb[opcode] == NULL))
+        {
+            brk->exec_cb[opcode] = inst_def->exec_cb;
+            inst_def->exec_cb = emcs51_break_exec_cb;
+        }
+        else if (!want && (brk->exec_cb[opcode] != NULL))
+        {
+            inst_def->exec_cb = brk->exec_cb[opcode];
+            brk->exec_cb[opcode] = NULL;
+        }
+    }
+}
+
+/*******************************************************************************
+ * @brief 初始化断点
+ * @param brk  断点结构体指针
+ * @param core 核心结构体指针，指令需已注册
+ * @return none
+ * @details 之后再注册指令（如 emcs51_derivative_init()）会覆盖已替换的分派项
+ ******************************************************************************/
+void emcs51_break_init(emcs51_break_t *brk, emcs51_core_t *core)
+{
+    memset(brk, 0, sizeof(emcs51_break_t));
+
+    brk->core = core;
+    brk->hit = -1;
+
+    core->brk = brk;
+}
+
+/*******************************************************************************
+ * @brief 删除全部断点并恢复分派项
+ * @param brk 断点结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_break_deinit(emcs51_break_t *brk)
+{
+    emcs51_break_clear(brk);
+
+    if (brk->core->brk == brk)
+        brk->core->brk = NULL;
+}
+
+/*******************************************************************************
+ * @brief 添加断点
+ * @param brk          断点结构体指针
+ * @param addr         code地址，在该地址的指令执行之前停止
+ * @param cond_cb      条件回调，NULL 表示无条件
+ * @param ctx          条件回调的上下文
+ * @param ignore_count 条件成立的前 ignore_count 次不停止
+ * @return 断点编号，失败返回 emcs51_err_t
+ ******************************************************************************/
+int emcs51_break_add(emcs51_break_t *brk, uint16_t addr, emcs51_break_cond_cb_t cond_cb, void *ctx, uint32_t ignore_count)
+{
+    emcs51_core_t *core = brk->core;
+    emcs51_breakpoint_t *bp = NULL;
+    uint8_t opcode;
+    int index;
+    int err;
+
+    for (index = 0; index < EMCS51_BREAK_MAX; index++)
+    {
+        if (brk->bp[index].used == 0)
+        {
+            bp = &brk->bp[index];
+            break;
+        }
+    }
+
+    if (bp == NULL)
+        return EMCS51_ERR;
+
+    memset(bp, 0, sizeof(emcs51_breakpoint_t));
+    bp->addr = addr;
+    bp->cond_cb = cond_cb;
+    bp->ctx = ctx;
+    bp->ignore_count = ignore_count;
+
+    if ((core->code_bank_sfr != 0) && (addr >= EMCS51_CODE_BANK_WINDOW))
+    {
+        bp->opcode = EMCS51_BREAK_OPCODE_ALL;
+        brk->refs_all++;
+    }
+    else
+    {
+        err = emcs51_core_read_code_byte(core, addr, &opcode);
+        if (err < 0)
+            return err;
+
+        bp->opcode = opcode;
+        brk->refs[opcode]++;
+    }
+
+    bp->used = 1;
+    emcs51_break_patch(brk);
+
+    return index;
+}
+
+/*******************************************************************************
+ * @brief 删除断点
+ * @param brk   断点结构体指针
+ * @param index 断点编号
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_break_remove(emcs51_break_t *brk, int index)
+{
+    emcs51_breakpoint_t *bp;
+
+    if ((index < 0) || (index >= EMCS51_BREAK_MAX) || (brk->bp[index].used == 0))
+        return EMCS51_ERR;
+
+    bp = &brk->bp[index];
+
+    if (bp->opcode == EMCS51_BREAK_OPCODE_ALL)
+        brk->refs_all--;
+    else
+        brk->refs[bp->opcode]--;
+
+    bp->used = 0;
+
+    if (brk->hit == index)
+        brk->hit = -1;
+
+    if (brk->resume && (brk->resume_pc == bp->addr))
+        brk->resume = 0;
+
+    emcs51_break_patch(brk);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 删除全部断点
+ * @param brk 断点结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_break_clear(emcs51_break_t *brk)
+{
+    for (int i = 0; i < EMCS51_BREAK_MAX; i++)
+    {
+        if (brk->bp[i].used)
+            emcs51_break_remove(brk, i);
+    }
+}
+
+/*******************************************************************************
+ * @brief 查找地址处的断点
+ * @param brk  断点结构体指针
+ * @param addr code地址
+ * @return 断点编号，未找到返回 EMCS51_ERR
+ ******************************************************************************/
+int emcs51_break_find(emcs51_break_t *brk, uint16_t addr)
+{
+    for (int i = 0; i < EMCS51_BREAK_MAX; i++)
+    {
+        if (brk->bp[i].used && (brk->bp[i].addr == addr))
+            return i;
+    }
+
+    return EMCS51_ERR;
+}
+
+/*******************************************************************************
+ * @brief 从断点处继续运行
+ * @param brk 断点结构体指针
+ * @return none
+ * @details 清除 EMCS51_ERR_BREAKPOINT，下一条指令即使位于断点地址也会执行；
+ *          未停在断点时同样跳过当前地址的断点，用于单步
+ ******************************************************************************/
+void emcs51_break_resume(emcs51_break_t *brk)
+{
+    emcs51_core_t *core = brk->core;
+
+    if ((core->err < 0) && (core->err != EMCS51_ERR_BREAKPOINT))
+        return;
+
+    core->err = EMCS51_OK;
+    brk->resume = 1;
+    brk->resume_pc = core->reg.pc;
+}
@@ -0,0 +1,50 @@
+#ifndef EMCS51_BREAK_H
+#define EMCS51_BREAK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core/emcs51_core.h"
+
+#define EMCS51_BREAK_MAX 16
+#define EMCS51_BREAK_OPCODE_ALL 0x100 // 分组窗口内的断点，每个分组的指令可能不同，替换全部操作码
+
+// 条件回调，返回非0表示条件成立
+typedef int (*emcs51_break_cond_cb_t)(emcs51_core_t *core, void *ctx);
+
+typedef struct EMCS51_BREAKPOINT
+{
+    uint8_t used;
+    uint16_t addr;
+    uint16_t opcode;                // 被替换的操作码，EMCS51_BREAK_OPCODE_ALL 表示全部
+    emcs51_break_cond_cb_t cond_cb; // NULL 表示无条件
+    void *ctx;
+    uint32_t ignore_count;          // 条件成立的前 ignore_count 次不停止
+    uint32_t hits;                  // 到达且条件成立的次数
+} emcs51_breakpoint_t;
+
+// 断点：替换断点地址处指令的分派项，没有断点的操作码不经过任何检查
+typedef struct EMCS51_BREAK
+{
+    emcs51_core_t *core;
+    emcs51_breakpoint_t bp[EMCS51_BREAK_MAX];
+
+    emcs51_inst_exec_cb_t exec_cb[256]; // 被替换的原回调，NULL 表示未替换
+    uint8_t refs[256];                  // 引用各操作码的断点数
+    uint8_t refs_all;                   // EMCS51_BREAK_OPCODE_ALL 断点数
+
+    int8_t hit;         // 最近命中的断点，-1 表示无
+    uint8_t resume;     // 继续运行时跳过 resume_pc 处的断点一次
+    uint16_t resume_pc;
+} emcs51_break_t;
+
+void emcs51_break_init(emcs51_break_t *brk, emcs51_core_t *core);
+void emcs51_break_deinit(emcs51_break_t *brk);
+
+int emcs51_break_add(emcs51_break_t *brk, uint16_t addr, emcs51_break_cond_cb_t cond_cb, void *ctx, uint32_t ignore_count);
+int emcs51_break_remove(emcs51_break_t *brk, int index);
+void emcs51_break_clear(emcs51_break_t *brk);
+int emcs51_break_find(emcs51_break_t *brk, uint16_t addr);
+
+void emcs51_break_resume(emcs51_break_t *brk);
+
+#endif // EMCS51_BREAK_H
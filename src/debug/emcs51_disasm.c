@@ -0,0 +1,603 @@
+#include "emcs51.h"
+
+/*******************************************************************************
+ * 操作数类型，按出现顺序依次取用指令中操作码之后的字节
+ ******************************************************************************/
+typedef enum EMCS51_DISASM_OPDS
+{
+    EMCS51_DISASM_OPD_NONE = 0,
+    EMCS51_DISASM_OPD_A,
+    EMCS51_DISASM_OPD_AB,
+    EMCS51_DISASM_OPD_C,
+    EMCS51_DISASM_OPD_DPTR,
+    EMCS51_DISASM_OPD_AT_DPTR,    // @DPTR
+    EMCS51_DISASM_OPD_AT_A_DPTR,  // @A+DPTR
+    EMCS51_DISASM_OPD_AT_A_PC,    // @A+PC
+    EMCS51_DISASM_OPD_RN,         // 寄存器号在操作码低3位
+    EMCS51_DISASM_OPD_AT_RI,      // 寄存器号在操作码最低位
+    EMCS51_DISASM_OPD_IMM8,       // #data
+    EMCS51_DISASM_OPD_IMM16,      // #data16，高字节在前
+    EMCS51_DISASM_OPD_DIRECT,     // 直接地址
+    EMCS51_DISASM_OPD_DIRECT_DST, // MOV direct, direct 的目的地址，在第3字节
+    EMCS51_DISASM_OPD_DIRECT_SRC, // MOV direct, direct 的源地址，在第2字节
+    EMCS51_DISASM_OPD_BIT,        // 位地址
+    EMCS51_DISASM_OPD_NBIT,       // /bit
+    EMCS51_DISASM_OPD_REL,        // 相对下一条指令的偏移
+    EMCS51_DISASM_OPD_ADDR11,     // 高3位在操作码中，2KB页内
+    EMCS51_DISASM_OPD_ADDR16,
+} emcs51_disasm_opds_t;
+
+typedef struct EMCS51_DISASM_DEF
+{
+    const char *mnemonic; // NULL 表示保留的操作码
+    uint8_t length;
+    uint8_t opds[3]; // emcs51_disasm_opds_t
+} emcs51_disasm_def_t;
+
+typedef struct EMCS51_DISASM_OUT
+{
+    char *buf;
+    uint32_t pos;
+    uint32_t size;
+} emcs51_disasm_out_t;
+
+/*******************************************************************************
+ * 完整的8051指令表，与 core->inst_def 中已实现的指令无关
+ ******************************************************************************/
+static const emcs51_disasm_def_t emcs51_disasm_defs[256] = {
+    [0x00] = {"NOP", 1, {0}},
+    [0x01] = {"AJMP", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x02] = {"LJMP", 3, {EMCS51_DISASM_OPD_ADDR16}},
+    [0x03] = {"RR", 1, {EMCS51_DISASM_OPD_A}},
+    [0x04] = {"INC", 1, {EMCS51_DISASM_OPD_A}},
+    [0x05] = {"INC", 2, {EMCS51_DISASM_OPD_DIRECT}},
+    [0x06] = {"INC", 1, {EMCS51_DISASM_OPD_AT_RI}},
+    [0x07] = {"INC", 1, {EMCS51_DISASM_OPD_AT_RI}},
+    [0x08] = {"INC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x09] = {"INC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x0A] = {"INC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x0B] = {"INC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x0C] = {"INC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x0D] = {"INC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x0E] = {"INC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x0F] = {"INC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x10] = {"JBC", 3, {EMCS51_DISASM_OPD_BIT, EMCS51_DISASM_OPD_REL}},
+    [0x11] = {"ACALL", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x12] = {"LCALL", 3, {EMCS51_DISASM_OPD_ADDR16}},
+    [0x13] = {"RRC", 1, {EMCS51_DISASM_OPD_A}},
+    [0x14] = {"DEC", 1, {EMCS51_DISASM_OPD_A}},
+    [0x15] = {"DEC", 2, {EMCS51_DISASM_OPD_DIRECT}},
+    [0x16] = {"DEC", 1, {EMCS51_DISASM_OPD_AT_RI}},
+    [0x17] = {"DEC", 1, {EMCS51_DISASM_OPD_AT_RI}},
+    [0x18] = {"DEC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x19] = {"DEC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x1A] = {"DEC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x1B] = {"DEC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x1C] = {"DEC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x1D] = {"DEC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x1E] = {"DEC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x1F] = {"DEC", 1, {EMCS51_DISASM_OPD_RN}},
+    [0x20] = {"JB", 3, {EMCS51_DISASM_OPD_BIT, EMCS51_DISASM_OPD_REL}},
+    [0x21] = {"AJMP", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x22] = {"RET", 1, {0}},
+    [0x23] = {"RL", 1, {EMCS51_DISASM_OPD_A}},
+    [0x24] = {"ADD", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_IMM8}},
+    [0x25] = {"ADD", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_DIRECT}},
+    [0x26] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x27] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x28] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x29] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x2A] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x2B] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x2C] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x2D] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x2E] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x2F] = {"ADD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x30] = {"JNB", 3, {EMCS51_DISASM_OPD_BIT, EMCS51_DISASM_OPD_REL}},
+    [0x31] = {"ACALL", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x32] = {"RETI", 1, {0}},
+    [0x33] = {"RLC", 1, {EMCS51_DISASM_OPD_A}},
+    [0x34] = {"ADDC", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_IMM8}},
+    [0x35] = {"ADDC", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_DIRECT}},
+    [0x36] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x37] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x38] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x39] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x3A] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x3B] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x3C] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x3D] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x3E] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x3F] = {"ADDC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x40] = {"JC", 2, {EMCS51_DISASM_OPD_REL}},
+    [0x41] = {"AJMP", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x42] = {"ORL", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_A}},
+    [0x43] = {"ORL", 3, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_IMM8}},
+    [0x44] = {"ORL", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_IMM8}},
+    [0x45] = {"ORL", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_DIRECT}},
+    [0x46] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x47] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x48] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x49] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x4A] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x4B] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x4C] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x4D] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x4E] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x4F] = {"ORL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x50] = {"JNC", 2, {EMCS51_DISASM_OPD_REL}},
+    [0x51] = {"ACALL", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x52] = {"ANL", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_A}},
+    [0x53] = {"ANL", 3, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_IMM8}},
+    [0x54] = {"ANL", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_IMM8}},
+    [0x55] = {"ANL", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_DIRECT}},
+    [0x56] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x57] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x58] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x59] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x5A] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x5B] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x5C] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x5D] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x5E] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x5F] = {"ANL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x60] = {"JZ", 2, {EMCS51_DISASM_OPD_REL}},
+    [0x61] = {"AJMP", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x62] = {"XRL", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_A}},
+    [0x63] = {"XRL", 3, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_IMM8}},
+    [0x64] = {"XRL", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_IMM8}},
+    [0x65] = {"XRL", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_DIRECT}},
+    [0x66] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x67] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x68] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x69] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x6A] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x6B] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x6C] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x6D] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x6E] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x6F] = {"XRL", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x70] = {"JNZ", 2, {EMCS51_DISASM_OPD_REL}},
+    [0x71] = {"ACALL", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x72] = {"ORL", 2, {EMCS51_DISASM_OPD_C, EMCS51_DISASM_OPD_BIT}},
+    [0x73] = {"JMP", 1, {EMCS51_DISASM_OPD_AT_A_DPTR}},
+    [0x74] = {"MOV", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_IMM8}},
+    [0x75] = {"MOV", 3, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_IMM8}},
+    [0x76] = {"MOV", 2, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_IMM8}},
+    [0x77] = {"MOV", 2, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_IMM8}},
+    [0x78] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8}},
+    [0x79] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8}},
+    [0x7A] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8}},
+    [0x7B] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8}},
+    [0x7C] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8}},
+    [0x7D] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8}},
+    [0x7E] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8}},
+    [0x7F] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8}},
+    [0x80] = {"SJMP", 2, {EMCS51_DISASM_OPD_REL}},
+    [0x81] = {"AJMP", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x82] = {"ANL", 2, {EMCS51_DISASM_OPD_C, EMCS51_DISASM_OPD_BIT}},
+    [0x83] = {"MOVC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_A_PC}},
+    [0x84] = {"DIV", 1, {EMCS51_DISASM_OPD_AB}},
+    [0x85] = {"MOV", 3, {EMCS51_DISASM_OPD_DIRECT_DST, EMCS51_DISASM_OPD_DIRECT_SRC}},
+    [0x86] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_AT_RI}},
+    [0x87] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_AT_RI}},
+    [0x88] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_RN}},
+    [0x89] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_RN}},
+    [0x8A] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_RN}},
+    [0x8B] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_RN}},
+    [0x8C] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_RN}},
+    [0x8D] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_RN}},
+    [0x8E] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_RN}},
+    [0x8F] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_RN}},
+    [0x90] = {"MOV", 3, {EMCS51_DISASM_OPD_DPTR, EMCS51_DISASM_OPD_IMM16}},
+    [0x91] = {"ACALL", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0x92] = {"MOV", 2, {EMCS51_DISASM_OPD_BIT, EMCS51_DISASM_OPD_C}},
+    [0x93] = {"MOVC", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_A_DPTR}},
+    [0x94] = {"SUBB", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_IMM8}},
+    [0x95] = {"SUBB", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_DIRECT}},
+    [0x96] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x97] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0x98] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x99] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x9A] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x9B] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x9C] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x9D] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x9E] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0x9F] = {"SUBB", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xA0] = {"ORL", 2, {EMCS51_DISASM_OPD_C, EMCS51_DISASM_OPD_NBIT}},
+    [0xA1] = {"AJMP", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0xA2] = {"MOV", 2, {EMCS51_DISASM_OPD_C, EMCS51_DISASM_OPD_BIT}},
+    [0xA3] = {"INC", 1, {EMCS51_DISASM_OPD_DPTR}},
+    [0xA4] = {"MUL", 1, {EMCS51_DISASM_OPD_AB}},
+    [0xA5] = {NULL, 1, {0}}, // 保留
+    [0xA6] = {"MOV", 2, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_DIRECT}},
+    [0xA7] = {"MOV", 2, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_DIRECT}},
+    [0xA8] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_DIRECT}},
+    [0xA9] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_DIRECT}},
+    [0xAA] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_DIRECT}},
+    [0xAB] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_DIRECT}},
+    [0xAC] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_DIRECT}},
+    [0xAD] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_DIRECT}},
+    [0xAE] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_DIRECT}},
+    [0xAF] = {"MOV", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_DIRECT}},
+    [0xB0] = {"ANL", 2, {EMCS51_DISASM_OPD_C, EMCS51_DISASM_OPD_NBIT}},
+    [0xB1] = {"ACALL", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0xB2] = {"CPL", 2, {EMCS51_DISASM_OPD_BIT}},
+    [0xB3] = {"CPL", 1, {EMCS51_DISASM_OPD_C}},
+    [0xB4] = {"CJNE", 3, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xB5] = {"CJNE", 3, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_REL}},
+    [0xB6] = {"CJNE", 3, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xB7] = {"CJNE", 3, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xB8] = {"CJNE", 3, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xB9] = {"CJNE", 3, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xBA] = {"CJNE", 3, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xBB] = {"CJNE", 3, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xBC] = {"CJNE", 3, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xBD] = {"CJNE", 3, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xBE] = {"CJNE", 3, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xBF] = {"CJNE", 3, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_IMM8, EMCS51_DISASM_OPD_REL}},
+    [0xC0] = {"PUSH", 2, {EMCS51_DISASM_OPD_DIRECT}},
+    [0xC1] = {"AJMP", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0xC2] = {"CLR", 2, {EMCS51_DISASM_OPD_BIT}},
+    [0xC3] = {"CLR", 1, {EMCS51_DISASM_OPD_C}},
+    [0xC4] = {"SWAP", 1, {EMCS51_DISASM_OPD_A}},
+    [0xC5] = {"XCH", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_DIRECT}},
+    [0xC6] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0xC7] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0xC8] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xC9] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xCA] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xCB] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xCC] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xCD] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xCE] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xCF] = {"XCH", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xD0] = {"POP", 2, {EMCS51_DISASM_OPD_DIRECT}},
+    [0xD1] = {"ACALL", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0xD2] = {"SETB", 2, {EMCS51_DISASM_OPD_BIT}},
+    [0xD3] = {"SETB", 1, {EMCS51_DISASM_OPD_C}},
+    [0xD4] = {"DA", 1, {EMCS51_DISASM_OPD_A}},
+    [0xD5] = {"DJNZ", 3, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_REL}},
+    [0xD6] = {"XCHD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0xD7] = {"XCHD", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0xD8] = {"DJNZ", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_REL}},
+    [0xD9] = {"DJNZ", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_REL}},
+    [0xDA] = {"DJNZ", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_REL}},
+    [0xDB] = {"DJNZ", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_REL}},
+    [0xDC] = {"DJNZ", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_REL}},
+    [0xDD] = {"DJNZ", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_REL}},
+    [0xDE] = {"DJNZ", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_REL}},
+    [0xDF] = {"DJNZ", 2, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_REL}},
+    [0xE0] = {"MOVX", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_DPTR}},
+    [0xE1] = {"AJMP", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0xE2] = {"MOVX", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0xE3] = {"MOVX", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0xE4] = {"CLR", 1, {EMCS51_DISASM_OPD_A}},
+    [0xE5] = {"MOV", 2, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_DIRECT}},
+    [0xE6] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0xE7] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_AT_RI}},
+    [0xE8] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xE9] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xEA] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xEB] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xEC] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xED] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xEE] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xEF] = {"MOV", 1, {EMCS51_DISASM_OPD_A, EMCS51_DISASM_OPD_RN}},
+    [0xF0] = {"MOVX", 1, {EMCS51_DISASM_OPD_AT_DPTR, EMCS51_DISASM_OPD_A}},
+    [0xF1] = {"ACALL", 2, {EMCS51_DISASM_OPD_ADDR11}},
+    [0xF2] = {"MOVX", 1, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_A}},
+    [0xF3] = {"MOVX", 1, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_A}},
+    [0xF4] = {"CPL", 1, {EMCS51_DISASM_OPD_A}},
+    [0xF5] = {"MOV", 2, {EMCS51_DISASM_OPD_DIRECT, EMCS51_DISASM_OPD_A}},
+    [0xF6] = {"MOV", 1, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_A}},
+    [0xF7] = {"MOV", 1, {EMCS51_DISASM_OPD_AT_RI, EMCS51_DISASM_OPD_A}},
+    [0xF8] = {"MOV", 1, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_A}},
+    [0xF9] = {"MOV", 1, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_A}},
+    [0xFA] = {"MOV", 1, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_A}},
+    [0xFB] = {"MOV", 1, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_A}},
+    [0xFC] = {"MOV", 1, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_A}},
+    [0xFD] = {"MOV", 1, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_A}},
+    [0xFE] = {"MOV", 1, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_A}},
+    [0xFF] = {"MOV", 1, {EMCS51_DISASM_OPD_RN, EMCS51_DISASM_OPD_A}},
+};
+
+// 标准8051的SFR，型号特有的SFR在 emcs51_disasm_init() 中覆盖
+static const emcs51_derivative_sfr_t emcs51_disasm_sfrs_8051[] = {
+    {0x80, 0x00, "P0"},
+    {0x81, 0x00, "SP"},
+    {0x82, 0x00, "DPL"},
+    {0x83, 0x00, "DPH"},
+    {0x87, 0x00, "PCON"},
+    {0x88, 0x00, "TCON"},
+    {0x89, 0x00, "TMOD"},
+    {0x8A, 0x00, "TL0"},
+    {0x8B, 0x00, "TL1"},
+    {0x8C, 0x00, "TH0"},
+    {0x8D, 0x00, "TH1"},
+    {0x90, 0x00, "P1"},
+    {0x98, 0x00, "SCON"},
+    {0x99, 0x00, "SBUF"},
+    {0xA0, 0x00, "P2"},
+    {0xA8, 0x00, "IE"},
+    {0xB0, 0x00, "P3"},
+    {0xB8, 0x00, "IP"},
+    {0xD0, 0x00, "PSW"},
+    {0xE0, 0x00, "ACC"},
+    {0xF0, 0x00, "B"},
+};
+
+// 有专用名称的位，下标为位地址减 0x80，其余位写作 SFR名.n
+static const char *const emcs51_disasm_bit_names[128] = {
+    [0x88 - 0x80] = "IT0", "IE0", "IT1", "IE1", "TR0", "TF0", "TR1", "TF1",
+    [0x98 - 0x80] = "RI", "TI", "RB8", "TB8", "REN", "SM2", "SM1", "SM0",
+    [0xA8 - 0x80] = "EX0", "ET0", "EX1", "ET1", "ES", "ET2", NULL, "EA",
+    [0xB8 - 0x80] = "PX0", "PT0", "PX1", "PT1", "PS", "PT2",
+    [0xD0 - 0x80] = "P", NULL, "OV", "RS0", "RS1", "F0", "AC", "CY",
+};
+
+static const char emcs51_disasm_hex[] = "0123456789ABCDEF";
+
+static inline void emcs51_disasm_putc(emcs51_disasm_out_t *out, char c)
+{
+    if (out->pos + 1 < out->size)
+        out->buf[out->pos++] = c;
+}
+
+static void emcs51_disasm_puts(emcs51_disasm_out_t *out, const char *s)
+{
+    while ((*s != '\0') && (out->pos + 1 < out->size))
+        out->buf[out->pos++] = *s++;
+}
+
+/*******************************************************************************
+ * @brief 以汇编器的格式输出十六进制数，如 30H、0FFH、0F800H
+ * @param out    输出
+ * @param value  数值
+ * @param digits 位数，2 或 4
+ * @return none
+ ******************************************************************************/
+static void emcs51_disasm_put_hex(emcs51_disasm_out_t *out, uint16_t value, uint8_t digits)
+{
+    uint8_t shift = (uint8_t)((digits - 1) * 4);
+
+    // 以字母开头时补0，以免被当作标识符
+    if (((value >> shift) & 0x0F) >= 0x0A)
+        emcs51_disasm_putc(out, '0');
+
+    for (; digits > 0; digits--, shift -= 4)
+        emcs51_disasm_putc(out, emcs51_disasm_hex[(value >> shift) & 0x0F]);
+
+    emcs51_disasm_putc(out, 'H');
+}
+
+/*******************************************************************************
+ * @brief 输出地址，有符号时写作 符号 或 符号+偏移，否则写作十六进制
+ * @param dis    反汇编器
+ * @param out    输出
+ * @param space  emcs51_space_types_t
+ * @param addr   地址
+ * @param digits 没有符号时的十六进制位数
+ * @return none
+ ******************************************************************************/
+static void emcs51_disasm_put_addr(const emcs51_disasm_t *dis, emcs51_disasm_out_t *out, uint8_t space, uint16_t addr, uint8_t digits)
+{
+    const emcs51_symbol_t *sym = NULL;
+
+    if (dis->symtab != NULL)
+        sym = emcs51_symtab_lookup(dis->symtab, space, addr);
+
+    if (sym == NULL)
+    {
+        emcs51_disasm_put_hex(out, addr, digits);
+        return;
+    }
+
+    emcs51_disasm_puts(out, emcs51_symtab_string(dis->symtab, sym->name));
+
+    if (addr != sym->addr)
+    {
+        emcs51_disasm_putc(out, '+');
+        emcs51_disasm_put_hex(out, (uint16_t)(addr - sym->addr), (addr - sym->addr > 0xFF) ? 4 : 2);
+    }
+}
+
+static void emcs51_disasm_put_direct(const emcs51_disasm_t *dis, emcs51_disasm_out_t *out, uint8_t addr)
+{
+    if ((addr >= 0x80) && (dis->sfr_names[addr - 0x80] != NULL))
+        emcs51_disasm_puts(out, dis->sfr_names[addr - 0x80]);
+    else
+        emcs51_disasm_put_addr(dis, out, (addr >= 0x80) ? EMCS51_SPACE_SFR : EMCS51_SPACE_IRAM, addr, 2);
+}
+
+static void emcs51_disasm_put_bit(const emcs51_disasm_t *dis, emcs51_disasm_out_t *out, uint8_t bit)
+{
+    if (bit < 0x80)
+    {
+        // 位寻址区 20H~2FH
+        emcs51_disasm_put_hex(out, (uint16_t)(0x20 + (bit >> 3)), 2);
+    }
+    else if (emcs51_disasm_bit_names[bit - 0x80] != NULL)
+    {
+        emcs51_disasm_puts(out, emcs51_disasm_bit_names[bit - 0x80]);
+        return;
+    }
+    else
+    {
+        emcs51_disasm_put_direct(dis, out, bit & 0xF8);
+    }
+
+    emcs51_disasm_putc(out, '.');
+    emcs51_disasm_putc(out, (char)('0' + (bit & 0x07)));
+}
+
+/*******************************************************************************
+ * @brief 初始化反汇编器
+ * @param dis        反汇编器
+ * @param derivative 衍生型号，提供额外的SFR名称，NULL 表示标准8051
+ * @param symtab     符号表，须已调用 emcs51_symtab_finalize()，NULL 表示不查符号
+ * @return none
+ ******************************************************************************/
+void emcs51_disasm_init(emcs51_disasm_t *dis, const emcs51_derivative_t *derivative, const emcs51_symtab_t *symtab)
+{
+    if (dis == NULL)
+        return;
+
+    memset(dis, 0, sizeof(emcs51_disasm_t));
+    dis->symtab = symtab;
+
+    for (uint32_t i = 0; i < sizeof(emcs51_disasm_sfrs_8051) / sizeof(emcs51_disasm_sfrs_8051[0]); i++)
+        dis->sfr_names[emcs51_disasm_sfrs_8051[i].addr - 0x80] = emcs51_disasm_sfrs_8051[i].name;
+
+    if (derivative == NULL)
+        return;
+
+    for (uint32_t i = 0; i < derivative->sfr_count; i++)
+    {
+        if (derivative->sfrs[i].addr >= 0x80)
+            dis->sfr_names[derivative->sfrs[i].addr - 0x80] = derivative->sfrs[i].name;
+    }
+}
+
+/*******************************************************************************
+ * @brief 指令长度
+ * @param opcode 操作码
+ * @return 字节数，保留的操作码为1
+ ******************************************************************************/
+uint8_t emcs51_disasm_length(uint8_t opcode)
+{
+    return emcs51_disasm_defs[opcode].length;
+}
+
+/*******************************************************************************
+ * @brief 指令助记符，不含操作数
+ * @param opcode 操作码
+ * @return 助记符，保留的操作码为 "DB"
+ ******************************************************************************/
+const char *emcs51_disasm_mnemonic(uint8_t opcode)
+{
+    const char *mnemonic = emcs51_disasm_defs[opcode].mnemonic;
+
+    return (mnemonic != NULL) ? mnemonic : "DB";
+}
+
+/*******************************************************************************
+ * @brief 反汇编一条指令，如 "MOV A, 30H"、"JNB P3.2, 0123H"
+ * @param dis  反汇编器
+ * @param pc   指令地址，用于计算转移目标
+ * @param code 指令字节，至少 emcs51_disasm_length(code[0]) 个
+ * @param buf  输出缓冲区，总以 '\0' 结尾，空间不足时截断
+ * @param size 缓冲区大小
+ * @return 写入的字符数，不含 '\0'
+ ******************************************************************************/
+uint32_t emcs51_disasm_inst(const emcs51_disasm_t *dis, uint16_t pc, const uint8_t *code, char *buf, uint32_t size)
+{
+    const emcs51_disasm_def_t *def;
+    emcs51_disasm_out_t out;
+    uint8_t opcode;
+    uint8_t pos = 1;
+    uint8_t data;
+
+    if ((dis == NULL) || (code == NULL) || (buf == NULL) || (size == 0))
+        return 0;
+
+    out.buf = buf;
+    out.pos = 0;
+    out.size = size;
+
+    opcode = code[0];
+    def = &emcs51_disasm_defs[opcode];
+
+    if (def->mnemonic == NULL)
+    {
+        emcs51_disasm_puts(&out, "DB ");
+        emcs51_disasm_put_hex(&out, opcode, 2);
+        buf[out.pos] = '\0';
+        return out.pos;
+    }
+
+    emcs51_disasm_puts(&out, def->mnemonic);
+
+    for (uint8_t i = 0; (i < 3) && (def->opds[i] != EMCS51_DISASM_OPD_NONE); i++)
+    {
+        emcs51_disasm_puts(&out, (i == 0) ? " " : ", ");
+
+        switch (def->opds[i])
+        {
+        case EMCS51_DISASM_OPD_A:
+            emcs51_disasm_putc(&out, 'A');
+            break;
+        case EMCS51_DISASM_OPD_AB:
+            emcs51_disasm_puts(&out, "AB");
+            break;
+        case EMCS51_DISASM_OPD_C:
+            emcs51_disasm_putc(&out, 'C');
+            break;
+        case EMCS51_DISASM_OPD_DPTR:
+            emcs51_disasm_puts(&out, "DPTR");
+            break;
+        case EMCS51_DISASM_OPD_AT_DPTR:
+            emcs51_disasm_puts(&out, "@DPTR");
+            break;
+        case EMCS51_DISASM_OPD_AT_A_DPTR:
+            emcs51_disasm_puts(&out, "@A+DPTR");
+            break;
+        case EMCS51_DISASM_OPD_AT_A_PC:
+            emcs51_disasm_puts(&out, "@A+PC");
+            break;
+        case EMCS51_DISASM_OPD_RN:
+            emcs51_disasm_putc(&out, 'R');
+            emcs51_disasm_putc(&out, (char)('0' + (opcode & 0x07)));
+            break;
+        case EMCS51_DISASM_OPD_AT_RI:
+            emcs51_disasm_puts(&out, "@R");
+            emcs51_disasm_putc(&out, (char)('0' + (opcode & 0x01)));
+            break;
+        case EMCS51_DISASM_OPD_IMM8:
+            emcs51_disasm_putc(&out, '#');
+            emcs51_disasm_put_hex(&out, code[pos++], 2);
+            break;
+        case EMCS51_DISASM_OPD_IMM16:
+            emcs51_disasm_putc(&out, '#');
+            emcs51_disasm_put_hex(&out, (uint16_t)((code[pos] << 8) | code[pos + 1]), 4);
+            pos += 2;
+            break;
+        case EMCS51_DISASM_OPD_DIRECT:
+            emcs51_disasm_put_direct(dis, &out, code[pos++]);
+            break;
+        case EMCS51_DISASM_OPD_DIRECT_DST:
+            emcs51_disasm_put_direct(dis, &out, code[2]);
+            break;
+        case EMCS51_DISASM_OPD_DIRECT_SRC:
+            emcs51_disasm_put_direct(dis, &out, code[1]);
+            break;
+        case EMCS51_DISASM_OPD_NBIT:
+            emcs51_disasm_putc(&out, '/');
+            emcs51_disasm_put_bit(dis, &out, code[pos++]);
+            break;
+        case EMCS51_DISASM_OPD_BIT:
+            emcs51_disasm_put_bit(dis, &out, code[pos++]);
+            break;
+        case EMCS51_DISASM_OPD_REL:
+            data = code[pos++];
+            emcs51_disasm_put_addr(dis, &out, EMCS51_SPACE_CODE, (uint16_t)(pc + def->length + (int8_t)data), 4);
+            break;
+        case EMCS51_DISASM_OPD_ADDR11:
+            data = code[pos++];
+            emcs51_disasm_put_addr(dis, &out, EMCS51_SPACE_CODE,
+                                   (uint16_t)(((pc + 2) & 0xF800) | ((opcode & 0xE0) << 3) | data), 4);
+            break;
+        case EMCS51_DISASM_OPD_ADDR16:
+            emcs51_disasm_put_addr(dis, &out, EMCS51_SPACE_CODE, (uint16_t)((code[pos] << 8) | code[pos + 1]), 4);
+            pos += 2;
+            break;
+        default:
+            break;
+        }
+    }
+
+    buf[out.pos] = '\0';
+
+    return out.pos;
+}
@@ -0,0 +1,25 @@
+#ifndef EMCS51_DISASM_H
+#define EMCS51_DISASM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "derivative/emcs51_derivative.h"
+#include "loader/emcs51_symtab.h"
+
+#define EMCS51_DISASM_INST_MAX 3  // 最长指令的字节数
+#define EMCS51_DISASM_TEXT_MAX 64 // 足够容纳任意一条指令（不含过长的符号名）
+
+// 反汇编器：操作数格式由静态表给出，输出写入调用者的缓冲区，不使用 printf 和堆
+typedef struct EMCS51_DISASM
+{
+    const char *sfr_names[128];    // 直接地址 0x80~0xFF 的名称，NULL 表示未定义
+    const emcs51_symtab_t *symtab; // NULL 表示不查符号
+} emcs51_disasm_t;
+
+void emcs51_disasm_init(emcs51_disasm_t *dis, const emcs51_derivative_t *derivative, const emcs51_symtab_t *symtab);
+
+uint8_t emcs51_disasm_length(uint8_t opcode);
+const char *emcs51_disasm_mnemonic(uint8_t opcode);
+uint32_t emcs51_disasm_inst(const emcs51_disasm_t *dis, uint16_t pc, const uint8_t *code, char *buf, uint32_t size);
+
+#endif // EMCS51_DISASM_H
@@ -0,0 +1,228 @@
+#include "emcs51.h"
+
+#define EMCS51_WATCH_SET_BIT(map, n) ((map)[(n) >> 5] |= ((uint32_t)1 << ((n) & 31)))
+#define EMCS51_WATCH_TEST_BIT(map, n) ((map)[(n) >> 5] & ((uint32_t)1 << ((n) & 31)))
+
+/*******************************************************************************
+ * @brief 按观察点重建核心和本结构中的位图
+ ******************************************************************************/
+static void emcs51_watch_rebuild(emcs51_watch_t *watch)
+{
+    emcs51_core_t *core = watch->core;
+
+    memset(core->watch_data_rd, 0, sizeof(core->watch_data_rd));
+    memset(core->watch_data_wr, 0, sizeof(core->watch_data_wr));
+    memset(core->watch_xdata_rd, 0, sizeof(core->watch_xdata_rd));
+    memset(core->watch_xdata_wr, 0, sizeof(core->watch_xdata_wr));
+    memset(watch->xdata_rd, 0, sizeof(watch->xdata_rd));
+    memset(watch->xdata_wr, 0, sizeof(watch->xdata_wr));
+
+    for (uint32_t i = 0; i < EMCS51_WATCH_MAX; i++)
+    {
+        emcs51_watchpoint_t *wp = &watch->wp[i];
+
+        if (wp->used == 0)
+            continue;
+
+        for (uint32_t addr = wp->addr; addr < (uint32_t)wp->addr + wp->len; addr++)
+        {
+            if (wp->space == EMCS51_SPACE_XDATA)
+            {
+                if (wp->type & EMCS51_WATCH_READ)
+                {
+                    EMCS51_WATCH_SET_BIT(watch->xdata_rd, addr);
+                    EMCS51_WATCH_SET_BIT(core->watch_xdata_rd, addr >> 8);
+                }
+
+                if (wp->type & EMCS51_WATCH_WRITE)
+                {
+                    EMCS51_WATCH_SET_BIT(watch->xdata_wr, addr);
+                    EMCS51_WATCH_SET_BIT(core->watch_xdata_wr, addr >> 8);
+                }
+            }
+            else
+            {
+                if (wp->type & EMCS51_WATCH_READ)
+                    EMCS51_WATCH_SET_BIT(core->watch_data_rd, addr);
+
+                if (wp->type & EMCS51_WATCH_WRITE)
+                    EMCS51_WATCH_SET_BIT(core->watch_data_wr, addr);
+            }
+        }
+    }
+
+    emcs51_core_rebuild_xdata_map(core);
+}
+
+/*******************************************************************************
+ * @brief 初始化观察点
+ * @param watch 观察点结构体指针
+ * @param core  核心结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_watch_init(emcs51_watch_t *watch, emcs51_core_t *core)
+{
+    memset(watch, 0, sizeof(emcs51_watch_t));
+
+    watch->core = core;
+    watch->hit.index = -1;
+
+    core->watch = watch;
+    emcs51_watch_rebuild(watch);
+}
+
+/*******************************************************************************
+ * @brief 删除全部观察点，恢复XDATA快速路径
+ * @param watch 观察点结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_watch_deinit(emcs51_watch_t *watch)
+{
+    emcs51_watch_clear(watch);
+
+    if (watch->core->watch == watch)
+        watch->core->watch = NULL;
+}
+
+/*******************************************************************************
+ * @brief 添加观察点
+ * @param watch 观察点结构体指针
+ * @param space EMCS51_SPACE_IRAM/EMCS51_SPACE_SFR/EMCS51_SPACE_XDATA
+ * @param addr  起始地址
+ * @param len   长度
+ * @param type  emcs51_watch_types_t
+ * @return 观察点编号，失败返回 emcs51_err_t
+ ******************************************************************************/
+int emcs51_watch_add(emcs51_watch_t *watch, uint8_t space, uint16_t addr, uint32_t len, uint8_t type)
+{
+    uint32_t limit = (space == EMCS51_SPACE_XDATA) ? 0x10000 : 0x100;
+
+    if ((space == EMCS51_SPACE_CODE) || (space > EMCS51_SPACE_XDATA))
+        return EMCS51_ERR;
+
+    if ((len == 0) || (((uint32_t)addr + len) > limit) || ((type & EMCS51_WATCH_ACCESS) == 0))
+        return EMCS51_ERR;
+
+    for (int i = 0; i < EMCS51_WATCH_MAX; i++)
+    {
+        emcs51_watchpoint_t *wp = &watch->wp[i];
+
+        if (wp->used)
+            continue;
+
+        memset(wp, 0, sizeof(emcs51_watchpoint_t));
+        wp->used = 1;
+        wp->space = space;
+        wp->type = type & EMCS51_WATCH_ACCESS;
+        wp->addr = addr;
+        wp->len = len;
+
+        emcs51_watch_rebuild(watch);
+
+        return i;
+    }
+
+    return EMCS51_ERR;
+}
+
+/*******************************************************************************
+ * @brief 删除观察点
+ * @param watch 观察点结构体指针
+ * @param index 观察点编号
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_watch_remove(emcs51_watch_t *watch, int index)
+{
+    if ((index < 0) || (index >= EMCS51_WATCH_MAX) || (watch->wp[index].used == 0))
+        return EMCS51_ERR;
+
+    watch->wp[index].used = 0;
+
+    if (watch->hit.index == index)
+        watch->hit.index = -1;
+
+    emcs51_watch_rebuild(watch);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 删除全部观察点
+ * @param watch 观察点结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_watch_clear(emcs51_watch_t *watch)
+{
+    for (int i = 0; i < EMCS51_WATCH_MAX; i++)
+        watch->wp[i].used = 0;
+
+    watch->hit.index = -1;
+
+    emcs51_watch_rebuild(watch);
+}
+
+/*******************************************************************************
+ * @brief 从观察点命中处继续运行
+ * @param watch 观察点结构体指针
+ * @return none
+ * @details 命中时访问所在的指令已执行完，只需清除 EMCS51_ERR_WATCHPOINT
+ ******************************************************************************/
+void emcs51_watch_resume(emcs51_watch_t *watch)
+{
+    if (watch->core->err == EMCS51_ERR_WATCHPOINT)
+        watch->core->err = EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 核心在位图命中后调用，检查字节位图并记录命中
+ * @param core      核心结构体指针
+ * @param space     访问的空间
+ * @param type      EMCS51_WATCH_READ 或 EMCS51_WATCH_WRITE
+ * @param addr      地址
+ * @param old_value 访问前的值
+ * @param new_value 读取或写入的值
+ * @return none
+ * @details 访问照常完成，指令执行完后 emcs51_core_run() 返回 EMCS51_ERR_WATCHPOINT；
+ *          同一条指令的多次命中只记录第一次
+ ******************************************************************************/
+void emcs51_watch_access(emcs51_core_t *core, uint8_t space, uint8_t type, uint16_t addr, uint8_t old_value, uint8_t new_value)
+{
+    emcs51_watch_t *watch = core->watch;
+    uint8_t is_xdata = (space == EMCS51_SPACE_XDATA);
+    const uint32_t *map;
+
+    if ((watch == NULL) || (core->err < 0))
+        return;
+
+    if (is_xdata)
+        map = (type == EMCS51_WATCH_READ) ? watch->xdata_rd : watch->xdata_wr;
+    else
+        map = (type == EMCS51_WATCH_READ) ? core->watch_data_rd : core->watch_data_wr;
+
+    if (!EMCS51_WATCH_TEST_BIT(map, addr))
+        return;
+
+    for (int i = 0; i < EMCS51_WATCH_MAX; i++)
+    {
+        emcs51_watchpoint_t *wp = &watch->wp[i];
+
+        if ((wp->used == 0) || ((wp->type & type) == 0) || ((wp->space == EMCS51_SPACE_XDATA) != is_xdata))
+            continue;
+
+        if ((addr < wp->addr) || (addr >= ((uint32_t)wp->addr + wp->len)))
+            continue;
+
+        wp->hits++;
+
+        watch->hit.index = (int8_t)i;
+        watch->hit.space = space;
+        watch->hit.type = type;
+        watch->hit.addr = addr;
+        watch->hit.pc = core->reg.pc;
+        watch->hit.old_value = old_value;
+        watch->hit.new_value = new_value;
+
+        core->err = EMCS51_ERR_WATCHPOINT;
+        return;
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef EMCS51_WATCH_H
+#define EMCS51_WATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core/emcs51_core.h"
+
+#define EMCS51_WATCH_MAX 16
+
+typedef enum EMCS51_WATCH_TYPES
+{
+    EMCS51_WATCH_READ = 0x01,
+    EMCS51_WATCH_WRITE = 0x02,
+    EMCS51_WATCH_ACCESS = 0x03, // 读或写
+} emcs51_watch_types_t;
+
+typedef struct EMCS51_WATCHPOINT
+{
+    uint8_t used;
+    uint8_t space; // emcs51_space_types_t，IRAM 和 SFR 共用 data_ram，按地址匹配
+    uint8_t type;  // emcs51_watch_types_t
+    uint16_t addr;
+    uint32_t len;
+    uint32_t hits;
+} emcs51_watchpoint_t;
+
+// 最近一次命中
+typedef struct EMCS51_WATCH_HIT
+{
+    int8_t index; // 观察点编号，-1 表示无
+    uint8_t space;
+    uint8_t type; // 本次访问的类型，EMCS51_WATCH_READ 或 EMCS51_WATCH_WRITE
+    uint16_t addr;
+    uint16_t pc;  // 访问所在指令的地址
+    uint8_t old_value;
+    uint8_t new_value;
+} emcs51_watch_hit_t;
+
+// 观察点：DATA区为核心中的每字节位图；XDATA区先按页过滤（被观察的页没有快速路径），再查每字节位图
+typedef struct EMCS51_WATCH
+{
+    emcs51_core_t *core;
+    emcs51_watchpoint_t wp[EMCS51_WATCH_MAX];
+
+    uint32_t xdata_rd[0x10000 / 32];
+    uint32_t xdata_wr[0x10000 / 32];
+
+    emcs51_watch_hit_t hit;
+} emcs51_watch_t;
+
+void emcs51_watch_init(emcs51_watch_t *watch, emcs51_core_t *core);
+void emcs51_watch_deinit(emcs51_watch_t *watch);
+
+int emcs51_watch_add(emcs51_watch_t *watch, uint8_t space, uint16_t addr, uint32_t len, uint8_t type);
+int emcs51_watch_remove(emcs51_watch_t *watch, int index);
+void emcs51_watch_clear(emcs51_watch_t *watch);
+
+void emcs51_watch_resume(emcs51_watch_t *watch);
+
+void emcs51_watch_access(emcs51_core_t *core, uint8_t space, uint8_t type, uint16_t addr, uint8_t old_value, uint8_t new_value);
+
+#endif // EMCS51_WATCH_H
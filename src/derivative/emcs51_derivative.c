@@ -0,0 +1,552 @@
+#include "emcs51.h"
+
+// 标准8051，单位：机器周期（12个时钟）
+const uint8_t emcs51_derivative_timing_8051[256] = {
+    1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x00
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x10
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x20
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x30
+    2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x40
+    2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x50
+    2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x60
+    2, 2, 2, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x70
+    2, 2, 2, 2, 4, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0x80
+    2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x90
+    2, 2, 1, 2, 4, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0xA0
+    2, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0xB0
+    2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xC0
+    2, 2, 1, 1, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, // 0xD0
+    2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xE0
+    2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xF0
+};
+
+// STC8 系列（1T），单位：时钟；MOVX 未计入 XRAM 访问等待
+static const uint8_t emcs51_derivative_timing_stc8[256] = {
+    1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x00
+    1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x10
+    1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x20
+    1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x30
+    1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x40
+    1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x50
+    1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x60
+    1, 3, 1, 4, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x70
+    3, 3, 1, 3, 6, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x80
+    1, 3, 1, 4, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0x90
+    1, 3, 1, 1, 2, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xA0
+    1, 3, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 0xB0
+    1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xC0
+    1, 3, 1, 1, 3, 2, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, // 0xD0
+    2, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xE0
+    2, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 0xF0
+};
+
+// STC8 条件转移成立时的时钟数：JBC/JB/JNB/JC/JNC/JZ/JNZ、CJNE、DJNZ
+static const uint8_t emcs51_derivative_timing_taken_stc8[256] = {
+    [0x10] = 3, [0x20] = 3, [0x30] = 3, [0x40] = 3, [0x50] = 3, [0x60] = 3, [0x70] = 3,
+    [0xB4] = 3, [0xB5] = 3, [0xB6] = 3, [0xB7] = 3, [0xB8] = 3, [0xB9] = 3, [0xBA] = 3, [0xBB] = 3,
+    [0xBC] = 3, [0xBD] = 3, [0xBE] = 3, [0xBF] = 3,
+    [0xD5] = 3, [0xD8] = 3, [0xD9] = 3, [0xDA] = 3, [0xDB] = 3, [0xDC] = 3, [0xDD] = 3, [0xDE] = 3, [0xDF] = 3,
+};
+
+static const emcs51_derivative_sfr_t emcs51_derivative_sfrs_at89s52[] = {
+    {0x8E, 0x00, "AUXR"},
+    {0xA2, 0x00, "AUXR1"},
+    {0xA6, 0x00, "WDTRST"},
+    {0xC8, 0x00, "T2CON"},
+    {0xC9, 0x00, "T2MOD"},
+    {0xCA, 0x00, "RCAP2L"},
+    {0xCB, 0x00, "RCAP2H"},
+    {0xCC, 0x00, "TL2"},
+    {0xCD, 0x00, "TH2"},
+};
+
+static const emcs51_derivative_sfr_t emcs51_derivative_sfrs_ds89c4x0[] = {
+    {0x84, 0x00, "DPL1"},
+    {0x85, 0x00, "DPH1"},
+    {0x86, 0x00, "DPS"},
+    {0x8E, 0x01, "CKCON"},
+    {0xC8, 0x00, "T2CON"},
+    {0xC9, 0x00, "T2MOD"},
+    {0xCA, 0x00, "RCAP2L"},
+    {0xCB, 0x00, "RCAP2H"},
+    {0xCC, 0x00, "TL2"},
+    {0xCD, 0x00, "TH2"},
+};
+
+static const emcs51_derivative_sfr_t emcs51_derivative_sfrs_stc8[] = {
+    {0x8E, 0x00, "AUXR"},
+    {0xA2, 0x00, "P_SW1"},
+    {0xBA, 0x00, "P_SW2"},
+    {0xE3, 0x00, "DPS"},
+    {0xE4, 0x00, "DPL1"},
+    {0xE5, 0x00, "DPH1"},
+};
+
+#define EMCS51_DERIVATIVE_SFRS(table) .sfrs = table, .sfr_count = sizeof(table) / sizeof(table[0])
+
+const emcs51_derivative_t emcs51_derivative_8051 = {
+    .name = "8051",
+    .clocks_per_cycle = 12,
+    .iram_size = 128,
+    .code_size = 0x1000,
+};
+
+// 6时钟（X2）型号，指令周期数与标准8051相同
+const emcs51_derivative_t emcs51_derivative_8051_x2 = {
+    .name = "8051-X2",
+    .clocks_per_cycle = 6,
+    .iram_size = 256,
+    .code_size = 0x10000,
+};
+
+// AUXR1.0 DPS，其余位未实现
+const emcs51_derivative_t emcs51_derivative_at89s52 = {
+    .name = "AT89S52",
+    .clocks_per_cycle = 12,
+    .iram_size = 256,
+    .code_size = 0x2000,
+    EMCS51_DERIVATIVE_SFRS(emcs51_derivative_sfrs_at89s52),
+    .dps_sfr = 0xA2,
+    .dps_sel_mask = 0x01,
+    .dps_write_mask = 0x01,
+};
+
+// DPS: ID1 ID0 TSL AID - - - SEL，ID0/ID1 同时决定 INC DPTR 的方向
+// 时序沿用标准表，未建模其每机器周期1个时钟的模式
+const emcs51_derivative_t emcs51_derivative_ds89c4x0 = {
+    .name = "DS89C4x0",
+    .clocks_per_cycle = 12,
+    .iram_size = 256,
+    .xram_size = 0x400,
+    .code_size = 0x4000,
+    EMCS51_DERIVATIVE_SFRS(emcs51_derivative_sfrs_ds89c4x0),
+    .dps_sfr = 0x86,
+    .dps_sel_mask = 0x01,
+    .dps_write_mask = 0xF1,
+    .dps_tsl_mask = 0x20,
+    .dps_inc_mask = {0x10, 0x10},
+    .dps_dec_mask = {0x40, 0x80},
+    .dps_dec_inc_dptr = 1,
+};
+
+// DPS: ID1 ID0 TSL AU1 AU0 - - SEL，DPTR1 位于 DPL1(0xE4)/DPH1(0xE5)
+const emcs51_derivative_t emcs51_derivative_stc8 = {
+    .name = "STC8",
+    .clocks_per_cycle = 1,
+    .timing = emcs51_derivative_timing_stc8,
+    .timing_taken = emcs51_derivative_timing_taken_stc8,
+    .iram_size = 256,
+    .xram_size = 0x2000,
+    .code_size = 0x10000,
+    EMCS51_DERIVATIVE_SFRS(emcs51_derivative_sfrs_stc8),
+    .dps_sfr = 0xE3,
+    .dps_sel_mask = 0x01,
+    .dps_write_mask = 0xF9,
+    .dps_tsl_mask = 0x20,
+    .dps_inc_mask = {0x08, 0x10},
+    .dps_dec_mask = {0x40, 0x80},
+    .dptr1_sfr = 0xE4,
+};
+
+static const emcs51_derivative_t *const emcs51_derivatives[] = {
+    &emcs51_derivative_8051,
+    &emcs51_derivative_8051_x2,
+    &emcs51_derivative_at89s52,
+    &emcs51_derivative_ds89c4x0,
+    &emcs51_derivative_stc8,
+};
+
+/*******************************************************************************
+ * @brief 按名称查找内置型号
+ * @param name 型号名称，如 "AT89S52"
+ * @return 型号描述，未找到返回NULL
+ ******************************************************************************/
+const emcs51_derivative_t *emcs51_derivative_find(const char *name)
+{
+    if (name == NULL)
+        return NULL;
+
+    for (uint32_t i = 0; i < sizeof(emcs51_derivatives) / sizeof(emcs51_derivatives[0]); i++)
+    {
+        if (strcmp(emcs51_derivatives[i]->name, name) == 0)
+            return emcs51_derivatives[i];
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * @brief 当前选中的DPTR编号
+ ******************************************************************************/
+static uint8_t emcs51_derivative_dptr_index(emcs51_core_t *core)
+{
+    return (core->data_ram[core->dps_sfr] & core->dps_sel_mask) ? 1 : 0;
+}
+
+/*******************************************************************************
+ * @brief MOVX @DPTR/MOVC @A+DPTR 之后的DPTR自动加减和自动切换
+ * @param core 核心结构体指针
+ * @return emcs51_err_t
+ ******************************************************************************/
+static int emcs51_derivative_dptr_post(emcs51_core_t *core)
+{
+    int err;
+    const emcs51_derivative_t *derivative = core->derivative;
+    uint8_t dps = core->data_ram[core->dps_sfr];
+    uint8_t index = emcs51_derivative_dptr_index(core);
+    uint16_t dptr_value;
+
+    if (dps & derivative->dps_inc_mask[index])
+    {
+        err = emcs51_core_read_DPTR(core, &dptr_value);
+        if (err < 0)
+            return err;
+
+        dptr_value = (dps & derivative->dps_dec_mask[index]) ? (uint16_t)(dptr_value - 1) : (uint16_t)(dptr_value + 1);
+
+        err = emcs51_core_write_DPTR(core, dptr_value);
+        if (err < 0)
+            return err;
+    }
+
+    if (dps & derivative->dps_tsl_mask)
+        return emcs51_core_write_data(core, core->dps_sfr, dps ^ core->dps_sel_mask);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 识别并整块执行双DPTR拷贝循环
+ * @param core 核心结构体指针
+ * @return 1 已执行，0 不符合条件，按单条指令执行
+ * @details 识别以下循环（Keil/SDCC 对 memcpy 到 xdata 的常见展开）：
+ *          LOOP: MOVX A, @DPTR
+ *                INC  DPTR
+ *                INC  DPS
+ *                MOVX @DPTR, A
+ *                INC  DPTR
+ *                INC  DPS
+ *                DJNZ Rn, LOOP
+ *          只在源和目的都位于 xdata_ram、DPS 两次加1后恢复原值且未开启自动加减/切换、
+ *          没有钩子、观察点、跟踪、剖析或覆盖率记录，且循环中的操作码都没有断点时才整块执行，
+ *          周期数和指令数按逐条执行累加。
+ *          整块执行可能超出 emcs51_core_run() 的周期预算，最多一个循环的长度
+ ******************************************************************************/
+static int emcs51_derivative_copy_loop(emcs51_core_t *core)
+{
+    const emcs51_derivative_t *derivative = core->derivative;
+    uint16_t pc = core->reg.pc;
+    uint8_t dps_sfr = core->dps_sfr;
+    uint8_t code[9];
+    uint8_t dps, dps1, busy;
+    uint8_t reg_num, count;
+    uint8_t src_dpl, dst_dpl;
+    uint16_t src, dst;
+    uint32_t n, page;
+    uint8_t *ram = core->xdata_ram;
+    uint8_t a;
+    uint64_t cycles;
+
+    if ((core->hook != NULL) || (core->watch != NULL) || (core->trace != NULL) || (core->profile != NULL) || (core->coverage != NULL))
+        return 0;
+
+    if (pc > 0xFFFF - 10)
+        return 0;
+
+    if (emcs51_core_read_code(core, pc + 1, code, sizeof(code)) < 0)
+        return 0;
+
+    if ((code[0] != 0xA3) || (code[1] != 0x05) || (code[2] != dps_sfr) || (code[3] != 0xF0) || (code[4] != 0xA3) ||
+        (code[5] != 0x05) || (code[6] != dps_sfr) || ((code[7] & 0xF8) != 0xD8) || (code[8] != 0xF6))
+        return 0;
+
+    // 断点通过替换操作码的分派项实现，整块执行会跳过循环内的断点
+    if ((core->brk != NULL) && (core->brk->refs_all || core->brk->refs[0xE0] || core->brk->refs[0xA3] ||
+                                core->brk->refs[0x05] || core->brk->refs[0xF0] || core->brk->refs[code[7]]))
+        return 0;
+
+    // INC DPS 只有在写掩码下两次加1回到原值、且每次都翻转选择位时才等价于切换DPTR
+    if (core->write_data_cb[dps_sfr] || core->read_data_cb[dps_sfr] || (dps_sfr == core->code_bank_sfr))
+        return 0;
+
+    dps = core->data_ram[dps_sfr];
+    dps1 = (uint8_t)(dps + 1) & core->dps_write_mask;
+
+    if ((((uint8_t)(dps1 + 1) & core->dps_write_mask) != dps) || (((dps ^ dps1) & core->dps_sel_mask) == 0))
+        return 0;
+
+    busy = derivative->dps_tsl_mask | derivative->dps_inc_mask[0] | derivative->dps_inc_mask[1];
+    if (derivative->dps_dec_inc_dptr)
+        busy |= derivative->dps_dec_mask[0] | derivative->dps_dec_mask[1];
+
+    if ((dps | dps1) & busy)
+        return 0;
+
+    reg_num = code[7] & 0x07;
+    if (emcs51_core_read_GPR(core, reg_num, &count) < 0)
+        return 0;
+
+    n = (count == 0) ? 256 : count;
+
+    src_dpl = (dps & core->dps_sel_mask) ? core->dptr1_addr : EMCS51_DPTR0_ADDR;
+    dst_dpl = (dps & core->dps_sel_mask) ? EMCS51_DPTR0_ADDR : core->dptr1_addr;
+    src = (uint16_t)((core->data_ram[src_dpl + 1] << 8) | core->data_ram[src_dpl]);
+    dst = (uint16_t)((core->data_ram[dst_dpl + 1] << 8) | core->data_ram[dst_dpl]);
+
+    if ((ram == NULL) || ((uint32_t)src + n > core->xdata_ram_size) || ((uint32_t)dst + n > core->xdata_ram_size))
+        return 0;
+
+    // 被其它区域覆盖的页（ROM/MMIO）必须逐条执行
+    for (page = src >> 8; page <= ((uint32_t)src + n - 1) >> 8; page++)
+    {
+        if (core->xdata_page_region[page] != 1)
+            return 0;
+    }
+
+    for (page = dst >> 8; page <= ((uint32_t)dst + n - 1) >> 8; page++)
+    {
+        if (core->xdata_page_region[page] != 1)
+            return 0;
+    }
+
+    // 逐字节向前拷贝的语义：目的在源之后且重叠时会重复前面的字节，不能用 memmove
+    if ((dst <= src) || (dst >= src + n))
+    {
+        a = ram[src + n - 1];
+        memmove(&ram[dst], &ram[src], n);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            a = ram[src + i];
+            ram[dst + i] = a;
+        }
+    }
+
+    emcs51_core_mark_xdata_dirty(core, dst, n);
+
+    src = (uint16_t)(src + n);
+    dst = (uint16_t)(dst + n);
+    core->data_ram[src_dpl] = src & 0xFF;
+    core->data_ram[src_dpl + 1] = src >> 8;
+    core->data_ram[dst_dpl] = dst & 0xFF;
+    core->data_ram[dst_dpl + 1] = dst >> 8;
+
+    core->reg.a = a;
+    emcs51_core_write_GPR(core, reg_num, 0);
+
+    // 本条 MOVX A, @DPTR 的周期和指令数由 emcs51_core_inc() 累加，DJNZ 最后一次不转移
+    cycles = (uint64_t)core->inst_def[0xE0].cycles + core->inst_def[0xA3].cycles * 2 + core->inst_def[0x05].cycles * 2 +
+             core->inst_def[0xF0].cycles + core->inst_def[code[7]].cycles;
+    core->cycles += cycles * n - core->inst_def[0xE0].cycles + (uint64_t)core->inst_def[code[7]].cycles_jump * (n - 1);
+    core->inst_count += 7 * (uint64_t)n - 1;
+
+    core->reg.pc = pc + 10;
+    core->is_jumped = true;
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 回调函数：0xE0 MOVX A, @DPTR 指令执行（双DPTR）
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_derivative_movx_a_at_dptr_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint16_t dptr_value;
+
+    if (emcs51_derivative_copy_loop(core))
+        return;
+
+    err = emcs51_core_read_DPTR(core, &dptr_value);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    err = emcs51_core_read_xdata(core, dptr_value, &core->reg.a);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    err = emcs51_derivative_dptr_post(core);
+    if (err < 0)
+        core->err = err;
+}
+
+/*******************************************************************************
+ * @brief 回调函数：0xF0 MOVX @DPTR, A 指令执行（双DPTR）
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_derivative_movx_at_dptr_a_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint16_t dptr_value;
+
+    err = emcs51_core_read_DPTR(core, &dptr_value);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    err = emcs51_core_write_xdata(core, dptr_value, core->reg.a);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    err = emcs51_derivative_dptr_post(core);
+    if (err < 0)
+        core->err = err;
+}
+
+/*******************************************************************************
+ * @brief 回调函数：0x93 MOVC A, @A+DPTR 指令执行（双DPTR）
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_derivative_movc_a_at_a_dptr_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint16_t dptr_value;
+
+    err = emcs51_core_read_DPTR(core, &dptr_value);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    err = emcs51_core_read_code_byte(core, (uint16_t)(dptr_value + core->reg.a), &core->reg.a);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    err = emcs51_derivative_dptr_post(core);
+    if (err < 0)
+        core->err = err;
+}
+
+/*******************************************************************************
+ * @brief 回调函数：0xA3 INC DPTR 指令执行，ID位置位时减1（DS89C4x0）
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_derivative_inc_dptr_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint8_t dps = core->data_ram[core->dps_sfr];
+    uint16_t dptr_value;
+
+    err = emcs51_core_read_DPTR(core, &dptr_value);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    if (dps & core->derivative->dps_dec_mask[emcs51_derivative_dptr_index(core)])
+        dptr_value--;
+    else
+        dptr_value++;
+
+    err = emcs51_core_write_DPTR(core, dptr_value);
+    if (err < 0)
+        core->err = err;
+}
+
+/*******************************************************************************
+ * @brief 按衍生型号注册指令并配置核心
+ * @param core       核心结构体指针
+ * @param derivative 型号描述，NULL 表示标准8051
+ * @return none
+ * @details 在 emcs51_general_inst_init() 的基础上按型号时序表设置各指令周期数，
+ *          替换与DPTR相关的指令，并写入型号SFR的复位值；需在 emcs51_core_init() 之后调用
+ ******************************************************************************/
+void emcs51_derivative_init(emcs51_core_t *core, const emcs51_derivative_t *derivative)
+{
+    const uint8_t *timing;
+
+    if (core == NULL)
+        return;
+
+    if (derivative == NULL)
+        derivative = &emcs51_derivative_8051;
+
+    emcs51_general_inst_init(core);
+
+    core->derivative = derivative;
+    core->clocks_per_cycle = (derivative->clocks_per_cycle != 0) ? derivative->clocks_per_cycle : EMCS51_CLOCKS_PER_CYCLE_DEFAULT;
+
+    timing = (derivative->timing != NULL) ? derivative->timing : emcs51_derivative_timing_8051;
+
+    for (uint32_t opcode = 0; opcode < 256; opcode++)
+    {
+        emcs51_inst_def_t *inst_def = &core->inst_def[opcode];
+
+        if ((inst_def->mnemonic == NULL) || (timing[opcode] == 0))
+            continue;
+
+        inst_def->cycles = timing[opcode];
+        inst_def->cycles_jump = 0;
+
+        if ((derivative->timing_taken != NULL) && (derivative->timing_taken[opcode] > timing[opcode]))
+            inst_def->cycles_jump = derivative->timing_taken[opcode] - timing[opcode];
+    }
+
+    core->dps_sfr = derivative->dps_sfr;
+    core->dps_sel_mask = derivative->dps_sel_mask;
+    core->dps_write_mask = (derivative->dps_write_mask != 0) ? derivative->dps_write_mask : 0xFF;
+    core->dptr1_addr = (derivative->dptr1_sfr != 0) ? derivative->dptr1_sfr : EMCS51_DPTR1_ADDR;
+
+    if (derivative->pdata_page_sfr != 0)
+        core->pdata_page_sfr = derivative->pdata_page_sfr;
+
+    emcs51_derivative_reset(core);
+
+    if (core->dps_sel_mask == 0)
+        return;
+
+    core->inst_def[0xE0].exec_cb = emcs51_derivative_movx_a_at_dptr_inst_exec_cb;
+    core->inst_def[0xF0].exec_cb = emcs51_derivative_movx_at_dptr_a_inst_exec_cb;
+    core->inst_def[0x93].exec_cb = emcs51_derivative_movc_a_at_a_dptr_inst_exec_cb;
+
+    if (derivative->dps_dec_inc_dptr)
+        core->inst_def[0xA3].exec_cb = emcs51_derivative_inc_dptr_inst_exec_cb;
+}
+
+/*******************************************************************************
+ * @brief 写入型号特有SFR的复位值
+ * @param core 核心结构体指针
+ * @return none
+ * @details 直接写 data_ram，不经过SFR回调；emcs51_core_reset() 之后按需调用
+ ******************************************************************************/
+void emcs51_derivative_reset(emcs51_core_t *core)
+{
+    const emcs51_derivative_t *derivative;
+
+    if ((core == NULL) || (core->derivative == NULL))
+        return;
+
+    derivative = core->derivative;
+
+    for (uint32_t i = 0; i < derivative->sfr_count; i++)
+    {
+        core->data_ram[derivative->sfrs[i].addr] = derivative->sfrs[i].reset;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef EMCS51_DERIVATIVE_H
+#define EMCS51_DERIVATIVE_H
+
+#include <stdint.h>
+#include "core/emcs51_core.h"
+
+// 型号特有的SFR及其复位值
+typedef struct EMCS51_DERIVATIVE_SFR
+{
+    uint8_t addr;
+    uint8_t reset;
+    const char *name;
+} emcs51_derivative_sfr_t;
+
+// 衍生型号描述，只读常量表，多个核心可共用
+typedef struct EMCS51_DERIVATIVE
+{
+    const char *name;
+
+    // 时序：emcs51_derivative_init() 将 timing 写入各指令的 cycles，执行时没有额外判断
+    uint8_t clocks_per_cycle;    // 每个计数周期的振荡器时钟数：12/6，1T 型号为1（timing 以时钟为单位）
+    const uint8_t *timing;       // 256项，每条指令的周期数，NULL 表示标准8051表
+    const uint8_t *timing_taken; // 256项，条件转移成立时的周期数，0 或 NULL 表示与 timing 相同
+
+    // 存储器大小，仅作描述，供工具按型号分配
+    uint16_t iram_size; // 128 或 256
+    uint32_t xram_size; // 片上XRAM，0 表示无
+    uint32_t code_size; // 片上code区
+
+    const emcs51_derivative_sfr_t *sfrs; // 标准8051之外的SFR
+    uint8_t sfr_count;
+
+    // 双DPTR：DPS中 dps_sel_mask 位选择 DPTR1
+    uint8_t dps_sfr;          // 数据指针选择寄存器（DPS/AUXR1），0 表示单DPTR
+    uint8_t dps_sel_mask;     // 选择 DPTR1 的位
+    uint8_t dps_write_mask;   // 已实现的位，其余位读回为0
+    uint8_t dps_tsl_mask;     // MOVX @DPTR/MOVC @A+DPTR 之后自动切换DPTR
+    uint8_t dps_inc_mask[2];  // DPTR0/DPTR1 在 MOVX @DPTR/MOVC @A+DPTR 之后自动加1
+    uint8_t dps_dec_mask[2];  // 与 dps_inc_mask 同时置位时改为自动减1
+    uint8_t dps_dec_inc_dptr; // 非0时 dps_dec_mask 同样使 INC DPTR 变为减1（DS89C4x0）
+    uint8_t dptr1_sfr;        // DPL1 地址，DPH1 紧随其后，0 表示 0x84
+
+    uint8_t pdata_page_sfr; // MOVX @Ri 页寄存器，0 表示 P2
+} emcs51_derivative_t;
+
+extern const emcs51_derivative_t emcs51_derivative_8051;
+extern const emcs51_derivative_t emcs51_derivative_8051_x2;
+extern const emcs51_derivative_t emcs51_derivative_at89s52;
+extern const emcs51_derivative_t emcs51_derivative_ds89c4x0;
+extern const emcs51_derivative_t emcs51_derivative_stc8;
+
+extern const uint8_t emcs51_derivative_timing_8051[256];
+
+void emcs51_derivative_init(emcs51_core_t *core, const emcs51_derivative_t *derivative);
+void emcs51_derivative_reset(emcs51_core_t *core);
+const emcs51_derivative_t *emcs51_derivative_find(const char *name);
+
+#endif // EMCS51_DERIVATIVE_H
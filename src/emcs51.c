@@ -14,6 +14,24 @@ const char* emcs51_err_name(int err)
             return "ERR_CODE_OUT_OF_RANGE";
         case EMCS51_ERR_UNKNOWN_INST:
             return "ERR_UNKNOWN_INST";
+        case EMCS51_ERR_XDATA_OUT_OF_RANGE:
+            return "ERR_XDATA_OUT_OF_RANGE";
+        case EMCS51_ERR_REPLAY_DIVERGED:
+            return "ERR_REPLAY_DIVERGED";
+        case EMCS51_ERR_STREAM:
+            return "ERR_STREAM";
+        case EMCS51_ERR_IHEX_FORMAT:
+            return "ERR_IHEX_FORMAT";
+        case EMCS51_ERR_IHEX_CHECKSUM:
+            return "ERR_IHEX_CHECKSUM";
+        case EMCS51_ERR_OBJ_FORMAT:
+            return "ERR_OBJ_FORMAT";
+        case EMCS51_ERR_BREAKPOINT:
+            return "ERR_BREAKPOINT";
+        case EMCS51_ERR_WATCHPOINT:
+            return "ERR_WATCHPOINT";
+        case EMCS51_ERR_TRACE_FORMAT:
+            return "ERR_TRACE_FORMAT";
     }
 
     return "UNKNOWN_ERR";
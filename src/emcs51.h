@@ -11,10 +11,18 @@ typedef enum EMCS51_ERR
 {
     EMCS51_OK = 0,
     EMCS51_ERR = -1,
-    EMCS51_ERR_CORE_NULL = -2,         // core is NULL
-    EMCS51_ERR_CODE_OUT_OF_RANGE = -3, // code out of range
-    EMCS51_ERR_UNKNOWN_INST = -4,      // unknown instruction
-    EMCS51_ERR_XDATA_OUT_OF_RANGE = -5 // xdata out of range
+    EMCS51_ERR_CORE_NULL = -2,          // core is NULL
+    EMCS51_ERR_CODE_OUT_OF_RANGE = -3,  // code out of range
+    EMCS51_ERR_UNKNOWN_INST = -4,       // unknown instruction
+    EMCS51_ERR_XDATA_OUT_OF_RANGE = -5, // xdata out of range
+    EMCS51_ERR_REPLAY_DIVERGED = -6,    // replay does not match the recorded inputs
+    EMCS51_ERR_STREAM = -7,             // record stream read/write failed
+    EMCS51_ERR_IHEX_FORMAT = -8,        // malformed Intel HEX record
+    EMCS51_ERR_IHEX_CHECKSUM = -9,      // Intel HEX record checksum mismatch
+    EMCS51_ERR_OBJ_FORMAT = -10,        // malformed OMF-51 object or SDCC debug file
+    EMCS51_ERR_BREAKPOINT = -11,        // stopped at a breakpoint, see emcs51_break_resume()
+    EMCS51_ERR_WATCHPOINT = -12,        // stopped after a watched access, see emcs51_watch_resume()
+    EMCS51_ERR_TRACE_FORMAT = -13,      // malformed execution trace
 } emcs51_err_t;
 
 const char *emcs51_err_name(int err);
@@ -22,5 +30,20 @@ const char *emcs51_err_name(int err);
 #include "core/emcs51_inst.h"
 #include "core/emcs51_core.h"
 #include "instruction/emcs51_general_inst.h"
+#include "derivative/emcs51_derivative.h"
+#include "snapshot/emcs51_snapshot.h"
+#include "replay/emcs51_rewind.h"
+#include "replay/emcs51_record.h"
+#include "lane/emcs51_lane.h"
+#include "debug/emcs51_break.h"
+#include "debug/emcs51_watch.h"
+#include "debug/emcs51_disasm.h"
+#include "trace/emcs51_trace.h"
+#include "profile/emcs51_profile.h"
+#include "coverage/emcs51_coverage.h"
+#include "loader/emcs51_ihex.h"
+#include "loader/emcs51_symtab.h"
+#include "loader/emcs51_cdb.h"
+#include "loader/emcs51_omf51.h"
 
 #endif // EMCS51_H
@@ -0,0 +1,1000 @@
+#define _GNU_SOURCE // pipe2
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "host/emcs51_gdb.h"
+
+// GDB 的信号编号
+#define EMCS51_GDB_SIGINT 0x02
+#define EMCS51_GDB_SIGILL 0x04
+#define EMCS51_GDB_SIGTRAP 0x05
+#define EMCS51_GDB_SIGSEGV 0x0B
+
+static const char emcs51_gdb_hex_digits[] = "0123456789abcdef";
+
+static int emcs51_gdb_hex_value(char c)
+{
+    if ((c >= '0') && (c <= '9'))
+        return c - '0';
+    if ((c >= 'a') && (c <= 'f'))
+        return c - 'a' + 10;
+    if ((c >= 'A') && (c <= 'F'))
+        return c - 'A' + 10;
+
+    return -1;
+}
+
+/*******************************************************************************
+ * @brief 解析十六进制数，p 指向第一个非十六进制字符
+ ******************************************************************************/
+static uint32_t emcs51_gdb_parse_hex(const char **p)
+{
+    uint32_t value = 0;
+    int digit;
+
+    while ((digit = emcs51_gdb_hex_value(**p)) >= 0)
+    {
+        value = (value << 4) | (uint32_t)digit;
+        (*p)++;
+    }
+
+    return value;
+}
+
+static int emcs51_gdb_parse_byte(const char *p, uint8_t *data)
+{
+    int hi = emcs51_gdb_hex_value(p[0]);
+    int lo = (hi < 0) ? -1 : emcs51_gdb_hex_value(p[1]);
+
+    if (lo < 0)
+        return EMCS51_ERR;
+
+    *data = (uint8_t)((hi << 4) | lo);
+
+    return EMCS51_OK;
+}
+
+static char *emcs51_gdb_put_byte(char *out, uint8_t data)
+{
+    *out++ = emcs51_gdb_hex_digits[data >> 4];
+    *out++ = emcs51_gdb_hex_digits[data & 0x0F];
+
+    return out;
+}
+
+static void emcs51_gdb_send_raw(emcs51_gdb_t *gdb, const char *buf, size_t len)
+{
+    ssize_t n;
+
+    while ((len > 0) && (gdb->client_fd >= 0))
+    {
+        n = send(gdb->client_fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        buf += n;
+        len -= (size_t)n;
+    }
+}
+
+/*******************************************************************************
+ * @brief 发送报文 $payload#cs
+ ******************************************************************************/
+static void emcs51_gdb_send(emcs51_gdb_t *gdb, const char *payload)
+{
+    size_t len = strlen(payload);
+    uint8_t cs = 0;
+    char *out = gdb->tx;
+
+    if (len > EMCS51_GDB_PACKET_SIZE - 4)
+        len = EMCS51_GDB_PACKET_SIZE - 4;
+
+    *out++ = '$';
+    for (size_t i = 0; i < len; i++)
+    {
+        cs += (uint8_t)payload[i];
+        *out++ = payload[i];
+    }
+    *out++ = '#';
+    out = emcs51_gdb_put_byte(out, cs);
+
+    emcs51_gdb_send_raw(gdb, gdb->tx, (size_t)(out - gdb->tx));
+}
+
+static void emcs51_gdb_notify(emcs51_gdb_t *gdb)
+{
+    char c = 0;
+
+    if (write(gdb->notify_fd[1], &c, 1) < 0)
+        return;
+}
+
+/*******************************************************************************
+ * @brief 读取DATA区当前值，A、B、PSW、SP 取自寄存器，不触发回调和观察点
+ ******************************************************************************/
+static uint8_t emcs51_gdb_peek_data(emcs51_core_t *core, uint8_t addr)
+{
+    switch (addr)
+    {
+    case 0xE0:
+        return core->reg.a;
+    case 0xF0:
+        return core->reg.b;
+    case 0xD0:
+        return core->reg.psw;
+    case 0x81:
+        return core->reg.sp;
+    default:
+        return core->data_ram[addr];
+    }
+}
+
+static void emcs51_gdb_poke_data(emcs51_core_t *core, uint8_t addr, uint8_t data)
+{
+    switch (addr)
+    {
+    case 0xE0:
+        core->reg.a = data;
+        break;
+    case 0xF0:
+        core->reg.b = data;
+        break;
+    case 0xD0:
+        core->reg.psw = data;
+        break;
+    case 0x81:
+        core->reg.sp = data;
+        break;
+    default:
+        core->data_ram[addr] = data;
+        if ((addr == core->code_bank_sfr) && (addr != 0))
+            emcs51_core_update_code_bank(core);
+        break;
+    }
+}
+
+/*******************************************************************************
+ * @brief 寄存器编号对应的DATA区地址，PC 返回 -1
+ ******************************************************************************/
+static int emcs51_gdb_reg_addr(emcs51_core_t *core, uint32_t n)
+{
+    static const uint8_t sfr_addr[] = {0xE0, 0xF0, 0xD0, 0x81, 0x82, 0x83};
+
+    if (n < EMCS51_GDB_REG_A)
+        return (core->reg.rs * 8) + n;
+
+    if (n < EMCS51_GDB_REG_PC)
+        return sfr_addr[n - EMCS51_GDB_REG_A];
+
+    return -1;
+}
+
+static char *emcs51_gdb_put_reg(emcs51_core_t *core, char *out, uint32_t n)
+{
+    if (n == EMCS51_GDB_REG_PC)
+    {
+        out = emcs51_gdb_put_byte(out, core->reg.pc & 0xFF);
+        return emcs51_gdb_put_byte(out, core->reg.pc >> 8);
+    }
+
+    return emcs51_gdb_put_byte(out, emcs51_gdb_peek_data(core, (uint8_t)emcs51_gdb_reg_addr(core, n)));
+}
+
+/*******************************************************************************
+ * @brief 按GDB格式写入寄存器
+ * @return 消耗的字符数，失败返回 emcs51_err_t
+ ******************************************************************************/
+static int emcs51_gdb_set_reg(emcs51_core_t *core, uint32_t n, const char *hex)
+{
+    uint8_t lo, hi;
+
+    if (emcs51_gdb_parse_byte(hex, &lo) < 0)
+        return EMCS51_ERR;
+
+    if (n == EMCS51_GDB_REG_PC)
+    {
+        if (emcs51_gdb_parse_byte(hex + 2, &hi) < 0)
+            return EMCS51_ERR;
+
+        core->reg.pc = ((uint16_t)hi << 8) | lo;
+        return 4;
+    }
+
+    emcs51_gdb_poke_data(core, (uint8_t)emcs51_gdb_reg_addr(core, n), lo);
+
+    return 2;
+}
+
+/*******************************************************************************
+ * @brief 读取存储区，地址见 EMCS51_GDB_ADDR_*
+ ******************************************************************************/
+static int emcs51_gdb_read_mem(emcs51_core_t *core, uint32_t addr, uint8_t *data)
+{
+    uint32_t offset = addr & ~(uint32_t)EMCS51_GDB_ADDR_SPACE_MASK;
+
+    switch (addr & EMCS51_GDB_ADDR_SPACE_MASK)
+    {
+    case EMCS51_GDB_ADDR_CODE:
+        return emcs51_core_read_code_byte(core, (uint16_t)offset, data);
+
+    case EMCS51_GDB_ADDR_DATA:
+        if (offset > 0xFF)
+            return EMCS51_ERR;
+        *data = emcs51_gdb_peek_data(core, (uint8_t)offset);
+        return EMCS51_OK;
+
+    case EMCS51_GDB_ADDR_XDATA:
+        *data = emcs51_core_peek_xdata(core, (uint16_t)offset);
+        return EMCS51_OK;
+
+    default:
+        return EMCS51_ERR;
+    }
+}
+
+static int emcs51_gdb_write_mem(emcs51_core_t *core, uint32_t addr, uint8_t data)
+{
+    uint32_t offset = addr & ~(uint32_t)EMCS51_GDB_ADDR_SPACE_MASK;
+
+    switch (addr & EMCS51_GDB_ADDR_SPACE_MASK)
+    {
+    case EMCS51_GDB_ADDR_DATA:
+        if (offset > 0xFF)
+            return EMCS51_ERR;
+        emcs51_gdb_poke_data(core, (uint8_t)offset, data);
+        return EMCS51_OK;
+
+    case EMCS51_GDB_ADDR_XDATA:
+        return emcs51_core_poke_xdata(core, (uint16_t)offset, data);
+
+    default: // code区只读
+        return EMCS51_ERR;
+    }
+}
+
+/*******************************************************************************
+ * @brief 发送停止应答，断点和观察点附带停止原因
+ ******************************************************************************/
+static void emcs51_gdb_send_stop(emcs51_gdb_t *gdb)
+{
+    static const char *const watch_kind[] = {"", "rwatch", "watch", "awatch"};
+    emcs51_core_t *core = gdb->core;
+    emcs51_watch_hit_t *hit = &gdb->watch.hit;
+    char reply[64];
+    uint32_t addr;
+
+    if (core->err == EMCS51_ERR_BREAKPOINT)
+    {
+        snprintf(reply, sizeof(reply), "T%02xswbreak:;", EMCS51_GDB_SIGTRAP);
+    }
+    else if ((core->err == EMCS51_ERR_WATCHPOINT) && (hit->index >= 0))
+    {
+        addr = (hit->space == EMCS51_SPACE_XDATA) ? (EMCS51_GDB_ADDR_XDATA + hit->addr) : (EMCS51_GDB_ADDR_DATA + hit->addr);
+        snprintf(reply, sizeof(reply), "T%02x%s:%x;", EMCS51_GDB_SIGTRAP, watch_kind[gdb->watch.wp[hit->index].type & EMCS51_WATCH_ACCESS],
+                 (unsigned)addr);
+    }
+    else
+    {
+        snprintf(reply, sizeof(reply), "S%02x", gdb->stop_signal);
+    }
+
+    emcs51_gdb_send(gdb, reply);
+}
+
+/*******************************************************************************
+ * @brief Z/z 报文：0、1 为断点，2 写、3 读、4 读写观察点
+ ******************************************************************************/
+static void emcs51_gdb_handle_point(emcs51_gdb_t *gdb, const char *p, uint8_t insert)
+{
+    static const uint8_t watch_type[] = {0, 0, EMCS51_WATCH_WRITE, EMCS51_WATCH_READ, EMCS51_WATCH_ACCESS};
+    uint32_t kind = emcs51_gdb_parse_hex(&p);
+    uint32_t addr, len, offset;
+    uint8_t space;
+    int index;
+
+    if ((kind > 4) || (*p++ != ','))
+    {
+        emcs51_gdb_send(gdb, "");
+        return;
+    }
+
+    addr = emcs51_gdb_parse_hex(&p);
+    len = (*p == ',') ? (p++, emcs51_gdb_parse_hex(&p)) : 1;
+    offset = addr & ~(uint32_t)EMCS51_GDB_ADDR_SPACE_MASK;
+
+    if (kind < 2)
+    {
+        if ((addr & EMCS51_GDB_ADDR_SPACE_MASK) != EMCS51_GDB_ADDR_CODE)
+        {
+            emcs51_gdb_send(gdb, "E01");
+            return;
+        }
+
+        if (insert)
+            index = emcs51_break_add(&gdb->brk, (uint16_t)offset, NULL, NULL, 0);
+        else
+            index = emcs51_break_remove(&gdb->brk, emcs51_break_find(&gdb->brk, (uint16_t)offset));
+
+        emcs51_gdb_send(gdb, (index < 0) ? "E01" : "OK");
+        return;
+    }
+
+    switch (addr & EMCS51_GDB_ADDR_SPACE_MASK)
+    {
+    case EMCS51_GDB_ADDR_DATA:
+        space = (offset < 0x80) ? EMCS51_SPACE_IRAM : EMCS51_SPACE_SFR;
+        break;
+    case EMCS51_GDB_ADDR_XDATA:
+        space = EMCS51_SPACE_XDATA;
+        break;
+    default:
+        emcs51_gdb_send(gdb, "E01");
+        return;
+    }
+
+    if (insert)
+    {
+        index = emcs51_watch_add(&gdb->watch, space, (uint16_t)offset, len, watch_type[kind]);
+    }
+    else
+    {
+        index = EMCS51_ERR;
+
+        for (int i = 0; i < EMCS51_WATCH_MAX; i++)
+        {
+            emcs51_watchpoint_t *wp = &gdb->watch.wp[i];
+
+            if (wp->used && ((wp->space == EMCS51_SPACE_XDATA) == (space == EMCS51_SPACE_XDATA)) && (wp->addr == offset) &&
+                (wp->len == len) && (wp->type == watch_type[kind]))
+            {
+                index = emcs51_watch_remove(&gdb->watch, i);
+                break;
+            }
+        }
+    }
+
+    emcs51_gdb_send(gdb, (index < 0) ? "E01" : "OK");
+}
+
+/*******************************************************************************
+ * @brief 交给仿真线程运行，暂停后由RSP线程发送停止应答
+ ******************************************************************************/
+static void emcs51_gdb_resume(emcs51_gdb_t *gdb, uint8_t state, uint8_t wait_stop)
+{
+    pthread_mutex_lock(&gdb->lock);
+    if (gdb->state != EMCS51_GDB_QUIT)
+        gdb->state = state;
+    gdb->wait_stop = wait_stop;
+    pthread_cond_broadcast(&gdb->cond);
+    pthread_mutex_unlock(&gdb->lock);
+}
+
+static void emcs51_gdb_close_client(emcs51_gdb_t *gdb)
+{
+    if (gdb->client_fd >= 0)
+        close(gdb->client_fd);
+
+    gdb->client_fd = -1;
+    gdb->rx_len = 0;
+    gdb->no_ack = 0;
+}
+
+/*******************************************************************************
+ * @brief 断开调试器：删除断点和观察点，目标继续运行
+ * @details 目标正在运行时由仿真线程在暂停后删除并继续运行，
+ *          调试器意外断开后不会停在旧断点上
+ ******************************************************************************/
+static void emcs51_gdb_detach(emcs51_gdb_t *gdb)
+{
+    uint8_t state;
+
+    emcs51_gdb_close_client(gdb);
+
+    pthread_mutex_lock(&gdb->lock);
+    state = gdb->state;
+    if ((state == EMCS51_GDB_RUNNING) || (state == EMCS51_GDB_STEP))
+    {
+        gdb->detach = 1;
+        gdb->wait_stop = 0;
+        atomic_store(&gdb->interrupt, 1);
+    }
+    pthread_mutex_unlock(&gdb->lock);
+
+    if (state != EMCS51_GDB_HALTED)
+        return;
+
+    emcs51_break_clear(&gdb->brk);
+    emcs51_watch_clear(&gdb->watch);
+
+    emcs51_gdb_resume(gdb, EMCS51_GDB_RUNNING, 0);
+}
+
+static void emcs51_gdb_handle_query(emcs51_gdb_t *gdb, const char *pkt)
+{
+    char reply[96];
+
+    if (strncmp(pkt, "qSupported", 10) == 0)
+    {
+        snprintf(reply, sizeof(reply), "PacketSize=%x;QStartNoAckMode+;swbreak+", EMCS51_GDB_PACKET_SIZE);
+        emcs51_gdb_send(gdb, reply);
+    }
+    else if (strcmp(pkt, "qAttached") == 0)
+    {
+        emcs51_gdb_send(gdb, "1");
+    }
+    else if (strcmp(pkt, "qC") == 0)
+    {
+        emcs51_gdb_send(gdb, "QC1");
+    }
+    else if (strcmp(pkt, "qfThreadInfo") == 0)
+    {
+        emcs51_gdb_send(gdb, "m1");
+    }
+    else if (strcmp(pkt, "qsThreadInfo") == 0)
+    {
+        emcs51_gdb_send(gdb, "l");
+    }
+    else if (strcmp(pkt, "QStartNoAckMode") == 0)
+    {
+        emcs51_gdb_send(gdb, "OK");
+        gdb->no_ack = 1;
+    }
+    else
+    {
+        emcs51_gdb_send(gdb, "");
+    }
+}
+
+/*******************************************************************************
+ * @brief 处理一个报文，只在目标暂停时调用
+ ******************************************************************************/
+static void emcs51_gdb_handle(emcs51_gdb_t *gdb, const char *pkt)
+{
+    emcs51_core_t *core = gdb->core;
+    char *reply = gdb->reply;
+    char *out = reply;
+    const char *p = pkt + 1;
+    uint32_t addr, len, n;
+    uint8_t data;
+    int ret;
+
+    switch (pkt[0])
+    {
+    case '?':
+        emcs51_gdb_send_stop(gdb);
+        break;
+
+    case 'g':
+        for (n = 0; n < EMCS51_GDB_REG_COUNT; n++)
+            out = emcs51_gdb_put_reg(core, out, n);
+        *out = '\0';
+        emcs51_gdb_send(gdb, reply);
+        break;
+
+    case 'G':
+        for (n = 0; n < EMCS51_GDB_REG_COUNT; n++)
+        {
+            ret = emcs51_gdb_set_reg(core, n, p);
+            if (ret < 0)
+                break;
+            p += ret;
+        }
+        emcs51_gdb_send(gdb, (n == EMCS51_GDB_REG_COUNT) ? "OK" : "E01");
+        break;
+
+    case 'p':
+        n = emcs51_gdb_parse_hex(&p);
+        if (n >= EMCS51_GDB_REG_COUNT)
+        {
+            emcs51_gdb_send(gdb, "E01");
+            break;
+        }
+        out = emcs51_gdb_put_reg(core, out, n);
+        *out = '\0';
+        emcs51_gdb_send(gdb, reply);
+        break;
+
+    case 'P':
+        n = emcs51_gdb_parse_hex(&p);
+        if ((n >= EMCS51_GDB_REG_COUNT) || (*p++ != '=') || (emcs51_gdb_set_reg(core, n, p) < 0))
+            emcs51_gdb_send(gdb, "E01");
+        else
+            emcs51_gdb_send(gdb, "OK");
+        break;
+
+    case 'm':
+        addr = emcs51_gdb_parse_hex(&p);
+        len = (*p == ',') ? (p++, emcs51_gdb_parse_hex(&p)) : 0;
+        if (len > (EMCS51_GDB_PACKET_SIZE - 8) / 2)
+            len = (EMCS51_GDB_PACKET_SIZE - 8) / 2;
+        for (n = 0; n < len; n++)
+        {
+            if (emcs51_gdb_read_mem(core, addr + n, &data) < 0)
+                break;
+            out = emcs51_gdb_put_byte(out, data);
+        }
+        *out = '\0';
+        emcs51_gdb_send(gdb, ((n == 0) && (len > 0)) ? "E01" : reply);
+        break;
+
+    case 'M':
+        addr = emcs51_gdb_parse_hex(&p);
+        len = (*p == ',') ? (p++, emcs51_gdb_parse_hex(&p)) : 0;
+        ret = (*p++ == ':') ? EMCS51_OK : EMCS51_ERR;
+        for (n = 0; (n < len) && (ret >= 0); n++, p += 2)
+        {
+            ret = emcs51_gdb_parse_byte(p, &data);
+            if (ret >= 0)
+                ret = emcs51_gdb_write_mem(core, addr + n, data);
+        }
+        emcs51_gdb_send(gdb, (ret < 0) ? "E01" : "OK");
+        break;
+
+    case 'c':
+    case 's':
+        if (*p != '\0')
+            core->reg.pc = (uint16_t)emcs51_gdb_parse_hex(&p);
+        emcs51_gdb_resume(gdb, (pkt[0] == 's') ? EMCS51_GDB_STEP : EMCS51_GDB_RUNNING, 1);
+        break;
+
+    case 'Z':
+    case 'z':
+        emcs51_gdb_handle_point(gdb, p, pkt[0] == 'Z');
+        break;
+
+    case 'D':
+        emcs51_gdb_send(gdb, "OK");
+        emcs51_gdb_detach(gdb);
+        break;
+
+    case 'k':
+        emcs51_gdb_close_client(gdb);
+        emcs51_gdb_resume(gdb, EMCS51_GDB_QUIT, 0);
+        // 仿真线程可能正在运行
+        atomic_store(&gdb->interrupt, 1);
+        break;
+
+    case 'H':
+    case 'T':
+        emcs51_gdb_send(gdb, "OK");
+        break;
+
+    case 'q':
+    case 'Q':
+        emcs51_gdb_handle_query(gdb, pkt);
+        break;
+
+    default:
+        emcs51_gdb_send(gdb, "");
+        break;
+    }
+}
+
+/*******************************************************************************
+ * @brief 处理接收缓冲中的字节：中断请求随时生效，报文等目标暂停后再处理
+ ******************************************************************************/
+static void emcs51_gdb_process(emcs51_gdb_t *gdb)
+{
+    uint32_t pos = 0;
+    uint8_t state;
+    uint8_t cs, expect;
+    char *start, *end;
+
+    while (pos < gdb->rx_len)
+    {
+        start = &gdb->rx[pos];
+
+        if (*start == 0x03)
+        {
+            pthread_mutex_lock(&gdb->lock);
+            if (gdb->state == EMCS51_GDB_RUNNING)
+                atomic_store(&gdb->interrupt, 1);
+            pthread_mutex_unlock(&gdb->lock);
+            pos++;
+            continue;
+        }
+
+        // '+'、'-' 及报文之间的杂散字符
+        if (*start != '$')
+        {
+            pos++;
+            continue;
+        }
+
+        end = memchr(start, '#', gdb->rx_len - pos);
+        if ((end == NULL) || ((uint32_t)(end - gdb->rx) + 3 > gdb->rx_len))
+            break;
+
+        pthread_mutex_lock(&gdb->lock);
+        state = gdb->state;
+        pthread_mutex_unlock(&gdb->lock);
+
+        if (state != EMCS51_GDB_HALTED)
+            break;
+
+        cs = 0;
+        for (char *c = start + 1; c < end; c++)
+            cs += (uint8_t)*c;
+
+        pos = (uint32_t)(end - gdb->rx) + 3;
+
+        if ((emcs51_gdb_parse_byte(end + 1, &expect) < 0) || (expect != cs))
+        {
+            if (!gdb->no_ack)
+                emcs51_gdb_send_raw(gdb, "-", 1);
+            continue;
+        }
+
+        if (!gdb->no_ack)
+            emcs51_gdb_send_raw(gdb, "+", 1);
+
+        *end = '\0';
+        emcs51_gdb_handle(gdb, start + 1);
+
+        // 'D'/'k' 已关闭连接并清空接收缓冲
+        if (gdb->client_fd < 0)
+            return;
+    }
+
+    if ((pos == 0) && (gdb->rx_len == sizeof(gdb->rx)))
+        pos = gdb->rx_len; // 报文超长，丢弃
+
+    memmove(gdb->rx, gdb->rx + pos, gdb->rx_len - pos);
+    gdb->rx_len -= pos;
+}
+
+/*******************************************************************************
+ * @brief 接受连接，目标正在运行时请求暂停
+ ******************************************************************************/
+static void emcs51_gdb_accept(emcs51_gdb_t *gdb)
+{
+    int fd = accept(gdb->listen_fd, NULL, NULL);
+    int one = 1;
+
+    if (fd < 0)
+        return;
+
+    if (gdb->config.unix_path == NULL)
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    gdb->client_fd = fd;
+    gdb->rx_len = 0;
+    gdb->no_ack = 0;
+
+    pthread_mutex_lock(&gdb->lock);
+    if (gdb->state == EMCS51_GDB_RUNNING)
+        atomic_store(&gdb->interrupt, 1);
+    if (gdb->detach)
+        gdb->detach = 2; // 删除旧断点后为新的调试器暂停
+    pthread_mutex_unlock(&gdb->lock);
+}
+
+/*******************************************************************************
+ * @brief RSP线程：等待连接、报文和仿真线程的暂停通知
+ ******************************************************************************/
+static void *emcs51_gdb_thread(void *arg)
+{
+    emcs51_gdb_t *gdb = (emcs51_gdb_t *)arg;
+    struct pollfd fds[2];
+    char drain[16];
+    ssize_t n;
+
+    for (;;)
+    {
+        pthread_mutex_lock(&gdb->lock);
+        if (gdb->state == EMCS51_GDB_QUIT)
+        {
+            pthread_mutex_unlock(&gdb->lock);
+            break;
+        }
+        pthread_mutex_unlock(&gdb->lock);
+
+        fds[0].fd = (gdb->client_fd >= 0) ? gdb->client_fd : gdb->listen_fd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = gdb->notify_fd[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            while (read(gdb->notify_fd[0], drain, sizeof(drain)) == (ssize_t)sizeof(drain))
+                ;
+
+            pthread_mutex_lock(&gdb->lock);
+            uint8_t send_stop = (gdb->state == EMCS51_GDB_HALTED) && gdb->wait_stop;
+            if (send_stop)
+                gdb->wait_stop = 0;
+            pthread_mutex_unlock(&gdb->lock);
+
+            if (send_stop)
+                emcs51_gdb_send_stop(gdb);
+        }
+
+        if (fds[0].revents == 0)
+        {
+            // 暂停后处理运行期间收到的报文
+            if (gdb->client_fd >= 0)
+                emcs51_gdb_process(gdb);
+            continue;
+        }
+
+        if (gdb->client_fd < 0)
+        {
+            emcs51_gdb_accept(gdb);
+            continue;
+        }
+
+        n = recv(gdb->client_fd, gdb->rx + gdb->rx_len, sizeof(gdb->rx) - gdb->rx_len, 0);
+        if (n <= 0)
+        {
+            if ((n < 0) && (errno == EINTR))
+                continue;
+
+            emcs51_gdb_detach(gdb);
+            continue;
+        }
+
+        gdb->rx_len += (uint32_t)n;
+        emcs51_gdb_process(gdb);
+    }
+
+    return NULL;
+}
+
+static int emcs51_gdb_listen(emcs51_gdb_t *gdb)
+{
+    int one = 1;
+    int fd;
+
+    if (gdb->config.unix_path != NULL)
+    {
+        struct sockaddr_un sa;
+
+        if (strlen(gdb->config.unix_path) >= sizeof(sa.sun_path))
+            return EMCS51_ERR;
+
+        memset(&sa, 0, sizeof(sa));
+        sa.sun_family = AF_UNIX;
+        strcpy(sa.sun_path, gdb->config.unix_path);
+        unlink(gdb->config.unix_path);
+
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return EMCS51_ERR;
+
+        if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0)
+        {
+            close(fd);
+            return EMCS51_ERR;
+        }
+    }
+    else
+    {
+        struct sockaddr_in sa;
+
+        memset(&sa, 0, sizeof(sa));
+        sa.sin_family = AF_INET;
+        sa.sin_port = htons(gdb->config.port);
+        sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return EMCS51_ERR;
+
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        if (bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0)
+        {
+            close(fd);
+            return EMCS51_ERR;
+        }
+    }
+
+    if (listen(fd, 1) != 0)
+    {
+        close(fd);
+        return EMCS51_ERR;
+    }
+
+    gdb->listen_fd = fd;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 初始化GDB服务并启动RSP线程，目标处于暂停状态等待连接
+ * @param gdb    GDB服务结构体指针
+ * @param core   核心结构体指针，指令需已注册
+ * @param config 监听地址和突发长度
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_gdb_init(emcs51_gdb_t *gdb, emcs51_core_t *core, const emcs51_gdb_config_t *config)
+{
+    int err;
+
+    memset(gdb, 0, sizeof(emcs51_gdb_t));
+
+    gdb->core = core;
+    gdb->config = *config;
+    gdb->listen_fd = -1;
+    gdb->client_fd = -1;
+    gdb->state = EMCS51_GDB_HALTED;
+    gdb->stop_signal = EMCS51_GDB_SIGTRAP;
+    atomic_init(&gdb->interrupt, 0);
+
+    if (gdb->config.burst_cycles == 0)
+        gdb->config.burst_cycles = EMCS51_GDB_BURST_CYCLES_DEFAULT;
+
+    if (pipe2(gdb->notify_fd, O_CLOEXEC | O_NONBLOCK) != 0)
+        return EMCS51_ERR;
+
+    err = emcs51_gdb_listen(gdb);
+    if (err < 0)
+    {
+        close(gdb->notify_fd[0]);
+        close(gdb->notify_fd[1]);
+        return err;
+    }
+
+    emcs51_break_init(&gdb->brk, core);
+    emcs51_watch_init(&gdb->watch, core);
+
+    pthread_mutex_init(&gdb->lock, NULL);
+    pthread_cond_init(&gdb->cond, NULL);
+
+    if (pthread_create(&gdb->thread, NULL, emcs51_gdb_thread, gdb) != 0)
+    {
+        emcs51_gdb_deinit(gdb);
+        return EMCS51_ERR;
+    }
+
+    gdb->thread_started = 1;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 在调用线程上运行仿真，直到调试器发送 k 或调用 emcs51_gdb_deinit()
+ * @param gdb GDB服务结构体指针
+ * @return emcs51_err_t，断点和观察点停止不视为错误
+ * @details 运行时每 burst_cycles 个机器周期检查一次中断请求，除此之外与 emcs51_core_run() 相同
+ ******************************************************************************/
+int emcs51_gdb_run(emcs51_gdb_t *gdb)
+{
+    emcs51_core_t *core = gdb->core;
+    uint8_t state;
+
+    pthread_mutex_lock(&gdb->lock);
+
+    for (;;)
+    {
+        while (gdb->state == EMCS51_GDB_HALTED)
+            pthread_cond_wait(&gdb->cond, &gdb->lock);
+
+        state = gdb->state;
+        if (state == EMCS51_GDB_QUIT)
+            break;
+
+        pthread_mutex_unlock(&gdb->lock);
+
+        emcs51_watch_resume(&gdb->watch);
+        emcs51_break_resume(&gdb->brk);
+
+        if (state == EMCS51_GDB_STEP)
+        {
+            emcs51_core_inc(core);
+        }
+        else
+        {
+            while ((core->err >= 0) && (atomic_load_explicit(&gdb->interrupt, memory_order_relaxed) == 0))
+                emcs51_core_run(core, gdb->config.burst_cycles);
+        }
+
+        pthread_mutex_lock(&gdb->lock);
+
+        atomic_store(&gdb->interrupt, 0);
+
+        if (gdb->detach)
+        {
+            uint8_t detach = gdb->detach;
+
+            gdb->detach = 0;
+            pthread_mutex_unlock(&gdb->lock);
+
+            emcs51_break_clear(&gdb->brk);
+            emcs51_watch_clear(&gdb->watch);
+
+            pthread_mutex_lock(&gdb->lock);
+
+            // 之前或删除期间有新的调试器连接时照常暂停；致命错误也照常暂停，等待下一个调试器查询
+            if ((detach == 1) && (gdb->state != EMCS51_GDB_QUIT) && (atomic_load(&gdb->interrupt) == 0) &&
+                ((core->err >= 0) || (core->err == EMCS51_ERR_BREAKPOINT) || (core->err == EMCS51_ERR_WATCHPOINT)))
+            {
+                gdb->state = EMCS51_GDB_RUNNING;
+                continue;
+            }
+        }
+
+        if (core->err == EMCS51_ERR_UNKNOWN_INST)
+            gdb->stop_signal = EMCS51_GDB_SIGILL;
+        else if ((core->err < 0) && (core->err != EMCS51_ERR_BREAKPOINT) && (core->err != EMCS51_ERR_WATCHPOINT))
+            gdb->stop_signal = EMCS51_GDB_SIGSEGV;
+        else if ((core->err < 0) || (state == EMCS51_GDB_STEP))
+            gdb->stop_signal = EMCS51_GDB_SIGTRAP;
+        else
+            gdb->stop_signal = EMCS51_GDB_SIGINT;
+
+        if (gdb->state != EMCS51_GDB_QUIT)
+            gdb->state = EMCS51_GDB_HALTED;
+
+        emcs51_gdb_notify(gdb);
+    }
+
+    pthread_mutex_unlock(&gdb->lock);
+
+    if ((core->err == EMCS51_ERR_BREAKPOINT) || (core->err == EMCS51_ERR_WATCHPOINT))
+        return EMCS51_OK;
+
+    return core->err;
+}
+
+/*******************************************************************************
+ * @brief 停止RSP线程，关闭套接字，删除断点和观察点
+ * @param gdb GDB服务结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_gdb_deinit(emcs51_gdb_t *gdb)
+{
+    pthread_mutex_lock(&gdb->lock);
+    gdb->state = EMCS51_GDB_QUIT;
+    atomic_store(&gdb->interrupt, 1);
+    pthread_cond_broadcast(&gdb->cond);
+    emcs51_gdb_notify(gdb);
+    pthread_mutex_unlock(&gdb->lock);
+
+    if (gdb->thread_started)
+        pthread_join(gdb->thread, NULL);
+
+    gdb->thread_started = 0;
+
+    emcs51_gdb_close_client(gdb);
+
+    if (gdb->listen_fd >= 0)
+    {
+        close(gdb->listen_fd);
+        if (gdb->config.unix_path != NULL)
+            unlink(gdb->config.unix_path);
+    }
+
+    gdb->listen_fd = -1;
+
+    close(gdb->notify_fd[0]);
+    close(gdb->notify_fd[1]);
+
+    emcs51_break_deinit(&gdb->brk);
+    emcs51_watch_deinit(&gdb->watch);
+
+    pthread_mutex_destroy(&gdb->lock);
+    pthread_cond_destroy(&gdb->cond);
+}
@@ -0,0 +1,82 @@
+#ifndef EMCS51_GDB_H
+#define EMCS51_GDB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "emcs51.h"
+
+#define EMCS51_GDB_PACKET_SIZE 0x1000
+#define EMCS51_GDB_BURST_CYCLES_DEFAULT 10000
+
+// GDB地址空间：高8位选择存储区
+#define EMCS51_GDB_ADDR_CODE 0x000000  // code区 0x0000~0xFFFF，当前分组
+#define EMCS51_GDB_ADDR_DATA 0x800000  // DATA区直接寻址 0x00~0xFF，0x80 以上为SFR
+#define EMCS51_GDB_ADDR_XDATA 0x810000 // XDATA区 0x0000~0xFFFF
+#define EMCS51_GDB_ADDR_SPACE_MASK 0xFF0000
+
+// 寄存器编号：0~7 为当前组 R0~R7，之后为 A、B、PSW、SP、DPL、DPH，最后是16位小端的 PC
+typedef enum EMCS51_GDB_REGS
+{
+    EMCS51_GDB_REG_R0 = 0,
+    EMCS51_GDB_REG_A = 8,
+    EMCS51_GDB_REG_B,
+    EMCS51_GDB_REG_PSW,
+    EMCS51_GDB_REG_SP,
+    EMCS51_GDB_REG_DPL,
+    EMCS51_GDB_REG_DPH,
+    EMCS51_GDB_REG_PC,
+    EMCS51_GDB_REG_COUNT,
+} emcs51_gdb_regs_t;
+
+typedef enum EMCS51_GDB_STATES
+{
+    EMCS51_GDB_HALTED = 0, // 仿真线程等待，RSP线程可访问核心
+    EMCS51_GDB_RUNNING,    // 按突发连续运行，直到断点、观察点、出错或中断请求
+    EMCS51_GDB_STEP,       // 执行一条指令后暂停
+    EMCS51_GDB_QUIT,       // emcs51_gdb_run() 返回
+} emcs51_gdb_states_t;
+
+typedef struct EMCS51_GDB_CONFIG
+{
+    uint16_t port;         // TCP端口，只监听 127.0.0.1
+    const char *unix_path; // 非NULL时改为监听Unix域套接字
+    uint64_t burst_cycles; // 运行时每次连续执行的机器周期数，0 表示默认值
+} emcs51_gdb_config_t;
+
+// GDB远程串行协议服务：RSP线程收发报文，仿真线程在 emcs51_gdb_run() 中执行，
+// 两者只在突发边界交接核心，已连接但空闲的调试器不占用仿真线程
+typedef struct EMCS51_GDB
+{
+    emcs51_core_t *core;
+    emcs51_gdb_config_t config;
+    emcs51_break_t brk;
+    emcs51_watch_t watch;
+
+    int listen_fd;
+    int client_fd;
+    int notify_fd[2]; // 仿真线程暂停后写入，唤醒RSP线程
+    pthread_t thread;
+    uint8_t thread_started;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t state;        // emcs51_gdb_states_t，受 lock 保护
+    uint8_t stop_signal;  // 最近一次暂停的信号
+    uint8_t wait_stop;    // 已执行 c/s，暂停后需发送停止应答
+    uint8_t detach;       // 运行中断开，仿真线程暂停后删除断点和观察点；1 继续运行，2 已有新连接，暂停
+    atomic_uint interrupt; // 请求暂停，仿真线程只在突发边界检查
+
+    uint8_t no_ack;
+    uint32_t rx_len;
+    char rx[EMCS51_GDB_PACKET_SIZE * 2];
+    char reply[EMCS51_GDB_PACKET_SIZE];
+    char tx[EMCS51_GDB_PACKET_SIZE + 4];
+} emcs51_gdb_t;
+
+int emcs51_gdb_init(emcs51_gdb_t *gdb, emcs51_core_t *core, const emcs51_gdb_config_t *config);
+int emcs51_gdb_run(emcs51_gdb_t *gdb);
+void emcs51_gdb_deinit(emcs51_gdb_t *gdb);
+
+#endif // EMCS51_GDB_H
@@ -0,0 +1,381 @@
+#define _GNU_SOURCE // st_mtim, MAP_ANONYMOUS
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "host/emcs51_image.h"
+
+// HEX旁路缓存末尾的标记，记录生成缓存时HEX文件的修改时间和大小
+typedef struct EMCS51_IMAGE_CACHE_TAG
+{
+    uint32_t magic;
+    uint32_t hex_mtime_nsec;
+    int64_t hex_mtime_sec;
+    uint64_t hex_size;
+} emcs51_image_cache_tag_t;
+
+#define EMCS51_IMAGE_CACHE_MAGIC 0x43313545 // "E51C"
+
+/*******************************************************************************
+ * @brief 只读映射整个文件
+ * @param img     镜像结构体指针
+ * @param fd      文件描述符
+ * @param len     文件长度
+ * @param max_len 允许的最大文件长度
+ * @return emcs51_err_t
+ ******************************************************************************/
+static int emcs51_image_map_fd(emcs51_image_t *img, int fd, size_t len, size_t max_len)
+{
+    void *map;
+
+    if ((len == 0) || (len > max_len))
+        return EMCS51_ERR_CODE_OUT_OF_RANGE;
+
+    map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        return EMCS51_ERR;
+
+    madvise(map, len, MADV_WILLNEED);
+
+    img->map = map;
+    img->map_len = len;
+    img->data = (const uint8_t *)map;
+    img->len = (uint32_t)len;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 映射文件路径
+ ******************************************************************************/
+static int emcs51_image_map_path(emcs51_image_t *img, const char *path, size_t max_len)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    int ret;
+
+    if (fd < 0)
+        return EMCS51_ERR_STREAM;
+
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return EMCS51_ERR_STREAM;
+    }
+
+    // 映射建立后即可关闭描述符
+    ret = emcs51_image_map_fd(img, fd, (size_t)st.st_size, max_len);
+    close(fd);
+
+    return ret;
+}
+
+/*******************************************************************************
+ * @brief 解析HEX文件到缓冲区
+ * @param path   HEX文件路径
+ * @param buffer EMCS51_IMAGE_MAX_SIZE 大小的缓冲区
+ * @param len    输出镜像长度（最高写入地址+1）
+ * @return emcs51_err_t
+ ******************************************************************************/
+static int emcs51_image_parse_hex(const char *path, uint8_t *buffer, uint32_t *len)
+{
+    char chunk[4096];
+    emcs51_ihex_t ih;
+    ssize_t n;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+        return EMCS51_ERR_STREAM;
+
+    memset(buffer, 0xFF, EMCS51_IMAGE_MAX_SIZE);
+    emcs51_ihex_init_buffer(&ih, buffer, EMCS51_IMAGE_MAX_SIZE);
+
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        if (emcs51_ihex_feed(&ih, chunk, (uint32_t)n) != EMCS51_OK)
+            break;
+    }
+
+    close(fd);
+
+    if (n < 0)
+        return EMCS51_ERR_STREAM;
+
+    if (emcs51_ihex_finish(&ih) != EMCS51_OK)
+    {
+        printf("[EMCS51][image] %s:%u: %s\r\n", path, (unsigned)ih.line, emcs51_err_name(ih.err));
+        return ih.err;
+    }
+
+    if (ih.addr_max == 0)
+        return EMCS51_ERR_CODE_OUT_OF_RANGE;
+
+    *len = ih.addr_max;
+
+    return EMCS51_OK;
+}
+
+static int emcs51_image_write_all(int fd, const void *data, uint32_t len)
+{
+    uint32_t pos = 0;
+
+    while (pos < len)
+    {
+        ssize_t n = write(fd, (const uint8_t *)data + pos, len - pos);
+
+        if (n <= 0)
+            return EMCS51_ERR_STREAM;
+
+        pos += (uint32_t)n;
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 生成HEX文件当前状态的缓存标记
+ ******************************************************************************/
+static void emcs51_image_cache_tag(emcs51_image_cache_tag_t *tag, const struct stat *hex_st)
+{
+    memset(tag, 0, sizeof(emcs51_image_cache_tag_t));
+
+    tag->magic = EMCS51_IMAGE_CACHE_MAGIC;
+    tag->hex_mtime_sec = (int64_t)hex_st->st_mtim.tv_sec;
+    tag->hex_mtime_nsec = (uint32_t)hex_st->st_mtim.tv_nsec;
+    tag->hex_size = (uint64_t)hex_st->st_size;
+}
+
+/*******************************************************************************
+ * @brief 写入旁路缓存：镜像之后是缓存标记
+ * @details 先写临时文件再 rename，多个进程同时生成缓存时不会读到半个文件
+ ******************************************************************************/
+static int emcs51_image_write_cache(const char *cache_path, const uint8_t *data, uint32_t len, const emcs51_image_cache_tag_t *tag)
+{
+    char tmp_path[4096];
+    int fd;
+
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", cache_path, (long)getpid()) >= (int)sizeof(tmp_path))
+        return EMCS51_ERR;
+
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return EMCS51_ERR_STREAM;
+
+    if ((emcs51_image_write_all(fd, data, len) != EMCS51_OK) ||
+        (emcs51_image_write_all(fd, tag, sizeof(emcs51_image_cache_tag_t)) != EMCS51_OK))
+    {
+        close(fd);
+        unlink(tmp_path);
+        return EMCS51_ERR_STREAM;
+    }
+
+    if ((close(fd) != 0) || (rename(tmp_path, cache_path) != 0))
+    {
+        unlink(tmp_path);
+        return EMCS51_ERR_STREAM;
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 映射旁路缓存，末尾标记与HEX文件不一致时失败
+ * @details 修改时间精确到纳秒并比较文件大小，同一秒内重新生成的HEX文件不会读到旧缓存
+ ******************************************************************************/
+static int emcs51_image_map_cache(emcs51_image_t *img, const char *cache_path, const emcs51_image_cache_tag_t *expect)
+{
+    emcs51_image_cache_tag_t tag;
+
+    if (emcs51_image_map_path(img, cache_path, EMCS51_IMAGE_MAX_SIZE + sizeof(emcs51_image_cache_tag_t)) != EMCS51_OK)
+        return EMCS51_ERR;
+
+    if (img->len > sizeof(emcs51_image_cache_tag_t))
+    {
+        memcpy(&tag, img->data + img->len - sizeof(emcs51_image_cache_tag_t), sizeof(emcs51_image_cache_tag_t));
+
+        if (memcmp(&tag, expect, sizeof(emcs51_image_cache_tag_t)) == 0)
+        {
+            img->len -= sizeof(emcs51_image_cache_tag_t);
+            return EMCS51_OK;
+        }
+    }
+
+    emcs51_image_unmap(img);
+
+    return EMCS51_ERR;
+}
+
+/*******************************************************************************
+ * @brief 映射HEX镜像
+ * @details 旁路缓存为 <path>.bin，末尾标记与HEX文件的修改时间和大小一致时直接映射；
+ *          否则解析HEX、写入缓存后再映射；缓存目录不可写时退化为匿名只读映射
+ ******************************************************************************/
+static int emcs51_image_map_hex(emcs51_image_t *img, const char *path)
+{
+    char cache_path[4096];
+    emcs51_image_cache_tag_t tag;
+    struct stat hex_st;
+    uint8_t *buffer;
+    uint32_t len = 0;
+    int ret;
+
+    if (stat(path, &hex_st) != 0)
+        return EMCS51_ERR_STREAM;
+
+    if (snprintf(cache_path, sizeof(cache_path), "%s.bin", path) >= (int)sizeof(cache_path))
+        return EMCS51_ERR;
+
+    emcs51_image_cache_tag(&tag, &hex_st);
+
+    if (emcs51_image_map_cache(img, cache_path, &tag) == EMCS51_OK)
+    {
+        img->source = EMCS51_IMAGE_SOURCE_HEX_CACHE;
+        return EMCS51_OK;
+    }
+
+    buffer = malloc(EMCS51_IMAGE_MAX_SIZE);
+    if (buffer == NULL)
+        return EMCS51_ERR;
+
+    ret = emcs51_image_parse_hex(path, buffer, &len);
+    if (ret != EMCS51_OK)
+    {
+        free(buffer);
+        return ret;
+    }
+
+    if ((emcs51_image_write_cache(cache_path, buffer, len, &tag) == EMCS51_OK) &&
+        (emcs51_image_map_cache(img, cache_path, &tag) == EMCS51_OK))
+    {
+        free(buffer);
+        img->source = EMCS51_IMAGE_SOURCE_HEX_PARSE;
+        return EMCS51_OK;
+    }
+
+    img->map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (img->map == MAP_FAILED)
+    {
+        img->map = NULL;
+        free(buffer);
+        return EMCS51_ERR;
+    }
+
+    memcpy(img->map, buffer, len);
+    mprotect(img->map, len, PROT_READ);
+    free(buffer);
+
+    img->map_len = len;
+    img->data = (const uint8_t *)img->map;
+    img->len = len;
+    img->source = EMCS51_IMAGE_SOURCE_HEX_ANON;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 只读映射固件镜像
+ * @param img  镜像结构体指针
+ * @param path 固件路径，.hex 或 .ihx（SDCC）结尾按Intel HEX处理，其余按原始二进制处理
+ * @return emcs51_err_t
+ * @details 映射为只读共享页，所有实例共用同一份物理内存，
+ *          实例数增加时常驻内存不随之增长
+ ******************************************************************************/
+int emcs51_image_map(emcs51_image_t *img, const char *path)
+{
+    size_t path_len;
+    int ret;
+
+    if ((img == NULL) || (path == NULL))
+        return EMCS51_ERR;
+
+    memset(img, 0, sizeof(emcs51_image_t));
+
+    path_len = strlen(path);
+    if ((path_len > 4) && ((strcasecmp(&path[path_len - 4], ".hex") == 0) || (strcasecmp(&path[path_len - 4], ".ihx") == 0)))
+        return emcs51_image_map_hex(img, path);
+
+    ret = emcs51_image_map_path(img, path, EMCS51_IMAGE_MAX_SIZE);
+    if (ret == EMCS51_OK)
+        img->source = EMCS51_IMAGE_SOURCE_BIN;
+
+    return ret;
+}
+
+/*******************************************************************************
+ * @brief 解除映射
+ * @param img 镜像结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_image_unmap(emcs51_image_t *img)
+{
+    if (img == NULL)
+        return;
+
+    if (img->map != NULL)
+        munmap(img->map, img->map_len);
+
+    memset(img, 0, sizeof(emcs51_image_t));
+}
+
+/*******************************************************************************
+ * @brief 将镜像设置为核心配置的只读code区
+ * @param img    镜像结构体指针
+ * @param config 核心配置
+ * @return none
+ ******************************************************************************/
+void emcs51_image_config(const emcs51_image_t *img, emcs51_core_config_t *config)
+{
+    if ((img == NULL) || (config == NULL))
+        return;
+
+    config->code_type = EMCS51_CODE_BUFFER;
+    config->code_buffer = img->data;
+    config->code_len = img->len;
+}
+
+/*******************************************************************************
+ * @brief 加载符号文件：.cdb 为SDCC调试信息，其他按OMF-51目标文件解析
+ * @param tab  符号表，应已调用 emcs51_symtab_init()
+ * @param path 文件路径
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_image_load_symbols(emcs51_symtab_t *tab, const char *path)
+{
+    struct stat st;
+    size_t path_len;
+    void *map;
+    int fd;
+    int ret;
+
+    if ((tab == NULL) || (path == NULL))
+        return EMCS51_ERR;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return EMCS51_ERR_STREAM;
+
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0) || ((uint64_t)st.st_size > UINT32_MAX))
+    {
+        close(fd);
+        return EMCS51_ERR_STREAM;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+        return EMCS51_ERR;
+
+    path_len = strlen(path);
+    if ((path_len > 4) && (strcasecmp(&path[path_len - 4], ".cdb") == 0))
+        ret = emcs51_cdb_load(tab, (const char *)map, (uint32_t)st.st_size);
+    else
+        ret = emcs51_omf51_load(tab, (const uint8_t *)map, (uint32_t)st.st_size, NULL, NULL);
+
+    munmap(map, (size_t)st.st_size);
+
+    return ret;
+}
@@ -0,0 +1,34 @@
+#ifndef EMCS51_IMAGE_H
+#define EMCS51_IMAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "emcs51.h"
+
+#define EMCS51_IMAGE_MAX_SIZE 0x100000 // 16 个 64 KiB 分组
+
+typedef enum EMCS51_IMAGE_SOURCES
+{
+    EMCS51_IMAGE_SOURCE_NONE = 0,
+    EMCS51_IMAGE_SOURCE_BIN,       // 直接映射 .bin
+    EMCS51_IMAGE_SOURCE_HEX_CACHE, // 映射已有的 .hex 旁路缓存
+    EMCS51_IMAGE_SOURCE_HEX_PARSE, // 解析 .hex 并写入旁路缓存后映射
+    EMCS51_IMAGE_SOURCE_HEX_ANON,  // 缓存无法写入，解析到匿名只读映射
+} emcs51_image_sources_t;
+
+typedef struct EMCS51_IMAGE
+{
+    const uint8_t *data; // 只读映射，可作为所有实例的 code_buffer
+    uint32_t len;
+    uint8_t source; // emcs51_image_sources_t
+
+    void *map;
+    size_t map_len;
+} emcs51_image_t;
+
+int emcs51_image_map(emcs51_image_t *img, const char *path);
+void emcs51_image_unmap(emcs51_image_t *img);
+void emcs51_image_config(const emcs51_image_t *img, emcs51_core_config_t *config);
+int emcs51_image_load_symbols(emcs51_symtab_t *tab, const char *path);
+
+#endif // EMCS51_IMAGE_H
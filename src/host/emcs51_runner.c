@@ -0,0 +1,469 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include "host/emcs51_runner.h"
+
+#define EMCS51_RUNNER_CACHE_LINE 64
+#define EMCS51_RUNNER_IDLE_SPINS 16       // 空闲时先让出CPU的次数，之后开始休眠
+#define EMCS51_RUNNER_IDLE_MAX_NS 1000000 // 空闲休眠的上限
+
+typedef struct EMCS51_RUNNER_DEQUE
+{
+    pthread_mutex_t lock;
+    uint32_t *items;
+    uint32_t cap;
+    uint32_t head; // 被窃取端
+    uint32_t len;
+} emcs51_runner_deque_t;
+
+struct EMCS51_RUNNER;
+
+typedef struct EMCS51_RUNNER_WORKER
+{
+    struct EMCS51_RUNNER *runner;
+    uint32_t id;
+    pthread_t thread;
+    emcs51_runner_deque_t deque;
+    uint64_t slices;
+    uint64_t steals;
+} emcs51_runner_worker_t;
+
+typedef struct EMCS51_RUNNER
+{
+    const emcs51_runner_config_t *config;
+    emcs51_runner_result_t *results;
+    emcs51_core_t **cores;
+    uint8_t *started;
+    emcs51_runner_worker_t *workers;
+    uint32_t worker_count;
+    atomic_uint active; // 尚未结束的实例数
+    atomic_uint abort;  // 非0时工作线程立即退出
+    double start;       // 主机开始时间，实时节拍的基准
+} emcs51_runner_t;
+
+/*******************************************************************************
+ * @brief 本线程压入任务（底端）
+ ******************************************************************************/
+static void emcs51_runner_push(emcs51_runner_deque_t *deque, uint32_t index)
+{
+    pthread_mutex_lock(&deque->lock);
+    deque->items[(deque->head + deque->len) % deque->cap] = index;
+    deque->len++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+/*******************************************************************************
+ * @brief 本线程弹出任务（底端，最近运行过的实例缓存更热）
+ ******************************************************************************/
+static int emcs51_runner_pop(emcs51_runner_deque_t *deque, uint32_t *index)
+{
+    int ok = 0;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->len > 0)
+    {
+        deque->len--;
+        *index = deque->items[(deque->head + deque->len) % deque->cap];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return ok;
+}
+
+/*******************************************************************************
+ * @brief 其它线程窃取任务（顶端）
+ ******************************************************************************/
+static int emcs51_runner_steal_from(emcs51_runner_deque_t *deque, uint32_t *index)
+{
+    int ok = 0;
+
+    if (pthread_mutex_trylock(&deque->lock) != 0)
+        return 0;
+
+    if (deque->len > 0)
+    {
+        *index = deque->items[deque->head];
+        deque->head = (deque->head + 1) % deque->cap;
+        deque->len--;
+        ok = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return ok;
+}
+
+static int emcs51_runner_steal(emcs51_runner_t *runner, emcs51_runner_worker_t *self, uint32_t *index)
+{
+    for (uint32_t i = 1; i < runner->worker_count; i++)
+    {
+        emcs51_runner_worker_t *victim = &runner->workers[(self->id + i) % runner->worker_count];
+
+        if (emcs51_runner_steal_from(&victim->deque, index))
+            return 1;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * @brief 实例结束，保存结果并释放资源
+ ******************************************************************************/
+static void emcs51_runner_finish(emcs51_runner_t *runner, uint32_t index, uint8_t stop_reason, int err)
+{
+    const emcs51_runner_config_t *config = runner->config;
+    emcs51_runner_result_t *result = &runner->results[index];
+    emcs51_core_t *core = runner->cores[index];
+
+    result->err = err;
+    result->stop_reason = stop_reason;
+
+    // setup_cb 失败时核心可能未初始化
+    if (stop_reason != EMCS51_RUNNER_STOP_SETUP)
+    {
+        result->pc = core->reg.pc;
+        result->cycles = core->cycles;
+        result->inst_count = core->inst_count;
+
+        if (config->teardown_cb)
+            config->teardown_cb(core, index, config->user);
+    }
+
+    atomic_fetch_sub(&runner->active, 1);
+}
+
+static double emcs51_runner_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/*******************************************************************************
+ * @brief 实时节拍：实例的振荡器时钟领先主机时间时休眠
+ * @details 按 emcs51_core_clocks() 计时，12T/6T/1T 型号在相同 osc_hz 下得到各自的实际速度
+ ******************************************************************************/
+static void emcs51_runner_pace(emcs51_runner_t *runner, emcs51_core_t *core)
+{
+    double due = runner->start + ((double)emcs51_core_clocks(core) / runner->config->osc_hz);
+    double ahead = due - emcs51_runner_now();
+    struct timespec ts;
+
+    if (ahead <= 0)
+        return;
+
+    ts.tv_sec = (time_t)ahead;
+    ts.tv_nsec = (long)((ahead - (double)ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+/*******************************************************************************
+ * @brief 运行实例的一个时间片
+ * @return 1 实例已结束，0 需要继续调度
+ ******************************************************************************/
+static int emcs51_runner_run_slice(emcs51_runner_t *runner, uint32_t index)
+{
+    const emcs51_runner_config_t *config = runner->config;
+    emcs51_core_t *core = runner->cores[index];
+    uint64_t slice = config->slice_cycles;
+    int err;
+
+    // instances are set up by the worker that first runs them, so their memory is local to it
+    if (runner->started[index] == 0)
+    {
+        runner->started[index] = 1;
+
+        err = config->setup_cb(core, index, config->user);
+        if (err < 0)
+        {
+            emcs51_runner_finish(runner, index, EMCS51_RUNNER_STOP_SETUP, err);
+            return 1;
+        }
+    }
+
+    if (config->max_cycles && ((config->max_cycles - core->cycles) < slice))
+        slice = config->max_cycles - core->cycles;
+
+    err = emcs51_core_run(core, slice);
+    runner->results[index].slices++;
+
+    if (err < 0)
+    {
+        emcs51_runner_finish(runner, index, ((err == EMCS51_ERR_BREAKPOINT) || (err == EMCS51_ERR_WATCHPOINT)) ? EMCS51_RUNNER_STOP_BREAKPOINT : EMCS51_RUNNER_STOP_ERR, err);
+        return 1;
+    }
+
+    if (config->osc_hz)
+        emcs51_runner_pace(runner, core);
+
+    if (config->max_cycles && (core->cycles >= config->max_cycles))
+    {
+        emcs51_runner_finish(runner, index, EMCS51_RUNNER_STOP_MAX_CYCLES, EMCS51_OK);
+        return 1;
+    }
+
+    if (config->stop_cb && config->stop_cb(core, index, config->user))
+    {
+        emcs51_runner_finish(runner, index, EMCS51_RUNNER_STOP_USER, EMCS51_OK);
+        return 1;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * @brief 没有可运行的实例时等待：先让出CPU，之后休眠时间逐次加倍
+ * @param idle 连续空闲的次数
+ ******************************************************************************/
+static void emcs51_runner_idle(uint32_t idle)
+{
+    struct timespec ts = {0};
+    uint32_t shift;
+
+    if (idle < EMCS51_RUNNER_IDLE_SPINS)
+    {
+        sched_yield();
+        return;
+    }
+
+    shift = idle - EMCS51_RUNNER_IDLE_SPINS;
+    ts.tv_nsec = (shift < 10) ? ((long)1000 << shift) : EMCS51_RUNNER_IDLE_MAX_NS;
+    if (ts.tv_nsec > EMCS51_RUNNER_IDLE_MAX_NS)
+        ts.tv_nsec = EMCS51_RUNNER_IDLE_MAX_NS;
+
+    nanosleep(&ts, NULL);
+}
+
+static void *emcs51_runner_worker_thread(void *arg)
+{
+    emcs51_runner_worker_t *worker = (emcs51_runner_worker_t *)arg;
+    emcs51_runner_t *runner = worker->runner;
+    uint32_t index;
+    uint32_t idle = 0;
+
+    while (atomic_load(&runner->abort) == 0)
+    {
+        if (emcs51_runner_pop(&worker->deque, &index) == 0)
+        {
+            if (emcs51_runner_steal(runner, worker, &index) == 0)
+            {
+                if (atomic_load(&runner->active) == 0)
+                    break;
+
+                emcs51_runner_idle(idle++);
+                continue;
+            }
+
+            worker->steals++;
+        }
+
+        idle = 0;
+        worker->slices++;
+
+        if (emcs51_runner_run_slice(runner, index) == 0)
+            emcs51_runner_push(&worker->deque, index);
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * @brief 在线程池上并行运行多个相互独立的核心实例
+ * @param config  配置参数
+ * @param results 每个实例的结果，长度为 instance_count
+ * @param summary 汇总结果，可为NULL
+ * @return emcs51_err_t，无法创建工作线程时返回错误，未运行结束的实例的结果为0
+ * @details 每个工作线程有自己的任务队列，实例每运行一个时间片后放回本线程队列底端，
+ *          本线程队列为空时从其它线程队列顶端窃取；停止条件在时间片边界检查
+ ******************************************************************************/
+int emcs51_runner_run(const emcs51_runner_config_t *config, emcs51_runner_result_t *results, emcs51_runner_summary_t *summary)
+{
+    emcs51_runner_t runner;
+    uint32_t n;
+    uint32_t i;
+    uint32_t threads;
+    double start;
+    int err = EMCS51_OK;
+
+    if ((config == NULL) || (results == NULL) || (config->setup_cb == NULL))
+        return EMCS51_ERR;
+
+    if ((config->instance_count == 0) || (config->slice_cycles == 0))
+        return EMCS51_ERR;
+
+    if ((config->max_cycles == 0) && (config->stop_cb == NULL))
+        return EMCS51_ERR;
+
+    n = config->instance_count;
+
+    memset(&runner, 0, sizeof(runner));
+    memset(results, 0, sizeof(emcs51_runner_result_t) * n);
+
+    runner.config = config;
+    runner.results = results;
+    runner.worker_count = config->thread_count;
+
+    if (runner.worker_count == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        runner.worker_count = (cpus > 0) ? (uint32_t)cpus : 1;
+    }
+
+    if (runner.worker_count > n)
+        runner.worker_count = n;
+
+    runner.cores = calloc(n, sizeof(emcs51_core_t *));
+    runner.started = calloc(n, 1);
+    runner.workers = calloc(runner.worker_count, sizeof(emcs51_runner_worker_t));
+
+    if ((runner.cores == NULL) || (runner.started == NULL) || (runner.workers == NULL))
+    {
+        err = EMCS51_ERR;
+        goto cleanup;
+    }
+
+    // every instance in its own cache lines, so workers never share one
+    size_t core_size = (sizeof(emcs51_core_t) + EMCS51_RUNNER_CACHE_LINE - 1) & ~(size_t)(EMCS51_RUNNER_CACHE_LINE - 1);
+
+    for (i = 0; i < n; i++)
+    {
+        runner.cores[i] = aligned_alloc(EMCS51_RUNNER_CACHE_LINE, core_size);
+        if (runner.cores[i] == NULL)
+        {
+            err = EMCS51_ERR;
+            goto cleanup;
+        }
+    }
+
+    for (i = 0; i < runner.worker_count; i++)
+    {
+        emcs51_runner_worker_t *worker = &runner.workers[i];
+
+        worker->runner = &runner;
+        worker->id = i;
+        worker->deque.cap = n;
+        worker->deque.items = calloc(n, sizeof(uint32_t));
+        pthread_mutex_init(&worker->deque.lock, NULL);
+
+        if (worker->deque.items == NULL)
+        {
+            err = EMCS51_ERR;
+            goto cleanup;
+        }
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        emcs51_runner_push(&runner.workers[i % runner.worker_count].deque, i);
+    }
+
+    atomic_init(&runner.active, n);
+    atomic_init(&runner.abort, 0);
+
+    start = emcs51_runner_now();
+    runner.start = start;
+
+    for (threads = 0; threads < runner.worker_count; threads++)
+    {
+        if (pthread_create(&runner.workers[threads].thread, NULL, emcs51_runner_worker_thread, &runner.workers[threads]) != 0)
+        {
+            atomic_store(&runner.abort, 1);
+            err = EMCS51_ERR;
+            break;
+        }
+    }
+
+    for (i = 0; i < threads; i++)
+    {
+        pthread_join(runner.workers[i].thread, NULL);
+    }
+
+    if (err < 0)
+    {
+        // 已初始化但未运行结束的实例
+        for (i = 0; i < n; i++)
+        {
+            if (runner.started[i] && (results[i].stop_reason == EMCS51_RUNNER_STOP_NONE) && config->teardown_cb)
+                config->teardown_cb(runner.cores[i], i, config->user);
+        }
+
+        goto cleanup;
+    }
+
+    if (summary)
+    {
+        memset(summary, 0, sizeof(emcs51_runner_summary_t));
+
+        summary->seconds = emcs51_runner_now() - start;
+        summary->instance_count = n;
+        summary->thread_count = runner.worker_count;
+
+        for (i = 0; i < n; i++)
+        {
+            summary->total_cycles += results[i].cycles;
+            summary->total_inst += results[i].inst_count;
+
+            if ((results[i].err < 0) && (results[i].stop_reason != EMCS51_RUNNER_STOP_BREAKPOINT))
+                summary->errors++;
+        }
+
+        for (i = 0; i < runner.worker_count; i++)
+        {
+            summary->slices += runner.workers[i].slices;
+            summary->steals += runner.workers[i].steals;
+        }
+    }
+
+cleanup:
+    if (runner.workers)
+    {
+        for (i = 0; i < runner.worker_count; i++)
+        {
+            if (runner.workers[i].deque.items)
+            {
+                pthread_mutex_destroy(&runner.workers[i].deque.lock);
+                free(runner.workers[i].deque.items);
+            }
+        }
+    }
+
+    if (runner.cores)
+    {
+        for (i = 0; i < n; i++)
+            free(runner.cores[i]);
+    }
+
+    free(runner.workers);
+    free(runner.started);
+    free(runner.cores);
+
+    return err;
+}
+
+/*******************************************************************************
+ * @brief 打印汇总结果
+ * @param summary 汇总结果
+ * @return none
+ ******************************************************************************/
+void emcs51_runner_dump_summary(const emcs51_runner_summary_t *summary)
+{
+    double mips = 0;
+
+    if (summary == NULL)
+        return;
+
+    if (summary->seconds > 0)
+        mips = (double)summary->total_inst / summary->seconds / 1e6;
+
+    printf("[EMCS51][runner] instances:%u threads:%u errors:%u\r\n",
+           (unsigned)summary->instance_count, (unsigned)summary->thread_count, (unsigned)summary->errors);
+    printf("[EMCS51][runner] cycles:%llu inst:%llu slices:%llu steals:%llu\r\n",
+           (unsigned long long)summary->total_cycles, (unsigned long long)summary->total_inst,
+           (unsigned long long)summary->slices, (unsigned long long)summary->steals);
+    printf("[EMCS51][runner] host:%.3fs emulated:%.2f MIPS\r\n", summary->seconds, mips);
+}
@@ -0,0 +1,64 @@
+#ifndef EMCS51_RUNNER_H
+#define EMCS51_RUNNER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "emcs51.h"
+
+typedef enum EMCS51_RUNNER_STOP_REASONS
+{
+    EMCS51_RUNNER_STOP_NONE = 0,
+    EMCS51_RUNNER_STOP_ERR,        // 核心出错
+    EMCS51_RUNNER_STOP_MAX_CYCLES, // 达到周期上限
+    EMCS51_RUNNER_STOP_USER,       // stop_cb 要求停止
+    EMCS51_RUNNER_STOP_SETUP,      // setup_cb 失败，未运行
+    EMCS51_RUNNER_STOP_BREAKPOINT, // 到达断点或观察点命中
+} emcs51_runner_stop_reasons_t;
+
+// 初始化第 index 个实例，实例状态应保存在 core->user 中，不可使用全局变量
+typedef int (*emcs51_runner_setup_cb_t)(emcs51_core_t *core, uint32_t index, void *user);
+// 每个时间片结束后调用，返回非0停止该实例
+typedef int (*emcs51_runner_stop_cb_t)(emcs51_core_t *core, uint32_t index, void *user);
+// 实例结束后调用，用于释放 setup_cb 分配的资源
+typedef void (*emcs51_runner_teardown_cb_t)(emcs51_core_t *core, uint32_t index, void *user);
+
+typedef struct EMCS51_RUNNER_CONFIG
+{
+    uint32_t instance_count; // 实例数
+    uint32_t thread_count;   // 工作线程数，0 表示CPU核心数
+    uint64_t slice_cycles;   // 时间片，单位：机器周期
+    uint64_t max_cycles;     // 每个实例的周期上限，0 表示不限（需提供 stop_cb）
+    uint32_t osc_hz;         // 振荡器频率，非0时每个时间片后按实时节拍休眠
+
+    emcs51_runner_setup_cb_t setup_cb;
+    emcs51_runner_stop_cb_t stop_cb;
+    emcs51_runner_teardown_cb_t teardown_cb;
+    void *user;
+} emcs51_runner_config_t;
+
+typedef struct EMCS51_RUNNER_RESULT
+{
+    int err;
+    uint8_t stop_reason; // emcs51_runner_stop_reasons_t
+    uint16_t pc;
+    uint64_t cycles;
+    uint64_t inst_count;
+    uint32_t slices;
+} emcs51_runner_result_t;
+
+typedef struct EMCS51_RUNNER_SUMMARY
+{
+    uint32_t instance_count;
+    uint32_t thread_count;
+    uint32_t errors;
+    uint64_t total_cycles;
+    uint64_t total_inst;
+    uint64_t slices;
+    uint64_t steals;
+    double seconds; // 主机耗时
+} emcs51_runner_summary_t;
+
+int emcs51_runner_run(const emcs51_runner_config_t *config, emcs51_runner_result_t *results, emcs51_runner_summary_t *summary);
+void emcs51_runner_dump_summary(const emcs51_runner_summary_t *summary);
+
+#endif // EMCS51_RUNNER_H
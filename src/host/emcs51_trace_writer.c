@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <time.h>
+#include "host/emcs51_trace_writer.h"
+
+#if EMCS51_TRACE_ENABLE
+
+/*******************************************************************************
+ * @brief 写入所有已完成的块
+ * @return 写入的块数
+ ******************************************************************************/
+static uint32_t emcs51_trace_writer_drain(emcs51_trace_writer_t *writer)
+{
+    const uint8_t *block;
+    uint32_t count = 0;
+    uint32_t len;
+
+    while ((block = emcs51_trace_consume(writer->trace, &len)) != NULL)
+    {
+        if ((writer->err == EMCS51_OK) && (fwrite(block, 1, len, writer->fp) != len))
+            writer->err = EMCS51_ERR_STREAM;
+
+        emcs51_trace_release(writer->trace);
+
+        writer->blocks++;
+        writer->bytes += len;
+        count++;
+    }
+
+    return count;
+}
+
+static void *emcs51_trace_writer_thread(void *arg)
+{
+    emcs51_trace_writer_t *writer = (emcs51_trace_writer_t *)arg;
+    struct timespec idle = {
+        .tv_sec = 0,
+        .tv_nsec = EMCS51_TRACE_WRITER_IDLE_US * 1000,
+    };
+
+    while (atomic_load(&writer->stop) == 0)
+    {
+        if (emcs51_trace_writer_drain(writer) == 0)
+            nanosleep(&idle, NULL);
+    }
+
+    emcs51_trace_writer_drain(writer);
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * @brief 创建跟踪文件并启动写入线程
+ * @param writer 写入线程结构体指针
+ * @param trace  STREAM 模式的跟踪
+ * @param path   输出文件路径
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_trace_writer_start(emcs51_trace_writer_t *writer, emcs51_trace_t *trace, const char *path)
+{
+    uint8_t header[EMCS51_TRACE_FILE_HEADER_SIZE];
+
+    if (trace->mode != EMCS51_TRACE_MODE_STREAM)
+        return EMCS51_ERR;
+
+    memset(writer, 0, sizeof(emcs51_trace_writer_t));
+    writer->trace = trace;
+    atomic_init(&writer->stop, 0);
+
+    writer->fp = fopen(path, "wb");
+    if (writer->fp == NULL)
+        return EMCS51_ERR_STREAM;
+
+    emcs51_trace_file_header(header);
+    if (fwrite(header, 1, sizeof(header), writer->fp) != sizeof(header))
+    {
+        fclose(writer->fp);
+        return EMCS51_ERR_STREAM;
+    }
+
+    writer->bytes = sizeof(header);
+
+    if (pthread_create(&writer->thread, NULL, emcs51_trace_writer_thread, writer) != 0)
+    {
+        fclose(writer->fp);
+        return EMCS51_ERR;
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 写完剩余的块后停止写入线程并关闭文件
+ * @param writer 写入线程结构体指针
+ * @return emcs51_err_t
+ * @details 应先在执行核心的线程上调用 emcs51_trace_flush() 或 emcs51_trace_deinit()
+ ******************************************************************************/
+int emcs51_trace_writer_stop(emcs51_trace_writer_t *writer)
+{
+    atomic_store(&writer->stop, 1);
+    pthread_join(writer->thread, NULL);
+
+    if ((fclose(writer->fp) != 0) && (writer->err == EMCS51_OK))
+        writer->err = EMCS51_ERR_STREAM;
+
+    return writer->err;
+}
+
+#endif // EMCS51_TRACE_ENABLE
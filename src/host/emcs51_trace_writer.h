@@ -0,0 +1,33 @@
+#ifndef EMCS51_TRACE_WRITER_H
+#define EMCS51_TRACE_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "emcs51.h"
+
+#if EMCS51_TRACE_ENABLE
+
+#define EMCS51_TRACE_WRITER_IDLE_US 1000 // 没有已完成的块时的休眠时间
+
+// 写入线程：把 STREAM 模式跟踪的已完成块依次写入文件
+typedef struct EMCS51_TRACE_WRITER
+{
+    emcs51_trace_t *trace;
+    FILE *fp;
+    pthread_t thread;
+    atomic_uint stop;
+
+    uint64_t blocks;
+    uint64_t bytes;
+    int err;
+} emcs51_trace_writer_t;
+
+int emcs51_trace_writer_start(emcs51_trace_writer_t *writer, emcs51_trace_t *trace, const char *path);
+int emcs51_trace_writer_stop(emcs51_trace_writer_t *writer);
+
+#endif // EMCS51_TRACE_ENABLE
+
+#endif // EMCS51_TRACE_WRITER_H
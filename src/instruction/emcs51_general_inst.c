@@ -39,6 +39,35 @@ static emcs51_inst_def_t ljmp_inst_def = {
     .exec_cb = emcs51_ljmp_inst_exec_cb,
 };
 
+/*******************************************************************************
+ * @brief 回调函数：0x05 INC direct 指令执行
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_inc_direct_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint8_t iram_addr = core->operands[0];
+    uint8_t data = 0;
+
+    err = emcs51_core_read_data(core, iram_addr, &data);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    emcs51_core_write_data(core, iram_addr, (uint8_t)(data + 1));
+}
+
+static emcs51_inst_def_t inc_direct_inst_def = {
+    .mnemonic = "INC direct",
+    .length = 1,
+    .cycles = 1,
+    .exec_cb = emcs51_inc_direct_inst_exec_cb,
+};
+
 /*******************************************************************************
  * @brief 回调函数：0x75 MOV direct, #immediate 指令执行
  * @param event 指令执行事件结构体指针
@@ -50,12 +79,7 @@ static void emcs51_mov_direct_immed_inst_exec_cb(emcs51_inst_exec_event_t *event
     uint8_t iram_addr = core->operands[0];
     uint8_t data = core->operands[1];
 
-    emcs51_write_data_cb_t write_data_cb = core->write_data_cb[iram_addr];
-
-    if (write_data_cb)
-        write_data_cb(iram_addr, data);
-
-    core->data_ram[iram_addr] = data;
+    emcs51_core_write_data(core, iram_addr, data);
 }
 
 static emcs51_inst_def_t mov_direct_immed_inst_def = {
@@ -82,12 +106,7 @@ static void emcs51_mov_rn_immed_inst_exec_cb(emcs51_inst_exec_event_t *event)
 
     // printf("[EMCS51] MOV R%u, #0x%02X\r\n", reg_num, data);
 
-    emcs51_write_data_cb_t write_data_cb = event->core->write_data_cb[iram_addr];
-
-    if (write_data_cb)
-        write_data_cb(iram_addr, data);
-
-    core->data_ram[iram_addr] = data;
+    emcs51_core_write_data(core, iram_addr, data);
 }
 
 static emcs51_inst_def_t mov_rn_immed_inst_def = {
@@ -121,6 +140,33 @@ static emcs51_inst_def_t sjmp_inst_def = {
     .exec_cb = emcs51_sjmp_inst_exec_cb,
 };
 
+/*******************************************************************************
+ * @brief 回调函数：0x83 MOVC A, @A+PC 指令执行
+ * @param event 指令执行事件结构体指针
+ * @return none
+ * @details PC取下一条指令的地址
+ ******************************************************************************/
+static void emcs51_movc_a_at_a_pc_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint16_t addr = (uint16_t)(core->reg.pc + 1 + core->reg.a);
+
+    err = emcs51_core_read_code_byte(core, addr, &core->reg.a);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+}
+
+static emcs51_inst_def_t movc_a_at_a_pc_inst_def = {
+    .mnemonic = "MOVC A, @A+PC",
+    .length = 0,
+    .cycles = 2,
+    .exec_cb = emcs51_movc_a_at_a_pc_inst_exec_cb,
+};
+
 /*******************************************************************************
  * @brief 回调函数：0x90 MOV DPTR #immediate 指令执行
  * @param event 指令执行事件结构体指针
@@ -143,6 +189,39 @@ static emcs51_inst_def_t mov_dptr_immed_inst_def = {
     .exec_cb = emcs51_mov_dptr_immed_inst_exec_cb,
 };
 
+/*******************************************************************************
+ * @brief 回调函数：0x93 MOVC A, @A+DPTR 指令执行
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_movc_a_at_a_dptr_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint16_t dptr_value;
+
+    err = emcs51_core_read_DPTR(core, &dptr_value);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    err = emcs51_core_read_code_byte(core, (uint16_t)(dptr_value + core->reg.a), &core->reg.a);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+}
+
+static emcs51_inst_def_t movc_a_at_a_dptr_inst_def = {
+    .mnemonic = "MOVC A, @A+DPTR",
+    .length = 0,
+    .cycles = 2,
+    .exec_cb = emcs51_movc_a_at_a_dptr_inst_exec_cb,
+};
+
 /*******************************************************************************
  * @brief 回调函数：0xA3 INC DPTR 指令执行
  * @param event 指令执行事件结构体指针
@@ -177,7 +256,7 @@ static void emcs51_inc_dptr_inst_exec_cb(emcs51_inst_exec_event_t *event)
 static emcs51_inst_def_t inc_dptr_inst_def = {
     .mnemonic = "INC DPTR",
     .length = 0,
-    .cycles = 1,
+    .cycles = 2,
     .exec_cb = emcs51_inc_dptr_inst_exec_cb,
 };
 
@@ -194,12 +273,7 @@ static void emcs51_clr_bit_inst_exec_cb(emcs51_inst_exec_event_t *event)
 
     // printf("[EMCS51] CLR bit 0x%02X\r\n", iram_addr);
 
-    emcs51_write_data_cb_t write_data_cb = event->core->write_data_cb[iram_addr];
-
-    if (write_data_cb)
-        write_data_cb(iram_addr, 0x00);
-
-    core->data_ram[iram_addr] = 0x00;
+    emcs51_core_write_data(core, iram_addr, 0x00);
 }
 
 static emcs51_inst_def_t clr_bit_inst_def = {
@@ -222,12 +296,7 @@ static void emcs51_set_bit_inst_exec_cb(emcs51_inst_exec_event_t *event)
 
     // printf("[EMCS51] SET bit 0x%02X\r\n", iram_addr);
 
-    emcs51_write_data_cb_t write_data_cb = event->core->write_data_cb[iram_addr];
-
-    if (write_data_cb)
-        write_data_cb(iram_addr, 0x01);
-
-    core->data_ram[iram_addr] = 0x01;
+    emcs51_core_write_data(core, iram_addr, 0x01);
 }
 
 static emcs51_inst_def_t set_bit_inst_def = {
@@ -282,10 +351,91 @@ static void emcs51_djnz_rn_offset_inst_exec_cb(emcs51_inst_exec_event_t *event)
 static emcs51_inst_def_t djnz_rn_offset_inst_def = {
     .mnemonic = "DJNZ Rn, offset",
     .length = 1,
-    .cycles = 1,
+    .cycles = 2,
     .exec_cb = emcs51_djnz_rn_offset_inst_exec_cb,
 };
 
+/*******************************************************************************
+ * @brief 回调函数：0xE0 MOVX A, @DPTR 指令执行
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_movx_a_at_dptr_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint16_t dptr_value;
+
+    err = emcs51_core_read_DPTR(core, &dptr_value);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    err = emcs51_core_read_xdata(core, dptr_value, &core->reg.a);
+    if (err < 0)
+        core->err = err;
+}
+
+static emcs51_inst_def_t movx_a_at_dptr_inst_def = {
+    .mnemonic = "MOVX A, @DPTR",
+    .length = 0,
+    .cycles = 2,
+    .exec_cb = emcs51_movx_a_at_dptr_inst_exec_cb,
+};
+
+/*******************************************************************************
+ * @brief 取 MOVX @Ri 的PDATA地址：高8位来自页寄存器（默认P2），低8位为Ri
+ * @param core    核心结构体指针
+ * @param reg_num 寄存器编号 0~1
+ * @param addr    PDATA地址
+ * @return emcs51_err_t
+ ******************************************************************************/
+static int emcs51_pdata_addr(emcs51_core_t *core, uint8_t reg_num, uint16_t *addr)
+{
+    int err;
+    uint8_t Rn_data = 0;
+
+    err = emcs51_core_read_GPR(core, reg_num, &Rn_data);
+    if (err < 0)
+        return err;
+
+    *addr = (uint16_t)((core->data_ram[core->pdata_page_sfr] << 8) | Rn_data);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 回调函数：0xE2~0xE3 MOVX A, @Ri 指令执行
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_movx_a_at_ri_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint16_t addr;
+
+    err = emcs51_pdata_addr(core, event->opcode & 0x01, &addr);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+
+    err = emcs51_core_read_xdata(core, addr, &core->reg.a);
+    if (err < 0)
+        core->err = err;
+}
+
+static emcs51_inst_def_t movx_a_at_ri_inst_def = {
+    .mnemonic = "MOVX A, @Ri",
+    .length = 0,
+    .cycles = 2,
+    .exec_cb = emcs51_movx_a_at_ri_inst_exec_cb,
+};
+
 /*******************************************************************************
  * @brief 回调函数：0xE4 CLR A 指令执行
  * @param event 指令执行事件结构体指针
@@ -307,6 +457,32 @@ static emcs51_inst_def_t clr_a_inst_def = {
     .exec_cb = emcs51_clr_a_inst_exec_cb,
 };
 
+/*******************************************************************************
+ * @brief 回调函数：0xE5 MOV A, direct 指令执行
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_mov_a_direct_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint8_t iram_addr = core->operands[0];
+
+    err = emcs51_core_read_data(core, iram_addr, &core->reg.a);
+    if (err < 0)
+    {
+        core->err = err;
+        return;
+    }
+}
+
+static emcs51_inst_def_t mov_a_direct_inst_def = {
+    .mnemonic = "MOV A, direct",
+    .length = 1,
+    .cycles = 1,
+    .exec_cb = emcs51_mov_a_direct_inst_exec_cb,
+};
+
 /*******************************************************************************
  * @brief 回调函数：0xF0 MOVX @DPTR, A 指令执行
  * @param event 指令执行事件结构体指针
@@ -327,20 +503,47 @@ static void emcs51_movx_at_dptr_a_inst_exec_cb(emcs51_inst_exec_event_t *event)
 
     // printf("[EMCS51] MOVX @DPTR(0x%04X), A(0x%02X)\r\n", dptr_value, core->reg.a);
 
-    if (dptr_value >= core->xdata_ram_size)
+    // unmapped addresses follow core->xdata_unmapped_mode, dropped by default
+    err = emcs51_core_write_xdata(core, dptr_value, core->reg.a);
+    if (err < 0)
+        core->err = err;
+}
+
+static emcs51_inst_def_t movx_at_dptr_a_inst_def = {
+    .mnemonic = "MOVX @DPTR, A",
+    .length = 0,
+    .cycles = 2,
+    .exec_cb = emcs51_movx_at_dptr_a_inst_exec_cb,
+};
+
+/*******************************************************************************
+ * @brief 回调函数：0xF2~0xF3 MOVX @Ri, A 指令执行
+ * @param event 指令执行事件结构体指针
+ * @return none
+ ******************************************************************************/
+static void emcs51_movx_at_ri_a_inst_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    int err;
+    emcs51_core_t *core = event->core;
+    uint16_t addr;
+
+    err = emcs51_pdata_addr(core, event->opcode & 0x01, &addr);
+    if (err < 0)
     {
-        // core->err = EMCS51_ERR_XDATA_OUT_OF_RANGE;
+        core->err = err;
         return;
     }
 
-    core->xdata_ram[dptr_value] = core->reg.a;
+    err = emcs51_core_write_xdata(core, addr, core->reg.a);
+    if (err < 0)
+        core->err = err;
 }
 
-static emcs51_inst_def_t movx_at_dptr_a_inst_def = {
-    .mnemonic = "MOVX @DPTR, A",
+static emcs51_inst_def_t movx_at_ri_a_inst_def = {
+    .mnemonic = "MOVX @Ri, A",
     .length = 0,
-    .cycles = 1,
-    .exec_cb = emcs51_movx_at_dptr_a_inst_exec_cb,
+    .cycles = 2,
+    .exec_cb = emcs51_movx_at_ri_a_inst_exec_cb,
 };
 
 /*******************************************************************************
@@ -363,12 +566,7 @@ static void emcs51_mov_ari_a_inst_exec_cb(emcs51_inst_exec_event_t *event)
         return;
     }
 
-    emcs51_write_data_cb_t write_data_cb = event->core->write_data_cb[Rn_data];
-
-    if (write_data_cb)
-        write_data_cb(Rn_data, core->reg.a);
-
-    core->data_ram[Rn_data] = core->reg.a;
+    emcs51_core_write_data(core, Rn_data, core->reg.a);
 }
 
 static emcs51_inst_def_t mov_ari_a_inst_def = {
@@ -378,6 +576,36 @@ static emcs51_inst_def_t mov_ari_a_inst_def = {
     .exec_cb = emcs51_mov_ari_a_inst_exec_cb,
 };
 
+typedef struct EMCS51_GENERAL_INST_ENTRY
+{
+    uint8_t opcode; // 起始操作码
+    uint8_t count;  // 连续的操作码数（Rn/@Ri 类指令）
+    emcs51_inst_def_t *inst_def;
+} emcs51_general_inst_entry_t;
+
+static const emcs51_general_inst_entry_t general_inst_table[] = {
+    {0x00, 1, &nop_inst_def},
+    {0x02, 1, &ljmp_inst_def},
+    {0x05, 1, &inc_direct_inst_def},
+    {0x75, 1, &mov_direct_immed_inst_def},
+    {0x78, 8, &mov_rn_immed_inst_def},
+    {0x80, 1, &sjmp_inst_def},
+    {0x83, 1, &movc_a_at_a_pc_inst_def},
+    {0x90, 1, &mov_dptr_immed_inst_def},
+    {0x93, 1, &movc_a_at_a_dptr_inst_def},
+    {0xA3, 1, &inc_dptr_inst_def},
+    {0xC2, 1, &clr_bit_inst_def},
+    {0xD2, 1, &set_bit_inst_def},
+    {0xD8, 8, &djnz_rn_offset_inst_def},
+    {0xE0, 1, &movx_a_at_dptr_inst_def},
+    {0xE2, 2, &movx_a_at_ri_inst_def},
+    {0xE4, 1, &clr_a_inst_def},
+    {0xE5, 1, &mov_a_direct_inst_def},
+    {0xF0, 1, &movx_at_dptr_a_inst_def},
+    {0xF2, 2, &movx_at_ri_a_inst_def},
+    {0xF6, 2, &mov_ari_a_inst_def},
+};
+
 /*******************************************************************************
  * @brief 注册通用指令
  * @param core 核心结构体指针
@@ -385,29 +613,32 @@ static emcs51_inst_def_t mov_ari_a_inst_def = {
  ******************************************************************************/
 void emcs51_general_inst_init(emcs51_core_t *core)
 {
-    emcs51_core_inst_add(core, 0x00, &nop_inst_def);
-
-    emcs51_core_inst_add(core, 0x02, &ljmp_inst_def);
-
-    emcs51_core_inst_add(core, 0x75, &mov_direct_immed_inst_def);
-
-    emcs51_core_inst_add_range(core, 0x78, 8, &mov_rn_immed_inst_def);
-
-    emcs51_core_inst_add(core, 0x80, &sjmp_inst_def);
-
-    emcs51_core_inst_add(core, 0x90, &mov_dptr_immed_inst_def);
-
-    emcs51_core_inst_add(core, 0xA3, &inc_dptr_inst_def);
-
-    emcs51_core_inst_add(core, 0xC2, &clr_bit_inst_def);
+    for (uint32_t i = 0; i < (sizeof(general_inst_table) / sizeof(general_inst_table[0])); i++)
+    {
+        const emcs51_general_inst_entry_t *entry = &general_inst_table[i];
 
-    emcs51_core_inst_add(core, 0xD2, &set_bit_inst_def);
+        emcs51_core_inst_add_range(core, entry->opcode, entry->count, entry->inst_def);
+    }
+}
 
-    emcs51_core_inst_add_range(core, 0xD8, 8, &djnz_rn_offset_inst_def);
+/*******************************************************************************
+ * @brief 操作码是否仍由通用指令实现执行
+ * @param core   核心结构体指针
+ * @param opcode 操作码
+ * @return 1 是，0 未注册或已被衍生型号、断点等替换
+ ******************************************************************************/
+uint8_t emcs51_general_inst_is_general(const emcs51_core_t *core, uint8_t opcode)
+{
+    for (uint32_t i = 0; i < (sizeof(general_inst_table) / sizeof(general_inst_table[0])); i++)
+    {
+        const emcs51_general_inst_entry_t *entry = &general_inst_table[i];
 
-    emcs51_core_inst_add(core, 0xE4, &clr_a_inst_def);
+        if ((opcode < entry->opcode) || (opcode >= (entry->opcode + entry->count)))
+            continue;
 
-    emcs51_core_inst_add(core, 0xF0, &movx_at_dptr_a_inst_def);
+        return (core->inst_def[opcode].exec_cb == entry->inst_def->exec_cb) &&
+               (core->inst_def[opcode].length == entry->inst_def->length);
+    }
 
-    emcs51_core_inst_add_range(core, 0xF6, 2, &mov_ari_a_inst_def);
+    return 0;
 }
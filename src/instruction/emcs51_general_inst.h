@@ -7,5 +7,6 @@
 // #include "core/emcs51_core.h"
 
 void emcs51_general_inst_init(emcs51_core_t* core);
+uint8_t emcs51_general_inst_is_general(const emcs51_core_t *core, uint8_t opcode);
 
 #endif // EMCS51_GENERAL_INST_H
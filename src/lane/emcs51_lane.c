@@ -0,0 +1,801 @@
+#include "emcs51.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// DPTR在 data_ram 中的位置，须与 emcs51_core_read_DPTR() 一致
+#define EMCS51_LANE_DPTR_HI 0x83 // DPH
+#define EMCS51_LANE_DPTR_LO 0x82 // DPL
+
+/*******************************************************************************
+ * @brief 最低置位的位号，bits 不为0
+ ******************************************************************************/
+static inline uint32_t emcs51_lane_ctz(uint32_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctz(bits);
+#else
+    uint32_t n = 0;
+
+    while ((bits & 1) == 0)
+    {
+        bits >>= 1;
+        n++;
+    }
+
+    return n;
+#endif
+}
+
+/*******************************************************************************
+ * @brief 按掩码把常量写入一行：dst[i] = mask[i] ? value : dst[i]
+ ******************************************************************************/
+static void emcs51_lane_fill(uint8_t *dst, uint8_t value, const uint8_t *mask, uint32_t width)
+{
+    uint32_t i = 0;
+
+#if defined(__AVX2__)
+    __m256i v = _mm256_set1_epi8((char)value);
+
+    for (; (i + 32) <= width; i += 32)
+    {
+        __m256i m = _mm256_loadu_si256((const __m256i *)&mask[i]);
+        __m256i d = _mm256_loadu_si256((const __m256i *)&dst[i]);
+        _mm256_storeu_si256((__m256i *)&dst[i], _mm256_blendv_epi8(d, v, m));
+    }
+#elif defined(__SSE2__)
+    __m128i v = _mm_set1_epi8((char)value);
+
+    for (; (i + 16) <= width; i += 16)
+    {
+        __m128i m = _mm_loadu_si128((const __m128i *)&mask[i]);
+        __m128i d = _mm_loadu_si128((const __m128i *)&dst[i]);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_or_si128(_mm_and_si128(m, v), _mm_andnot_si128(m, d)));
+    }
+#elif defined(__ARM_NEON)
+    uint8x16_t v = vdupq_n_u8(value);
+
+    for (; (i + 16) <= width; i += 16)
+    {
+        vst1q_u8(&dst[i], vbslq_u8(vld1q_u8(&mask[i]), v, vld1q_u8(&dst[i])));
+    }
+#endif
+
+    for (; i < width; i++)
+    {
+        dst[i] = (uint8_t)((value & mask[i]) | (dst[i] & (uint8_t)~mask[i]));
+    }
+}
+
+/*******************************************************************************
+ * @brief 按掩码拷贝一行：dst[i] = mask[i] ? src[i] : dst[i]
+ ******************************************************************************/
+static void emcs51_lane_copy(uint8_t *dst, const uint8_t *src, const uint8_t *mask, uint32_t width)
+{
+    uint32_t i = 0;
+
+#if defined(__AVX2__)
+    for (; (i + 32) <= width; i += 32)
+    {
+        __m256i m = _mm256_loadu_si256((const __m256i *)&mask[i]);
+        __m256i s = _mm256_loadu_si256((const __m256i *)&src[i]);
+        __m256i d = _mm256_loadu_si256((const __m256i *)&dst[i]);
+        _mm256_storeu_si256((__m256i *)&dst[i], _mm256_blendv_epi8(d, s, m));
+    }
+#elif defined(__SSE2__)
+    for (; (i + 16) <= width; i += 16)
+    {
+        __m128i m = _mm_loadu_si128((const __m128i *)&mask[i]);
+        __m128i s = _mm_loadu_si128((const __m128i *)&src[i]);
+        __m128i d = _mm_loadu_si128((const __m128i *)&dst[i]);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_or_si128(_mm_and_si128(m, s), _mm_andnot_si128(m, d)));
+    }
+#elif defined(__ARM_NEON)
+    for (; (i + 16) <= width; i += 16)
+    {
+        vst1q_u8(&dst[i], vbslq_u8(vld1q_u8(&mask[i]), vld1q_u8(&src[i]), vld1q_u8(&dst[i])));
+    }
+#endif
+
+    for (; i < width; i++)
+    {
+        dst[i] = (uint8_t)((src[i] & mask[i]) | (dst[i] & (uint8_t)~mask[i]));
+    }
+}
+
+/*******************************************************************************
+ * @brief 按掩码设置PC
+ ******************************************************************************/
+static void emcs51_lane_set_pc(emcs51_lane_core_t *lc, uint16_t pc)
+{
+    for (uint32_t i = 0; i < lc->lane_width; i++)
+    {
+        uint16_t m = (uint16_t)(int16_t)(int8_t)lc->mask[i];
+        lc->pc[i] = (uint16_t)((pc & m) | (lc->pc[i] & (uint16_t)~m));
+    }
+}
+
+/*******************************************************************************
+ * @brief 本次执行的lane是否使用同一个寄存器组
+ * @return 寄存器组编号，不一致时返回 -1
+ ******************************************************************************/
+static int emcs51_lane_uniform_bank(emcs51_lane_core_t *lc)
+{
+    int bank = -1;
+
+    for (uint32_t i = 0; i < lc->lane_count; i++)
+    {
+        if (lc->mask[i] == 0)
+            continue;
+
+        int rs = (lc->psw[i] >> 3) & 0x03;
+
+        if (bank < 0)
+            bank = rs;
+        else if (bank != rs)
+            return -1;
+    }
+
+    return bank;
+}
+
+/*******************************************************************************
+ * @brief 把lane除IRAM以外的状态拷贝到标量核心
+ ******************************************************************************/
+static void emcs51_lane_export_regs(emcs51_lane_core_t *lc, uint32_t lane, emcs51_core_t *core)
+{
+    core->reg.a = lc->a[lane];
+    core->reg.b = lc->b[lane];
+    core->reg.sp = lc->sp[lane];
+    core->reg.psw = lc->psw[lane];
+    core->reg.pc = lc->pc[lane];
+
+    core->err = lc->err[lane];
+    core->inst_count = lc->inst_count[lane];
+    core->cycles = lc->cycles[lane];
+    if ((core->xdata_ram != lc->xdata_ram[lane]) || (core->xdata_ram_size != lc->xdata_ram_size[lane]))
+        emcs51_core_set_xdata_ram(core, lc->xdata_ram[lane], lc->xdata_ram_size[lane]);
+    core->user = lc->user[lane];
+}
+
+/*******************************************************************************
+ * @brief 把标量核心除IRAM以外的状态拷贝到lane
+ ******************************************************************************/
+static void emcs51_lane_import_regs(emcs51_lane_core_t *lc, uint32_t lane, const emcs51_core_t *core)
+{
+    lc->a[lane] = core->reg.a;
+    lc->b[lane] = core->reg.b;
+    lc->sp[lane] = core->reg.sp;
+    lc->psw[lane] = core->reg.psw;
+    lc->pc[lane] = core->reg.pc;
+
+    lc->err[lane] = core->err;
+    lc->active[lane] = (core->err < 0) ? 0x00 : 0xFF;
+    lc->inst_count[lane] = core->inst_count;
+    lc->cycles[lane] = core->cycles;
+    lc->xdata_ram[lane] = core->xdata_ram;
+    lc->xdata_ram_size[lane] = core->xdata_ram_size;
+    lc->user[lane] = core->user;
+}
+
+/*******************************************************************************
+ * @brief 把lane的状态拷贝到标量核心
+ * @param lc   lane核心结构体指针
+ * @param lane lane编号
+ * @param core 标量核心结构体指针，只覆盖寄存器、IRAM、XDATA区和计数等运行状态
+ * @return none
+ ******************************************************************************/
+void emcs51_lane_export(emcs51_lane_core_t *lc, uint32_t lane, emcs51_core_t *core)
+{
+    for (uint32_t addr = 0; addr < 256; addr++)
+    {
+        core->data_ram[addr] = lc->data_ram[addr][lane];
+    }
+
+    emcs51_lane_export_regs(lc, lane, core);
+    emcs51_core_update_code_bank(core);
+}
+
+/*******************************************************************************
+ * @brief 把标量核心的状态拷贝到lane
+ * @param lc   lane核心结构体指针
+ * @param lane lane编号
+ * @param core 标量核心结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_lane_import(emcs51_lane_core_t *lc, uint32_t lane, const emcs51_core_t *core)
+{
+    for (uint32_t addr = 0; addr < 256; addr++)
+    {
+        lc->data_ram[addr][lane] = core->data_ram[addr];
+    }
+
+    memcpy(lc->shadow[lane], core->data_ram, sizeof(lc->shadow[lane]));
+    memset(lc->stale[lane], 0, sizeof(lc->stale[lane]));
+
+    emcs51_lane_import_regs(lc, lane, core);
+}
+
+/*******************************************************************************
+ * @brief 初始化lane核心，所有lane的初始状态取自标量核心
+ * @param lc         lane核心结构体指针
+ * @param scalar     已初始化的标量核心，之后作为回退执行的临时核心，其运行状态会被覆盖，
+ *                   xdata_ram 改为间接模式
+ * @param lane_count lane数，不超过 EMCS51_LANE_MAX
+ * @return emcs51_err_t
+ * @details 只有标量核心中仍是通用指令实现的操作码才走向量路径，
+ *          被替换过的指令（衍生型号等）一律回退到标量核心执行；
+ *          标量核心挂接钩子、观察点、断点、跟踪、性能分析或覆盖率时所有指令都回退执行
+ ******************************************************************************/
+int emcs51_lane_init(emcs51_lane_core_t *lc, emcs51_core_t *scalar, uint32_t lane_count)
+{
+    static const uint8_t vector_opcodes[] = {
+        0x00, 0x02, 0x05, 0x75, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F, 0x80, 0x83, 0x90, 0x93, 0xA3, 0xC2, 0xD2,
+        0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF, 0xE0, 0xE2, 0xE3, 0xE4, 0xE5, 0xF0, 0xF2, 0xF3, 0xF6, 0xF7};
+
+    if ((lc == NULL) || (scalar == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    if ((lane_count == 0) || (lane_count > EMCS51_LANE_MAX))
+        return EMCS51_ERR;
+
+    memset(lc, 0, sizeof(emcs51_lane_core_t));
+
+    lc->scalar = scalar;
+    lc->lane_count = lane_count;
+    lc->lane_width = (lane_count + 31) & ~(uint32_t)31;
+
+    for (uint32_t i = 0; i < sizeof(vector_opcodes); i++)
+    {
+        uint8_t opcode = vector_opcodes[i];
+
+        lc->fast[opcode] = emcs51_general_inst_is_general(scalar, opcode);
+    }
+
+    // 回退执行时标量核心在各lane的XDATA区之间切换
+    emcs51_core_set_xdata_ram_indirect(scalar, 1);
+
+    for (uint32_t lane = 0; lane < lane_count; lane++)
+    {
+        emcs51_lane_import(lc, lane, scalar);
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 设置lane的XDATA区
+ ******************************************************************************/
+void emcs51_lane_set_xdata_ram(emcs51_lane_core_t *lc, uint32_t lane, uint8_t *xdata_ram, uint32_t xdata_ram_size)
+{
+    if ((lc == NULL) || (lane >= lc->lane_count))
+        return;
+
+    lc->xdata_ram[lane] = xdata_ram;
+    lc->xdata_ram_size[lane] = xdata_ram_size;
+}
+
+/*******************************************************************************
+ * @brief 设置lane的用户上下文，回退执行时作为 core->user 传给回调
+ ******************************************************************************/
+void emcs51_lane_set_user(emcs51_lane_core_t *lc, uint32_t lane, void *user)
+{
+    if ((lc == NULL) || (lane >= lc->lane_count))
+        return;
+
+    lc->user[lane] = user;
+}
+
+/*******************************************************************************
+ * @brief 记录向量路径写过的IRAM地址
+ ******************************************************************************/
+static inline void emcs51_lane_mark(emcs51_lane_core_t *lc, uint8_t addr)
+{
+    lc->written[addr >> 5] |= (uint32_t)1 << (addr & 31);
+}
+
+/*******************************************************************************
+ * @brief 把向量路径写过的地址标记到每个lane的 shadow 上，回退执行前调用
+ ******************************************************************************/
+static void emcs51_lane_flush_written(emcs51_lane_core_t *lc)
+{
+    for (uint32_t w = 0; w < 8; w++)
+    {
+        if (lc->written[w] == 0)
+            continue;
+
+        for (uint32_t lane = 0; lane < lc->lane_count; lane++)
+        {
+            lc->stale[lane][w] |= lc->written[w];
+        }
+
+        lc->written[w] = 0;
+    }
+}
+
+/*******************************************************************************
+ * @brief 在标量核心上执行单个lane的一条指令
+ * @details IRAM经 shadow 整块拷贝，只从 data_ram 补齐被向量路径改写的地址，
+ *          执行后只写回标量核心改变的地址
+ ******************************************************************************/
+static void emcs51_lane_fallback(emcs51_lane_core_t *lc, uint32_t lane)
+{
+    emcs51_core_t *scalar = lc->scalar;
+    uint8_t *shadow = lc->shadow[lane];
+
+    for (uint32_t w = 0; w < 8; w++)
+    {
+        uint32_t bits = lc->stale[lane][w];
+
+        while (bits != 0)
+        {
+            uint32_t addr = (w << 5) + emcs51_lane_ctz(bits);
+
+            shadow[addr] = lc->data_ram[addr][lane];
+            bits &= bits - 1;
+        }
+
+        lc->stale[lane][w] = 0;
+    }
+
+    memcpy(scalar->data_ram, shadow, sizeof(scalar->data_ram));
+    emcs51_lane_export_regs(lc, lane, scalar);
+    emcs51_core_update_code_bank(scalar);
+
+    emcs51_core_inc(scalar);
+
+    for (uint32_t base = 0; base < 256; base += 32)
+    {
+        if (memcmp(&scalar->data_ram[base], &shadow[base], 32) == 0)
+            continue;
+
+        for (uint32_t addr = base; addr < (base + 32); addr++)
+        {
+            if (scalar->data_ram[addr] != shadow[addr])
+            {
+                shadow[addr] = scalar->data_ram[addr];
+                lc->data_ram[addr][lane] = shadow[addr];
+            }
+        }
+    }
+
+    emcs51_lane_import_regs(lc, lane, scalar);
+
+    lc->stats.fallback_inst++;
+}
+
+/*******************************************************************************
+ * @brief 向量路径执行一条指令
+ * @return 1 已执行，0 需要回退到标量核心
+ ******************************************************************************/
+static int emcs51_lane_exec_vector(emcs51_lane_core_t *lc, uint8_t opcode, const uint8_t *operands, uint16_t pc, uint16_t next_pc)
+{
+    emcs51_core_t *scalar = lc->scalar;
+    uint8_t *mask = lc->mask;
+    uint32_t width = lc->lane_width;
+    int bank;
+
+    switch (opcode)
+    {
+    case 0x00: // NOP
+        break;
+
+    case 0x02: // LJMP addr16
+        emcs51_lane_set_pc(lc, (uint16_t)((operands[0] << 8) | operands[1]));
+        return 1;
+
+    case 0x80: // SJMP offset
+        emcs51_lane_set_pc(lc, (uint16_t)(pc + 2 + (int8_t)operands[0]));
+        return 1;
+
+    case 0x75: // MOV direct, #immediate
+    case 0xC2: // CLR bit
+    case 0xD2: // SET bit
+        if (scalar->write_data_cb[operands[0]] || (scalar->dps_sel_mask && (operands[0] == scalar->dps_sfr)))
+            return 0;
+
+        emcs51_lane_fill(lc->data_ram[operands[0]], (opcode == 0x75) ? operands[1] : ((opcode == 0xD2) ? 0x01 : 0x00), mask, width);
+        emcs51_lane_mark(lc, operands[0]);
+        break;
+
+    case 0x05: // INC direct
+    {
+        uint8_t *row = lc->data_ram[operands[0]];
+
+        if (scalar->read_data_cb[operands[0]] || scalar->write_data_cb[operands[0]] ||
+            (scalar->dps_sel_mask && (operands[0] == scalar->dps_sfr)))
+            return 0;
+
+        for (uint32_t i = 0; i < width; i++)
+        {
+            row[i] = (uint8_t)(row[i] + (mask[i] & 1));
+        }
+
+        emcs51_lane_mark(lc, operands[0]);
+        break;
+    }
+
+    case 0x78: // MOV Rn, #immediate
+    case 0x79:
+    case 0x7A:
+    case 0x7B:
+    case 0x7C:
+    case 0x7D:
+    case 0x7E:
+    case 0x7F:
+        bank = emcs51_lane_uniform_bank(lc);
+        if ((bank < 0) || scalar->write_data_cb[(bank * 8) + (opcode & 0x07)])
+            return 0;
+
+        emcs51_lane_fill(lc->data_ram[(bank * 8) + (opcode & 0x07)], operands[0], mask, width);
+        emcs51_lane_mark(lc, (uint8_t)((bank * 8) + (opcode & 0x07)));
+        break;
+
+    case 0x90: // MOV DPTR, #immediate
+        // lane只模拟单DPTR，双DPTR的型号回退到标量核心
+        if (scalar->dps_sel_mask)
+            return 0;
+
+        emcs51_lane_fill(lc->data_ram[EMCS51_LANE_DPTR_HI], operands[0], mask, width);
+        emcs51_lane_fill(lc->data_ram[EMCS51_LANE_DPTR_LO], operands[1], mask, width);
+        emcs51_lane_mark(lc, EMCS51_LANE_DPTR_HI);
+        emcs51_lane_mark(lc, EMCS51_LANE_DPTR_LO);
+        break;
+
+    case 0xA3: // INC DPTR
+    {
+        if (scalar->dps_sel_mask)
+            return 0;
+
+        uint8_t *hi = lc->data_ram[EMCS51_LANE_DPTR_HI];
+        uint8_t *lo = lc->data_ram[EMCS51_LANE_DPTR_LO];
+
+        for (uint32_t i = 0; i < width; i++)
+        {
+            uint8_t m = mask[i];
+            uint8_t carry = (uint8_t)((lo[i] == 0xFF) ? m : 0x00);
+
+            lo[i] = (uint8_t)(lo[i] + (m & 1));
+            hi[i] = (uint8_t)(hi[i] + (carry & 1));
+        }
+
+        emcs51_lane_mark(lc, EMCS51_LANE_DPTR_HI);
+        emcs51_lane_mark(lc, EMCS51_LANE_DPTR_LO);
+        break;
+    }
+
+    case 0xD8: // DJNZ Rn, offset
+    case 0xD9:
+    case 0xDA:
+    case 0xDB:
+    case 0xDC:
+    case 0xDD:
+    case 0xDE:
+    case 0xDF:
+    {
+        uint16_t target = (uint16_t)(pc + 2 + (int8_t)operands[0]);
+        uint8_t *rn;
+
+        bank = emcs51_lane_uniform_bank(lc);
+        if (bank < 0)
+            return 0;
+
+        rn = lc->data_ram[(bank * 8) + (opcode & 0x07)];
+        emcs51_lane_mark(lc, (uint8_t)((bank * 8) + (opcode & 0x07)));
+
+        for (uint32_t i = 0; i < width; i++)
+        {
+            uint8_t m = mask[i];
+            uint8_t value = (uint8_t)(rn[i] - (m & 1));
+            uint16_t taken = (uint16_t)(((value != 0) && m) ? 0xFFFF : 0x0000);
+            uint16_t m16 = (uint16_t)(int16_t)(int8_t)m;
+
+            rn[i] = value;
+            lc->cycles[i] += taken & scalar->inst_def[opcode].cycles_jump;
+            lc->pc[i] = (uint16_t)((((target & taken) | (next_pc & (uint16_t)~taken)) & m16) | (lc->pc[i] & (uint16_t)~m16));
+        }
+
+        return 1;
+    }
+
+    case 0x83: // MOVC A, @A+PC
+    case 0x93: // MOVC A, @A+DPTR
+    {
+        uint16_t addr[EMCS51_LANE_MAX];
+
+        if ((scalar->code_type != EMCS51_CODE_BUFFER) || ((opcode == 0x93) && scalar->dps_sel_mask))
+            return 0;
+
+        // 越界由标量核心报告错误，分组窗口内的内容取决于各lane的分组，也由标量核心执行
+        for (uint32_t i = 0; i < lc->lane_count; i++)
+        {
+            uint16_t base;
+
+            if (mask[i] == 0)
+                continue;
+
+            base = (opcode == 0x83) ? next_pc : (uint16_t)((lc->data_ram[EMCS51_LANE_DPTR_HI][i] << 8) | lc->data_ram[EMCS51_LANE_DPTR_LO][i]);
+            addr[i] = (uint16_t)(base + lc->a[i]);
+
+            if (((addr[i] >> 15) && scalar->code_bank_sfr) || ((uint32_t)(addr[i] & 0x7FFF) >= scalar->code_page_len[addr[i] >> 15]))
+                return 0;
+        }
+
+        for (uint32_t i = 0; i < lc->lane_count; i++)
+        {
+            if (mask[i])
+                lc->a[i] = scalar->code_page[addr[i] >> 15][addr[i] & 0x7FFF];
+        }
+        break;
+    }
+
+    case 0xE4: // CLR A
+        emcs51_lane_fill(lc->a, 0x00, mask, width);
+        break;
+
+    case 0xE5: // MOV A, direct
+        if (scalar->read_data_cb[operands[0]])
+            return 0;
+
+        emcs51_lane_copy(lc->a, lc->data_ram[operands[0]], mask, width);
+        break;
+
+    case 0xE0: // MOVX A, @DPTR
+    case 0xE2: // MOVX A, @Ri
+    case 0xE3:
+    case 0xF0: // MOVX @DPTR, A
+    case 0xF2: // MOVX @Ri, A
+    case 0xF3:
+    {
+        const uint8_t *hi;
+        const uint8_t *lo;
+
+        // lane只模拟平坦的 xdata_ram，其它映射区域、未映射地址的错误和双DPTR由标量核心执行
+        if ((scalar->xdata_region_count > 1) || (scalar->xdata_unmapped_mode != EMCS51_XDATA_UNMAPPED_IGNORE))
+            return 0;
+
+        if (opcode & 0x02)
+        {
+            bank = emcs51_lane_uniform_bank(lc);
+            if (bank < 0)
+                return 0;
+
+            hi = lc->data_ram[scalar->pdata_page_sfr];
+            lo = lc->data_ram[(bank * 8) + (opcode & 0x01)];
+        }
+        else
+        {
+            if (scalar->dps_sel_mask)
+                return 0;
+
+            hi = lc->data_ram[EMCS51_LANE_DPTR_HI];
+            lo = lc->data_ram[EMCS51_LANE_DPTR_LO];
+        }
+
+        for (uint32_t i = 0; i < lc->lane_count; i++)
+        {
+            uint16_t addr;
+
+            if (mask[i] == 0)
+                continue;
+
+            addr = (uint16_t)((hi[i] << 8) | lo[i]);
+
+            // 未映射地址写入被丢弃，读出 0xFF
+            if (opcode & 0x10)
+            {
+                if (addr < lc->xdata_ram_size[i])
+                    lc->xdata_ram[i][addr] = lc->a[i];
+            }
+            else
+            {
+                lc->a[i] = (addr < lc->xdata_ram_size[i]) ? lc->xdata_ram[i][addr] : 0xFF;
+            }
+        }
+        break;
+    }
+
+    case 0xF6: // MOV @Ri, A
+    case 0xF7:
+        bank = emcs51_lane_uniform_bank(lc);
+        if (bank < 0)
+            return 0;
+
+        for (uint32_t i = 0; i < lc->lane_count; i++)
+        {
+            uint8_t addr;
+
+            if (mask[i] == 0)
+                continue;
+
+            addr = lc->data_ram[(bank * 8) + (opcode & 0x01)][i];
+
+            if (scalar->write_data_cb[addr])
+                return 0;
+        }
+
+        for (uint32_t i = 0; i < lc->lane_count; i++)
+        {
+            uint8_t addr = lc->data_ram[(bank * 8) + (opcode & 0x01)][i];
+
+            if (mask[i])
+            {
+                lc->data_ram[addr][i] = lc->a[i];
+                emcs51_lane_mark(lc, addr);
+            }
+        }
+        break;
+
+    default:
+        return 0;
+    }
+
+    emcs51_lane_set_pc(lc, next_pc);
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 标量核心是否挂接了需要逐条观察指令的功能，与 emcs51_core_inc() 中的检查一致
+ ******************************************************************************/
+static uint8_t emcs51_lane_observed(const emcs51_core_t *scalar)
+{
+    if ((scalar->hook != NULL) || (scalar->watch != NULL) || (scalar->brk != NULL) || (scalar->coverage != NULL))
+        return 1;
+
+#if EMCS51_TRACE_ENABLE
+    if (scalar->trace != NULL)
+        return 1;
+#endif
+
+#if EMCS51_PROFILE_ENABLE
+    if (scalar->profile != NULL)
+        return 1;
+#endif
+
+    return 0;
+}
+
+/*******************************************************************************
+ * @brief 锁步执行一条指令
+ * @param lc lane核心结构体指针
+ * @return 本次执行的lane数，0 表示所有lane都已停止
+ * @details 选择运行中lane的最小PC，所有PC相同的lane一起执行；
+ *          PC不一致时其余lane等待，循环退出后自然重新汇合
+ ******************************************************************************/
+int emcs51_lane_step(emcs51_lane_core_t *lc)
+{
+    emcs51_core_t *scalar = lc->scalar;
+    emcs51_inst_def_t *inst_def;
+    uint32_t min_pc = 0x10000;
+    uint32_t active_count = 0;
+    uint32_t count = 0;
+    int key_bank = -1;
+    uint8_t operands[4];
+    uint8_t opcode;
+    uint8_t vector;
+    int err;
+
+    for (uint32_t i = 0; i < lc->lane_count; i++)
+    {
+        if (lc->active[i] && (lc->pc[i] < min_pc))
+            min_pc = lc->pc[i];
+
+        active_count += lc->active[i] & 1;
+    }
+
+    if (min_pc > 0xFFFF)
+        return 0;
+
+    // 分组窗口内同一PC在不同分组是不同的代码，只与第一个lane同组的一起执行
+    if ((scalar->code_bank_sfr != 0) && (min_pc >= EMCS51_CODE_BANK_WINDOW))
+    {
+        for (uint32_t i = 0; i < lc->lane_count; i++)
+        {
+            if (lc->active[i] && (lc->pc[i] == min_pc))
+            {
+                key_bank = lc->data_ram[scalar->code_bank_sfr][i] & scalar->code_bank_mask;
+                scalar->data_ram[scalar->code_bank_sfr] = lc->data_ram[scalar->code_bank_sfr][i];
+                emcs51_core_update_code_bank(scalar);
+                break;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < lc->lane_width; i++)
+    {
+        uint8_t run = lc->active[i] && (lc->pc[i] == min_pc);
+
+        if (run && (key_bank >= 0))
+            run = ((lc->data_ram[scalar->code_bank_sfr][i] & scalar->code_bank_mask) == key_bank);
+
+        lc->mask[i] = (uint8_t)(run ? 0xFF : 0x00);
+        count += lc->mask[i] & 1;
+    }
+
+    lc->stats.steps++;
+    lc->stats.lane_inst += count;
+
+    if (count < active_count)
+        lc->stats.divergent_steps++;
+
+    // 取指错误和未知操作码也由标量路径报告
+    err = emcs51_core_read_code(scalar, (uint16_t)min_pc, &opcode, 1);
+    inst_def = &scalar->inst_def[opcode];
+    vector = (err >= 0) && lc->fast[opcode] && !emcs51_lane_observed(scalar) && ((min_pc + 1 + inst_def->length) <= 0xFFFF);
+
+    if (vector)
+        vector = (emcs51_core_read_code(scalar, (uint16_t)(min_pc + 1), operands, inst_def->length) == EMCS51_OK);
+
+    if (vector && emcs51_lane_exec_vector(lc, opcode, operands, (uint16_t)min_pc, (uint16_t)(min_pc + 1 + inst_def->length)))
+    {
+        for (uint32_t i = 0; i < lc->lane_count; i++)
+        {
+            uint64_t m = (uint64_t)(int64_t)(int8_t)lc->mask[i];
+
+            lc->inst_count[i] += m & 1;
+            lc->cycles[i] += m & inst_def->cycles;
+        }
+
+        lc->stats.vector_inst += count;
+
+        return (int)count;
+    }
+
+    emcs51_lane_flush_written(lc);
+
+    for (uint32_t i = 0; i < lc->lane_count; i++)
+    {
+        if (lc->mask[i])
+            emcs51_lane_fallback(lc, i);
+    }
+
+    return (int)count;
+}
+
+/*******************************************************************************
+ * @brief 锁步执行，直到所有lane停止或达到步数上限
+ * @param lc        lane核心结构体指针
+ * @param max_steps 最多执行的锁步次数
+ * @return 实际执行的锁步次数
+ ******************************************************************************/
+uint64_t emcs51_lane_run(emcs51_lane_core_t *lc, uint64_t max_steps)
+{
+    uint64_t steps = 0;
+
+    if (lc == NULL)
+        return 0;
+
+    while (steps < max_steps)
+    {
+        if (emcs51_lane_step(lc) == 0)
+            break;
+
+        steps++;
+    }
+
+    return steps;
+}
+
+/*******************************************************************************
+ * @brief 打印lane执行统计
+ ******************************************************************************/
+void emcs51_lane_dump_stats(emcs51_lane_core_t *lc)
+{
+    emcs51_lane_stats_t *stats;
+
+    if (lc == NULL)
+        return;
+
+    stats = &lc->stats;
+
+    printf("[EMCS51][lane] lanes:%u steps:%llu lane_inst:%llu avg_lanes:%.2f\r\n",
+           (unsigned)lc->lane_count, (unsigned long long)stats->steps, (unsigned long long)stats->lane_inst,
+           stats->steps ? ((double)stats->lane_inst / (double)stats->steps) : 0.0);
+    printf("[EMCS51][lane] vector:%llu fallback:%llu divergent_steps:%llu\r\n",
+           (unsigned long long)stats->vector_inst, (unsigned long long)stats->fallback_inst,
+           (unsigned long long)stats->divergent_steps);
+}
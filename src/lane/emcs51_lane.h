@@ -0,0 +1,75 @@
+#ifndef EMCS51_LANE_H
+#define EMCS51_LANE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core/emcs51_core.h"
+
+// 最大lane数，必须是32的倍数
+#ifndef EMCS51_LANE_MAX
+#define EMCS51_LANE_MAX 64
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define EMCS51_LANE_ALIGNED __attribute__((aligned(32)))
+#else
+#define EMCS51_LANE_ALIGNED
+#endif
+
+typedef struct EMCS51_LANE_STATS
+{
+    uint64_t steps;           // 锁步执行次数
+    uint64_t lane_inst;       // 所有lane累计执行的指令数
+    uint64_t vector_inst;     // 其中由向量路径执行的指令数
+    uint64_t fallback_inst;   // 其中回退到标量核心执行的指令数
+    uint64_t divergent_steps; // PC不一致、只执行了部分lane的次数
+} emcs51_lane_stats_t;
+
+// 结构体数组布局：同一寄存器/同一IRAM地址的所有lane连续存放，
+// data_ram 只能由向量路径和 emcs51_lane_import() 修改，否则 shadow 不会更新
+typedef struct EMCS51_LANE_CORE
+{
+    emcs51_core_t *scalar; // 提供指令表、回调和code区，也用于执行没有向量实现的指令
+    uint32_t lane_count;
+    uint32_t lane_width; // lane_count 向上取整到32
+
+    uint8_t fast[256]; // 操作码是否有向量实现
+
+    EMCS51_LANE_ALIGNED uint8_t data_ram[256][EMCS51_LANE_MAX];
+    EMCS51_LANE_ALIGNED uint8_t a[EMCS51_LANE_MAX];
+    EMCS51_LANE_ALIGNED uint8_t b[EMCS51_LANE_MAX];
+    EMCS51_LANE_ALIGNED uint8_t sp[EMCS51_LANE_MAX];
+    EMCS51_LANE_ALIGNED uint8_t psw[EMCS51_LANE_MAX];
+    EMCS51_LANE_ALIGNED uint16_t pc[EMCS51_LANE_MAX];
+    EMCS51_LANE_ALIGNED uint8_t active[EMCS51_LANE_MAX]; // 0xFF 运行中，0x00 已停止
+    EMCS51_LANE_ALIGNED uint8_t mask[EMCS51_LANE_MAX];   // 本次执行的lane
+
+    int err[EMCS51_LANE_MAX];
+    uint64_t inst_count[EMCS51_LANE_MAX];
+    uint64_t cycles[EMCS51_LANE_MAX];
+
+    // 回退执行时每个lane的IRAM连续副本，stale 中置位的地址已被向量路径改写，回退前才从 data_ram 补齐
+    EMCS51_LANE_ALIGNED uint8_t shadow[EMCS51_LANE_MAX][256];
+    uint32_t stale[EMCS51_LANE_MAX][8];
+    uint32_t written[8]; // 上次回退以来向量路径写过的IRAM地址，每地址一位
+
+    uint8_t *xdata_ram[EMCS51_LANE_MAX];
+    uint32_t xdata_ram_size[EMCS51_LANE_MAX];
+    void *user[EMCS51_LANE_MAX]; // 回退执行时作为 core->user 传给回调
+
+    emcs51_lane_stats_t stats;
+} emcs51_lane_core_t;
+
+int emcs51_lane_init(emcs51_lane_core_t *lc, emcs51_core_t *scalar, uint32_t lane_count);
+void emcs51_lane_set_xdata_ram(emcs51_lane_core_t *lc, uint32_t lane, uint8_t *xdata_ram, uint32_t xdata_ram_size);
+void emcs51_lane_set_user(emcs51_lane_core_t *lc, uint32_t lane, void *user);
+
+void emcs51_lane_import(emcs51_lane_core_t *lc, uint32_t lane, const emcs51_core_t *core);
+void emcs51_lane_export(emcs51_lane_core_t *lc, uint32_t lane, emcs51_core_t *core);
+
+int emcs51_lane_step(emcs51_lane_core_t *lc);
+uint64_t emcs51_lane_run(emcs51_lane_core_t *lc, uint64_t max_steps);
+
+void emcs51_lane_dump_stats(emcs51_lane_core_t *lc);
+
+#endif // EMCS51_LANE_H
@@ -0,0 +1,288 @@
+#include <stdlib.h>
+#include "emcs51.h"
+
+// S: 记录，仅在加载过程中使用，为 L: 记录提供地址空间和符号类型
+typedef struct EMCS51_CDB_ENTRY
+{
+    const char *key;
+    uint32_t key_len;
+    uint8_t space;
+    uint8_t kind;
+    uint8_t has_end;
+    int32_t sym;  // 对应的符号序号，-1 表示尚无 L: 记录
+    uint32_t end; // L:X 记录给出的函数结束地址
+} emcs51_cdb_entry_t;
+
+/*******************************************************************************
+ * @brief SDCC地址空间字母转换为emcs51_space_types_t
+ ******************************************************************************/
+static uint8_t emcs51_cdb_space(char c)
+{
+    switch (c)
+    {
+    case 'C': // code
+    case 'D': // code/static segment
+        return EMCS51_SPACE_CODE;
+    case 'I': // SFR
+    case 'J': // sbit
+        return EMCS51_SPACE_SFR;
+    case 'A': // external stack
+    case 'F': // xdata
+        return EMCS51_SPACE_XDATA;
+    }
+
+    return EMCS51_SPACE_IRAM;
+}
+
+static int emcs51_cdb_entry_cmp(const void *a, const void *b)
+{
+    const emcs51_cdb_entry_t *ea = (const emcs51_cdb_entry_t *)a;
+    const emcs51_cdb_entry_t *eb = (const emcs51_cdb_entry_t *)b;
+    uint32_t len = (ea->key_len < eb->key_len) ? ea->key_len : eb->key_len;
+    int ret = memcmp(ea->key, eb->key, len);
+
+    if (ret != 0)
+        return ret;
+
+    return (ea->key_len < eb->key_len) ? -1 : (ea->key_len > eb->key_len);
+}
+
+static emcs51_cdb_entry_t *emcs51_cdb_find(emcs51_cdb_entry_t *entries, uint32_t count, const char *key, uint32_t key_len)
+{
+    emcs51_cdb_entry_t target = {.key = key, .key_len = key_len};
+
+    if (count == 0)
+        return NULL;
+
+    return (emcs51_cdb_entry_t *)bsearch(&target, entries, count, sizeof(emcs51_cdb_entry_t), emcs51_cdb_entry_cmp);
+}
+
+/*******************************************************************************
+ * @brief 查找下一个分隔符
+ * @return 分隔符位置，找不到返回 end
+ ******************************************************************************/
+static const char *emcs51_cdb_find_char(const char *p, const char *end, char c)
+{
+    const char *r = memchr(p, c, (size_t)(end - p));
+
+    return r ? r : end;
+}
+
+static uint32_t emcs51_cdb_parse_uint(const char *p, const char *end, int base)
+{
+    uint32_t v = 0;
+
+    for (; p < end; p++)
+    {
+        uint32_t d;
+
+        if ((*p >= '0') && (*p <= '9'))
+            d = (uint32_t)(*p - '0');
+        else if ((base == 16) && (*p >= 'A') && (*p <= 'F'))
+            d = (uint32_t)(*p - 'A' + 10);
+        else if ((base == 16) && (*p >= 'a') && (*p <= 'f'))
+            d = (uint32_t)(*p - 'a' + 10);
+        else
+            break;
+
+        v = (v * (uint32_t)base) + d;
+    }
+
+    return v;
+}
+
+/*******************************************************************************
+ * @brief 处理一条 S: 记录
+ * @details S:G$main$0_0$0({2}DF,SV:S),C,0,0
+ ******************************************************************************/
+static void emcs51_cdb_parse_s(emcs51_cdb_entry_t *entry, const char *p, const char *end)
+{
+    const char *paren = emcs51_cdb_find_char(p, end, '(');
+    const char *close = emcs51_cdb_find_char(paren, end, ')');
+
+    entry->key = p;
+    entry->key_len = (uint32_t)(paren - p);
+    entry->space = EMCS51_SPACE_IRAM;
+    entry->kind = EMCS51_SYMBOL_DATA;
+    entry->has_end = 0;
+    entry->sym = -1;
+    entry->end = 0;
+
+    if (((end - close) >= 3) && (close[1] == ','))
+        entry->space = emcs51_cdb_space(close[2]);
+
+    // 类型链以 DF 开头的是函数
+    for (const char *t = paren; (t + 2) < close; t++)
+    {
+        if ((t[0] == '}') && (t[1] == 'D') && (t[2] == 'F'))
+        {
+            entry->kind = EMCS51_SYMBOL_FUNC;
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+ * @brief 处理一条 L: 记录
+ * @details L:G$main$0_0$0:6A          全局符号
+ *          L:Fblink$count$0_0$0:21    文件内静态符号
+ *          L:Lmain$i$1_0$1:8          局部符号
+ *          L:XG$main$0_0$0:7F         函数结束地址
+ *          L:C$blink.c$12$1_0$1:6D    C源代码行
+ *          L:A$blink$85:6A            汇编源代码行
+ ******************************************************************************/
+static int emcs51_cdb_parse_l(emcs51_symtab_t *tab, emcs51_cdb_entry_t *entries, uint32_t entry_count, const char *p, const char *end)
+{
+    const char *colon = end;
+    const char *key_end;
+    const char *c1, *c2, *c3;
+    uint32_t addr;
+
+    while ((colon > p) && (colon[-1] != ':'))
+        colon--;
+
+    if (colon <= p)
+        return EMCS51_ERR_OBJ_FORMAT;
+
+    key_end = colon - 1;
+    addr = emcs51_cdb_parse_uint(colon, end, 16);
+
+    // 各字段以 '$' 分隔
+    c1 = emcs51_cdb_find_char(p, key_end, '$');
+    c2 = (c1 < key_end) ? emcs51_cdb_find_char(c1 + 1, key_end, '$') : key_end;
+    c3 = (c2 < key_end) ? emcs51_cdb_find_char(c2 + 1, key_end, '$') : key_end;
+
+    if (c1 >= key_end)
+        return EMCS51_ERR_OBJ_FORMAT;
+
+    if ((p[0] == 'C') || (p[0] == 'A'))
+    {
+        if (c2 >= key_end)
+            return EMCS51_ERR_OBJ_FORMAT;
+
+        return emcs51_symtab_add_line(tab, addr, c1 + 1, (uint32_t)(c2 - c1 - 1), emcs51_cdb_parse_uint(c2 + 1, c3, 10));
+    }
+
+    if (p[0] == 'X')
+    {
+        emcs51_cdb_entry_t *entry = emcs51_cdb_find(entries, entry_count, p + 1, (uint32_t)(key_end - p - 1));
+
+        if (entry != NULL)
+        {
+            entry->has_end = 1;
+            entry->end = addr;
+        }
+
+        return EMCS51_OK;
+    }
+
+    if ((p[0] == 'G') || (p[0] == 'F') || (p[0] == 'L'))
+    {
+        emcs51_cdb_entry_t *entry = emcs51_cdb_find(entries, entry_count, p, (uint32_t)(key_end - p));
+        uint8_t space = entry ? entry->space : EMCS51_SPACE_CODE;
+        uint8_t kind = entry ? entry->kind : EMCS51_SYMBOL_LABEL;
+        char name[128];
+        int name_len;
+        int sym;
+
+        if (c2 > key_end)
+            return EMCS51_ERR_OBJ_FORMAT;
+
+        // 局部符号带上所属函数名
+        if ((p[0] == 'L') && (c1 > (p + 1)))
+            name_len = snprintf(name, sizeof(name), "%.*s.%.*s", (int)(c1 - p - 1), p + 1, (int)(c2 - c1 - 1), c1 + 1);
+        else
+            name_len = snprintf(name, sizeof(name), "%.*s", (int)(c2 - c1 - 1), c1 + 1);
+
+        if (name_len >= (int)sizeof(name))
+            name_len = sizeof(name) - 1;
+
+        sym = emcs51_symtab_add(tab, space, addr, 0, kind, name, (uint32_t)name_len);
+        if (sym < 0)
+            return sym;
+
+        if (entry != NULL)
+            entry->sym = sym;
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 加载SDCC .cdb调试信息
+ * @param tab  符号表结构体指针
+ * @param text .cdb文件内容
+ * @param len  文件长度
+ * @return emcs51_err_t
+ * @details 第一遍收集 S: 记录（地址空间、是否为函数），
+ *          第二遍处理 L: 记录生成符号和行号，最后按 L:X 记录补齐函数大小并排序。
+ *          code内容请用 emcs51_ihex 加载同名 .ihx 文件
+ ******************************************************************************/
+int emcs51_cdb_load(emcs51_symtab_t *tab, const char *text, uint32_t len)
+{
+    emcs51_cdb_entry_t *entries = NULL;
+    uint32_t entry_count = 0;
+    uint32_t entry_cap = 0;
+    const char *end = text + len;
+    const char *p;
+    int ret = EMCS51_OK;
+
+    if ((tab == NULL) || (text == NULL))
+        return EMCS51_ERR;
+
+    for (p = text; p < end;)
+    {
+        const char *eol = emcs51_cdb_find_char(p, end, '\n');
+        const char *line_end = ((eol > p) && (eol[-1] == '\r')) ? (eol - 1) : eol;
+
+        if (((line_end - p) > 2) && (p[0] == 'S') && (p[1] == ':'))
+        {
+            if (entry_count == entry_cap)
+            {
+                uint32_t new_cap = entry_cap ? (entry_cap * 2) : 64;
+                emcs51_cdb_entry_t *n = realloc(entries, new_cap * sizeof(emcs51_cdb_entry_t));
+
+                if (n == NULL)
+                {
+                    free(entries);
+                    return EMCS51_ERR;
+                }
+
+                entries = n;
+                entry_cap = new_cap;
+            }
+
+            emcs51_cdb_parse_s(&entries[entry_count++], p + 2, line_end);
+        }
+
+        p = eol + 1;
+    }
+
+    if (entry_count > 1)
+        qsort(entries, entry_count, sizeof(emcs51_cdb_entry_t), emcs51_cdb_entry_cmp);
+
+    for (p = text; (p < end) && (ret == EMCS51_OK);)
+    {
+        const char *eol = emcs51_cdb_find_char(p, end, '\n');
+        const char *line_end = ((eol > p) && (eol[-1] == '\r')) ? (eol - 1) : eol;
+
+        if (((line_end - p) > 2) && (p[0] == 'L') && (p[1] == ':'))
+            ret = emcs51_cdb_parse_l(tab, entries, entry_count, p + 2, line_end);
+
+        p = eol + 1;
+    }
+
+    for (uint32_t i = 0; i < entry_count; i++)
+    {
+        emcs51_cdb_entry_t *entry = &entries[i];
+
+        if ((entry->sym >= 0) && entry->has_end && (entry->end >= tab->syms[entry->sym].addr))
+            tab->syms[entry->sym].size = entry->end - tab->syms[entry->sym].addr + 1;
+    }
+
+    free(entries);
+
+    emcs51_symtab_finalize(tab);
+
+    return ret;
+}
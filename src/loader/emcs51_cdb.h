@@ -0,0 +1,9 @@
+#ifndef EMCS51_CDB_H
+#define EMCS51_CDB_H
+
+#include <stdint.h>
+#include "loader/emcs51_symtab.h"
+
+int emcs51_cdb_load(emcs51_symtab_t *tab, const char *text, uint32_t len);
+
+#endif // EMCS51_CDB_H
@@ -0,0 +1,280 @@
+#include "emcs51.h"
+
+// 十六进制字符查找表，存放 值+1，0 表示非法字符
+static const uint8_t emcs51_ihex_hex_table[256] = {
+    ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5,
+    ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+};
+
+/*******************************************************************************
+ * @brief 初始化Intel HEX解析器（回调输出模式）
+ * @param ih      解析器结构体指针
+ * @param sink_cb 数据记录输出回调
+ * @param user    回调用户上下文
+ * @return none
+ ******************************************************************************/
+void emcs51_ihex_init(emcs51_ihex_t *ih, emcs51_ihex_sink_cb_t sink_cb, void *user)
+{
+    if (ih == NULL)
+        return;
+
+    memset(ih, 0, sizeof(emcs51_ihex_t));
+
+    ih->sink_cb = sink_cb;
+    ih->user = user;
+    ih->line = 1;
+    ih->addr_min = UINT32_MAX;
+}
+
+/*******************************************************************************
+ * @brief 初始化Intel HEX解析器（直接写入缓冲区模式）
+ * @param ih          解析器结构体指针
+ * @param buffer      目标缓冲区，通常即为code区
+ * @param buffer_size 目标缓冲区大小，超出范围的数据记录视为错误
+ * @return none
+ ******************************************************************************/
+void emcs51_ihex_init_buffer(emcs51_ihex_t *ih, uint8_t *buffer, uint32_t buffer_size)
+{
+    emcs51_ihex_init(ih, NULL, NULL);
+
+    if (ih == NULL)
+        return;
+
+    ih->buffer = buffer;
+    ih->buffer_size = buffer_size;
+}
+
+/*******************************************************************************
+ * @brief 输出一条数据记录
+ * @param ih   解析器结构体指针
+ * @param addr 绝对地址
+ * @param data 数据
+ * @param len  数据长度
+ * @return emcs51_err_t
+ ******************************************************************************/
+static int emcs51_ihex_emit(emcs51_ihex_t *ih, uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    int ret = EMCS51_OK;
+
+    if (len == 0)
+        return EMCS51_OK;
+
+    if (ih->buffer != NULL)
+    {
+        if ((addr >= ih->buffer_size) || (len > (ih->buffer_size - addr)))
+            return EMCS51_ERR_CODE_OUT_OF_RANGE;
+
+        memcpy(&ih->buffer[addr], data, len);
+    }
+    else if (ih->sink_cb != NULL)
+    {
+        ret = ih->sink_cb(ih->user, addr, data, len);
+
+        if (ret != EMCS51_OK)
+            return ret;
+    }
+
+    if (addr < ih->addr_min)
+        ih->addr_min = addr;
+
+    if ((addr + len) > ih->addr_max)
+        ih->addr_max = addr + len;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 处理一条完整的记录
+ * @param ih 解析器结构体指针
+ * @return emcs51_err_t
+ ******************************************************************************/
+static int emcs51_ihex_process(emcs51_ihex_t *ih)
+{
+    const uint8_t *rec = ih->record;
+    const uint8_t *data = &rec[4];
+    uint8_t len = rec[0];
+    uint16_t offset = (uint16_t)((rec[1] << 8) | rec[2]);
+    uint8_t sum = 0;
+
+    for (uint16_t i = 0; i < ih->need; i++)
+        sum += rec[i];
+
+    if (sum != 0)
+        return EMCS51_ERR_IHEX_CHECKSUM;
+
+    ih->records++;
+
+    switch (rec[3])
+    {
+    case EMCS51_IHEX_DATA:
+        return emcs51_ihex_emit(ih, ih->base + offset, data, len);
+
+    case EMCS51_IHEX_EOF:
+        if (len != 0)
+            return EMCS51_ERR_IHEX_FORMAT;
+
+        ih->done = 1;
+        return EMCS51_OK;
+
+    case EMCS51_IHEX_EXT_SEGMENT_ADDR:
+        if (len != 2)
+            return EMCS51_ERR_IHEX_FORMAT;
+
+        ih->base = (uint32_t)((data[0] << 8) | data[1]) << 4;
+        return EMCS51_OK;
+
+    case EMCS51_IHEX_EXT_LINEAR_ADDR:
+        if (len != 2)
+            return EMCS51_ERR_IHEX_FORMAT;
+
+        ih->base = (uint32_t)((data[0] << 8) | data[1]) << 16;
+        return EMCS51_OK;
+
+    case EMCS51_IHEX_START_SEGMENT_ADDR:
+    case EMCS51_IHEX_START_LINEAR_ADDR:
+        if (len != 4)
+            return EMCS51_ERR_IHEX_FORMAT;
+
+        ih->start_addr = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+        return EMCS51_OK;
+    }
+
+    return EMCS51_ERR_IHEX_FORMAT;
+}
+
+/*******************************************************************************
+ * @brief 向解析器输入一段HEX文本
+ * @param ih   解析器结构体指针
+ * @param text HEX文本，可在任意位置切分（包括记录中间）
+ * @param len  文本长度
+ * @return emcs51_err_t
+ * @details 逐字节状态机，不需要整行缓冲，也不分配内存；
+ *          读到EOF记录后其余文本被忽略
+ ******************************************************************************/
+int emcs51_ihex_feed(emcs51_ihex_t *ih, const char *text, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)text;
+    const uint8_t *end = p + len;
+
+    if (ih == NULL)
+        return EMCS51_ERR;
+
+    if (ih->err != EMCS51_OK)
+        return ih->err;
+
+    while (p < end)
+    {
+        if (ih->done)
+            return EMCS51_OK;
+
+        if (ih->state == 0)
+        {
+            uint8_t c = *p++;
+
+            if (c == ':')
+            {
+                ih->state = 1;
+                ih->nibble = 0;
+                ih->pos = 0;
+                ih->need = 5;
+            }
+            else if (c == '\n')
+            {
+                ih->line++;
+            }
+            else if ((c != '\r') && (c != ' ') && (c != '\t'))
+            {
+                ih->err = EMCS51_ERR_IHEX_FORMAT;
+                return ih->err;
+            }
+
+            continue;
+        }
+
+        // 先补齐上一段输入遗留的半个字节
+        if (ih->nibble)
+        {
+            uint8_t v = emcs51_ihex_hex_table[*p++];
+
+            if (v == 0)
+            {
+                ih->err = EMCS51_ERR_IHEX_FORMAT;
+                return ih->err;
+            }
+
+            ih->record[ih->pos++] |= (uint8_t)(v - 1);
+            ih->nibble = 0;
+
+            if (ih->pos == 1)
+                ih->need = (uint16_t)(ih->record[0] + 5);
+        }
+
+        // 成对解码
+        while ((ih->pos < ih->need) && ((end - p) >= 2))
+        {
+            uint8_t hi = emcs51_ihex_hex_table[p[0]];
+            uint8_t lo = emcs51_ihex_hex_table[p[1]];
+
+            if ((hi == 0) || (lo == 0))
+            {
+                ih->err = EMCS51_ERR_IHEX_FORMAT;
+                return ih->err;
+            }
+
+            ih->record[ih->pos++] = (uint8_t)(((hi - 1) << 4) | (lo - 1));
+            p += 2;
+
+            if (ih->pos == 1)
+                ih->need = (uint16_t)(ih->record[0] + 5);
+        }
+
+        if (ih->pos == ih->need)
+        {
+            ih->state = 0;
+            ih->err = emcs51_ihex_process(ih);
+
+            if (ih->err != EMCS51_OK)
+                return ih->err;
+
+            continue;
+        }
+
+        // 剩余单个字符：记录高半字节，等待下一段输入
+        if (p < end)
+        {
+            uint8_t v = emcs51_ihex_hex_table[*p++];
+
+            if (v == 0)
+            {
+                ih->err = EMCS51_ERR_IHEX_FORMAT;
+                return ih->err;
+            }
+
+            ih->record[ih->pos] = (uint8_t)((v - 1) << 4);
+            ih->nibble = 1;
+        }
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 结束输入，检查文件是否完整
+ * @param ih 解析器结构体指针
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_ihex_finish(emcs51_ihex_t *ih)
+{
+    if (ih == NULL)
+        return EMCS51_ERR;
+
+    if (ih->err != EMCS51_OK)
+        return ih->err;
+
+    if ((ih->state != 0) || (ih->done == 0))
+        ih->err = EMCS51_ERR_IHEX_FORMAT;
+
+    return ih->err;
+}
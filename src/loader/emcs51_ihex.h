@@ -0,0 +1,50 @@
+#ifndef EMCS51_IHEX_H
+#define EMCS51_IHEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 数据输出回调，addr 为已加上扩展段/线性地址后的绝对地址
+typedef int (*emcs51_ihex_sink_cb_t)(void *user, uint32_t addr, const uint8_t *data, uint32_t len);
+
+typedef enum EMCS51_IHEX_RECORD_TYPES
+{
+    EMCS51_IHEX_DATA = 0x00,
+    EMCS51_IHEX_EOF = 0x01,
+    EMCS51_IHEX_EXT_SEGMENT_ADDR = 0x02,
+    EMCS51_IHEX_START_SEGMENT_ADDR = 0x03,
+    EMCS51_IHEX_EXT_LINEAR_ADDR = 0x04,
+    EMCS51_IHEX_START_LINEAR_ADDR = 0x05,
+} emcs51_ihex_record_types_t;
+
+typedef struct EMCS51_IHEX
+{
+    emcs51_ihex_sink_cb_t sink_cb;
+    void *user;
+
+    uint8_t *buffer; // 直接写入模式的目标缓冲区
+    uint32_t buffer_size;
+
+    uint8_t state;    // 0 等待':'，1 读取十六进制字符
+    uint8_t nibble;   // 0 高半字节，1 低半字节
+    uint8_t done;     // 已读到EOF记录
+    uint16_t pos;     // record 中已解码的字节数
+    uint16_t need;    // 本条记录的总字节数
+    uint8_t record[5 + 255]; // 长度 地址(2) 类型 数据 校验和
+
+    uint32_t base;       // 扩展段/线性地址
+    uint32_t start_addr; // 起始地址记录
+    uint32_t line;       // 当前行号，用于报错
+    uint32_t records;    // 已处理的记录数
+    uint32_t addr_min;   // 写入过的最小地址
+    uint32_t addr_max;   // 写入过的最大地址+1
+    int err;
+} emcs51_ihex_t;
+
+void emcs51_ihex_init(emcs51_ihex_t *ih, emcs51_ihex_sink_cb_t sink_cb, void *user);
+void emcs51_ihex_init_buffer(emcs51_ihex_t *ih, uint8_t *buffer, uint32_t buffer_size);
+
+int emcs51_ihex_feed(emcs51_ihex_t *ih, const char *text, uint32_t len);
+int emcs51_ihex_finish(emcs51_ihex_t *ih);
+
+#endif // EMCS51_IHEX_H
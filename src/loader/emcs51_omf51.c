@@ -0,0 +1,195 @@
+#include "emcs51.h"
+
+/*******************************************************************************
+ * @brief OMF-51 SYM INFO 段类型转换为emcs51_space_types_t
+ * @return 地址空间，BIT/NUMBER 类型返回 -1
+ ******************************************************************************/
+static int emcs51_omf51_space(uint8_t sym_info)
+{
+    switch (sym_info & 0x07)
+    {
+    case 0: // CODE
+        return EMCS51_SPACE_CODE;
+    case 1: // XDATA
+        return EMCS51_SPACE_XDATA;
+    case 2: // DATA
+    case 3: // IDATA
+        return EMCS51_SPACE_IRAM;
+    }
+
+    return -1;
+}
+
+/*******************************************************************************
+ * @brief 处理调试项记录
+ * @param tab    符号表
+ * @param p      记录内容（不含类型、长度和校验和）
+ * @param len    内容长度
+ * @param module 当前模块名，作为行号记录的文件名
+ * @return emcs51_err_t
+ ******************************************************************************/
+static int emcs51_omf51_debug_items(emcs51_symtab_t *tab, const uint8_t *p, uint32_t len, const char *module, uint32_t module_len)
+{
+    const uint8_t *end = p + len;
+    uint8_t def_type;
+    int ret;
+
+    if (len < 1)
+        return EMCS51_ERR_OBJ_FORMAT;
+
+    def_type = *p++;
+
+    while (p < end)
+    {
+        if ((def_type == EMCS51_OMF51_DEBUG_LOCAL) || (def_type == EMCS51_OMF51_DEBUG_PUBLIC))
+        {
+            // SEG ID, SYM INFO, OFFSET(2), 保留, NAME
+            uint8_t sym_info;
+            uint16_t offset;
+            uint8_t name_len;
+            int space;
+
+            if ((end - p) < 6)
+                return EMCS51_ERR_OBJ_FORMAT;
+
+            sym_info = p[1];
+            offset = (uint16_t)(p[2] | (p[3] << 8));
+            name_len = p[5];
+            p += 6;
+
+            if ((end - p) < name_len)
+                return EMCS51_ERR_OBJ_FORMAT;
+
+            space = emcs51_omf51_space(sym_info);
+            if (space >= 0)
+            {
+                uint8_t kind = (sym_info & 0x80) ? EMCS51_SYMBOL_FUNC : ((space == EMCS51_SPACE_CODE) ? EMCS51_SYMBOL_LABEL : EMCS51_SYMBOL_DATA);
+
+                // DATA段高于0x80的地址是SFR
+                if ((space == EMCS51_SPACE_IRAM) && ((sym_info & 0x07) == 2) && (offset >= 0x80))
+                    space = EMCS51_SPACE_SFR;
+
+                ret = emcs51_symtab_add(tab, (uint8_t)space, offset, 0, kind, (const char *)p, name_len);
+                if (ret < 0)
+                    return ret;
+            }
+
+            p += name_len;
+        }
+        else if (def_type == EMCS51_OMF51_DEBUG_LINE)
+        {
+            // SEG ID, OFFSET(2), LINE(2)
+            if ((end - p) < 5)
+                return EMCS51_ERR_OBJ_FORMAT;
+
+            ret = emcs51_symtab_add_line(tab, (uint32_t)(p[1] | (p[2] << 8)), module, module_len, (uint32_t)(p[3] | (p[4] << 8)));
+            if (ret != EMCS51_OK)
+                return ret;
+
+            p += 5;
+        }
+        else
+        {
+            // 段符号不需要
+            break;
+        }
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 加载OMF-51绝对目标文件（Keil BL51/LX51 输出的 AOMF）
+ * @param tab     符号表结构体指针，可为NULL（只加载code）
+ * @param data    文件内容
+ * @param len     文件长度
+ * @param sink_cb 内容记录输出回调，可为NULL（只加载符号）
+ * @param user    回调用户上下文
+ * @return emcs51_err_t
+ * @details 每条记录为 类型(1) 长度(2) 内容 校验和(1)，长度包含校验和，
+ *          多字节字段低字节在前，记录所有字节之和为0；
+ *          处理内容(0x06)、作用域(0x10)和调试项(0x12)记录，其余记录跳过
+ ******************************************************************************/
+int emcs51_omf51_load(emcs51_symtab_t *tab, const uint8_t *data, uint32_t len, emcs51_omf51_sink_cb_t sink_cb, void *user)
+{
+    const uint8_t *p = data;
+    const uint8_t *end = data + len;
+    const char *module = "";
+    uint32_t module_len = 0;
+    int ret = EMCS51_OK;
+
+    if (data == NULL)
+        return EMCS51_ERR;
+
+    while (p < end)
+    {
+        uint8_t type;
+        uint16_t rec_len;
+        const uint8_t *content;
+        uint32_t content_len;
+        uint8_t sum = 0;
+
+        if ((end - p) < 3)
+            return EMCS51_ERR_OBJ_FORMAT;
+
+        type = p[0];
+        rec_len = (uint16_t)(p[1] | (p[2] << 8));
+
+        if ((rec_len < 1) || ((uint32_t)(end - p - 3) < rec_len))
+            return EMCS51_ERR_OBJ_FORMAT;
+
+        for (uint32_t i = 0; i < (uint32_t)rec_len + 3; i++)
+            sum += p[i];
+
+        if (sum != 0)
+            return EMCS51_ERR_OBJ_FORMAT;
+
+        content = &p[3];
+        content_len = (uint32_t)rec_len - 1;
+        p += (uint32_t)rec_len + 3;
+
+        switch (type)
+        {
+        case EMCS51_OMF51_CONTENT:
+            // SEG ID, OFFSET(2), DATA，绝对目标文件中段号为0
+            if (content_len < 3)
+                return EMCS51_ERR_OBJ_FORMAT;
+
+            if ((content[0] == 0) && (sink_cb != NULL) && (content_len > 3))
+            {
+                ret = sink_cb(user, (uint32_t)(content[1] | (content[2] << 8)), &content[3], content_len - 3);
+                if (ret != EMCS51_OK)
+                    return ret;
+            }
+            break;
+
+        case EMCS51_OMF51_SCOPE_DEF:
+            // BLK TYP, NAME；类型0为模块开始
+            if ((content_len >= 2) && (content[0] == 0) && ((uint32_t)content[1] + 2 <= content_len))
+            {
+                module = (const char *)&content[2];
+                module_len = content[1];
+            }
+            break;
+
+        case EMCS51_OMF51_DEBUG_ITEMS:
+            if (tab != NULL)
+            {
+                ret = emcs51_omf51_debug_items(tab, content, content_len, module, module_len);
+                if (ret != EMCS51_OK)
+                    return ret;
+            }
+            break;
+
+        case EMCS51_OMF51_MODULE_END:
+            module = "";
+            module_len = 0;
+            break;
+        }
+    }
+
+    if (tab != NULL)
+        emcs51_symtab_finalize(tab);
+
+    return EMCS51_OK;
+}
@@ -0,0 +1,30 @@
+#ifndef EMCS51_OMF51_H
+#define EMCS51_OMF51_H
+
+#include <stdint.h>
+#include "loader/emcs51_ihex.h"
+#include "loader/emcs51_symtab.h"
+
+typedef enum EMCS51_OMF51_RECORD_TYPES
+{
+    EMCS51_OMF51_MODULE_HEADER = 0x02,
+    EMCS51_OMF51_MODULE_END = 0x04,
+    EMCS51_OMF51_CONTENT = 0x06,
+    EMCS51_OMF51_SCOPE_DEF = 0x10,
+    EMCS51_OMF51_DEBUG_ITEMS = 0x12,
+} emcs51_omf51_record_types_t;
+
+typedef enum EMCS51_OMF51_DEBUG_TYPES
+{
+    EMCS51_OMF51_DEBUG_LOCAL = 0x00,
+    EMCS51_OMF51_DEBUG_PUBLIC = 0x01,
+    EMCS51_OMF51_DEBUG_SEGMENT = 0x02,
+    EMCS51_OMF51_DEBUG_LINE = 0x03,
+} emcs51_omf51_debug_types_t;
+
+// 内容记录输出回调，与 Intel HEX 加载器相同
+typedef emcs51_ihex_sink_cb_t emcs51_omf51_sink_cb_t;
+
+int emcs51_omf51_load(emcs51_symtab_t *tab, const uint8_t *data, uint32_t len, emcs51_omf51_sink_cb_t sink_cb, void *user);
+
+#endif // EMCS51_OMF51_H
@@ -0,0 +1,322 @@
+#include <stdlib.h>
+#include "emcs51.h"
+
+/*******************************************************************************
+ * @brief 初始化符号表
+ * @param tab 符号表结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_symtab_init(emcs51_symtab_t *tab)
+{
+    if (tab == NULL)
+        return;
+
+    memset(tab, 0, sizeof(emcs51_symtab_t));
+    tab->last_file = UINT32_MAX;
+}
+
+/*******************************************************************************
+ * @brief 释放符号表
+ * @param tab 符号表结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_symtab_deinit(emcs51_symtab_t *tab)
+{
+    if (tab == NULL)
+        return;
+
+    free(tab->syms);
+    free(tab->lines);
+    free(tab->strings);
+
+    emcs51_symtab_init(tab);
+}
+
+/*******************************************************************************
+ * @brief 按需扩容数组
+ * @param ptr  数组指针的地址
+ * @param cap  当前容量
+ * @param need 需要的元素个数
+ * @param size 元素大小
+ * @return emcs51_err_t
+ ******************************************************************************/
+static int emcs51_symtab_reserve(void **ptr, uint32_t *cap, uint32_t need, size_t size)
+{
+    uint32_t new_cap = *cap ? *cap : 64;
+    void *p;
+
+    if (need <= *cap)
+        return EMCS51_OK;
+
+    while (new_cap < need)
+        new_cap *= 2;
+
+    p = realloc(*ptr, (size_t)new_cap * size);
+    if (p == NULL)
+        return EMCS51_ERR;
+
+    *ptr = p;
+    *cap = new_cap;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 向字符串表追加字符串
+ * @return 字符串表偏移，失败返回 UINT32_MAX
+ ******************************************************************************/
+static uint32_t emcs51_symtab_add_string(emcs51_symtab_t *tab, const char *str, uint32_t len)
+{
+    uint32_t offset = tab->str_len;
+
+    if (emcs51_symtab_reserve((void **)&tab->strings, &tab->str_cap, tab->str_len + len + 1, 1) != EMCS51_OK)
+        return UINT32_MAX;
+
+    memcpy(&tab->strings[offset], str, len);
+    tab->strings[offset + len] = '\0';
+    tab->str_len += len + 1;
+
+    return offset;
+}
+
+/*******************************************************************************
+ * @brief 添加符号
+ * @param tab      符号表结构体指针
+ * @param space    地址空间 emcs51_space_types_t
+ * @param addr     地址
+ * @param size     大小，0 表示未知
+ * @param kind     符号类型 emcs51_symbol_kinds_t
+ * @param name     符号名，不要求以'\0'结尾
+ * @param name_len 符号名长度
+ * @return 符号序号，失败返回 emcs51_err_t
+ ******************************************************************************/
+int emcs51_symtab_add(emcs51_symtab_t *tab, uint8_t space, uint32_t addr, uint32_t size, uint8_t kind, const char *name, uint32_t name_len)
+{
+    emcs51_symbol_t *sym;
+    uint32_t name_off;
+
+    if (tab == NULL)
+        return EMCS51_ERR;
+
+    if (emcs51_symtab_reserve((void **)&tab->syms, &tab->sym_cap, tab->sym_count + 1, sizeof(emcs51_symbol_t)) != EMCS51_OK)
+        return EMCS51_ERR;
+
+    name_off = emcs51_symtab_add_string(tab, name, name_len);
+    if (name_off == UINT32_MAX)
+        return EMCS51_ERR;
+
+    sym = &tab->syms[tab->sym_count];
+    sym->addr = addr;
+    sym->size = size;
+    sym->name = name_off;
+    sym->space = space;
+    sym->kind = kind;
+
+    tab->sorted = 0;
+
+    return (int)tab->sym_count++;
+}
+
+/*******************************************************************************
+ * @brief 添加行号记录
+ * @param tab      符号表结构体指针
+ * @param addr     code区地址
+ * @param file     源文件名，不要求以'\0'结尾
+ * @param file_len 源文件名长度
+ * @param line     行号
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_symtab_add_line(emcs51_symtab_t *tab, uint32_t addr, const char *file, uint32_t file_len, uint32_t line)
+{
+    emcs51_line_t *entry;
+
+    if (tab == NULL)
+        return EMCS51_ERR;
+
+    if (emcs51_symtab_reserve((void **)&tab->lines, &tab->line_cap, tab->line_count + 1, sizeof(emcs51_line_t)) != EMCS51_OK)
+        return EMCS51_ERR;
+
+    if ((tab->last_file == UINT32_MAX) ||
+        (strlen(&tab->strings[tab->last_file]) != file_len) ||
+        (memcmp(&tab->strings[tab->last_file], file, file_len) != 0))
+    {
+        tab->last_file = emcs51_symtab_add_string(tab, file, file_len);
+        if (tab->last_file == UINT32_MAX)
+            return EMCS51_ERR;
+    }
+
+    entry = &tab->lines[tab->line_count++];
+    entry->addr = addr;
+    entry->line = line;
+    entry->file = tab->last_file;
+
+    tab->sorted = 0;
+
+    return EMCS51_OK;
+}
+
+static int emcs51_symtab_sym_cmp(const void *a, const void *b)
+{
+    const emcs51_symbol_t *sa = (const emcs51_symbol_t *)a;
+    const emcs51_symbol_t *sb = (const emcs51_symbol_t *)b;
+
+    if (sa->space != sb->space)
+        return (sa->space < sb->space) ? -1 : 1;
+
+    if (sa->addr != sb->addr)
+        return (sa->addr < sb->addr) ? -1 : 1;
+
+    // 同一地址上函数优先于标号，查找时取最后一个
+    if (sa->kind != sb->kind)
+        return (sa->kind < sb->kind) ? -1 : 1;
+
+    return (sa->name < sb->name) ? -1 : (sa->name > sb->name);
+}
+
+static int emcs51_symtab_line_cmp(const void *a, const void *b)
+{
+    const emcs51_line_t *la = (const emcs51_line_t *)a;
+    const emcs51_line_t *lb = (const emcs51_line_t *)b;
+
+    if (la->addr != lb->addr)
+        return (la->addr < lb->addr) ? -1 : 1;
+
+    return (la->line < lb->line) ? -1 : (la->line > lb->line);
+}
+
+/*******************************************************************************
+ * @brief 排序符号表，加载完成后、查找前调用
+ * @param tab 符号表结构体指针
+ * @return none
+ * @details 同一地址的重复行号记录只保留行号最小的一条
+ ******************************************************************************/
+void emcs51_symtab_finalize(emcs51_symtab_t *tab)
+{
+    uint32_t out = 0;
+
+    if (tab == NULL)
+        return;
+
+    if (tab->sym_count > 1)
+        qsort(tab->syms, tab->sym_count, sizeof(emcs51_symbol_t), emcs51_symtab_sym_cmp);
+
+    if (tab->line_count > 1)
+        qsort(tab->lines, tab->line_count, sizeof(emcs51_line_t), emcs51_symtab_line_cmp);
+
+    for (uint32_t i = 0; i < tab->line_count; i++)
+    {
+        if ((out > 0) && (tab->lines[out - 1].addr == tab->lines[i].addr))
+            continue;
+
+        tab->lines[out++] = tab->lines[i];
+    }
+
+    tab->line_count = out;
+    tab->sorted = 1;
+}
+
+/*******************************************************************************
+ * @brief 查找包含某地址的符号
+ * @param tab   符号表结构体指针
+ * @param space 地址空间 emcs51_space_types_t
+ * @param addr  地址
+ * @return 符号指针，找不到返回NULL
+ * @details 二分查找，不做字符串操作，可在执行热路径中调用
+ ******************************************************************************/
+const emcs51_symbol_t *emcs51_symtab_lookup(const emcs51_symtab_t *tab, uint8_t space, uint32_t addr)
+{
+    const emcs51_symbol_t *sym;
+    uint32_t lo = 0;
+    uint32_t hi;
+
+    if ((tab == NULL) || (tab->sorted == 0))
+        return NULL;
+
+    hi = tab->sym_count;
+
+    // 找到最后一个 (space, addr) <= 目标的符号
+    while (lo < hi)
+    {
+        uint32_t mid = lo + ((hi - lo) >> 1);
+        const emcs51_symbol_t *m = &tab->syms[mid];
+
+        if ((m->space < space) || ((m->space == space) && (m->addr <= addr)))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0)
+        return NULL;
+
+    sym = &tab->syms[lo - 1];
+
+    if (sym->space != space)
+        return NULL;
+
+    if ((sym->size != 0) && ((addr - sym->addr) >= sym->size))
+        return NULL;
+
+    return sym;
+}
+
+/*******************************************************************************
+ * @brief 查找某code区地址所在的源代码行
+ * @param tab  符号表结构体指针
+ * @param addr code区地址
+ * @return 行号记录指针，找不到返回NULL
+ ******************************************************************************/
+const emcs51_line_t *emcs51_symtab_find_line(const emcs51_symtab_t *tab, uint32_t addr)
+{
+    uint32_t lo = 0;
+    uint32_t hi;
+
+    if ((tab == NULL) || (tab->sorted == 0))
+        return NULL;
+
+    hi = tab->line_count;
+
+    while (lo < hi)
+    {
+        uint32_t mid = lo + ((hi - lo) >> 1);
+
+        if (tab->lines[mid].addr <= addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0)
+        return NULL;
+
+    return &tab->lines[lo - 1];
+}
+
+/*******************************************************************************
+ * @brief 按名称查找符号
+ * @param tab  符号表结构体指针
+ * @param name 符号名
+ * @return 符号指针，找不到返回NULL
+ * @details 线性查找，用于设置断点等非热路径场合
+ ******************************************************************************/
+const emcs51_symbol_t *emcs51_symtab_find_name(const emcs51_symtab_t *tab, const char *name)
+{
+    if ((tab == NULL) || (name == NULL))
+        return NULL;
+
+    for (uint32_t i = 0; i < tab->sym_count; i++)
+    {
+        if (strcmp(&tab->strings[tab->syms[i].name], name) == 0)
+            return &tab->syms[i];
+    }
+
+    return NULL;
+}
+
+const char *emcs51_symtab_string(const emcs51_symtab_t *tab, uint32_t offset)
+{
+    if ((tab == NULL) || (offset >= tab->str_len))
+        return "";
+
+    return &tab->strings[offset];
+}
@@ -0,0 +1,62 @@
+#ifndef EMCS51_SYMTAB_H
+#define EMCS51_SYMTAB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum EMCS51_SYMBOL_KINDS
+{
+    EMCS51_SYMBOL_LABEL = 0, // code区标号
+    EMCS51_SYMBOL_FUNC,      // 函数
+    EMCS51_SYMBOL_DATA,      // 变量
+} emcs51_symbol_kinds_t;
+
+typedef struct EMCS51_SYMBOL
+{
+    uint32_t addr;
+    uint32_t size;  // 0 表示延伸到同一空间的下一个符号
+    uint32_t name;  // 字符串表偏移
+    uint8_t space;  // emcs51_space_types_t
+    uint8_t kind;   // emcs51_symbol_kinds_t
+} emcs51_symbol_t;
+
+typedef struct EMCS51_LINE
+{
+    uint32_t addr; // code区地址
+    uint32_t line;
+    uint32_t file; // 字符串表偏移
+} emcs51_line_t;
+
+typedef struct EMCS51_SYMTAB
+{
+    emcs51_symbol_t *syms;
+    uint32_t sym_count;
+    uint32_t sym_cap;
+
+    emcs51_line_t *lines;
+    uint32_t line_count;
+    uint32_t line_cap;
+
+    char *strings;
+    uint32_t str_len;
+    uint32_t str_cap;
+    uint32_t last_file; // 最近一次添加的文件名，行号记录大多连续属于同一文件
+
+    uint8_t sorted;
+} emcs51_symtab_t;
+
+void emcs51_symtab_init(emcs51_symtab_t *tab);
+void emcs51_symtab_deinit(emcs51_symtab_t *tab);
+
+int emcs51_symtab_add(emcs51_symtab_t *tab, uint8_t space, uint32_t addr, uint32_t size, uint8_t kind, const char *name, uint32_t name_len);
+int emcs51_symtab_add_line(emcs51_symtab_t *tab, uint32_t addr, const char *file, uint32_t file_len, uint32_t line);
+void emcs51_symtab_finalize(emcs51_symtab_t *tab);
+
+const emcs51_symbol_t *emcs51_symtab_lookup(const emcs51_symtab_t *tab, uint8_t space, uint32_t addr);
+const emcs51_line_t *emcs51_symtab_find_line(const emcs51_symtab_t *tab, uint32_t addr);
+const emcs51_symbol_t *emcs51_symtab_find_name(const emcs51_symtab_t *tab, const char *name);
+
+// 取符号名/文件名，仅用于输出，不应在执行热路径中调用
+const char *emcs51_symtab_string(const emcs51_symtab_t *tab, uint32_t offset);
+
+#endif // EMCS51_SYMTAB_H
@@ -0,0 +1,397 @@
+#include <stdlib.h>
+#include "emcs51.h"
+
+#if EMCS51_PROFILE_ENABLE
+
+typedef enum EMCS51_PROFILE_OPS
+{
+    EMCS51_PROFILE_OP_NONE = 0,
+    EMCS51_PROFILE_OP_CALL,
+    EMCS51_PROFILE_OP_RET,
+} emcs51_profile_ops_t;
+
+// 改变调用栈的指令：LCALL、ACALL（8个页）、RET、RETI
+static const uint8_t emcs51_profile_ops[256] = {
+    [0x11] = EMCS51_PROFILE_OP_CALL,
+    [0x12] = EMCS51_PROFILE_OP_CALL,
+    [0x22] = EMCS51_PROFILE_OP_RET,
+    [0x31] = EMCS51_PROFILE_OP_CALL,
+    [0x32] = EMCS51_PROFILE_OP_RET,
+    [0x51] = EMCS51_PROFILE_OP_CALL,
+    [0x71] = EMCS51_PROFILE_OP_CALL,
+    [0x91] = EMCS51_PROFILE_OP_CALL,
+    [0xB1] = EMCS51_PROFILE_OP_CALL,
+    [0xD1] = EMCS51_PROFILE_OP_CALL,
+    [0xF1] = EMCS51_PROFILE_OP_CALL,
+};
+
+/*******************************************************************************
+ * @brief 开始剖析，之后 emcs51_core_inc() 每执行一条指令调用 emcs51_profile_inst()
+ * @param prof 剖析结构体指针，约1.3MB，应静态或在堆上分配
+ * @param core 核心结构体指针
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_profile_init(emcs51_profile_t *prof, emcs51_core_t *core)
+{
+    if ((prof == NULL) || (core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    prof->core = core;
+    emcs51_profile_reset(prof);
+
+    core->profile = prof;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 从核心上移除，已统计的数据保留
+ * @param prof 剖析结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_profile_deinit(emcs51_profile_t *prof)
+{
+    if (prof->core->profile == prof)
+        prof->core->profile = NULL;
+}
+
+/*******************************************************************************
+ * @brief 清空统计，调用上下文树从当前PC重新开始
+ * @param prof 剖析结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_profile_reset(emcs51_profile_t *prof)
+{
+    emcs51_core_t *core = prof->core;
+
+    memset(prof, 0, sizeof(emcs51_profile_t));
+
+    prof->core = core;
+    prof->node_count = 1;
+    prof->cur = EMCS51_PROFILE_ROOT;
+    prof->nodes[EMCS51_PROFILE_ROOT].func = core->reg.pc;
+}
+
+/*******************************************************************************
+ * @brief 进入被调用函数：在当前节点下查找或新建子节点
+ ******************************************************************************/
+static void emcs51_profile_call(emcs51_profile_t *prof)
+{
+    emcs51_profile_node_t *parent = &prof->nodes[prof->cur];
+    uint16_t func = prof->core->reg.pc;
+    uint16_t index = parent->child;
+
+    // 未入栈的调用返回时SP不小于栈顶帧，调用栈保持正确
+    if (prof->depth >= EMCS51_PROFILE_DEPTH_MAX)
+    {
+        prof->depth_overflow++;
+        return;
+    }
+
+    while ((index != 0) && (prof->nodes[index].func != func))
+        index = prof->nodes[index].sibling;
+
+    if ((index == 0) && (prof->node_count < EMCS51_PROFILE_NODE_MAX))
+    {
+        emcs51_profile_node_t *node;
+
+        index = (uint16_t)prof->node_count++;
+        node = &prof->nodes[index];
+        node->func = func;
+        node->parent = prof->cur;
+        node->sibling = parent->child;
+        parent->child = index;
+    }
+
+    prof->frames[prof->depth].node = prof->cur;
+    prof->frames[prof->depth].sp = prof->core->reg.sp;
+    prof->depth++;
+
+    if (index == 0)
+    {
+        prof->node_overflow++;
+        return;
+    }
+
+    prof->nodes[index].calls++;
+    prof->cur = index;
+}
+
+/*******************************************************************************
+ * @brief 返回：弹出SP已回退到其下的帧，也处理丢弃返回地址后直接跳转的情况
+ ******************************************************************************/
+static void emcs51_profile_ret(emcs51_profile_t *prof)
+{
+    uint8_t sp = prof->core->reg.sp;
+
+    while ((prof->depth > 0) && (prof->frames[prof->depth - 1].sp > sp))
+    {
+        prof->depth--;
+        prof->cur = prof->frames[prof->depth].node;
+    }
+}
+
+/*******************************************************************************
+ * @brief 记录一条已执行的指令，由 emcs51_core_inc() 调用
+ * @param prof   剖析结构体指针
+ * @param pc     指令地址
+ * @param opcode 操作码
+ * @param cycles 指令消耗的机器周期数
+ * @return none
+ ******************************************************************************/
+void emcs51_profile_inst(emcs51_profile_t *prof, uint16_t pc, uint8_t opcode, uint32_t cycles)
+{
+    emcs51_profile_node_t *node = &prof->nodes[prof->cur];
+
+    prof->inst[pc]++;
+    prof->cycles[pc] += cycles;
+    node->self_inst++;
+    node->self_cycles += cycles;
+
+    switch (emcs51_profile_ops[opcode])
+    {
+    case EMCS51_PROFILE_OP_CALL:
+        emcs51_profile_call(prof);
+        break;
+    case EMCS51_PROFILE_OP_RET:
+        emcs51_profile_ret(prof);
+        break;
+    default:
+        break;
+    }
+}
+
+static int emcs51_profile_func_cmp(const void *a, const void *b)
+{
+    const emcs51_profile_func_t *fa = (const emcs51_profile_func_t *)a;
+    const emcs51_profile_func_t *fb = (const emcs51_profile_func_t *)b;
+
+    if (fa->self_cycles != fb->self_cycles)
+        return (fa->self_cycles < fb->self_cycles) ? 1 : -1;
+
+    return (int)fa->func - (int)fb->func;
+}
+
+/*******************************************************************************
+ * @brief 计算各节点的总周期并按函数汇总到 prof->funcs，按自身周期降序排列
+ * @param prof 剖析结构体指针
+ * @return 函数数
+ ******************************************************************************/
+uint32_t emcs51_profile_summarize(emcs51_profile_t *prof)
+{
+    uint32_t func_count = 0;
+
+    // 子节点总在父节点之后分配，倒序累加即得到总周期
+    for (uint32_t i = 0; i < prof->node_count; i++)
+        prof->nodes[i].total_cycles = prof->nodes[i].self_cycles;
+
+    for (uint32_t i = prof->node_count - 1; i > 0; i--)
+        prof->nodes[prof->nodes[i].parent].total_cycles += prof->nodes[i].total_cycles;
+
+    for (uint32_t i = 0; i < prof->node_count; i++)
+    {
+        const emcs51_profile_node_t *node = &prof->nodes[i];
+        emcs51_profile_func_t *func = NULL;
+        uint32_t j;
+        uint16_t up;
+        uint8_t outer;
+
+        for (j = 0; j < func_count; j++)
+        {
+            if (prof->funcs[j].func == node->func)
+            {
+                func = &prof->funcs[j];
+                break;
+            }
+        }
+
+        if (func == NULL)
+        {
+            func = &prof->funcs[func_count++];
+            memset(func, 0, sizeof(emcs51_profile_func_t));
+            func->func = node->func;
+        }
+
+        func->calls += node->calls;
+        func->self_inst += node->self_inst;
+        func->self_cycles += node->self_cycles;
+
+        // 递归时外层节点的总周期已包含内层
+        outer = 1;
+        for (up = (uint16_t)i; up != EMCS51_PROFILE_ROOT;)
+        {
+            up = prof->nodes[up].parent;
+            if (prof->nodes[up].func == node->func)
+            {
+                outer = 0;
+                break;
+            }
+        }
+
+        if (outer)
+            func->total_cycles += node->total_cycles;
+    }
+
+    qsort(prof->funcs, func_count, sizeof(emcs51_profile_func_t), emcs51_profile_func_cmp);
+
+    return func_count;
+}
+
+/*******************************************************************************
+ * @brief code区地址的名称：符号、符号+偏移或十六进制地址
+ ******************************************************************************/
+static void emcs51_profile_name(const emcs51_symtab_t *symtab, uint16_t addr, char *buf, uint32_t size)
+{
+    const emcs51_symbol_t *sym = emcs51_symtab_lookup(symtab, EMCS51_SPACE_CODE, addr);
+
+    if (sym == NULL)
+        snprintf(buf, size, "%04X", addr);
+    else if (sym->addr == addr)
+        snprintf(buf, size, "%s", emcs51_symtab_string(symtab, sym->name));
+    else
+        snprintf(buf, size, "%s+%X", emcs51_symtab_string(symtab, sym->name), (unsigned)(addr - sym->addr));
+}
+
+static int emcs51_profile_puts(emcs51_profile_write_cb_t write_cb, void *user, const char *s)
+{
+    uint32_t len = (uint32_t)strlen(s);
+
+    if (write_cb(user, (const uint8_t *)s, len) != (int)len)
+        return EMCS51_ERR_STREAM;
+
+    return EMCS51_OK;
+}
+
+static double emcs51_profile_percent(uint64_t part, uint64_t total)
+{
+    return (total != 0) ? (100.0 * (double)part / (double)total) : 0.0;
+}
+
+/*******************************************************************************
+ * @brief 输出平面剖析：按函数的自身/总周期，以及最热的指令地址
+ * @param prof     剖析结构体指针
+ * @param symtab   符号表，NULL 时以地址表示函数
+ * @param top      输出的指令地址数
+ * @param write_cb 输出回调
+ * @param user     回调参数
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_profile_report(emcs51_profile_t *prof, const emcs51_symtab_t *symtab, uint32_t top, emcs51_profile_write_cb_t write_cb, void *user)
+{
+    uint32_t func_count = emcs51_profile_summarize(prof);
+    const emcs51_profile_node_t *root = &prof->nodes[EMCS51_PROFILE_ROOT];
+    uint64_t total_inst = 0;
+    uint64_t last = UINT64_MAX;
+    uint32_t last_pc = 0;
+    char name[128];
+    char line[256];
+    int err;
+
+    for (uint32_t i = 0; i < prof->node_count; i++)
+        total_inst += prof->nodes[i].self_inst;
+
+    snprintf(line, sizeof(line), "inst:%llu cycles:%llu nodes:%u node_overflow:%llu depth_overflow:%llu\n", (unsigned long long)total_inst,
+             (unsigned long long)root->total_cycles, (unsigned)prof->node_count, (unsigned long long)prof->node_overflow,
+             (unsigned long long)prof->depth_overflow);
+    err = emcs51_profile_puts(write_cb, user, line);
+    if (err == EMCS51_OK)
+        err = emcs51_profile_puts(write_cb, user, "\n  self%      self_cycles  total%     total_cycles      calls  function\n");
+
+    for (uint32_t i = 0; (err == EMCS51_OK) && (i < func_count); i++)
+    {
+        const emcs51_profile_func_t *func = &prof->funcs[i];
+
+        emcs51_profile_name(symtab, func->func, name, sizeof(name));
+        snprintf(line, sizeof(line), "%7.2f %16llu %7.2f %16llu %10u  %s\n", emcs51_profile_percent(func->self_cycles, root->total_cycles),
+                 (unsigned long long)func->self_cycles, emcs51_profile_percent(func->total_cycles, root->total_cycles),
+                 (unsigned long long)func->total_cycles, (unsigned)func->calls, name);
+        err = emcs51_profile_puts(write_cb, user, line);
+    }
+
+    if ((err == EMCS51_OK) && (top > 0))
+        err = emcs51_profile_puts(write_cb, user, "\n cycles%           cycles             inst  address\n");
+
+    // 每轮取小于上一轮（相同时地址更大）的最大值，不需要排序的临时空间
+    for (uint32_t n = 0; (err == EMCS51_OK) && (n < top); n++)
+    {
+        uint64_t best = 0;
+        uint32_t best_pc = 0x10000;
+
+        for (uint32_t pc = 0; pc < 0x10000; pc++)
+        {
+            uint64_t c = prof->cycles[pc];
+
+            if ((c == 0) || (c > last) || ((c == last) && (pc <= last_pc)) || (c <= best))
+                continue;
+
+            best = c;
+            best_pc = pc;
+        }
+
+        if (best_pc == 0x10000)
+            break;
+
+        last = best;
+        last_pc = best_pc;
+
+        // 没有符号时只输出地址
+        if (emcs51_symtab_lookup(symtab, EMCS51_SPACE_CODE, best_pc) != NULL)
+            emcs51_profile_name(symtab, (uint16_t)best_pc, name, sizeof(name));
+        else
+            name[0] = '\0';
+
+        snprintf(line, sizeof(line), "%7.2f %16llu %16llu  %04X%s%s\n", emcs51_profile_percent(best, root->total_cycles), (unsigned long long)best,
+                 (unsigned long long)prof->inst[best_pc], (unsigned)best_pc, (name[0] != '\0') ? " " : "", name);
+        err = emcs51_profile_puts(write_cb, user, line);
+    }
+
+    return err;
+}
+
+/*******************************************************************************
+ * @brief 输出折叠调用栈，每行 "调用者;被调用者 自身周期"，可直接用于火焰图工具
+ * @param prof     剖析结构体指针
+ * @param symtab   符号表，NULL 时以地址表示函数
+ * @param write_cb 输出回调
+ * @param user     回调参数
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_profile_collapsed(emcs51_profile_t *prof, const emcs51_symtab_t *symtab, emcs51_profile_write_cb_t write_cb, void *user)
+{
+    uint16_t path[EMCS51_PROFILE_DEPTH_MAX + 1];
+    char name[128];
+    char count[32];
+    int err = EMCS51_OK;
+
+    for (uint32_t i = 0; (err == EMCS51_OK) && (i < prof->node_count); i++)
+    {
+        uint32_t depth = 0;
+
+        if (prof->nodes[i].self_cycles == 0)
+            continue;
+
+        for (uint16_t n = (uint16_t)i;; n = prof->nodes[n].parent)
+        {
+            path[depth++] = n;
+            if (n == EMCS51_PROFILE_ROOT)
+                break;
+        }
+
+        while ((err == EMCS51_OK) && (depth > 0))
+        {
+            depth--;
+            emcs51_profile_name(symtab, prof->nodes[path[depth]].func, name, sizeof(name));
+            err = emcs51_profile_puts(write_cb, user, name);
+            if ((err == EMCS51_OK) && (depth > 0))
+                err = emcs51_profile_puts(write_cb, user, ";");
+        }
+
+        snprintf(count, sizeof(count), " %llu\n", (unsigned long long)prof->nodes[i].self_cycles);
+        if (err == EMCS51_OK)
+            err = emcs51_profile_puts(write_cb, user, count);
+    }
+
+    return err;
+}
+
+#endif // EMCS51_PROFILE_ENABLE
@@ -0,0 +1,90 @@
+#ifndef EMCS51_PROFILE_H
+#define EMCS51_PROFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core/emcs51_core.h"
+#include "loader/emcs51_symtab.h"
+
+// 编译期开关，定义为0时核心中的剖析代码全部移除
+#ifndef EMCS51_PROFILE_ENABLE
+#define EMCS51_PROFILE_ENABLE 1
+#endif
+
+#if EMCS51_PROFILE_ENABLE
+
+// 调用上下文树的节点数，超出后新的调用计入调用者
+#ifndef EMCS51_PROFILE_NODE_MAX
+#define EMCS51_PROFILE_NODE_MAX 4096
+#endif
+
+#define EMCS51_PROFILE_DEPTH_MAX 128 // 8051 堆栈最多容纳的返回地址数
+#define EMCS51_PROFILE_ROOT 0
+
+// 调用上下文树的节点：同一函数经不同调用路径到达时为不同节点
+typedef struct EMCS51_PROFILE_NODE
+{
+    uint16_t func;    // 函数入口地址，根节点为开始统计时的PC
+    uint16_t parent;
+    uint16_t child;   // 第一个子节点，0 表示无（根节点不会是子节点）
+    uint16_t sibling; // 下一个兄弟节点，0 表示无
+    uint32_t calls;
+    uint64_t self_inst;
+    uint64_t self_cycles;
+    uint64_t total_cycles; // 包含被调用函数，由报告生成时计算
+} emcs51_profile_node_t;
+
+typedef struct EMCS51_PROFILE_FRAME
+{
+    uint16_t node;
+    uint8_t sp; // 调用后的SP，返回后SP小于它即出栈
+} emcs51_profile_frame_t;
+
+// 报告生成时按函数汇总
+typedef struct EMCS51_PROFILE_FUNC
+{
+    uint16_t func;
+    uint32_t calls;
+    uint64_t self_inst;
+    uint64_t self_cycles;
+    uint64_t total_cycles; // 递归调用只计最外层
+} emcs51_profile_func_t;
+
+// 精确剖析：按code区地址累计每条指令的执行次数和周期，并以 LCALL/ACALL 与 RET/RETI
+// 维护调用栈，将周期计入调用上下文树。code区地址为16位PC，分组窗口内不区分分组
+typedef struct EMCS51_PROFILE
+{
+    emcs51_core_t *core;
+
+    uint64_t inst[0x10000];
+    uint64_t cycles[0x10000];
+
+    emcs51_profile_node_t nodes[EMCS51_PROFILE_NODE_MAX];
+    uint32_t node_count;
+    uint16_t cur; // 当前节点
+
+    emcs51_profile_frame_t frames[EMCS51_PROFILE_DEPTH_MAX];
+    uint32_t depth;
+
+    uint64_t node_overflow;  // 节点用尽时未单独统计的调用数
+    uint64_t depth_overflow; // 调用栈超出 EMCS51_PROFILE_DEPTH_MAX 的调用数
+
+    emcs51_profile_func_t funcs[EMCS51_PROFILE_NODE_MAX]; // 报告用
+} emcs51_profile_t;
+
+// 与 emcs51_record_write_cb_t 相同，返回写入的字节数
+typedef int (*emcs51_profile_write_cb_t)(void *user, const uint8_t *data, uint32_t len);
+
+int emcs51_profile_init(emcs51_profile_t *prof, emcs51_core_t *core);
+void emcs51_profile_deinit(emcs51_profile_t *prof);
+void emcs51_profile_reset(emcs51_profile_t *prof);
+
+void emcs51_profile_inst(emcs51_profile_t *prof, uint16_t pc, uint8_t opcode, uint32_t cycles);
+
+uint32_t emcs51_profile_summarize(emcs51_profile_t *prof);
+int emcs51_profile_report(emcs51_profile_t *prof, const emcs51_symtab_t *symtab, uint32_t top, emcs51_profile_write_cb_t write_cb, void *user);
+int emcs51_profile_collapsed(emcs51_profile_t *prof, const emcs51_symtab_t *symtab, emcs51_profile_write_cb_t write_cb, void *user);
+
+#endif // EMCS51_PROFILE_ENABLE
+
+#endif // EMCS51_PROFILE_H
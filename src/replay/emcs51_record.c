@@ -0,0 +1,362 @@
+#include "emcs51.h"
+
+/*******************************************************************************
+ * @brief 把缓冲区写入输出流
+ ******************************************************************************/
+static void emcs51_recorder_flush(emcs51_recorder_t *rec)
+{
+    if (rec->buffer_len == 0)
+        return;
+
+    // 出错后丢弃数据，但仍清空缓冲区，否则后续写入越界
+    if ((rec->err >= 0) && (rec->write_cb(rec->user, rec->buffer, rec->buffer_len) != (int)rec->buffer_len))
+        rec->err = EMCS51_ERR_STREAM;
+
+    rec->buffer_len = 0;
+}
+
+/*******************************************************************************
+ * @brief 写入单个字节
+ ******************************************************************************/
+static void emcs51_recorder_putc(emcs51_recorder_t *rec, uint8_t c)
+{
+    if (rec->buffer_len >= sizeof(rec->buffer))
+        emcs51_recorder_flush(rec);
+
+    rec->buffer[rec->buffer_len++] = c;
+}
+
+/*******************************************************************************
+ * @brief 写入变长整数（LEB128）
+ ******************************************************************************/
+static void emcs51_recorder_put_varint(emcs51_recorder_t *rec, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        emcs51_recorder_putc(rec, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+
+    emcs51_recorder_putc(rec, (uint8_t)value);
+}
+
+/*******************************************************************************
+ * @brief 钩子回调：记录外部输入
+ * @details 每条输入编码为：周期增量(varint) 类型(1) 地址(varint) 数据(1)，
+ *          SFR读取通常只占4字节
+ ******************************************************************************/
+static void emcs51_recorder_record_cb(void *ctx, emcs51_core_t *core, const emcs51_input_t *input)
+{
+    emcs51_recorder_t *rec = (emcs51_recorder_t *)ctx;
+
+    emcs51_recorder_put_varint(rec, input->cycle - rec->last_cycle);
+    emcs51_recorder_putc(rec, input->type);
+    emcs51_recorder_put_varint(rec, input->addr);
+    emcs51_recorder_putc(rec, input->data);
+
+    rec->last_cycle = input->cycle;
+    rec->count++;
+}
+
+/*******************************************************************************
+ * @brief 初始化记录器，开始记录核心的外部输入
+ * @param rec      记录器结构体指针
+ * @param core     核心结构体指针
+ * @param write_cb 流写入回调
+ * @param user     流写入回调的用户参数
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_recorder_init(emcs51_recorder_t *rec, emcs51_core_t *core, emcs51_record_write_cb_t write_cb, void *user)
+{
+    if ((rec == NULL) || (core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    if (write_cb == NULL)
+        return EMCS51_ERR;
+
+    memset(rec, 0, sizeof(emcs51_recorder_t));
+
+    rec->core = core;
+    rec->write_cb = write_cb;
+    rec->user = user;
+    rec->last_cycle = core->cycles;
+
+    memcpy(rec->buffer, EMCS51_RECORD_MAGIC, 7);
+    rec->buffer[7] = EMCS51_RECORD_VERSION;
+    rec->buffer_len = 8;
+
+    // the stream starts at the current cycle count of the core
+    emcs51_recorder_put_varint(rec, core->cycles);
+
+    rec->hook.record_cb = emcs51_recorder_record_cb;
+    rec->hook.ctx = rec;
+
+    emcs51_core_set_hook(core, &rec->hook);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 结束记录，写入结束标记并刷新输出流
+ * @param rec 记录器结构体指针
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_recorder_deinit(emcs51_recorder_t *rec)
+{
+    if ((rec == NULL) || (rec->core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    if (rec->core->hook == &rec->hook)
+        emcs51_core_set_hook(rec->core, NULL);
+
+    emcs51_recorder_put_varint(rec, 0);
+    emcs51_recorder_putc(rec, EMCS51_RECORD_END);
+    emcs51_recorder_flush(rec);
+
+    rec->core = NULL;
+
+    return rec->err;
+}
+
+/*******************************************************************************
+ * @brief 读取单个字节
+ * @return 1 成功，0 流结束
+ ******************************************************************************/
+static int emcs51_replayer_getc(emcs51_replayer_t *rp, uint8_t *c)
+{
+    if (rp->buffer_pos >= rp->buffer_len)
+    {
+        int len = rp->read_cb(rp->user, rp->buffer, sizeof(rp->buffer));
+
+        if (len <= 0)
+            return 0;
+
+        rp->buffer_pos = 0;
+        rp->buffer_len = (uint32_t)len;
+    }
+
+    *c = rp->buffer[rp->buffer_pos++];
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 读取变长整数（LEB128）
+ * @return 1 成功，0 流结束
+ ******************************************************************************/
+static int emcs51_replayer_get_varint(emcs51_replayer_t *rp, uint64_t *value)
+{
+    uint64_t result = 0;
+    uint8_t shift = 0;
+    uint8_t c;
+
+    do
+    {
+        if ((shift > 63) || (emcs51_replayer_getc(rp, &c) == 0))
+            return 0;
+
+        result |= (uint64_t)(c & 0x7F) << shift;
+        shift += 7;
+    } while (c & 0x80);
+
+    *value = result;
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 预读下一条输入
+ ******************************************************************************/
+static void emcs51_replayer_advance(emcs51_replayer_t *rp)
+{
+    uint64_t delta;
+    uint64_t addr;
+    uint8_t type;
+    uint8_t data;
+
+    rp->has_next = 0;
+
+    if ((emcs51_replayer_get_varint(rp, &delta) == 0) || (emcs51_replayer_getc(rp, &type) == 0))
+    {
+        rp->finished = 1;
+        return;
+    }
+
+    if (type == EMCS51_RECORD_END)
+    {
+        rp->finished = 1;
+        return;
+    }
+
+    if ((emcs51_replayer_get_varint(rp, &addr) == 0) || (emcs51_replayer_getc(rp, &data) == 0))
+    {
+        rp->err = EMCS51_ERR_STREAM;
+        rp->finished = 1;
+        return;
+    }
+
+    rp->last_cycle += delta;
+
+    rp->next.cycle = rp->last_cycle;
+    rp->next.type = type;
+    rp->next.addr = (uint16_t)addr;
+    rp->next.data = data;
+    rp->has_next = 1;
+}
+
+/*******************************************************************************
+ * @brief 让已到期的异步输入生效
+ ******************************************************************************/
+static void emcs51_replayer_apply_async(emcs51_replayer_t *rp, uint8_t all)
+{
+    emcs51_core_t *core = rp->core;
+
+    while (rp->has_next && EMCS51_INPUT_IS_ASYNC(rp->next.type))
+    {
+        if ((all == 0) && (rp->next.cycle > core->cycles))
+            break;
+
+        if (core->input_cb)
+            core->input_cb(core, core->user, &rp->next);
+
+        rp->count++;
+        emcs51_replayer_advance(rp);
+    }
+}
+
+/*******************************************************************************
+ * @brief 钩子回调：从日志回放外部输入
+ ******************************************************************************/
+static int emcs51_replayer_replay_cb(void *ctx, emcs51_core_t *core, emcs51_input_t *input)
+{
+    emcs51_replayer_t *rp = (emcs51_replayer_t *)ctx;
+
+    if (rp->finished)
+        return 0;
+
+    // asynchronous inputs are delivered from the log while replaying
+    if (EMCS51_INPUT_IS_ASYNC(input->type))
+        return 1;
+
+    emcs51_replayer_apply_async(rp, 1);
+
+    if (rp->has_next == 0)
+        return 0;
+
+    if ((rp->next.type != input->type) || (rp->next.addr != input->addr) || (rp->next.cycle != input->cycle))
+    {
+        rp->err = EMCS51_ERR_REPLAY_DIVERGED;
+        core->err = EMCS51_ERR_REPLAY_DIVERGED;
+    }
+
+    input->data = rp->next.data;
+    rp->count++;
+    emcs51_replayer_advance(rp);
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 初始化回放器，之后的外部输入全部来自日志，不调用用户回调
+ * @param rp      回放器结构体指针
+ * @param core    核心结构体指针，状态须与记录开始时一致
+ * @param read_cb 流读取回调
+ * @param user    流读取回调的用户参数
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_replayer_init(emcs51_replayer_t *rp, emcs51_core_t *core, emcs51_record_read_cb_t read_cb, void *user)
+{
+    uint8_t header[8];
+    uint64_t start_cycle;
+
+    if ((rp == NULL) || (core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    if (read_cb == NULL)
+        return EMCS51_ERR;
+
+    memset(rp, 0, sizeof(emcs51_replayer_t));
+
+    rp->core = core;
+    rp->read_cb = read_cb;
+    rp->user = user;
+
+    for (uint32_t i = 0; i < sizeof(header); i++)
+    {
+        if (emcs51_replayer_getc(rp, &header[i]) == 0)
+            return EMCS51_ERR_STREAM;
+    }
+
+    if ((memcmp(header, EMCS51_RECORD_MAGIC, 7) != 0) || (header[7] != EMCS51_RECORD_VERSION))
+        return EMCS51_ERR_STREAM;
+
+    if (emcs51_replayer_get_varint(rp, &start_cycle) == 0)
+        return EMCS51_ERR_STREAM;
+
+    if (start_cycle != core->cycles)
+        return EMCS51_ERR_REPLAY_DIVERGED;
+
+    rp->last_cycle = start_cycle;
+    emcs51_replayer_advance(rp);
+
+    rp->hook.replay_cb = emcs51_replayer_replay_cb;
+    rp->hook.ctx = rp;
+
+    emcs51_core_set_hook(core, &rp->hook);
+
+    return rp->err;
+}
+
+/*******************************************************************************
+ * @brief 结束回放
+ * @param rp 回放器结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_replayer_deinit(emcs51_replayer_t *rp)
+{
+    if ((rp == NULL) || (rp->core == NULL))
+        return;
+
+    if (rp->core->hook == &rp->hook)
+        emcs51_core_set_hook(rp->core, NULL);
+
+    rp->core = NULL;
+}
+
+/*******************************************************************************
+ * @brief 回放单步执行，先让到期的异步输入生效
+ * @param rp 回放器结构体指针
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_replayer_step(emcs51_replayer_t *rp)
+{
+    emcs51_core_t *core = rp->core;
+
+    if (core->err < 0)
+        return core->err;
+
+    emcs51_replayer_apply_async(rp, 0);
+
+    emcs51_core_inc(core);
+
+    if (rp->err < 0)
+        return rp->err;
+
+    return (core->err < 0) ? core->err : EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 流写入回调：写入 FILE*，user 为 FILE 指针
+ ******************************************************************************/
+int emcs51_record_file_write_cb(void *user, const uint8_t *data, uint32_t len)
+{
+    return (int)fwrite(data, 1, len, (FILE *)user);
+}
+
+/*******************************************************************************
+ * @brief 流读取回调：读取 FILE*，user 为 FILE 指针
+ ******************************************************************************/
+int emcs51_record_file_read_cb(void *user, uint8_t *data, uint32_t len)
+{
+    return (int)fread(data, 1, len, (FILE *)user);
+}
@@ -0,0 +1,66 @@
+#ifndef EMCS51_RECORD_H
+#define EMCS51_RECORD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "core/emcs51_core.h"
+
+#define EMCS51_RECORD_MAGIC "EMCS51R"
+#define EMCS51_RECORD_VERSION 1
+#define EMCS51_RECORD_END 0xFF // 结束标记，占用类型字节
+
+#define EMCS51_RECORD_BUFFER_SIZE 256
+
+// 流写入回调，返回写入的字节数
+typedef int (*emcs51_record_write_cb_t)(void *user, const uint8_t *data, uint32_t len);
+// 流读取回调，返回读取的字节数，0 表示结束
+typedef int (*emcs51_record_read_cb_t)(void *user, uint8_t *data, uint32_t len);
+
+typedef struct EMCS51_RECORDER
+{
+    emcs51_core_t *core;
+    emcs51_core_hook_t hook;
+
+    emcs51_record_write_cb_t write_cb;
+    void *user;
+
+    uint64_t last_cycle;
+    uint32_t count; // 已记录的输入数
+    int err;
+
+    uint32_t buffer_len;
+    uint8_t buffer[EMCS51_RECORD_BUFFER_SIZE];
+} emcs51_recorder_t;
+
+typedef struct EMCS51_REPLAYER
+{
+    emcs51_core_t *core;
+    emcs51_core_hook_t hook;
+
+    emcs51_record_read_cb_t read_cb;
+    void *user;
+
+    emcs51_input_t next; // 预读的下一条输入
+    uint8_t has_next;
+    uint8_t finished; // 日志已读完，之后的输入直接调用用户回调
+    uint64_t last_cycle;
+    uint32_t count; // 已回放的输入数
+    int err;
+
+    uint32_t buffer_pos;
+    uint32_t buffer_len;
+    uint8_t buffer[EMCS51_RECORD_BUFFER_SIZE];
+} emcs51_replayer_t;
+
+int emcs51_recorder_init(emcs51_recorder_t *rec, emcs51_core_t *core, emcs51_record_write_cb_t write_cb, void *user);
+int emcs51_recorder_deinit(emcs51_recorder_t *rec);
+
+int emcs51_replayer_init(emcs51_replayer_t *rp, emcs51_core_t *core, emcs51_record_read_cb_t read_cb, void *user);
+void emcs51_replayer_deinit(emcs51_replayer_t *rp);
+int emcs51_replayer_step(emcs51_replayer_t *rp);
+
+int emcs51_record_file_write_cb(void *user, const uint8_t *data, uint32_t len);
+int emcs51_record_file_read_cb(void *user, uint8_t *data, uint32_t len);
+
+#endif // EMCS51_RECORD_H
@@ -0,0 +1,388 @@
+#include "emcs51.h"
+
+#define EMCS51_REWIND_ALIGN(x) (((x) + (uintptr_t)7) & ~(uintptr_t)7)
+
+/*******************************************************************************
+ * @brief 取第 i 个检查点（0 为最旧）
+ ******************************************************************************/
+static emcs51_rewind_checkpoint_t *emcs51_rewind_checkpoint(emcs51_rewind_t *rw, uint32_t i)
+{
+    return &rw->checkpoints[(rw->checkpoint_head + i) % rw->checkpoint_cap];
+}
+
+/*******************************************************************************
+ * @brief 当前位置对应的输入日志序号
+ ******************************************************************************/
+static uint64_t emcs51_rewind_input_seq(emcs51_rewind_t *rw)
+{
+    if (rw->core->inst_count < rw->live_inst_count)
+        return rw->replay_seq;
+
+    return rw->input_head;
+}
+
+/*******************************************************************************
+ * @brief 保存检查点，缓冲区满时覆盖最旧的检查点
+ ******************************************************************************/
+static int emcs51_rewind_take_checkpoint(emcs51_rewind_t *rw)
+{
+    emcs51_rewind_checkpoint_t *cp;
+
+    if (rw->checkpoint_count < rw->checkpoint_cap)
+    {
+        cp = emcs51_rewind_checkpoint(rw, rw->checkpoint_count);
+        rw->checkpoint_count++;
+    }
+    else
+    {
+        cp = emcs51_rewind_checkpoint(rw, 0);
+        rw->checkpoint_head = (rw->checkpoint_head + 1) % rw->checkpoint_cap;
+    }
+
+    cp->input_seq = emcs51_rewind_input_seq(rw);
+
+    return emcs51_snapshot_take(rw->core, &cp->snap);
+}
+
+/*******************************************************************************
+ * @brief 回放时让已记录的异步输入生效
+ ******************************************************************************/
+static void emcs51_rewind_apply_async(emcs51_rewind_t *rw, uint8_t all)
+{
+    emcs51_core_t *core = rw->core;
+
+    while (rw->replay_seq < rw->input_head)
+    {
+        emcs51_input_t *input = &rw->input_log[rw->replay_seq % rw->input_log_len];
+
+        if (!EMCS51_INPUT_IS_ASYNC(input->type))
+            break;
+
+        if ((all == 0) && (input->cycle > core->cycles))
+            break;
+
+        if (core->input_cb)
+            core->input_cb(core, core->user, input);
+
+        rw->replay_seq++;
+    }
+}
+
+/*******************************************************************************
+ * @brief 钩子回调：回放外部输入
+ ******************************************************************************/
+static int emcs51_rewind_replay_cb(void *ctx, emcs51_core_t *core, emcs51_input_t *input)
+{
+    emcs51_rewind_t *rw = (emcs51_rewind_t *)ctx;
+
+    if (core->inst_count >= rw->live_inst_count)
+        return 0;
+
+    // asynchronous inputs are delivered from the log while replaying
+    if (EMCS51_INPUT_IS_ASYNC(input->type))
+        return 1;
+
+    emcs51_rewind_apply_async(rw, 1);
+
+    if (rw->replay_seq >= rw->input_head)
+        return 0;
+
+    input->data = rw->input_log[rw->replay_seq % rw->input_log_len].data;
+    rw->replay_seq++;
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 钩子回调：记录外部输入，日志满时丢弃无法回放的旧检查点
+ ******************************************************************************/
+static void emcs51_rewind_record_cb(void *ctx, emcs51_core_t *core, const emcs51_input_t *input)
+{
+    emcs51_rewind_t *rw = (emcs51_rewind_t *)ctx;
+
+    while (rw->checkpoint_count > 0)
+    {
+        emcs51_rewind_checkpoint_t *oldest = emcs51_rewind_checkpoint(rw, 0);
+
+        if ((rw->input_head - oldest->input_seq) < rw->input_log_len)
+            break;
+
+        rw->checkpoint_head = (rw->checkpoint_head + 1) % rw->checkpoint_cap;
+        rw->checkpoint_count--;
+    }
+
+    rw->input_log[rw->input_head % rw->input_log_len] = *input;
+    rw->input_head++;
+}
+
+/*******************************************************************************
+ * @brief 钩子回调：存储器写入，用于查找上一次写入
+ ******************************************************************************/
+static void emcs51_rewind_write_cb(void *ctx, emcs51_core_t *core, uint8_t space, uint16_t addr, uint8_t data)
+{
+    emcs51_rewind_t *rw = (emcs51_rewind_t *)ctx;
+
+    if ((rw->watch_active == 0) || (space != rw->watch_space) || (addr != rw->watch_addr))
+        return;
+
+    rw->watch_found = 1;
+    rw->watch_hit = core->inst_count;
+}
+
+/*******************************************************************************
+ * @brief 初始化反向执行引擎
+ * @param rw     反向执行引擎结构体指针
+ * @param core   核心结构体指针，XDATA区需已设置
+ * @param config 配置参数
+ * @return emcs51_err_t
+ * @details 引擎通过核心钩子记录外部输入，期间核心不能再挂接其它钩子；
+ *          检查点使用COW快照，反复恢复同一检查点（如连续反向单步）时只拷贝脏页；
+ *          检查点会使其它COW快照的下一次保存退化为完整拷贝
+ ******************************************************************************/
+int emcs51_rewind_init(emcs51_rewind_t *rw, emcs51_core_t *core, const emcs51_rewind_config_t *config)
+{
+    uint8_t *buffer;
+    uint32_t offset;
+    uint32_t size;
+    uint64_t log_bytes;
+    uint32_t xdata_bytes;
+    uint32_t cp_bytes;
+
+    if ((rw == NULL) || (core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    if ((config == NULL) || (config->buffer == NULL) || (config->checkpoint_interval == 0))
+        return EMCS51_ERR;
+
+    memset(rw, 0, sizeof(emcs51_rewind_t));
+
+    buffer = (uint8_t *)EMCS51_REWIND_ALIGN((uintptr_t)config->buffer);
+    offset = (uint32_t)(buffer - (uint8_t *)config->buffer);
+
+    if (config->buffer_size <= offset)
+        return EMCS51_ERR;
+
+    size = config->buffer_size - offset;
+
+    xdata_bytes = EMCS51_REWIND_ALIGN(core->xdata_ram_size);
+    cp_bytes = EMCS51_REWIND_ALIGN(sizeof(emcs51_rewind_checkpoint_t)) + xdata_bytes;
+
+    if (size < cp_bytes)
+        return EMCS51_ERR;
+
+    rw->input_log_len = config->input_log_len;
+    if (rw->input_log_len == 0)
+        rw->input_log_len = (size / 8) / sizeof(emcs51_input_t);
+
+    // 先限制条目数再计算字节数，避免乘法溢出后通过大小检查
+    if ((rw->input_log_len == 0) || (rw->input_log_len > ((size - cp_bytes) / sizeof(emcs51_input_t))))
+        return EMCS51_ERR;
+
+    log_bytes = EMCS51_REWIND_ALIGN((uint64_t)rw->input_log_len * sizeof(emcs51_input_t));
+
+    if (((uint64_t)size - cp_bytes) < log_bytes)
+        return EMCS51_ERR;
+
+    rw->input_log = (emcs51_input_t *)buffer;
+    rw->checkpoint_cap = (uint32_t)((size - log_bytes) / cp_bytes);
+    rw->checkpoints = (emcs51_rewind_checkpoint_t *)(buffer + log_bytes);
+
+    uint8_t *xdata = buffer + log_bytes + (rw->checkpoint_cap * EMCS51_REWIND_ALIGN(sizeof(emcs51_rewind_checkpoint_t)));
+
+    for (uint32_t i = 0; i < rw->checkpoint_cap; i++)
+    {
+        emcs51_snapshot_init(&rw->checkpoints[i].snap, EMCS51_SNAPSHOT_COW, xdata + (i * xdata_bytes), core->xdata_ram_size);
+    }
+
+    rw->core = core;
+    rw->checkpoint_interval = config->checkpoint_interval;
+    rw->live_inst_count = core->inst_count;
+
+    rw->hook.replay_cb = emcs51_rewind_replay_cb;
+    rw->hook.record_cb = emcs51_rewind_record_cb;
+    rw->hook.write_cb = emcs51_rewind_write_cb;
+    rw->hook.ctx = rw;
+
+    emcs51_core_set_hook(core, &rw->hook);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 移除反向执行引擎
+ * @param rw 反向执行引擎结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_rewind_deinit(emcs51_rewind_t *rw)
+{
+    if ((rw == NULL) || (rw->core == NULL))
+        return;
+
+    if (rw->core->hook == &rw->hook)
+        emcs51_core_set_hook(rw->core, NULL);
+
+    rw->core = NULL;
+}
+
+/*******************************************************************************
+ * @brief 单步执行，按间隔保存检查点
+ * @param rw 反向执行引擎结构体指针
+ * @return emcs51_err_t
+ * @details 位于已执行过的历史中时，外部输入全部来自日志，不调用用户回调
+ ******************************************************************************/
+int emcs51_rewind_step(emcs51_rewind_t *rw)
+{
+    emcs51_core_t *core = rw->core;
+    int err;
+
+    if (core->err < 0)
+        return core->err;
+
+    if (core->inst_count < rw->live_inst_count)
+        emcs51_rewind_apply_async(rw, 0);
+
+    if ((rw->checkpoint_count == 0) ||
+        (core->inst_count >= (emcs51_rewind_checkpoint(rw, rw->checkpoint_count - 1)->snap.inst_count + rw->checkpoint_interval)))
+    {
+        err = emcs51_rewind_take_checkpoint(rw);
+        if (err < 0)
+            return err;
+    }
+
+    emcs51_core_inc(core);
+
+    if (core->inst_count > rw->live_inst_count)
+        rw->live_inst_count = core->inst_count;
+
+    return (core->err < 0) ? core->err : EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 从不晚于目标位置的最近检查点恢复，并确定性地回放到目标位置
+ * @param rw         反向执行引擎结构体指针
+ * @param inst_count 目标位置（已执行指令数）
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_rewind_goto(emcs51_rewind_t *rw, uint64_t inst_count)
+{
+    emcs51_rewind_checkpoint_t *cp = NULL;
+    emcs51_core_t *core;
+    int err;
+
+    if ((rw == NULL) || (rw->core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    core = rw->core;
+
+    if (inst_count > rw->live_inst_count)
+        return EMCS51_ERR;
+
+    for (uint32_t i = rw->checkpoint_count; i > 0; i--)
+    {
+        emcs51_rewind_checkpoint_t *it = emcs51_rewind_checkpoint(rw, i - 1);
+
+        if (it->snap.inst_count <= inst_count)
+        {
+            cp = it;
+            break;
+        }
+    }
+
+    if (cp == NULL)
+        return EMCS51_ERR;
+
+    err = emcs51_snapshot_restore(core, &cp->snap);
+    if (err < 0)
+        return err;
+
+    rw->replay_seq = cp->input_seq;
+
+    while (core->inst_count < inst_count)
+    {
+        err = emcs51_rewind_step(rw);
+        if (err < 0)
+            return err;
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 后退 n 条指令
+ * @param rw 反向执行引擎结构体指针
+ * @param n  后退的指令数
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_rewind_step_back(emcs51_rewind_t *rw, uint64_t n)
+{
+    if ((rw == NULL) || (rw->core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    if (n > rw->core->inst_count)
+        return EMCS51_ERR;
+
+    return emcs51_rewind_goto(rw, rw->core->inst_count - n);
+}
+
+/*******************************************************************************
+ * @brief 反向运行到上一次写入指定地址的指令
+ * @param rw    反向执行引擎结构体指针
+ * @param space 地址空间 emcs51_space_types_t
+ * @param addr  地址
+ * @return emcs51_err_t，找到时核心停在该写入指令执行之前；未找到时回到原位置并返回错误
+ * @details 从最近的检查点开始逐段向前搜索，每段只回放到上一段的起点
+ ******************************************************************************/
+int emcs51_rewind_back_to_write(emcs51_rewind_t *rw, uint8_t space, uint16_t addr)
+{
+    emcs51_core_t *core;
+    uint64_t origin;
+    uint64_t end;
+    int err = EMCS51_OK;
+
+    if ((rw == NULL) || (rw->core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    core = rw->core;
+    origin = core->inst_count;
+    end = origin;
+
+    rw->watch_space = space;
+    rw->watch_addr = addr;
+
+    for (uint32_t i = rw->checkpoint_count; i > 0; i--)
+    {
+        emcs51_rewind_checkpoint_t *cp = emcs51_rewind_checkpoint(rw, i - 1);
+
+        if (cp->snap.inst_count >= end)
+            continue;
+
+        err = emcs51_snapshot_restore(core, &cp->snap);
+        if (err < 0)
+            break;
+
+        rw->replay_seq = cp->input_seq;
+        rw->watch_found = 0;
+        rw->watch_active = 1;
+
+        while (core->inst_count < end)
+        {
+            err = emcs51_rewind_step(rw);
+            if (err < 0)
+                break;
+        }
+
+        rw->watch_active = 0;
+
+        if (err < 0)
+            break;
+
+        if (rw->watch_found)
+            return emcs51_rewind_goto(rw, rw->watch_hit);
+
+        end = cp->snap.inst_count;
+    }
+
+    emcs51_rewind_goto(rw, origin);
+
+    return (err < 0) ? err : EMCS51_ERR;
+}
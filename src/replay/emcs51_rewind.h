@@ -0,0 +1,57 @@
+#ifndef EMCS51_REWIND_H
+#define EMCS51_REWIND_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core/emcs51_core.h"
+#include "snapshot/emcs51_snapshot.h"
+
+typedef struct EMCS51_REWIND_CONFIG
+{
+    uint32_t checkpoint_interval; // 检查点间隔，单位：指令
+    void *buffer;                 // 内存预算，检查点与输入日志共用
+    uint32_t buffer_size;         // 内存预算大小
+    uint32_t input_log_len;       // 输入日志条目数，0 表示使用 buffer 的 1/8
+} emcs51_rewind_config_t;
+
+typedef struct EMCS51_REWIND_CHECKPOINT
+{
+    uint64_t input_seq; // 检查点时的输入日志序号
+    emcs51_snapshot_t snap;
+} emcs51_rewind_checkpoint_t;
+
+typedef struct EMCS51_REWIND
+{
+    emcs51_core_t *core;
+    emcs51_core_hook_t hook;
+
+    uint32_t checkpoint_interval;
+
+    emcs51_rewind_checkpoint_t *checkpoints; // 检查点环形缓冲区
+    uint32_t checkpoint_cap;
+    uint32_t checkpoint_head; // 最旧的检查点
+    uint32_t checkpoint_count;
+
+    emcs51_input_t *input_log; // 输入日志环形缓冲区
+    uint32_t input_log_len;
+    uint64_t input_head; // 已记录的输入总数
+    uint64_t replay_seq; // 回放位置
+
+    uint64_t live_inst_count; // 曾到达的最远位置，之前的位置全部由日志回放
+
+    uint8_t watch_active;
+    uint8_t watch_found;
+    uint8_t watch_space;
+    uint16_t watch_addr;
+    uint64_t watch_hit; // 最近一次写入目标地址的指令序号
+} emcs51_rewind_t;
+
+int emcs51_rewind_init(emcs51_rewind_t *rw, emcs51_core_t *core, const emcs51_rewind_config_t *config);
+void emcs51_rewind_deinit(emcs51_rewind_t *rw);
+
+int emcs51_rewind_step(emcs51_rewind_t *rw);
+int emcs51_rewind_goto(emcs51_rewind_t *rw, uint64_t inst_count);
+int emcs51_rewind_step_back(emcs51_rewind_t *rw, uint64_t n);
+int emcs51_rewind_back_to_write(emcs51_rewind_t *rw, uint8_t space, uint16_t addr);
+
+#endif // EMCS51_REWIND_H
@@ -0,0 +1,216 @@
+#include "emcs51.h"
+
+/*******************************************************************************
+ * @brief 按脏页标记拷贝XDATA区
+ * @param core 核心结构体指针
+ * @param dst  目标缓冲区
+ * @param src  源缓冲区
+ * @return 拷贝的页数
+ ******************************************************************************/
+static uint32_t emcs51_snapshot_copy_dirty(emcs51_core_t *core, uint8_t *dst, const uint8_t *src)
+{
+    uint32_t page_size = (uint32_t)1 << core->xdata_page_shift;
+    uint32_t page_count = (core->xdata_ram_size + page_size - 1) >> core->xdata_page_shift;
+    uint32_t copied = 0;
+
+    for (uint32_t word_i = 0; (word_i * 32) < page_count; word_i++)
+    {
+        uint32_t word = core->xdata_dirty[word_i];
+
+        while (word)
+        {
+            uint32_t bit = 0;
+
+            while ((word & ((uint32_t)1 << bit)) == 0)
+                bit++;
+
+            word &= ~((uint32_t)1 << bit);
+
+            uint32_t offset = ((word_i * 32) + bit) << core->xdata_page_shift;
+            uint32_t len = page_size;
+
+            if (offset >= core->xdata_ram_size)
+                break;
+
+            if ((offset + len) > core->xdata_ram_size)
+                len = core->xdata_ram_size - offset;
+
+            memcpy(&dst[offset], &src[offset], len);
+            copied++;
+        }
+    }
+
+    return copied;
+}
+
+/*******************************************************************************
+ * @brief 更新快照统计
+ * @param core   核心结构体指针
+ * @param snap   快照结构体指针
+ * @param pages  本次拷贝的脏页数
+ * @param full   是否完整拷贝
+ * @return none
+ ******************************************************************************/
+static void emcs51_snapshot_update_stats(emcs51_core_t *core, emcs51_snapshot_t *snap, uint32_t pages, uint8_t full)
+{
+    emcs51_snapshot_stats_t *stats = &snap->stats;
+    uint32_t page_size = (uint32_t)1 << core->xdata_page_shift;
+
+    stats->page_size = page_size;
+    stats->page_count = (core->xdata_ram_size + page_size - 1) >> core->xdata_page_shift;
+
+    if (full)
+    {
+        pages = stats->page_count;
+        stats->full_copies++;
+        stats->bytes_copied += core->xdata_ram_size;
+    }
+    else
+    {
+        stats->bytes_copied += (uint64_t)pages * page_size;
+    }
+
+    stats->pages_copied += pages;
+    stats->last_dirty_pages = core->xdata_dirty_pages;
+
+    if (core->xdata_dirty_pages > stats->max_dirty_pages)
+        stats->max_dirty_pages = core->xdata_dirty_pages;
+}
+
+/*******************************************************************************
+ * @brief 初始化快照
+ * @param snap       快照结构体指针
+ * @param mode       快照模式
+ * @param xdata      XDATA区副本缓冲区，可为NULL（核心没有XDATA区时）
+ * @param xdata_size XDATA区副本缓冲区大小
+ * @return none
+ ******************************************************************************/
+void emcs51_snapshot_init(emcs51_snapshot_t *snap, emcs51_snapshot_mode_t mode, uint8_t *xdata, uint32_t xdata_size)
+{
+    if (snap == NULL)
+        return;
+
+    memset(snap, 0, sizeof(emcs51_snapshot_t));
+
+    snap->mode = mode;
+    snap->xdata = xdata;
+    snap->xdata_size = xdata_size;
+}
+
+/*******************************************************************************
+ * @brief 保存检查点
+ * @param core 核心结构体指针
+ * @param snap 快照结构体指针
+ * @return emcs51_err_t
+ * @details COW模式下，若核心的脏页标记是相对于本快照的，只拷贝脏页；
+ *          否则（首次保存、中间被其它快照使用过）退化为完整拷贝
+ ******************************************************************************/
+int emcs51_snapshot_take(emcs51_core_t *core, emcs51_snapshot_t *snap)
+{
+    uint32_t pages = 0;
+    uint8_t full;
+
+    if (core == NULL)
+        return EMCS51_ERR_CORE_NULL;
+
+    if (snap == NULL)
+        return EMCS51_ERR;
+
+    if (snap->xdata_size < core->xdata_ram_size)
+        return EMCS51_ERR_XDATA_OUT_OF_RANGE;
+
+    full = (snap->mode == EMCS51_SNAPSHOT_FULL) || (snap->valid == 0) || (core->xdata_dirty_owner != snap);
+
+    if (core->xdata_ram_size > 0)
+    {
+        if (full)
+            memcpy(snap->xdata, core->xdata_ram, core->xdata_ram_size);
+        else
+            pages = emcs51_snapshot_copy_dirty(core, snap->xdata, core->xdata_ram);
+    }
+
+    snap->err = core->err;
+    snap->reg = core->reg;
+    snap->is_jumped = core->is_jumped;
+    snap->inst_count = core->inst_count;
+    snap->cycles = core->cycles;
+    memcpy(snap->data_ram, core->data_ram, sizeof(snap->data_ram));
+
+    emcs51_snapshot_update_stats(core, snap, pages, full);
+    snap->stats.take_count++;
+    snap->valid = 1;
+
+    emcs51_core_clear_xdata_dirty(core);
+    core->xdata_dirty_owner = snap;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 恢复检查点
+ * @param core 核心结构体指针
+ * @param snap 快照结构体指针
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_snapshot_restore(emcs51_core_t *core, emcs51_snapshot_t *snap)
+{
+    uint32_t pages = 0;
+    uint8_t full;
+
+    if (core == NULL)
+        return EMCS51_ERR_CORE_NULL;
+
+    if ((snap == NULL) || (snap->valid == 0))
+        return EMCS51_ERR;
+
+    if (snap->xdata_size < core->xdata_ram_size)
+        return EMCS51_ERR_XDATA_OUT_OF_RANGE;
+
+    full = (snap->mode == EMCS51_SNAPSHOT_FULL) || (core->xdata_dirty_owner != snap);
+
+    if (core->xdata_ram_size > 0)
+    {
+        if (full)
+            memcpy(core->xdata_ram, snap->xdata, core->xdata_ram_size);
+        else
+            pages = emcs51_snapshot_copy_dirty(core, core->xdata_ram, snap->xdata);
+    }
+
+    core->err = snap->err;
+    core->reg = snap->reg;
+    core->is_jumped = snap->is_jumped;
+    core->inst_count = snap->inst_count;
+    core->cycles = snap->cycles;
+    memcpy(core->data_ram, snap->data_ram, sizeof(core->data_ram));
+    emcs51_core_update_code_bank(core);
+
+    emcs51_snapshot_update_stats(core, snap, pages, full);
+    snap->stats.restore_count++;
+
+    emcs51_core_clear_xdata_dirty(core);
+    core->xdata_dirty_owner = snap;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 打印快照脏页统计，用于调整页大小
+ * @param snap 快照结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_snapshot_dump_stats(emcs51_snapshot_t *snap)
+{
+    emcs51_snapshot_stats_t *stats;
+
+    if (snap == NULL)
+        return;
+
+    stats = &snap->stats;
+
+    printf("[EMCS51][snapshot] page_size:%u page_count:%u\r\n", (unsigned)stats->page_size, (unsigned)stats->page_count);
+    printf("[EMCS51][snapshot] take:%u restore:%u full_copies:%u\r\n",
+           (unsigned)stats->take_count, (unsigned)stats->restore_count, (unsigned)stats->full_copies);
+    printf("[EMCS51][snapshot] pages_copied:%u bytes_copied:%llu dirty_last:%u dirty_max:%u\r\n",
+           (unsigned)stats->pages_copied, (unsigned long long)stats->bytes_copied,
+           (unsigned)stats->last_dirty_pages, (unsigned)stats->max_dirty_pages);
+}
@@ -0,0 +1,52 @@
+#ifndef EMCS51_SNAPSHOT_H
+#define EMCS51_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core/emcs51_core.h"
+
+typedef enum EMCS51_SNAPSHOT_MODE
+{
+    EMCS51_SNAPSHOT_FULL = 0, // 每次完整拷贝XDATA区
+    EMCS51_SNAPSHOT_COW,      // 只拷贝上次检查点之后被写过的脏页
+} emcs51_snapshot_mode_t;
+
+typedef struct EMCS51_SNAPSHOT_STATS
+{
+    uint32_t take_count;      // 保存次数
+    uint32_t restore_count;   // 恢复次数
+    uint32_t full_copies;     // 退化为完整拷贝的次数
+    uint32_t pages_copied;    // 累计拷贝的XDATA页数
+    uint64_t bytes_copied;    // 累计拷贝的XDATA字节数
+    uint32_t last_dirty_pages; // 最近一次保存/恢复时的脏页数
+    uint32_t max_dirty_pages;  // 单次保存/恢复的最大脏页数
+    uint32_t page_count;       // XDATA区总页数
+    uint32_t page_size;        // 当前页大小
+} emcs51_snapshot_stats_t;
+
+typedef struct EMCS51_SNAPSHOT
+{
+    emcs51_snapshot_mode_t mode;
+    uint8_t valid;
+
+    int err;
+    emcs51_core_reg_t reg;
+    uint8_t data_ram[256];
+    uint8_t is_jumped;
+    uint64_t inst_count;
+    uint64_t cycles;
+
+    uint8_t *xdata;      // XDATA区副本，由调用者提供
+    uint32_t xdata_size; // 副本大小，必须不小于核心的 xdata_ram_size
+
+    emcs51_snapshot_stats_t stats;
+} emcs51_snapshot_t;
+
+void emcs51_snapshot_init(emcs51_snapshot_t *snap, emcs51_snapshot_mode_t mode, uint8_t *xdata, uint32_t xdata_size);
+
+int emcs51_snapshot_take(emcs51_core_t *core, emcs51_snapshot_t *snap);
+int emcs51_snapshot_restore(emcs51_core_t *core, emcs51_snapshot_t *snap);
+
+void emcs51_snapshot_dump_stats(emcs51_snapshot_t *snap);
+
+#endif // EMCS51_SNAPSHOT_H
@@ -0,0 +1,458 @@
+#include "emcs51.h"
+
+static uint64_t emcs51_trace_get_le(const uint8_t *in, uint8_t len)
+{
+    uint64_t value = 0;
+
+    for (uint8_t i = 0; i < len; i++)
+        value |= (uint64_t)in[i] << (i * 8);
+
+    return value;
+}
+
+#if EMCS51_TRACE_ENABLE
+
+static void emcs51_trace_put_le(uint8_t *out, uint64_t value, uint8_t len)
+{
+    for (uint8_t i = 0; i < len; i++)
+        out[i] = (uint8_t)(value >> (i * 8));
+}
+
+/*******************************************************************************
+ * @brief 写入变长整数（LEB128）
+ ******************************************************************************/
+static uint8_t *emcs51_trace_put_varint(uint8_t *out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+
+    *out++ = (uint8_t)value;
+
+    return out;
+}
+
+/*******************************************************************************
+ * @brief 完成当前块：写入长度后发布给消费者
+ ******************************************************************************/
+static void emcs51_trace_close_block(emcs51_trace_t *trace)
+{
+    if (trace->cur == NULL)
+        return;
+
+    emcs51_trace_put_le(trace->cur + 4, trace->pos, 2);
+    trace->cur = NULL;
+
+    atomic_store_explicit(&trace->head, atomic_load_explicit(&trace->head, memory_order_relaxed) + 1, memory_order_release);
+}
+
+/*******************************************************************************
+ * @brief 开始新块，STREAM 模式下缓冲已满时返回0
+ ******************************************************************************/
+static int emcs51_trace_open_block(emcs51_trace_t *trace, uint16_t pc, uint64_t cycles)
+{
+    uint32_t head = atomic_load_explicit(&trace->head, memory_order_relaxed);
+
+    if ((trace->mode == EMCS51_TRACE_MODE_STREAM) &&
+        ((uint32_t)(head - atomic_load_explicit(&trace->tail, memory_order_acquire)) >= trace->block_count))
+        return 0;
+
+    trace->cur = trace->blocks + (size_t)(head % trace->block_count) * EMCS51_TRACE_BLOCK_SIZE;
+    trace->pos = EMCS51_TRACE_BLOCK_HEADER_SIZE;
+    trace->expected_pc = pc;
+
+    emcs51_trace_put_le(trace->cur + 0, trace->seq++, 4);
+    emcs51_trace_put_le(trace->cur + 4, 0, 2);
+    emcs51_trace_put_le(trace->cur + 6, pc, 2);
+    emcs51_trace_put_le(trace->cur + 8, trace->core->inst_count - 1, 8);
+    emcs51_trace_put_le(trace->cur + 16, cycles, 8);
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 初始化跟踪并挂到核心上
+ * @param trace  跟踪结构体指针
+ * @param core   核心结构体指针
+ * @param buffer 块缓冲，至少一块 EMCS51_TRACE_BLOCK_SIZE
+ * @param size   块缓冲大小，按块向下取整
+ * @param mode   emcs51_trace_modes_t
+ * @param flags  emcs51_trace_flags_t
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_trace_init(emcs51_trace_t *trace, emcs51_core_t *core, uint8_t *buffer, uint32_t size, uint8_t mode, uint8_t flags)
+{
+    if ((trace == NULL) || (core == NULL))
+        return EMCS51_ERR_CORE_NULL;
+
+    if ((buffer == NULL) || (size < EMCS51_TRACE_BLOCK_SIZE) || (mode > EMCS51_TRACE_MODE_STREAM))
+        return EMCS51_ERR;
+
+    memset(trace, 0, sizeof(emcs51_trace_t));
+
+    trace->core = core;
+    trace->blocks = buffer;
+    trace->block_count = size / EMCS51_TRACE_BLOCK_SIZE;
+    trace->mode = mode;
+    trace->flags = flags;
+
+    atomic_init(&trace->head, 0);
+    atomic_init(&trace->tail, 0);
+
+    core->trace = trace;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 完成当前块并从核心上移除
+ * @param trace 跟踪结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_trace_deinit(emcs51_trace_t *trace)
+{
+    emcs51_trace_flush(trace);
+
+    if (trace->core->trace == trace)
+        trace->core->trace = NULL;
+}
+
+/*******************************************************************************
+ * @brief 完成当前块，使已记录的指令对消费者和 emcs51_trace_dump() 可见
+ * @param trace 跟踪结构体指针
+ * @return none
+ * @details 只能在执行核心的线程上调用
+ ******************************************************************************/
+void emcs51_trace_flush(emcs51_trace_t *trace)
+{
+    emcs51_trace_close_block(trace);
+}
+
+/*******************************************************************************
+ * @brief 记录一条已执行的指令，由 emcs51_core_inc() 调用
+ * @param trace  跟踪结构体指针
+ * @param pc     指令地址
+ * @param opcode 操作码
+ * @param length 操作数字节数
+ * @param cycles 执行前的 core->cycles
+ * @return none
+ * @details 顺序执行、无存储器写入且周期数小于3的指令只占2字节
+ ******************************************************************************/
+void emcs51_trace_inst(emcs51_trace_t *trace, uint16_t pc, uint8_t opcode, uint8_t length, uint64_t cycles)
+{
+    uint64_t delta = trace->core->cycles - cycles;
+    uint8_t tag = length & EMCS51_TRACE_TAG_LENGTH;
+    uint8_t *out;
+
+    if ((trace->cur != NULL) && (trace->pos > EMCS51_TRACE_BLOCK_SIZE - EMCS51_TRACE_RECORD_MAX))
+        emcs51_trace_close_block(trace);
+
+    if ((trace->cur == NULL) && !emcs51_trace_open_block(trace, pc, cycles))
+    {
+        trace->lost++;
+        trace->effect_count = 0;
+        trace->effect_truncated = 0;
+        return;
+    }
+
+    out = trace->cur + trace->pos + 1;
+
+    *out++ = opcode;
+
+    if (delta < 3)
+        tag |= (uint8_t)(delta << EMCS51_TRACE_TAG_CYCLES_SHIFT);
+    else
+    {
+        tag |= EMCS51_TRACE_TAG_CYCLES;
+        out = emcs51_trace_put_varint(out, delta);
+    }
+
+    if (pc != trace->expected_pc)
+    {
+        int16_t diff = (int16_t)(uint16_t)(pc - trace->expected_pc);
+
+        tag |= EMCS51_TRACE_TAG_PC;
+        out = emcs51_trace_put_varint(out, ((uint32_t)diff << 1) ^ (uint32_t)(diff >> 15));
+    }
+
+    if (trace->effect_count || trace->effect_truncated)
+    {
+        tag |= EMCS51_TRACE_TAG_EFFECTS;
+        *out++ = trace->effect_count | (trace->effect_truncated ? 0x80 : 0x00);
+
+        for (uint8_t i = 0; i < trace->effect_count; i++)
+        {
+            *out++ = trace->effects[i].space;
+            out = emcs51_trace_put_varint(out, trace->effects[i].addr);
+            *out++ = trace->effects[i].data;
+        }
+
+        trace->effect_count = 0;
+        trace->effect_truncated = 0;
+    }
+
+    trace->cur[trace->pos] = tag;
+    trace->pos = (uint32_t)(out - trace->cur);
+    trace->expected_pc = (uint16_t)(pc + 1 + length);
+    trace->records++;
+}
+
+/*******************************************************************************
+ * @brief 记录当前指令的存储器写入，随指令一起写入记录
+ * @param trace 跟踪结构体指针
+ * @param space emcs51_space_types_t
+ * @param addr  地址
+ * @param data  写入的数据
+ * @return none
+ ******************************************************************************/
+void emcs51_trace_write(emcs51_trace_t *trace, uint8_t space, uint16_t addr, uint8_t data)
+{
+    emcs51_trace_effect_t *effect;
+
+    if ((trace->flags & EMCS51_TRACE_FLAG_MEM) == 0)
+        return;
+
+    if (trace->effect_count >= EMCS51_TRACE_EFFECT_MAX)
+    {
+        trace->effect_truncated = 1;
+        return;
+    }
+
+    effect = &trace->effects[trace->effect_count++];
+    effect->space = space;
+    effect->addr = addr;
+    effect->data = data;
+}
+
+/*******************************************************************************
+ * @brief 消费者取最旧的已完成块（STREAM 模式）
+ * @param trace 跟踪结构体指针
+ * @param len   输出块长度
+ * @return 块指针，没有已完成的块返回NULL；用完后调用 emcs51_trace_release()
+ * @details 可在另一个线程上调用，与生产者之间无锁
+ ******************************************************************************/
+const uint8_t *emcs51_trace_consume(emcs51_trace_t *trace, uint32_t *len)
+{
+    uint32_t tail = atomic_load_explicit(&trace->tail, memory_order_relaxed);
+    const uint8_t *block;
+
+    if (tail == atomic_load_explicit(&trace->head, memory_order_acquire))
+        return NULL;
+
+    block = trace->blocks + (size_t)(tail % trace->block_count) * EMCS51_TRACE_BLOCK_SIZE;
+    *len = emcs51_trace_block_len(block);
+
+    return block;
+}
+
+/*******************************************************************************
+ * @brief 归还 emcs51_trace_consume() 取得的块
+ * @param trace 跟踪结构体指针
+ * @return none
+ ******************************************************************************/
+void emcs51_trace_release(emcs51_trace_t *trace)
+{
+    atomic_store_explicit(&trace->tail, atomic_load_explicit(&trace->tail, memory_order_relaxed) + 1, memory_order_release);
+}
+
+/*******************************************************************************
+ * @brief 按从旧到新的顺序输出环形缓冲中的块（RING 模式），带文件头
+ * @param trace    跟踪结构体指针
+ * @param write_cb 流写入回调
+ * @param user     流写入回调的用户参数
+ * @return emcs51_err_t
+ * @details 在执行核心的线程上先调用 emcs51_trace_flush()
+ ******************************************************************************/
+int emcs51_trace_dump(emcs51_trace_t *trace, emcs51_trace_write_cb_t write_cb, void *user)
+{
+    uint32_t head = atomic_load_explicit(&trace->head, memory_order_acquire);
+    uint32_t first = (head > trace->block_count) ? (head - trace->block_count) : 0;
+    uint8_t header[EMCS51_TRACE_FILE_HEADER_SIZE];
+
+    emcs51_trace_file_header(header);
+    if (write_cb(user, header, sizeof(header)) != (int)sizeof(header))
+        return EMCS51_ERR_STREAM;
+
+    for (uint32_t i = first; i != head; i++)
+    {
+        const uint8_t *block = trace->blocks + (size_t)(i % trace->block_count) * EMCS51_TRACE_BLOCK_SIZE;
+        uint32_t len = emcs51_trace_block_len(block);
+
+        if (write_cb(user, block, len) != (int)len)
+            return EMCS51_ERR_STREAM;
+    }
+
+    return EMCS51_OK;
+}
+
+#endif // EMCS51_TRACE_ENABLE
+
+/*******************************************************************************
+ * @brief 生成跟踪文件头
+ * @param header EMCS51_TRACE_FILE_HEADER_SIZE 字节
+ * @return none
+ ******************************************************************************/
+void emcs51_trace_file_header(uint8_t *header)
+{
+    memcpy(header, EMCS51_TRACE_MAGIC, 7);
+    header[7] = EMCS51_TRACE_VERSION;
+}
+
+/*******************************************************************************
+ * @brief 块的有效长度（含块头），块头见 EMCS51_TRACE_BLOCK_HEADER_SIZE
+ ******************************************************************************/
+uint32_t emcs51_trace_block_len(const uint8_t *block)
+{
+    return (uint32_t)emcs51_trace_get_le(block + 4, 2);
+}
+
+/*******************************************************************************
+ * @brief 读取变长整数
+ * @return 1 成功，0 越界
+ ******************************************************************************/
+static int emcs51_trace_get_varint(const uint8_t **p, const uint8_t *end, uint64_t *value)
+{
+    uint8_t shift = 0;
+
+    *value = 0;
+
+    while ((*p < end) && (shift < 64))
+    {
+        uint8_t c = *(*p)++;
+
+        *value |= (uint64_t)(c & 0x7F) << shift;
+        if ((c & 0x80) == 0)
+            return 1;
+
+        shift += 7;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * @brief 解码一个块
+ * @param block     块数据
+ * @param len       块数据长度，不小于块头中的长度
+ * @param record_cb 每条指令的回调，返回负数停止解码并返回该值
+ * @param user      回调的用户参数
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_trace_decode_block(const uint8_t *block, uint32_t len, emcs51_trace_record_cb_t record_cb, void *user)
+{
+    emcs51_trace_record_t record;
+    uint32_t block_len;
+    const uint8_t *p, *end;
+    uint16_t expected_pc;
+    uint64_t value;
+    int ret;
+
+    if (len < EMCS51_TRACE_BLOCK_HEADER_SIZE)
+        return EMCS51_ERR_TRACE_FORMAT;
+
+    block_len = emcs51_trace_block_len(block);
+    if ((block_len < EMCS51_TRACE_BLOCK_HEADER_SIZE) || (block_len > len))
+        return EMCS51_ERR_TRACE_FORMAT;
+
+    memset(&record, 0, sizeof(record));
+    expected_pc = (uint16_t)emcs51_trace_get_le(block + 6, 2);
+    record.inst = emcs51_trace_get_le(block + 8, 8);
+    record.cycles = emcs51_trace_get_le(block + 16, 8);
+
+    p = block + EMCS51_TRACE_BLOCK_HEADER_SIZE;
+    end = block + block_len;
+
+    while (p < end)
+    {
+        uint8_t tag = *p++;
+
+        if ((tag & 0xC0) || (p >= end))
+            return EMCS51_ERR_TRACE_FORMAT;
+
+        record.opcode = *p++;
+        record.length = tag & EMCS51_TRACE_TAG_LENGTH;
+        record.cycle_delta = (tag & EMCS51_TRACE_TAG_CYCLES) >> EMCS51_TRACE_TAG_CYCLES_SHIFT;
+        record.pc = expected_pc;
+        record.effect_count = 0;
+        record.effect_truncated = 0;
+
+        if ((tag & EMCS51_TRACE_TAG_CYCLES) == EMCS51_TRACE_TAG_CYCLES)
+        {
+            if (!emcs51_trace_get_varint(&p, end, &value))
+                return EMCS51_ERR_TRACE_FORMAT;
+            record.cycle_delta = (uint32_t)value;
+        }
+
+        if (tag & EMCS51_TRACE_TAG_PC)
+        {
+            if (!emcs51_trace_get_varint(&p, end, &value))
+                return EMCS51_ERR_TRACE_FORMAT;
+            record.pc = (uint16_t)(expected_pc + (uint16_t)((value >> 1) ^ (0 - (value & 1))));
+        }
+
+        if (tag & EMCS51_TRACE_TAG_EFFECTS)
+        {
+            if (p >= end)
+                return EMCS51_ERR_TRACE_FORMAT;
+
+            record.effect_count = *p & 0x7F;
+            record.effect_truncated = (*p & 0x80) ? 1 : 0;
+            p++;
+
+            if (record.effect_count > EMCS51_TRACE_EFFECT_MAX)
+                return EMCS51_ERR_TRACE_FORMAT;
+
+            for (uint8_t i = 0; i < record.effect_count; i++)
+            {
+                if (p >= end)
+                    return EMCS51_ERR_TRACE_FORMAT;
+                record.effects[i].space = *p++;
+
+                if (!emcs51_trace_get_varint(&p, end, &value) || (p >= end))
+                    return EMCS51_ERR_TRACE_FORMAT;
+                record.effects[i].addr = (uint16_t)value;
+                record.effects[i].data = *p++;
+            }
+        }
+
+        ret = record_cb(user, &record);
+        if (ret < 0)
+            return ret;
+
+        expected_pc = (uint16_t)(record.pc + 1 + record.length);
+        record.cycles += record.cycle_delta;
+        record.inst++;
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 解码内存中的整个跟踪文件
+ * @param data      文件内容，以文件头开始
+ * @param len       文件长度
+ * @param record_cb 每条指令的回调
+ * @param user      回调的用户参数
+ * @return emcs51_err_t
+ ******************************************************************************/
+int emcs51_trace_decode(const uint8_t *data, uint32_t len, emcs51_trace_record_cb_t record_cb, void *user)
+{
+    uint32_t pos = EMCS51_TRACE_FILE_HEADER_SIZE;
+    int err;
+
+    if ((len < EMCS51_TRACE_FILE_HEADER_SIZE) || (memcmp(data, EMCS51_TRACE_MAGIC, 7) != 0) || (data[7] != EMCS51_TRACE_VERSION))
+        return EMCS51_ERR_TRACE_FORMAT;
+
+    while (pos < len)
+    {
+        err = emcs51_trace_decode_block(data + pos, len - pos, record_cb, user);
+        if (err < 0)
+            return err;
+
+        pos += emcs51_trace_block_len(data + pos);
+    }
+
+    return EMCS51_OK;
+}
@@ -0,0 +1,132 @@
+#ifndef EMCS51_TRACE_H
+#define EMCS51_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "core/emcs51_core.h"
+
+// 编译期开关，定义为0时核心中的跟踪代码全部移除；默认在支持C11原子操作的编译器上启用
+#ifndef EMCS51_TRACE_ENABLE
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#define EMCS51_TRACE_ENABLE 1
+#else
+#define EMCS51_TRACE_ENABLE 0
+#endif
+#endif
+
+#define EMCS51_TRACE_MAGIC "EMCS51T"
+#define EMCS51_TRACE_VERSION 1
+#define EMCS51_TRACE_FILE_HEADER_SIZE 8
+
+// 块大小，每块以绝对的指令序号、周期和PC开头，可单独解码
+#ifndef EMCS51_TRACE_BLOCK_SIZE
+#define EMCS51_TRACE_BLOCK_SIZE 4096
+#endif
+
+#define EMCS51_TRACE_BLOCK_HEADER_SIZE 24 // seq(4) len(2) pc(2) inst(8) cycles(8)，小端
+#define EMCS51_TRACE_RECORD_MAX 64        // 单条记录的最大长度
+#define EMCS51_TRACE_EFFECT_MAX 8         // 每条指令最多记录的存储器写入
+
+// 记录的首字节
+#define EMCS51_TRACE_TAG_LENGTH 0x03      // 操作数字节数，用于推算下一条指令的地址
+#define EMCS51_TRACE_TAG_CYCLES 0x0C      // 周期数 0~2，为3时其后跟变长整数
+#define EMCS51_TRACE_TAG_CYCLES_SHIFT 2
+#define EMCS51_TRACE_TAG_PC 0x10          // PC不连续，其后跟相对推算地址的 zigzag 变长整数
+#define EMCS51_TRACE_TAG_EFFECTS 0x20     // 其后跟存储器写入
+
+typedef enum EMCS51_TRACE_MODES
+{
+    EMCS51_TRACE_MODE_RING = 0, // 覆盖最旧的块，保留最近的执行历史，见 emcs51_trace_dump()
+    EMCS51_TRACE_MODE_STREAM,   // 由消费者线程取走已完成的块，缓冲满时丢弃
+} emcs51_trace_modes_t;
+
+typedef enum EMCS51_TRACE_FLAGS
+{
+    EMCS51_TRACE_FLAG_MEM = 0x01, // 记录DATA/XDATA写入
+} emcs51_trace_flags_t;
+
+typedef struct EMCS51_TRACE_EFFECT
+{
+    uint8_t space; // emcs51_space_types_t
+    uint16_t addr;
+    uint8_t data;
+} emcs51_trace_effect_t;
+
+// 解码后的一条指令
+typedef struct EMCS51_TRACE_RECORD
+{
+    uint64_t inst;   // 指令序号，等于执行前的 core->inst_count
+    uint64_t cycles; // 执行前的 core->cycles
+    uint32_t cycle_delta;
+    uint16_t pc;
+    uint8_t opcode;
+    uint8_t length; // 操作数字节数
+    uint8_t effect_count;
+    uint8_t effect_truncated; // 写入超过 EMCS51_TRACE_EFFECT_MAX
+    emcs51_trace_effect_t effects[EMCS51_TRACE_EFFECT_MAX];
+} emcs51_trace_record_t;
+
+typedef int (*emcs51_trace_record_cb_t)(void *user, const emcs51_trace_record_t *record);
+// 与 emcs51_record_write_cb_t 相同，返回写入的字节数
+typedef int (*emcs51_trace_write_cb_t)(void *user, const uint8_t *data, uint32_t len);
+
+#if EMCS51_TRACE_ENABLE
+
+#include <stdatomic.h>
+
+// 块缓冲为单生产者单消费者无锁环：生产者是执行核心的线程，消费者见 emcs51_trace_consume()
+typedef struct EMCS51_TRACE
+{
+    emcs51_core_t *core;
+    uint8_t *blocks;
+    uint32_t block_count;
+    uint8_t mode;  // emcs51_trace_modes_t
+    uint8_t flags; // emcs51_trace_flags_t
+
+    atomic_uint_least32_t head; // 已完成的块数，生产者写入
+    atomic_uint_least32_t tail; // 已取走的块数，消费者写入，RING 模式不使用
+
+    // 当前块，只由生产者访问
+    uint8_t *cur;
+    uint32_t pos;
+    uint32_t seq;
+    uint16_t expected_pc;
+
+    emcs51_trace_effect_t effects[EMCS51_TRACE_EFFECT_MAX];
+    uint8_t effect_count;
+    uint8_t effect_truncated;
+
+    uint64_t records;
+    uint64_t lost; // STREAM 模式缓冲满时丢弃的指令数
+} emcs51_trace_t;
+
+int emcs51_trace_init(emcs51_trace_t *trace, emcs51_core_t *core, uint8_t *buffer, uint32_t size, uint8_t mode, uint8_t flags);
+void emcs51_trace_deinit(emcs51_trace_t *trace);
+void emcs51_trace_flush(emcs51_trace_t *trace);
+
+void emcs51_trace_inst(emcs51_trace_t *trace, uint16_t pc, uint8_t opcode, uint8_t length, uint64_t cycles);
+void emcs51_trace_write(emcs51_trace_t *trace, uint8_t space, uint16_t addr, uint8_t data);
+
+const uint8_t *emcs51_trace_consume(emcs51_trace_t *trace, uint32_t *len);
+void emcs51_trace_release(emcs51_trace_t *trace);
+int emcs51_trace_dump(emcs51_trace_t *trace, emcs51_trace_write_cb_t write_cb, void *user);
+
+#define EMCS51_TRACE_WRITE(core, space, addr, data)                          \
+    do                                                                       \
+    {                                                                        \
+        if ((core)->trace != NULL)                                           \
+            emcs51_trace_write((core)->trace, (space), (addr), (data));      \
+    } while (0)
+
+#else
+
+#define EMCS51_TRACE_WRITE(core, space, addr, data) ((void)0)
+
+#endif // EMCS51_TRACE_ENABLE
+
+void emcs51_trace_file_header(uint8_t *header);
+uint32_t emcs51_trace_block_len(const uint8_t *block);
+int emcs51_trace_decode_block(const uint8_t *block, uint32_t len, emcs51_trace_record_cb_t record_cb, void *user);
+int emcs51_trace_decode(const uint8_t *data, uint32_t len, emcs51_trace_record_cb_t record_cb, void *user);
+
+#endif // EMCS51_TRACE_H
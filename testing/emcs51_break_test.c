@@ -0,0 +1,175 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const uint8_t break_code_memory[] = {
+    0x78, 0x05, // 0x00 MOV R0, #05H
+    0x00,       // 0x02 NOP
+    0xD8, 0xFD, // 0x03 DJNZ R0, 0x02
+    0x80, 0xFE, // 0x05 SJMP $
+};
+
+// AT89S52 双DPTR拷贝循环，无断点时由衍生型号整块执行
+static const uint8_t break_copy_loop_code_memory[] = {
+    0x90, 0x01, 0x00,                                           // 0x00 MOV DPTR, #0100H
+    0x05, 0xA2,                                                 // 0x03 INC AUXR1
+    0x90, 0x02, 0x00,                                           // 0x05 MOV DPTR, #0200H
+    0x05, 0xA2,                                                 // 0x08 INC AUXR1
+    0x78, 0x20,                                                 // 0x0A MOV R0, #20H
+    0xE0, 0xA3, 0x05, 0xA2, 0xF0, 0xA3, 0x05, 0xA2, 0xD8, 0xF6, // 0x0C 拷贝循环，0x10 MOVX @DPTR, A
+    0x80, 0xFE,                                                 // 0x16 SJMP $
+};
+
+static uint8_t break_xdata[0x400];
+
+/*******************************************************************************
+ * @brief 条件回调：R0 为指定值
+ ******************************************************************************/
+static int emcs51_break_test_r0_cond(emcs51_core_t *core, void *ctx)
+{
+    return core->data_ram[0x00] == *(uint8_t *)ctx;
+}
+
+static void emcs51_break_test_fail(emcs51_testing_t *t, emcs51_core_t *core, const char *what)
+{
+    snprintf(t->msg, sizeof(t->msg), "%s: err %s pc 0x%04X R0 %u inst %llu", what, emcs51_err_name(core->err), core->reg.pc,
+             core->data_ram[0x00], (unsigned long long)core->inst_count);
+    t->err = EMCS51_ERR;
+}
+
+/*******************************************************************************
+ * @brief 测试：衍生型号整块执行的拷贝循环中的断点
+ ******************************************************************************/
+static int emcs51_break_test_copy_loop(emcs51_testing_t *t)
+{
+    emcs51_core_t core;
+    emcs51_break_t brk;
+    int err;
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = break_copy_loop_code_memory,
+        .code_len = sizeof(break_copy_loop_code_memory),
+    };
+
+    emcs51_core_init(&core, &config);
+    emcs51_derivative_init(&core, &emcs51_derivative_at89s52);
+    emcs51_core_set_xdata_ram(&core, break_xdata, sizeof(break_xdata));
+    emcs51_break_init(&brk, &core);
+
+    emcs51_break_add(&brk, 0x0010, NULL, NULL, 0);
+
+    // 每次循环都要停在 MOVX @DPTR, A
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        err = emcs51_core_run(&core, 10000);
+        if ((err != EMCS51_ERR_BREAKPOINT) || (core.reg.pc != 0x0010) || (core.data_ram[0x00] != 0x20 - i) ||
+            (brk.bp[0].hits != i + 1))
+        {
+            emcs51_break_test_fail(t, &core, "copy loop");
+            return 0;
+        }
+
+        emcs51_break_resume(&brk);
+    }
+
+    emcs51_break_deinit(&brk);
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 测试：断点、条件断点和命中计数
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_break(emcs51_testing_t *t)
+{
+    emcs51_core_t core;
+    emcs51_break_t brk;
+    emcs51_inst_exec_cb_t nop_exec_cb;
+    uint8_t r0_value = 2;
+    int err;
+    int index;
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = break_code_memory,
+        .code_len = sizeof(break_code_memory),
+    };
+
+    emcs51_core_init(&core, &config);
+    emcs51_general_inst_init(&core);
+    emcs51_break_init(&brk, &core);
+
+    nop_exec_cb = core.inst_def[0x00].exec_cb;
+
+    // 无条件断点：停在指令执行之前，周期和指令数不包括断点处的指令
+    index = emcs51_break_add(&brk, 0x0002, NULL, NULL, 0);
+    if (index < 0)
+    {
+        emcs51_break_test_fail(t, &core, "add");
+        return;
+    }
+
+    err = emcs51_core_run(&core, 1000);
+    if ((err != EMCS51_ERR_BREAKPOINT) || (core.reg.pc != 0x0002) || (core.inst_count != 1) || (brk.hit != index))
+    {
+        emcs51_break_test_fail(t, &core, "first hit");
+        return;
+    }
+
+    emcs51_break_resume(&brk);
+    err = emcs51_core_run(&core, 1000);
+    if ((err != EMCS51_ERR_BREAKPOINT) || (core.reg.pc != 0x0002) || (core.inst_count != 3) || (core.data_ram[0x00] != 4) ||
+        (brk.bp[index].hits != 2))
+    {
+        emcs51_break_test_fail(t, &core, "second hit");
+        return;
+    }
+
+    // 条件断点：只在 R0 == 2 时停止
+    emcs51_break_remove(&brk, index);
+    emcs51_break_resume(&brk);
+
+    index = emcs51_break_add(&brk, 0x0002, emcs51_break_test_r0_cond, &r0_value, 0);
+    err = emcs51_core_run(&core, 1000);
+    if ((err != EMCS51_ERR_BREAKPOINT) || (core.reg.pc != 0x0002) || (core.data_ram[0x00] != 2) || (brk.bp[index].hits != 1))
+    {
+        emcs51_break_test_fail(t, &core, "condition");
+        return;
+    }
+
+    // 命中计数：DJNZ 处忽略前1次
+    emcs51_break_clear(&brk);
+    emcs51_break_resume(&brk);
+
+    index = emcs51_break_add(&brk, 0x0003, NULL, NULL, 1);
+    err = emcs51_core_run(&core, 1000);
+    if ((err != EMCS51_ERR_BREAKPOINT) || (core.reg.pc != 0x0003) || (core.data_ram[0x00] != 1) || (brk.bp[index].hits != 2))
+    {
+        emcs51_break_test_fail(t, &core, "ignore count");
+        return;
+    }
+
+    // 删除全部断点后分派项恢复原样
+    emcs51_break_resume(&brk);
+    emcs51_break_deinit(&brk);
+
+    if ((core.inst_def[0x00].exec_cb != nop_exec_cb) || (core.brk != NULL))
+    {
+        emcs51_break_test_fail(t, &core, "dispatch not restored");
+        return;
+    }
+
+    err = emcs51_core_run(&core, 100);
+    if ((err != EMCS51_OK) || (core.reg.pc != 0x0005))
+    {
+        emcs51_break_test_fail(t, &core, "run after deinit");
+        return;
+    }
+
+    if (!emcs51_break_test_copy_loop(t))
+        return;
+
+    t->err = EMCS51_OK;
+}
@@ -0,0 +1,94 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const uint8_t code_bank_test_common[] = {
+    0x75, 0x90, 0x00, // MOV P1, #00H      ; 选择分组0
+    0x02, 0x80, 0x00, // LJMP 8000H
+    0x75, 0x90, 0x01, // MOV P1, #01H      ; 选择分组1
+    0x02, 0x80, 0x00, // LJMP 8000H
+};
+
+static const uint8_t code_bank_test_bank0[] = {
+    0x75, 0x40, 0xAA, // MOV 40H, #0AAH
+    0x02, 0x00, 0x06, // LJMP 0006H
+};
+
+static const uint8_t code_bank_test_bank1[] = {
+    0x75, 0x41, 0xBB, // MOV 41H, #0BBH
+    0x80, 0xFE,       // SJMP $
+};
+
+static const uint8_t *const code_bank_test_banks[] = {
+    code_bank_test_bank0,
+    code_bank_test_bank1,
+};
+
+/*******************************************************************************
+ * @brief 测试：分组code区，P1低位选择 0x8000~0xFFFF 的分组
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_code_bank(emcs51_testing_t *t)
+{
+    emcs51_core_t emcs51_core;
+    emcs51_snapshot_t snap;
+
+    emcs51_core_config_t emcs51_core_config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = code_bank_test_common,
+        .code_len = sizeof(code_bank_test_common),
+        .code_bank_sfr = 0x90,
+        .code_bank_mask = 0x03,
+        .code_banks = code_bank_test_banks,
+        .code_bank_count = 2,
+        .code_bank_len = sizeof(code_bank_test_bank0),
+    };
+
+    emcs51_core_init(&emcs51_core, &emcs51_core_config);
+    emcs51_general_inst_init(&emcs51_core);
+
+    emcs51_snapshot_init(&snap, EMCS51_SNAPSHOT_FULL, NULL, 0);
+    emcs51_snapshot_take(&emcs51_core, &snap);
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        emcs51_core_inc(&emcs51_core);
+        if (emcs51_core.err < 0)
+        {
+            snprintf(t->msg, sizeof(t->msg), "step %u at pc 0x%04X: %s", (unsigned)i, emcs51_core.reg.pc, emcs51_err_name(emcs51_core.err));
+            t->err = emcs51_core.err;
+            return;
+        }
+    }
+
+    if ((emcs51_core.data_ram[0x40] != 0xAA) || (emcs51_core.data_ram[0x41] != 0xBB) ||
+        (emcs51_core.reg.pc != 0x8003) || (emcs51_core.code_bank != 1))
+    {
+        snprintf(t->msg, sizeof(t->msg), "bank switch failed, pc 0x%04X bank %u", emcs51_core.reg.pc, emcs51_core.code_bank);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 恢复快照后应重新选择分组
+    emcs51_snapshot_restore(&emcs51_core, &snap);
+    if (emcs51_core.code_bank != 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "bank not restored from snapshot");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 不存在的分组
+    emcs51_core.data_ram[0x90] = 0x03;
+    emcs51_core_update_code_bank(&emcs51_core);
+    emcs51_core.reg.pc = 0x8000;
+    emcs51_core_inc(&emcs51_core);
+    if (emcs51_core.err != EMCS51_ERR_CODE_OUT_OF_RANGE)
+    {
+        snprintf(t->msg, sizeof(t->msg), "missing bank not reported: %s", emcs51_err_name(emcs51_core.err));
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    t->err = EMCS51_OK;
+}
@@ -0,0 +1,120 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const uint8_t coverage_code_memory[] = {
+    0x78, 0x03, // 0x00 MOV R0, #03H
+    0x05, 0x30, // 0x02 INC 30H
+    0xD8, 0xFC, // 0x04 DJNZ R0, 0x02
+    0xE5, 0x30, // 0x06 MOV A, 30H
+    0x80, 0xFE, // 0x08 SJMP $
+    0x04,       // 0x0A INC A，不会执行
+};
+
+typedef struct COVERAGE_TEST_TEXT
+{
+    char data[64];
+    uint32_t len;
+} coverage_test_text_t;
+
+static int emcs51_coverage_test_write_cb(void *user, const uint8_t *data, uint32_t len)
+{
+    coverage_test_text_t *text = (coverage_test_text_t *)user;
+
+    if (text->len + len >= sizeof(text->data))
+        return 0;
+
+    memcpy(text->data + text->len, data, len);
+    text->len += len;
+    text->data[text->len] = '\0';
+
+    return (int)len;
+}
+
+static uint32_t emcs51_coverage_test_saturated(const uint8_t *edges, uint32_t size)
+{
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < size; i++)
+        count += (edges[i] == 0xFF);
+
+    return count;
+}
+
+/*******************************************************************************
+ * @brief 测试：已执行地址、转移边计数和地址区间输出
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_coverage(emcs51_testing_t *t)
+{
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = coverage_code_memory,
+        .code_len = sizeof(coverage_code_memory),
+    };
+    emcs51_core_t core;
+    emcs51_coverage_t cov;
+    coverage_test_text_t text = {0};
+    uint8_t edges[256];
+    int err;
+
+    emcs51_core_init(&core, &config);
+    emcs51_general_inst_init(&core);
+
+    err = emcs51_coverage_init(&cov, &core, edges, 100);
+    if (err == EMCS51_OK)
+    {
+        snprintf(t->msg, sizeof(t->msg), "edge map size must be a power of 2");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    emcs51_coverage_init(&cov, &core, edges, sizeof(edges));
+
+    // MOV, 3次 INC/DJNZ, MOV, SJMP
+    for (uint32_t i = 0; i < 9; i++)
+        emcs51_core_inc(&core);
+
+    // DJNZ 成立两次（从入口块和从循环体）、不成立一次，SJMP 一次
+    if ((emcs51_coverage_count(&cov) != 10) || emcs51_coverage_hit(&cov, 0x0A) || (emcs51_coverage_edge_count(&cov) != 4))
+    {
+        snprintf(t->msg, sizeof(t->msg), "count %u edges %u", (unsigned)emcs51_coverage_count(&cov), (unsigned)emcs51_coverage_edge_count(&cov));
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // SJMP $ 自身的边多加一条，计数饱和于 0xFF
+    for (uint32_t i = 0; i < 300; i++)
+        emcs51_core_inc(&core);
+
+    if ((emcs51_coverage_edge_count(&cov) != 5) || (emcs51_coverage_test_saturated(edges, sizeof(edges)) != 1))
+    {
+        snprintf(t->msg, sizeof(t->msg), "saturate edges %u", (unsigned)emcs51_coverage_edge_count(&cov));
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    err = emcs51_coverage_ranges(&cov, emcs51_coverage_test_write_cb, &text);
+    if ((err != EMCS51_OK) || (strcmp(text.data, "0000-0009\n") != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "ranges err %s", emcs51_err_name(err));
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 复位后只记录新的执行，deinit 后核心不再调用
+    emcs51_coverage_reset(&cov);
+    emcs51_core_inc(&core);
+    emcs51_coverage_deinit(&cov);
+    emcs51_core_inc(&core);
+
+    if ((core.coverage != NULL) || (emcs51_coverage_count(&cov) != 2) || (emcs51_coverage_edge_count(&cov) != 1))
+    {
+        snprintf(t->msg, sizeof(t->msg), "reset count %u edges %u", (unsigned)emcs51_coverage_count(&cov),
+                 (unsigned)emcs51_coverage_edge_count(&cov));
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    t->err = EMCS51_OK;
+}
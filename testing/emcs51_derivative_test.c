@@ -0,0 +1,321 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+// AT89S52：两个双DPTR拷贝循环，第一个目的与源重叠且在源之后
+static const uint8_t copy_loop_code_memory[] = {
+    0x90, 0x01, 0x00,                                           // 0x00 MOV DPTR, #0100H
+    0x05, 0xA2,                                                 // 0x03 INC AUXR1
+    0x90, 0x01, 0x04,                                           // 0x05 MOV DPTR, #0104H
+    0x05, 0xA2,                                                 // 0x08 INC AUXR1
+    0x78, 0x20,                                                 // 0x0A MOV R0, #20H
+    0xE0, 0xA3, 0x05, 0xA2, 0xF0, 0xA3, 0x05, 0xA2, 0xD8, 0xF6, // 0x0C 拷贝循环
+    0x05, 0xA2,                                                 // 0x16 INC AUXR1
+    0x90, 0x03, 0x00,                                           // 0x18 MOV DPTR, #0300H
+    0x05, 0xA2,                                                 // 0x1B INC AUXR1
+    0x90, 0x01, 0x00,                                           // 0x1D MOV DPTR, #0100H
+    0x79, 0x00,                                                 // 0x20 MOV R1, #00H   ; 256次
+    0xE0, 0xA3, 0x05, 0xA2, 0xF0, 0xA3, 0x05, 0xA2, 0xD9, 0xF6, // 0x22 拷贝循环
+    0x80, 0xFE,                                                 // 0x2C SJMP $
+};
+
+// DS89C4x0：AID+TSL，ID1 使 DPTR1 自动减1，INC DPTR 同样减1
+static const uint8_t auto_dptr_code_memory[] = {
+    0x90, 0x00, 0x10, // 0x00 MOV DPTR, #0010H
+    0x75, 0x86, 0xB0, // 0x03 MOV DPS, #0B0H
+    0xE0,             // 0x06 MOVX A, @DPTR   ; DPTR0 = 0011H，切换到DPTR1
+    0xA3,             // 0x07 INC DPTR        ; DPTR1 = FFFFH
+    0xF0,             // 0x08 MOVX @DPTR, A   ; DPTR1 = FFFEH，切换到DPTR0
+    0x80, 0xFE,       // 0x09 SJMP $
+};
+
+// STC8：DPS未实现的位读回为0，DPTR1 位于 0xE4/0xE5
+static const uint8_t stc8_dps_code_memory[] = {
+    0x75, 0xE3, 0xFF, // 0x00 MOV DPS, #0FFH
+    0x75, 0xE3, 0x01, // 0x03 MOV DPS, #01H
+    0x90, 0x12, 0x34, // 0x06 MOV DPTR, #1234H
+    0x80, 0xFE,       // 0x09 SJMP $
+};
+
+// 时序：MOV R2 一次，DJNZ 转移两次、不转移一次
+static const uint8_t timing_code_memory[] = {
+    0x7A, 0x03, // 0x00 MOV R2, #03H
+    0xDA, 0xFE, // 0x02 DJNZ R2, $
+    0x80, 0xFE, // 0x04 SJMP $
+};
+
+static uint8_t derivative_xdata[2][0x400];
+
+static void emcs51_derivative_test_write_cb(void *ctx, emcs51_core_t *core, uint8_t space, uint16_t addr, uint8_t data)
+{
+}
+
+static emcs51_core_hook_t derivative_test_hook = {
+    .write_cb = emcs51_derivative_test_write_cb,
+};
+
+/*******************************************************************************
+ * @brief 运行到指定地址
+ * @return 执行的 emcs51_core_inc() 次数，出错返回0
+ ******************************************************************************/
+static uint32_t emcs51_derivative_run_to(emcs51_testing_t *t, emcs51_core_t *core, uint16_t pc)
+{
+    uint32_t steps = 0;
+
+    while (core->reg.pc != pc)
+    {
+        emcs51_core_inc(core);
+        steps++;
+
+        if ((core->err < 0) || (steps > 100000))
+        {
+            snprintf(t->msg, sizeof(t->msg), "stopped at pc 0x%04X: %s", core->reg.pc, emcs51_err_name(core->err));
+            t->err = EMCS51_ERR;
+            return 0;
+        }
+    }
+
+    return steps;
+}
+
+/*******************************************************************************
+ * @brief 测试：整块执行的拷贝循环与逐条执行结果一致
+ ******************************************************************************/
+static int emcs51_derivative_test_copy_loop(emcs51_testing_t *t)
+{
+    static emcs51_core_t cores[2];
+    uint32_t steps[2];
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = copy_loop_code_memory,
+        .code_len = sizeof(copy_loop_code_memory),
+    };
+
+    // [0] 整块执行，[1] 有钩子观察每次写入，逐条执行
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        for (uint32_t j = 0; j < sizeof(derivative_xdata[i]); j++)
+            derivative_xdata[i][j] = (uint8_t)(j * 7 + 3);
+
+        emcs51_core_init(&cores[i], &config);
+        emcs51_derivative_init(&cores[i], &emcs51_derivative_at89s52);
+        emcs51_core_set_xdata_ram(&cores[i], derivative_xdata[i], sizeof(derivative_xdata[i]));
+    }
+
+    emcs51_core_set_hook(&cores[1], &derivative_test_hook);
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        steps[i] = emcs51_derivative_run_to(t, &cores[i], 0x002C);
+        if (steps[i] == 0)
+            return 0;
+    }
+
+    if (steps[0] >= steps[1])
+    {
+        snprintf(t->msg, sizeof(t->msg), "copy loop not recognised: %u/%u steps", (unsigned)steps[0], (unsigned)steps[1]);
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    if ((memcmp(derivative_xdata[0], derivative_xdata[1], sizeof(derivative_xdata[0])) != 0) ||
+        (memcmp(cores[0].data_ram, cores[1].data_ram, sizeof(cores[0].data_ram)) != 0) || (cores[0].reg.a != cores[1].reg.a))
+    {
+        snprintf(t->msg, sizeof(t->msg), "copy loop state differs");
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    if ((cores[0].cycles != cores[1].cycles) || (cores[0].inst_count != cores[1].inst_count))
+    {
+        snprintf(t->msg, sizeof(t->msg), "cycles %llu/%llu inst %llu/%llu", (unsigned long long)cores[0].cycles,
+                 (unsigned long long)cores[1].cycles, (unsigned long long)cores[0].inst_count, (unsigned long long)cores[1].inst_count);
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    // 重叠拷贝按字节向前传播：0x0104 起重复 0x0100~0x0103
+    if ((derivative_xdata[0][0x0104] != derivative_xdata[0][0x0100]) || (derivative_xdata[0][0x0123] != derivative_xdata[0][0x0103]) ||
+        (derivative_xdata[0][0x03FF] != derivative_xdata[0][0x01FF]))
+    {
+        snprintf(t->msg, sizeof(t->msg), "copy loop data wrong");
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    // 目的 0x0104~0x0123 和 0x0300~0x03FF 各占一页
+    if (cores[0].xdata_dirty_pages != 2)
+    {
+        snprintf(t->msg, sizeof(t->msg), "dirty pages %u", (unsigned)cores[0].xdata_dirty_pages);
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 测试：DPTR自动加减和自动切换
+ ******************************************************************************/
+static int emcs51_derivative_test_auto_dptr(emcs51_testing_t *t)
+{
+    emcs51_core_t core;
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = auto_dptr_code_memory,
+        .code_len = sizeof(auto_dptr_code_memory),
+    };
+
+    memset(derivative_xdata[0], 0, sizeof(derivative_xdata[0]));
+    derivative_xdata[0][0x0010] = 0x5A;
+
+    emcs51_core_init(&core, &config);
+    emcs51_derivative_init(&core, &emcs51_derivative_ds89c4x0);
+    emcs51_core_set_xdata_ram(&core, derivative_xdata[0], sizeof(derivative_xdata[0]));
+
+    if (emcs51_derivative_run_to(t, &core, 0x0009) == 0)
+        return 0;
+
+    if ((core.reg.a != 0x5A) || (core.data_ram[0x82] != 0x11) || (core.data_ram[0x83] != 0x00) || (core.data_ram[0x84] != 0xFE) ||
+        (core.data_ram[0x85] != 0xFF) || (core.data_ram[0x86] != 0xB0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "A 0x%02X DPTR0 0x%02X%02X DPTR1 0x%02X%02X DPS 0x%02X", core.reg.a, core.data_ram[0x83],
+                 core.data_ram[0x82], core.data_ram[0x85], core.data_ram[0x84], core.data_ram[0x86]);
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 测试：DPS写掩码和DPTR1地址
+ ******************************************************************************/
+static int emcs51_derivative_test_stc8(emcs51_testing_t *t)
+{
+    emcs51_core_t core;
+    uint8_t dps;
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = stc8_dps_code_memory,
+        .code_len = sizeof(stc8_dps_code_memory),
+    };
+
+    emcs51_core_init(&core, &config);
+    emcs51_derivative_init(&core, &emcs51_derivative_stc8);
+
+    emcs51_core_inc(&core);
+    dps = core.data_ram[0xE3];
+
+    if (emcs51_derivative_run_to(t, &core, 0x0009) == 0)
+        return 0;
+
+    if ((dps != 0xF9) || (core.data_ram[0xE4] != 0x34) || (core.data_ram[0xE5] != 0x12) || (core.data_ram[0x82] != 0x00))
+    {
+        snprintf(t->msg, sizeof(t->msg), "DPS 0x%02X DPTR1 0x%02X%02X", dps, core.data_ram[0xE5], core.data_ram[0xE4]);
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 测试：按型号时序表计算周期和时钟数
+ ******************************************************************************/
+static int emcs51_derivative_test_timing(emcs51_testing_t *t)
+{
+    emcs51_core_t core;
+
+    static const struct
+    {
+        const char *name;
+        uint64_t cycles;
+        uint64_t clocks;
+    } cases[] = {
+        {"8051", 7, 84},
+        {"8051-X2", 7, 42},
+        {"STC8", 9, 9},
+    };
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = timing_code_memory,
+        .code_len = sizeof(timing_code_memory),
+    };
+
+    for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        const emcs51_derivative_t *derivative = emcs51_derivative_find(cases[i].name);
+
+        if (derivative == NULL)
+        {
+            snprintf(t->msg, sizeof(t->msg), "derivative %s not found", cases[i].name);
+            t->err = EMCS51_ERR;
+            return 0;
+        }
+
+        emcs51_core_init(&core, &config);
+        emcs51_derivative_init(&core, derivative);
+
+        if (emcs51_derivative_run_to(t, &core, 0x0004) == 0)
+            return 0;
+
+        if ((core.cycles != cases[i].cycles) || (emcs51_core_clocks(&core) != cases[i].clocks))
+        {
+            snprintf(t->msg, sizeof(t->msg), "%s cycles %llu clocks %llu", cases[i].name, (unsigned long long)core.cycles,
+                     (unsigned long long)emcs51_core_clocks(&core));
+            t->err = EMCS51_ERR;
+            return 0;
+        }
+    }
+
+    // 只注册通用指令的核心按标准8051计时
+    emcs51_core_init(&core, &config);
+    emcs51_general_inst_init(&core);
+
+    for (uint32_t opcode = 0; opcode < 256; opcode++)
+    {
+        if ((core.inst_def[opcode].mnemonic != NULL) && (core.inst_def[opcode].cycles != emcs51_derivative_timing_8051[opcode]))
+        {
+            snprintf(t->msg, sizeof(t->msg), "general 0x%02X %s takes %u cycles", (unsigned)opcode, core.inst_def[opcode].mnemonic,
+                     (unsigned)core.inst_def[opcode].cycles);
+            t->err = EMCS51_ERR;
+            return 0;
+        }
+    }
+
+    if ((emcs51_derivative_run_to(t, &core, 0x0004) == 0) || (core.cycles != 7) || (emcs51_core_clocks(&core) != 84))
+    {
+        snprintf(t->msg, sizeof(t->msg), "general cycles %llu clocks %llu", (unsigned long long)core.cycles,
+                 (unsigned long long)emcs51_core_clocks(&core));
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 测试：衍生型号双DPTR及时序表
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_derivative(emcs51_testing_t *t)
+{
+    if (!emcs51_derivative_test_copy_loop(t))
+        return;
+
+    if (!emcs51_derivative_test_auto_dptr(t))
+        return;
+
+    if (!emcs51_derivative_test_stc8(t))
+        return;
+
+    if (!emcs51_derivative_test_timing(t))
+        return;
+
+    t->err = EMCS51_OK;
+}
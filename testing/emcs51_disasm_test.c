@@ -0,0 +1,116 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+typedef struct DISASM_TEST_CASE
+{
+    uint16_t pc;
+    uint8_t code[EMCS51_DISASM_INST_MAX];
+    const char *text;
+} disasm_test_case_t;
+
+static const disasm_test_case_t disasm_test_cases[] = {
+    {0x0000, {0x00}, "NOP"},
+    {0x0000, {0x02, 0x01, 0x23}, "LJMP 0123H"},
+    {0x07FE, {0x21, 0x10}, "AJMP 0910H"}, // 下一条指令在 0800H 所在的页
+    {0x0100, {0xE5, 0xE0}, "MOV A, ACC"},
+    {0x0100, {0xE5, 0x2F}, "MOV A, 2FH"},
+    {0x0100, {0x75, 0x90, 0xFF}, "MOV P1, #0FFH"},
+    {0x0100, {0x85, 0x30, 0x81}, "MOV SP, 30H"}, // 源地址在前
+    {0x0100, {0x90, 0xA0, 0x00}, "MOV DPTR, #0A000H"},
+    {0x0100, {0xC2, 0x80}, "CLR P0.0"},
+    {0x0100, {0xD2, 0xD7}, "SETB CY"},
+    {0x0100, {0xB0, 0x0B}, "ANL C, /21H.3"},
+    {0x0100, {0x30, 0xB2, 0xFD}, "JNB P3.2, 0100H"},
+    {0x0100, {0x80, 0xFE}, "SJMP 0100H"},
+    {0x0100, {0xB6, 0x55, 0x10}, "CJNE @R0, #55H, 0113H"},
+    {0x0100, {0xDF, 0x80}, "DJNZ R7, 0082H"},
+    {0x0100, {0x93}, "MOVC A, @A+DPTR"},
+    {0x0100, {0xF2}, "MOVX @R0, A"},
+    {0x0100, {0x84}, "DIV AB"},
+    {0x0100, {0xA5}, "DB 0A5H"},
+};
+
+static int emcs51_disasm_test_check(emcs51_testing_t *t, const emcs51_disasm_t *dis, uint16_t pc, const uint8_t *code, const char *text)
+{
+    char buf[EMCS51_DISASM_TEXT_MAX];
+    uint32_t len = emcs51_disasm_inst(dis, pc, code, buf, sizeof(buf));
+
+    if ((strcmp(buf, text) != 0) || (len != strlen(text)))
+    {
+        snprintf(t->msg, sizeof(t->msg), "%04X %02X: \"%s\" expected \"%s\"", pc, code[0], buf, text);
+        t->err = EMCS51_ERR;
+        return EMCS51_ERR;
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 测试：反汇编的操作数格式、型号SFR名称、符号和截断
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_disasm(emcs51_testing_t *t)
+{
+    static const uint8_t sym_code[][EMCS51_DISASM_INST_MAX] = {
+        {0x12, 0x02, 0x00}, // LCALL delay
+        {0x05, 0x31},       // INC count+01H
+        {0xE5, 0xC8},       // MOV A, T2CON
+    };
+    emcs51_disasm_t dis;
+    emcs51_symtab_t tab;
+    char buf[8];
+    uint32_t len;
+
+    emcs51_disasm_init(&dis, NULL, NULL);
+
+    for (uint32_t i = 0; i < sizeof(disasm_test_cases) / sizeof(disasm_test_cases[0]); i++)
+    {
+        const disasm_test_case_t *c = &disasm_test_cases[i];
+
+        if (emcs51_disasm_test_check(t, &dis, c->pc, c->code, c->text) != EMCS51_OK)
+            return;
+    }
+
+    // 指令长度覆盖全部操作码
+    for (uint32_t op = 0; op < 256; op++)
+    {
+        uint8_t length = emcs51_disasm_length((uint8_t)op);
+
+        if ((length < 1) || (length > EMCS51_DISASM_INST_MAX))
+        {
+            snprintf(t->msg, sizeof(t->msg), "opcode %02X length %u", (unsigned)op, length);
+            t->err = EMCS51_ERR;
+            return;
+        }
+    }
+
+    // 符号和型号特有的SFR
+    emcs51_symtab_init(&tab);
+    emcs51_symtab_add(&tab, EMCS51_SPACE_CODE, 0x0200, 0, EMCS51_SYMBOL_FUNC, "delay", 5);
+    emcs51_symtab_add(&tab, EMCS51_SPACE_IRAM, 0x30, 2, EMCS51_SYMBOL_DATA, "count", 5);
+    emcs51_symtab_finalize(&tab);
+    emcs51_disasm_init(&dis, &emcs51_derivative_at89s52, &tab);
+
+    if ((emcs51_disasm_test_check(t, &dis, 0x0100, sym_code[0], "LCALL delay") != EMCS51_OK) ||
+        (emcs51_disasm_test_check(t, &dis, 0x0100, sym_code[1], "INC count+01H") != EMCS51_OK) ||
+        (emcs51_disasm_test_check(t, &dis, 0x0100, sym_code[2], "MOV A, T2CON") != EMCS51_OK))
+    {
+        emcs51_symtab_deinit(&tab);
+        return;
+    }
+
+    emcs51_symtab_deinit(&tab);
+
+    // 缓冲区不足时截断
+    emcs51_disasm_init(&dis, NULL, NULL);
+    len = emcs51_disasm_inst(&dis, 0x0100, disasm_test_cases[5].code, buf, sizeof(buf));
+    if ((len != sizeof(buf) - 1) || (strcmp(buf, "MOV P1,") != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "truncate: \"%s\" len %u", buf, (unsigned)len);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    t->err = EMCS51_OK;
+}
@@ -0,0 +1,112 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const char ihex_test_text[] =
+    ":0A00000075800000007580FF80F697\r\n"
+    ":020000040000FA\r\n"
+    ":02002000123498\r\n"
+    ":0400000500000000F7\r\n"
+    ":00000001FF\r\n";
+
+static const uint8_t ihex_test_expect[] = {
+    0x75, 0x80, 0x00, // MOV P0, #00H
+    0x00,             // NOP
+    0x00,             // NOP
+    0x75, 0x80, 0xFF, // MOV P0, #0FFH
+    0x80, 0xF6,       // SJMP -10
+};
+
+static uint32_t ihex_test_sink_addr = 0;
+static uint32_t ihex_test_sink_len = 0;
+
+/*******************************************************************************
+ * @brief 回调函数：记录最后一条数据记录的地址和长度
+ ******************************************************************************/
+static int emcs51_ihex_test_sink_cb(void *user, uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    ihex_test_sink_addr = addr;
+    ihex_test_sink_len = len;
+
+    return EMCS51_OK;
+}
+
+void emcs51_test_ihex(emcs51_testing_t *t)
+{
+    static uint8_t code[0x100];
+    static uint8_t code_bytewise[0x100];
+    emcs51_ihex_t ih;
+
+    // 一次性输入
+    memset(code, 0xFF, sizeof(code));
+    emcs51_ihex_init_buffer(&ih, code, sizeof(code));
+    emcs51_ihex_feed(&ih, ihex_test_text, (uint32_t)strlen(ihex_test_text));
+    t->err = emcs51_ihex_finish(&ih);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "load failed at line %u: %s", (unsigned)ih.line, emcs51_err_name(t->err));
+        return;
+    }
+
+    if ((memcmp(code, ihex_test_expect, sizeof(ihex_test_expect)) != 0) || (code[0x20] != 0x12) || (code[0x21] != 0x34))
+    {
+        snprintf(t->msg, sizeof(t->msg), "loaded image mismatch");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    if ((ih.addr_min != 0x00) || (ih.addr_max != 0x22) || (ih.records != 5))
+    {
+        snprintf(t->msg, sizeof(t->msg), "extent 0x%X-0x%X records %u", (unsigned)ih.addr_min, (unsigned)ih.addr_max, (unsigned)ih.records);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 逐字节输入，结果应完全相同
+    memset(code_bytewise, 0xFF, sizeof(code_bytewise));
+    emcs51_ihex_init_buffer(&ih, code_bytewise, sizeof(code_bytewise));
+    for (uint32_t i = 0; i < strlen(ihex_test_text); i++)
+    {
+        emcs51_ihex_feed(&ih, &ihex_test_text[i], 1);
+    }
+    t->err = emcs51_ihex_finish(&ih);
+    if ((t->err < 0) || (memcmp(code, code_bytewise, sizeof(code)) != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "byte-wise load differs: %s", emcs51_err_name(t->err));
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 扩展线性地址
+    emcs51_ihex_init(&ih, emcs51_ihex_test_sink_cb, NULL);
+    emcs51_ihex_feed(&ih, ":020000040001F9\n:02002000123498\n:00000001FF\n", 44);
+    t->err = emcs51_ihex_finish(&ih);
+    if ((t->err < 0) || (ihex_test_sink_addr != 0x10020) || (ihex_test_sink_len != 2))
+    {
+        snprintf(t->msg, sizeof(t->msg), "extended linear address: addr 0x%X", (unsigned)ihex_test_sink_addr);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 校验和错误
+    emcs51_ihex_init_buffer(&ih, code, sizeof(code));
+    t->err = emcs51_ihex_feed(&ih, ":02002000123499\n", 16);
+    if (t->err != EMCS51_ERR_IHEX_CHECKSUM)
+    {
+        snprintf(t->msg, sizeof(t->msg), "bad checksum not detected: %s", emcs51_err_name(t->err));
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 缺少EOF记录
+    emcs51_ihex_init_buffer(&ih, code, sizeof(code));
+    emcs51_ihex_feed(&ih, ":02002000123498\n", 16);
+    t->err = emcs51_ihex_finish(&ih);
+    if (t->err != EMCS51_ERR_IHEX_FORMAT)
+    {
+        snprintf(t->msg, sizeof(t->msg), "missing EOF record not detected: %s", emcs51_err_name(t->err));
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    t->err = EMCS51_OK;
+}
@@ -6,14 +6,12 @@ static const uint8_t mov_direct_immed_test1_code_memory[] = {
     0x75, 0x80, 0x55  // MOV P0 #055H
 };
 
-static uint8_t port0_data = 0x00;
-
 /*******************************************************************************
  * @brief 回调函数：读取code区存储器
  * @param none
  * @return none
  ******************************************************************************/
-static int emcs51_mov_direct_immed_read_code_cb(uint16_t addr, uint8_t *data, uint16_t len)
+static int emcs51_mov_direct_immed_read_code_cb(emcs51_core_t *core, void *user, uint16_t addr, uint8_t *data, uint16_t len)
 {
     if (addr + len > sizeof(mov_direct_immed_test1_code_memory))
     {
@@ -25,10 +23,11 @@ static int emcs51_mov_direct_immed_read_code_cb(uint16_t addr, uint8_t *data, ui
     return EMCS51_OK;
 }
 
-static int emcs51_mov_direct_immed_write_data_cb(uint8_t addr, uint8_t data)
+static int emcs51_mov_direct_immed_write_data_cb(emcs51_core_t *core, void *user, uint8_t addr, uint8_t data)
 {
+    uint8_t *port0_data = (uint8_t *)user;
 
-    port0_data = data;
+    *port0_data = data;
 
     return EMCS51_OK;
 }
@@ -41,9 +40,11 @@ static int emcs51_mov_direct_immed_write_data_cb(uint8_t addr, uint8_t data)
 void emcs51_test_inst_mov_direct_immed(emcs51_testing_t *t)
 {
     emcs51_core_t emcs51_core;
+    uint8_t port0_data = 0x00;
 
     emcs51_core_config_t emcs51_core_config = {
         .read_code_cb = emcs51_mov_direct_immed_read_code_cb,
+        .user = &port0_data,
     };
 
     emcs51_core_init(&emcs51_core, &emcs51_core_config);
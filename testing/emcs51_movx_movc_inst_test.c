@@ -0,0 +1,123 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const uint8_t movx_movc_code_memory[] = {
+    0x90, 0x00, 0x20, // 0x00 MOV DPTR, #0020H
+    0xE4,             // 0x03 CLR A
+    0x93,             // 0x04 MOVC A, @A+DPTR  ; A = 11H
+    0xF0,             // 0x05 MOVX @DPTR, A
+    0x75, 0xA0, 0x01, // 0x06 MOV P2, #01H
+    0x78, 0x30,       // 0x09 MOV R0, #30H
+    0xF2,             // 0x0B MOVX @R0, A
+    0xE4,             // 0x0C CLR A
+    0xE2,             // 0x0D MOVX A, @R0
+    0xF6,             // 0x0E MOV @R0, A
+    0xE4,             // 0x0F CLR A
+    0xE0,             // 0x10 MOVX A, @DPTR
+    0xE4,             // 0x11 CLR A
+    0x83,             // 0x12 MOVC A, @A+PC    ; A = 80H
+    0x80, 0xFE,       // 0x13 SJMP $
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x11,             // 0x20 表
+};
+
+static uint8_t movx_movc_xdata[0x200];
+
+/*******************************************************************************
+ * @brief 回调函数：读取code区存储器
+ * @param none
+ * @return none
+ ******************************************************************************/
+static int emcs51_movx_movc_read_code_cb(emcs51_core_t *core, void *user, uint16_t addr, uint8_t *data, uint16_t len)
+{
+    if (addr + len > sizeof(movx_movc_code_memory))
+    {
+        return EMCS51_ERR_CODE_OUT_OF_RANGE;
+    }
+
+    memcpy(data, &movx_movc_code_memory[addr], len);
+
+    return EMCS51_OK;
+}
+
+static int emcs51_movx_movc_run(emcs51_testing_t *t, emcs51_core_config_t *config)
+{
+    emcs51_core_t emcs51_core;
+
+    memset(movx_movc_xdata, 0, sizeof(movx_movc_xdata));
+
+    emcs51_core_init(&emcs51_core, config);
+    emcs51_general_inst_init(&emcs51_core);
+    emcs51_core_set_xdata_ram(&emcs51_core, movx_movc_xdata, sizeof(movx_movc_xdata));
+
+    for (uint32_t i = 0; i < 14; i++)
+    {
+        emcs51_core_inc(&emcs51_core);
+        if (emcs51_core.err < 0)
+        {
+            snprintf(t->msg, sizeof(t->msg), "step %u at pc 0x%04X: %s", (unsigned)i, emcs51_core.reg.pc, emcs51_err_name(emcs51_core.err));
+            t->err = emcs51_core.err;
+            return 0;
+        }
+    }
+
+    if ((emcs51_core.data_ram[0x82] != 0x20) || (emcs51_core.data_ram[0x83] != 0x00))
+    {
+        snprintf(t->msg, sizeof(t->msg), "DPL/DPH 0x%02X/0x%02X", emcs51_core.data_ram[0x82], emcs51_core.data_ram[0x83]);
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    if ((emcs51_core.reg.a != 0x80) || (emcs51_core.reg.pc != 0x0013) || (emcs51_core.data_ram[0x30] != 0x11) ||
+        (movx_movc_xdata[0x0020] != 0x11))
+    {
+        snprintf(t->msg, sizeof(t->msg), "A 0x%02X pc 0x%04X @R0 0x%02X", emcs51_core.reg.a, emcs51_core.reg.pc, emcs51_core.data_ram[0x30]);
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 测试：MOVX 各寻址方式及 MOVC 查表
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_inst_movx_movc(emcs51_testing_t *t)
+{
+    // code区缓冲区，PDATA页寄存器为P2
+    emcs51_core_config_t buffer_config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = movx_movc_code_memory,
+        .code_len = sizeof(movx_movc_code_memory),
+    };
+
+    if (!emcs51_movx_movc_run(t, &buffer_config))
+        return;
+
+    if (movx_movc_xdata[0x0130] != 0x11)
+    {
+        snprintf(t->msg, sizeof(t->msg), "MOVX @R0 with P2 page failed");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // code区回调，PDATA页寄存器改为P1（代替MPAGE之类的专用SFR）
+    emcs51_core_config_t callback_config = {
+        .read_code_cb = emcs51_movx_movc_read_code_cb,
+        .pdata_page_sfr = 0x90,
+    };
+
+    if (!emcs51_movx_movc_run(t, &callback_config))
+        return;
+
+    if ((movx_movc_xdata[0x0030] != 0x11) || (movx_movc_xdata[0x0130] != 0x00))
+    {
+        snprintf(t->msg, sizeof(t->msg), "MOVX @R0 with custom page SFR failed");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    t->err = EMCS51_OK;
+}
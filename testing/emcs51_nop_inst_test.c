@@ -13,7 +13,7 @@ static const uint8_t code_memory[] = {
  * @param none
  * @return none
  ******************************************************************************/
-static int emcs51_core_read_code_cb(uint16_t addr, uint8_t *data, uint16_t len)
+static int emcs51_core_read_code_cb(emcs51_core_t *core, void *user, uint16_t addr, uint8_t *data, uint16_t len)
 {
     if (addr + len > sizeof(code_memory))
     {
@@ -0,0 +1,170 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+#if EMCS51_PROFILE_ENABLE
+
+static const uint8_t profile_code_memory[] = {
+    0x12, 0x00, 0x10, // 0x00 LCALL f
+    0x12, 0x00, 0x20, // 0x03 LCALL g
+    0x80, 0xFE,       // 0x06 SJMP $
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x12, 0x00, 0x20, // 0x10 f: LCALL g
+    0x00,             // 0x13    NOP
+    0x22,             // 0x14    RET
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00,             // 0x20 g: NOP
+    0x00,             // 0x21    NOP
+    0x22,             // 0x22    RET
+};
+
+static const char profile_test_collapsed[] =
+    "main 8\n"
+    "main;f 5\n"
+    "main;f;g 4\n"
+    "main;g 4\n";
+
+typedef struct PROFILE_TEST_OUT
+{
+    char data[2048];
+    uint32_t len;
+} profile_test_out_t;
+
+static emcs51_profile_t profile_test_prof;
+static profile_test_out_t profile_test_out;
+
+// 通用指令集尚未实现 LCALL/RET，测试中按标准语义补充
+static void emcs51_profile_test_lcall_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    emcs51_core_t *core = event->core;
+    uint16_t ret_pc = (uint16_t)(core->reg.pc + 3);
+
+    core->data_ram[++core->reg.sp] = (uint8_t)(ret_pc & 0xFF);
+    core->data_ram[++core->reg.sp] = (uint8_t)(ret_pc >> 8);
+    core->reg.pc = (uint16_t)((core->operands[0] << 8) | core->operands[1]);
+    core->is_jumped = true;
+}
+
+static void emcs51_profile_test_ret_exec_cb(emcs51_inst_exec_event_t *event)
+{
+    emcs51_core_t *core = event->core;
+    uint16_t ret_pc = (uint16_t)(core->data_ram[core->reg.sp] << 8);
+
+    ret_pc |= core->data_ram[core->reg.sp - 1];
+    core->reg.sp -= 2;
+    core->reg.pc = ret_pc;
+    core->is_jumped = true;
+}
+
+static emcs51_inst_def_t profile_test_lcall_inst_def = {
+    .mnemonic = "LCALL addr16",
+    .length = 2,
+    .cycles = 2,
+    .exec_cb = emcs51_profile_test_lcall_exec_cb,
+};
+
+static emcs51_inst_def_t profile_test_ret_inst_def = {
+    .mnemonic = "RET",
+    .length = 0,
+    .cycles = 2,
+    .exec_cb = emcs51_profile_test_ret_exec_cb,
+};
+
+static int emcs51_profile_test_write_cb(void *user, const uint8_t *data, uint32_t len)
+{
+    profile_test_out_t *out = (profile_test_out_t *)user;
+
+    if (out->len + len >= sizeof(out->data))
+        return 0;
+
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+    out->data[out->len] = '\0';
+
+    return (int)len;
+}
+
+#endif // EMCS51_PROFILE_ENABLE
+
+/*******************************************************************************
+ * @brief 测试：按地址计数、调用上下文和折叠调用栈输出
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_profile(emcs51_testing_t *t)
+{
+#if EMCS51_PROFILE_ENABLE
+    emcs51_profile_t *prof = &profile_test_prof;
+    emcs51_core_t core;
+    emcs51_symtab_t tab;
+    uint32_t func_count;
+    int err;
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = profile_code_memory,
+        .code_len = sizeof(profile_code_memory),
+    };
+
+    emcs51_core_init(&core, &config);
+    emcs51_general_inst_init(&core);
+    emcs51_core_inst_add(&core, 0x12, &profile_test_lcall_inst_def);
+    emcs51_core_inst_add(&core, 0x22, &profile_test_ret_inst_def);
+    emcs51_profile_init(prof, &core);
+
+    // 执行到 SJMP $ 后再执行两次
+    for (uint32_t i = 0; i < 13; i++)
+        emcs51_core_inc(&core);
+
+    emcs51_profile_deinit(prof);
+
+    if ((core.err < 0) || (core.reg.pc != 0x06) || (core.profile != NULL) || (prof->depth != 0) || (prof->node_count != 4) ||
+        (prof->inst[0x20] != 2) || (prof->cycles[0x22] != 4) || (prof->cycles[0x06] != 4))
+    {
+        snprintf(t->msg, sizeof(t->msg), "count: err %d pc %04X depth %u nodes %u", core.err, core.reg.pc, (unsigned)prof->depth,
+                 (unsigned)prof->node_count);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 按自身周期降序，相同时按地址：main 8、g 8、f 5
+    func_count = emcs51_profile_summarize(prof);
+    if ((func_count != 3) || (prof->nodes[EMCS51_PROFILE_ROOT].total_cycles != 21) || (prof->funcs[1].func != 0x20) ||
+        (prof->funcs[1].calls != 2) || (prof->funcs[1].total_cycles != 8) || (prof->funcs[2].func != 0x10) ||
+        (prof->funcs[2].total_cycles != 9))
+    {
+        snprintf(t->msg, sizeof(t->msg), "summarize: funcs %u total %llu", (unsigned)func_count,
+                 (unsigned long long)prof->nodes[EMCS51_PROFILE_ROOT].total_cycles);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    emcs51_symtab_init(&tab);
+    emcs51_symtab_add(&tab, EMCS51_SPACE_CODE, 0x00, 0, EMCS51_SYMBOL_FUNC, "main", 4);
+    emcs51_symtab_add(&tab, EMCS51_SPACE_CODE, 0x10, 0, EMCS51_SYMBOL_FUNC, "f", 1);
+    emcs51_symtab_add(&tab, EMCS51_SPACE_CODE, 0x20, 0, EMCS51_SYMBOL_FUNC, "g", 1);
+    emcs51_symtab_finalize(&tab);
+
+    profile_test_out.len = 0;
+    err = emcs51_profile_collapsed(prof, &tab, emcs51_profile_test_write_cb, &profile_test_out);
+    if ((err != EMCS51_OK) || (strcmp(profile_test_out.data, profile_test_collapsed) != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "collapsed: err %d", err);
+        emcs51_symtab_deinit(&tab);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    profile_test_out.len = 0;
+    err = emcs51_profile_report(prof, &tab, 4, emcs51_profile_test_write_cb, &profile_test_out);
+    emcs51_symtab_deinit(&tab);
+
+    if ((err != EMCS51_OK) || (strstr(profile_test_out.data, "  0022 g+2\n") == NULL))
+    {
+        snprintf(t->msg, sizeof(t->msg), "report: err %d", err);
+        t->err = EMCS51_ERR;
+        return;
+    }
+#endif // EMCS51_PROFILE_ENABLE
+
+    t->err = EMCS51_OK;
+}
@@ -0,0 +1,177 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const uint8_t record_test_code_memory[] = {
+    0x90, 0x00, 0x00, // MOV DPTR, #0000H
+    0xE5, 0x90,       // MOV A, P1
+    0xF0,             // MOVX @DPTR, A
+    0xA3,             // INC DPTR
+    0xE5, 0x40,       // MOV A, 40H
+    0xF0,             // MOVX @DPTR, A
+    0xA3,             // INC DPTR
+    0x80, 0xF6        // SJMP -10
+};
+
+typedef struct RECORD_TEST_STREAM
+{
+    uint8_t data[1024];
+    uint32_t len;
+    uint32_t pos;
+} record_test_stream_t;
+
+static record_test_stream_t record_test_stream;
+static uint8_t record_test_port1_data = 0x00;
+static uint32_t record_test_port1_reads = 0;
+
+/*******************************************************************************
+ * @brief 回调函数：读取code区存储器
+ * @param none
+ * @return none
+ ******************************************************************************/
+static int emcs51_record_test_read_code_cb(emcs51_core_t *core, void *user, uint16_t addr, uint8_t *data, uint16_t len)
+{
+    if (addr + len > sizeof(record_test_code_memory))
+    {
+        return EMCS51_ERR_CODE_OUT_OF_RANGE;
+    }
+
+    memcpy(data, &record_test_code_memory[addr], len);
+
+    return EMCS51_OK;
+}
+
+static int emcs51_record_test_port1_read_data_cb(emcs51_core_t *core, void *user, uint8_t addr, uint8_t *data)
+{
+    record_test_port1_data += 13;
+    record_test_port1_reads++;
+
+    *data = record_test_port1_data;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 回调函数：串口接收字节写入IRAM 0x40
+ ******************************************************************************/
+static void emcs51_record_test_input_cb(emcs51_core_t *core, void *user, const emcs51_input_t *input)
+{
+    core->data_ram[0x40] = input->data;
+}
+
+static int emcs51_record_test_write_cb(void *user, const uint8_t *data, uint32_t len)
+{
+    record_test_stream_t *stream = (record_test_stream_t *)user;
+
+    if (stream->len + len > sizeof(stream->data))
+        return 0;
+
+    memcpy(&stream->data[stream->len], data, len);
+    stream->len += len;
+
+    return (int)len;
+}
+
+static int emcs51_record_test_read_cb(void *user, uint8_t *data, uint32_t len)
+{
+    record_test_stream_t *stream = (record_test_stream_t *)user;
+
+    if (len > stream->len - stream->pos)
+        len = stream->len - stream->pos;
+
+    memcpy(data, &stream->data[stream->pos], len);
+    stream->pos += len;
+
+    return (int)len;
+}
+
+static void emcs51_record_test_core_init(emcs51_core_t *core, uint8_t *xdata, uint32_t xdata_size)
+{
+    emcs51_core_config_t emcs51_core_config = {
+        .read_code_cb = emcs51_record_test_read_code_cb,
+    };
+
+    memset(xdata, 0xFF, xdata_size);
+
+    emcs51_core_init(core, &emcs51_core_config);
+    emcs51_general_inst_init(core);
+    emcs51_core_reg_add(core, 0x90, NULL, emcs51_record_test_port1_read_data_cb);
+    emcs51_core_set_xdata_ram(core, xdata, xdata_size);
+    emcs51_core_set_input_cb(core, emcs51_record_test_input_cb);
+}
+
+/*******************************************************************************
+ * @brief 测试：外部输入的记录与回放
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_record_replay(emcs51_testing_t *t)
+{
+    emcs51_core_t emcs51_core;
+    emcs51_recorder_t rec;
+    emcs51_replayer_t rp;
+    uint8_t recorded_xdata[256];
+    uint8_t replayed_xdata[256];
+    uint32_t reads;
+
+    memset(&record_test_stream, 0, sizeof(record_test_stream));
+
+    emcs51_record_test_core_init(&emcs51_core, recorded_xdata, sizeof(recorded_xdata));
+    emcs51_recorder_init(&rec, &emcs51_core, emcs51_record_test_write_cb, &record_test_stream);
+
+    for (uint32_t i = 0; i < 120; i++)
+    {
+        if (i == 50)
+            emcs51_core_raise_input(&emcs51_core, EMCS51_INPUT_UART_RX, 0, 0x5A);
+
+        emcs51_core_inc(&emcs51_core);
+        if (emcs51_core.err < 0)
+        {
+            t->err = emcs51_core.err;
+            return;
+        }
+    }
+
+    t->err = emcs51_recorder_deinit(&rec);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "record stream error");
+        return;
+    }
+
+    reads = record_test_port1_reads;
+    record_test_port1_data = 0x00;
+
+    emcs51_record_test_core_init(&emcs51_core, replayed_xdata, sizeof(replayed_xdata));
+    t->err = emcs51_replayer_init(&rp, &emcs51_core, emcs51_record_test_read_cb, &record_test_stream);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "replay stream error");
+        return;
+    }
+
+    for (uint32_t i = 0; i < 120; i++)
+    {
+        t->err = emcs51_replayer_step(&rp);
+        if (t->err < 0)
+        {
+            snprintf(t->msg, sizeof(t->msg), "replay failed at %u: %s", (unsigned)i, emcs51_err_name(t->err));
+            return;
+        }
+    }
+
+    emcs51_replayer_deinit(&rp);
+
+    if (record_test_port1_reads != reads)
+    {
+        snprintf(t->msg, sizeof(t->msg), "P1 callback called while replaying");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    if ((rp.count != rec.count) || (memcmp(recorded_xdata, replayed_xdata, sizeof(recorded_xdata)) != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "replayed run differs from the recorded one");
+        t->err = EMCS51_ERR;
+        return;
+    }
+}
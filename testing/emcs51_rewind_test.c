@@ -0,0 +1,196 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const uint8_t rewind_test_code_memory[] = {
+    0x90, 0x00, 0x00, // MOV DPTR, #0000H
+    0xE5, 0x90,       // MOV A, P1
+    0xF0,             // MOVX @DPTR, A
+    0xA3,             // INC DPTR
+    0x80, 0xFA        // SJMP -6
+};
+
+static uint8_t rewind_test_xdata[256];
+static uint8_t rewind_test_port1_data = 0x00;
+static uint32_t rewind_test_port1_reads = 0;
+
+static uint64_t rewind_test_buffer[4096];
+
+/*******************************************************************************
+ * @brief 回调函数：读取code区存储器
+ * @param none
+ * @return none
+ ******************************************************************************/
+static int emcs51_rewind_test_read_code_cb(emcs51_core_t *core, void *user, uint16_t addr, uint8_t *data, uint16_t len)
+{
+    if (addr + len > sizeof(rewind_test_code_memory))
+    {
+        return EMCS51_ERR_CODE_OUT_OF_RANGE;
+    }
+
+    memcpy(data, &rewind_test_code_memory[addr], len);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 回调函数：读取P1，每次返回不同的值
+ * @param none
+ * @return none
+ ******************************************************************************/
+static int emcs51_rewind_test_port1_read_data_cb(emcs51_core_t *core, void *user, uint8_t addr, uint8_t *data)
+{
+    rewind_test_port1_data += 7;
+    rewind_test_port1_reads++;
+
+    *data = rewind_test_port1_data;
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 测试：检查点加回放的反向执行
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_rewind(emcs51_testing_t *t)
+{
+    emcs51_core_t emcs51_core;
+    emcs51_rewind_t rw;
+    uint8_t xdata_at_60[sizeof(rewind_test_xdata)];
+    emcs51_core_reg_t reg_at_60;
+    uint32_t reads;
+
+    emcs51_core_config_t emcs51_core_config = {
+        .read_code_cb = emcs51_rewind_test_read_code_cb,
+    };
+
+    emcs51_rewind_config_t rewind_config = {
+        .checkpoint_interval = 16,
+        .buffer = rewind_test_buffer,
+        .buffer_size = sizeof(rewind_test_buffer),
+    };
+    emcs51_rewind_config_t tiny_config = {
+        .checkpoint_interval = 16,
+        .buffer = (uint8_t *)rewind_test_buffer + 1,
+        .buffer_size = 4,
+    };
+    emcs51_rewind_config_t huge_log_config = {
+        .checkpoint_interval = 16,
+        .buffer = rewind_test_buffer,
+        .buffer_size = sizeof(rewind_test_buffer),
+        .input_log_len = 0x20000000, // 字节数在32位下溢出
+    };
+    emcs51_snapshot_t *snap;
+    uint32_t full_copies;
+
+    memset(rewind_test_xdata, 0xFF, sizeof(rewind_test_xdata));
+
+    emcs51_core_init(&emcs51_core, &emcs51_core_config);
+    emcs51_general_inst_init(&emcs51_core);
+    emcs51_core_reg_add(&emcs51_core, 0x90, NULL, emcs51_rewind_test_port1_read_data_cb);
+    emcs51_core_set_xdata_ram(&emcs51_core, rewind_test_xdata, sizeof(rewind_test_xdata));
+
+    // 缓冲区小于对齐所需的字节数
+    if (emcs51_rewind_init(&rw, &emcs51_core, &tiny_config) == EMCS51_OK)
+    {
+        snprintf(t->msg, sizeof(t->msg), "buffer smaller than the alignment must be rejected");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    if (emcs51_rewind_init(&rw, &emcs51_core, &huge_log_config) == EMCS51_OK)
+    {
+        snprintf(t->msg, sizeof(t->msg), "input log larger than the buffer must be rejected");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    t->err = emcs51_rewind_init(&rw, &emcs51_core, &rewind_config);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "rewind init failed");
+        return;
+    }
+
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        if (emcs51_core.inst_count == 60)
+        {
+            reg_at_60 = emcs51_core.reg;
+            memcpy(xdata_at_60, rewind_test_xdata, sizeof(xdata_at_60));
+        }
+
+        t->err = emcs51_rewind_step(&rw);
+        if (t->err < 0)
+            return;
+    }
+
+    reads = rewind_test_port1_reads;
+
+    t->err = emcs51_rewind_step_back(&rw, 40);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "step back failed");
+        return;
+    }
+
+    if ((emcs51_core.inst_count != 60) || (memcmp(&reg_at_60, &emcs51_core.reg, sizeof(reg_at_60)) != 0) ||
+        (memcmp(xdata_at_60, rewind_test_xdata, sizeof(xdata_at_60)) != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "state after step back differs from the recorded one");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // replay back to the present must not call the P1 callback again
+    for (uint32_t i = 0; i < 40; i++)
+    {
+        t->err = emcs51_rewind_step(&rw);
+        if (t->err < 0)
+            return;
+    }
+
+    if (rewind_test_port1_reads != reads)
+    {
+        snprintf(t->msg, sizeof(t->msg), "P1 callback called while replaying");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // XDATA 0x0005 is written by the MOVX of the 6th loop, instruction 1 + 4 * 5 + 1
+    t->err = emcs51_rewind_back_to_write(&rw, EMCS51_SPACE_XDATA, 0x0005);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "previous write of XDATA 0x0005 not found");
+        return;
+    }
+
+    if ((emcs51_core.inst_count != 22) || (emcs51_core.reg.pc != 0x0005) || (rewind_test_xdata[5] != 0xFF))
+    {
+        snprintf(t->msg, sizeof(t->msg), "must stop before the MOVX writing 0x0005");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 连续反向单步反复恢复位置16的检查点，只拷贝脏页
+    snap = &rw.checkpoints[(rw.checkpoint_head + 1) % rw.checkpoint_cap].snap;
+    full_copies = snap->stats.full_copies;
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        t->err = emcs51_rewind_step_back(&rw, 1);
+        if (t->err < 0)
+            return;
+    }
+
+    if ((snap->inst_count != 16) || (snap->stats.full_copies != full_copies) ||
+        (emcs51_core.inst_count != 20) || (rewind_test_xdata[5] != 0xFF))
+    {
+        snprintf(t->msg, sizeof(t->msg), "reverse step restored cp:%u full_copies:%u",
+                 (unsigned)snap->inst_count, (unsigned)snap->stats.full_copies);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    emcs51_rewind_deinit(&rw);
+}
@@ -0,0 +1,70 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+#if EMCS51_SELF_PROFILE
+
+static const uint8_t self_profile_code_memory[] = {
+    0x75, 0x90, 0x55, // 0x00 MOV P1, #55H
+    0xE5, 0x90,       // 0x03 MOV A, P1
+    0x80, 0xF9,       // 0x05 SJMP 0x00
+};
+
+static int emcs51_self_profile_test_write_cb(emcs51_core_t *core, void *user, uint8_t addr, uint8_t data)
+{
+    return EMCS51_OK;
+}
+
+static int emcs51_self_profile_test_read_cb(emcs51_core_t *core, void *user, uint8_t addr, uint8_t *data)
+{
+    *data = 0xAA;
+    return EMCS51_OK;
+}
+
+#endif // EMCS51_SELF_PROFILE
+
+/*******************************************************************************
+ * @brief 测试：自剖析构建中的操作码和回调计数
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_self_profile(emcs51_testing_t *t)
+{
+#if EMCS51_SELF_PROFILE
+    emcs51_core_t core;
+    const emcs51_self_profile_t *sp = &core.self_profile;
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = self_profile_code_memory,
+        .code_len = sizeof(self_profile_code_memory),
+    };
+
+    emcs51_core_init(&core, &config);
+    emcs51_general_inst_init(&core);
+    emcs51_core_reg_add(&core, 0x90, emcs51_self_profile_test_write_cb, emcs51_self_profile_test_read_cb);
+
+    // 每轮 2 + 1 + 2 个周期
+    emcs51_core_run(&core, 40);
+
+    if ((core.err < 0) || (sp->op_count[0x75] != 8) || (sp->op_count[0xE5] != 8) || (sp->op_count[0x80] != 8) ||
+        (sp->cb_count[EMCS51_SELF_PROFILE_CB_WRITE_DATA] != 8) || (sp->cb_count[EMCS51_SELF_PROFILE_CB_READ_DATA] != 8) ||
+        (sp->cb_count[EMCS51_SELF_PROFILE_CB_READ_CODE] != 0) || (core.reg.a != 0xAA))
+    {
+        snprintf(t->msg, sizeof(t->msg), "err %d mov %llu read_cb %llu write_cb %llu", core.err, (unsigned long long)sp->op_count[0x75],
+                 (unsigned long long)sp->cb_count[EMCS51_SELF_PROFILE_CB_READ_DATA],
+                 (unsigned long long)sp->cb_count[EMCS51_SELF_PROFILE_CB_WRITE_DATA]);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    emcs51_core_self_profile_reset(&core);
+    if (sp->op_count[0x75] != 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "reset");
+        t->err = EMCS51_ERR;
+        return;
+    }
+#endif // EMCS51_SELF_PROFILE
+
+    t->err = EMCS51_OK;
+}
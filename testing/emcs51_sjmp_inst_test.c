@@ -11,7 +11,7 @@ static const uint8_t emcs51_sjmp_test1_code_memory[] = {
  * @param none
  * @return none
  ******************************************************************************/
-static int emcs51_sjmp_test1_read_code_cb(uint16_t addr, uint8_t *data, uint16_t len)
+static int emcs51_sjmp_test1_read_code_cb(emcs51_core_t *core, void *user, uint16_t addr, uint8_t *data, uint16_t len)
 {
     if (addr + len > sizeof(emcs51_sjmp_test1_code_memory))
     {
@@ -70,7 +70,7 @@ static const uint8_t emcs51_sjmp_test2_code_memory[] = {
  * @param none
  * @return none
  ******************************************************************************/
-static int emcs51_sjmp_test2_read_code_cb(uint16_t addr, uint8_t *data, uint16_t len)
+static int emcs51_sjmp_test2_read_code_cb(emcs51_core_t *core, void *user, uint16_t addr, uint8_t *data, uint16_t len)
 {
     if (addr + len > sizeof(emcs51_sjmp_test2_code_memory))
     {
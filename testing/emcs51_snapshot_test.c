@@ -0,0 +1,119 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const uint8_t snapshot_test_code_memory[] = {
+    0x90, 0x01, 0x00, // MOV DPTR, #0100H
+    0xE4,             // CLR A
+    0xF0,             // MOVX @DPTR, A
+    0xA3,             // INC DPTR
+    0x80, 0xFC        // SJMP -4
+};
+
+static uint8_t snapshot_test_xdata[1024];
+static uint8_t snapshot_test_xdata_copy[1024];
+
+/*******************************************************************************
+ * @brief 回调函数：读取code区存储器
+ * @param none
+ * @return none
+ ******************************************************************************/
+static int emcs51_snapshot_test_read_code_cb(emcs51_core_t *core, void *user, uint16_t addr, uint8_t *data, uint16_t len)
+{
+    if (addr + len > sizeof(snapshot_test_code_memory))
+    {
+        return EMCS51_ERR_CODE_OUT_OF_RANGE;
+    }
+
+    memcpy(data, &snapshot_test_code_memory[addr], len);
+
+    return EMCS51_OK;
+}
+
+static int emcs51_snapshot_test_step(emcs51_core_t *core, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        emcs51_core_inc(core);
+        if (core->err < 0)
+            return core->err;
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 测试：XDATA区写时拷贝快照
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_snapshot_cow(emcs51_testing_t *t)
+{
+    emcs51_core_t emcs51_core;
+    emcs51_snapshot_t snap;
+
+    emcs51_core_config_t emcs51_core_config = {
+        .read_code_cb = emcs51_snapshot_test_read_code_cb,
+    };
+
+    memset(snapshot_test_xdata, 0xFF, sizeof(snapshot_test_xdata));
+
+    emcs51_core_init(&emcs51_core, &emcs51_core_config);
+    emcs51_general_inst_init(&emcs51_core);
+    emcs51_core_set_xdata_ram(&emcs51_core, snapshot_test_xdata, sizeof(snapshot_test_xdata));
+    emcs51_core_set_xdata_page_size(&emcs51_core, 64);
+
+    emcs51_snapshot_init(&snap, EMCS51_SNAPSHOT_COW, snapshot_test_xdata_copy, sizeof(snapshot_test_xdata_copy));
+
+    t->err = emcs51_snapshot_test_step(&emcs51_core, 2);
+    if (t->err < 0)
+        return;
+
+    // first checkpoint is always a full copy
+    emcs51_snapshot_take(&emcs51_core, &snap);
+    if ((snap.stats.full_copies != 1) || (snap.stats.page_count != 16))
+    {
+        snprintf(t->msg, sizeof(t->msg), "first take must be a full copy of 16 pages");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // clear 0x0100~0x0109, one dirty page
+    t->err = emcs51_snapshot_test_step(&emcs51_core, 3 * 10);
+    if (t->err < 0)
+        return;
+
+    if (emcs51_core.xdata_dirty_pages != 1)
+    {
+        snprintf(t->msg, sizeof(t->msg), "dirty pages must be 1, got %u", (unsigned)emcs51_core.xdata_dirty_pages);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    emcs51_snapshot_restore(&emcs51_core, &snap);
+    if ((snap.stats.pages_copied != 16 + 1) || (emcs51_core.reg.pc != 0x0004) || (snapshot_test_xdata[0x100] != 0xFF))
+    {
+        snprintf(t->msg, sizeof(t->msg), "restore must copy back exactly one page");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // clear 0x0100~0x0145, two dirty pages
+    t->err = emcs51_snapshot_test_step(&emcs51_core, 3 * 70);
+    if (t->err < 0)
+        return;
+
+    emcs51_snapshot_take(&emcs51_core, &snap);
+    if ((snap.stats.pages_copied != 16 + 1 + 2) || (snap.stats.max_dirty_pages != 2) || (snapshot_test_xdata_copy[0x145] != 0x00))
+    {
+        snprintf(t->msg, sizeof(t->msg), "take must copy exactly two pages");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    if (emcs51_core.xdata_dirty_pages != 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "dirty pages must be cleared after take");
+        t->err = EMCS51_ERR;
+        return;
+    }
+}
@@ -0,0 +1,172 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const char symtab_test_cdb[] =
+    "M:blink\n"
+    "S:G$main$0_0$0({2}DF,SV:S),C,0,0\n"
+    "S:G$delay$0_0$0({2}DF,SV:S),C,0,0\n"
+    "S:Fblink$count$0_0$0({1}SC:U),E,0,0\n"
+    "S:G$P1$0_0$0({1}SC:U),I,0,0\n"
+    "L:G$delay$0_0$0:40\r\n"
+    "L:XG$delay$0_0$0:4F\r\n"
+    "L:G$main$0_0$0:50\n"
+    "L:Fblink$count$0_0$0:21\n"
+    "L:G$P1$0_0$0:90\n"
+    "L:C$blink.c$12$1_0$1:50\n"
+    "L:C$blink.c$13$1_0$1:53\n"
+    "L:C$blink.c$13$1_0$1:53\n"
+    "L:A$blink$85:40\n"
+    "L:XG$main$0_0$0:5F\n";
+
+static uint8_t symtab_test_code[0x10];
+
+static int emcs51_symtab_test_sink_cb(void *user, uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (addr + len > sizeof(symtab_test_code))
+        return EMCS51_ERR_CODE_OUT_OF_RANGE;
+
+    memcpy(&symtab_test_code[addr], data, len);
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 生成一条OMF-51记录
+ * @return 写入的字节数
+ ******************************************************************************/
+static uint32_t emcs51_symtab_test_omf_record(uint8_t *out, uint8_t type, const uint8_t *content, uint16_t len)
+{
+    uint8_t sum = 0;
+
+    out[0] = type;
+    out[1] = (uint8_t)((len + 1) & 0xFF);
+    out[2] = (uint8_t)((len + 1) >> 8);
+    memcpy(&out[3], content, len);
+
+    for (uint32_t i = 0; i < (uint32_t)len + 3; i++)
+        sum += out[i];
+
+    out[len + 3] = (uint8_t)(0x100 - sum);
+
+    return (uint32_t)len + 4;
+}
+
+static int emcs51_symtab_test_check(emcs51_testing_t *t, const emcs51_symtab_t *tab, uint8_t space, uint32_t addr, const char *name)
+{
+    const emcs51_symbol_t *sym = emcs51_symtab_lookup(tab, space, addr);
+    const char *found = sym ? emcs51_symtab_string(tab, sym->name) : "(none)";
+
+    if (((name == NULL) && (sym != NULL)) || ((name != NULL) && ((sym == NULL) || (strcmp(found, name) != 0))))
+    {
+        snprintf(t->msg, sizeof(t->msg), "space %u addr 0x%X: got %s, expected %s", space, (unsigned)addr, found, name ? name : "(none)");
+        t->err = EMCS51_ERR;
+        return 0;
+    }
+
+    return 1;
+}
+
+void emcs51_test_symtab(emcs51_testing_t *t)
+{
+    static const uint8_t scope[] = {0x00, 5, 'B', 'L', 'I', 'N', 'K'};
+    static const uint8_t content[] = {0x00, 0x02, 0x00, 0x75, 0x90, 0x00};
+    static const uint8_t publics[] = {
+        EMCS51_OMF51_DEBUG_PUBLIC,
+        0x00, 0x80, 0x02, 0x00, 0x00, 4, 'M', 'A', 'I', 'N', // CODE, 过程
+        0x00, 0x02, 0x30, 0x00, 0x00, 3, 'C', 'N', 'T',      // DATA
+        0x00, 0x04, 0x08, 0x00, 0x00, 3, 'L', 'E', 'D',      // BIT，忽略
+    };
+    static const uint8_t lines[] = {
+        EMCS51_OMF51_DEBUG_LINE,
+        0x00, 0x02, 0x00, 0x07, 0x00,
+        0x00, 0x05, 0x00, 0x08, 0x00,
+    };
+    static uint8_t omf[128];
+    uint32_t omf_len = 0;
+    const emcs51_symbol_t *sym;
+    const emcs51_line_t *line;
+    emcs51_symtab_t tab;
+
+    // SDCC .cdb
+    emcs51_symtab_init(&tab);
+    t->err = emcs51_cdb_load(&tab, symtab_test_cdb, (uint32_t)strlen(symtab_test_cdb));
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "cdb load failed: %s", emcs51_err_name(t->err));
+        goto done;
+    }
+
+    if (!emcs51_symtab_test_check(t, &tab, EMCS51_SPACE_CODE, 0x3F, NULL) ||
+        !emcs51_symtab_test_check(t, &tab, EMCS51_SPACE_CODE, 0x40, "delay") ||
+        !emcs51_symtab_test_check(t, &tab, EMCS51_SPACE_CODE, 0x4F, "delay") ||
+        !emcs51_symtab_test_check(t, &tab, EMCS51_SPACE_CODE, 0x5F, "main") ||
+        !emcs51_symtab_test_check(t, &tab, EMCS51_SPACE_CODE, 0x60, NULL) ||
+        !emcs51_symtab_test_check(t, &tab, EMCS51_SPACE_IRAM, 0x21, "count") ||
+        !emcs51_symtab_test_check(t, &tab, EMCS51_SPACE_SFR, 0x90, "P1"))
+        goto done;
+
+    sym = emcs51_symtab_find_name(&tab, "main");
+    if ((sym == NULL) || (sym->kind != EMCS51_SYMBOL_FUNC) || (sym->size != 0x10))
+    {
+        snprintf(t->msg, sizeof(t->msg), "main function record wrong");
+        t->err = EMCS51_ERR;
+        goto done;
+    }
+
+    line = emcs51_symtab_find_line(&tab, 0x55);
+    if ((line == NULL) || (line->line != 13) || (strcmp(emcs51_symtab_string(&tab, line->file), "blink.c") != 0) || (tab.line_count != 3))
+    {
+        snprintf(t->msg, sizeof(t->msg), "line lookup wrong");
+        t->err = EMCS51_ERR;
+        goto done;
+    }
+
+    emcs51_symtab_deinit(&tab);
+
+    // OMF-51
+    omf_len += emcs51_symtab_test_omf_record(&omf[omf_len], EMCS51_OMF51_SCOPE_DEF, scope, sizeof(scope));
+    omf_len += emcs51_symtab_test_omf_record(&omf[omf_len], EMCS51_OMF51_CONTENT, content, sizeof(content));
+    omf_len += emcs51_symtab_test_omf_record(&omf[omf_len], EMCS51_OMF51_DEBUG_ITEMS, publics, sizeof(publics));
+    omf_len += emcs51_symtab_test_omf_record(&omf[omf_len], EMCS51_OMF51_DEBUG_ITEMS, lines, sizeof(lines));
+
+    emcs51_symtab_init(&tab);
+    t->err = emcs51_omf51_load(&tab, omf, omf_len, emcs51_symtab_test_sink_cb, NULL);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "omf load failed: %s", emcs51_err_name(t->err));
+        goto done;
+    }
+
+    if ((symtab_test_code[2] != 0x75) || (symtab_test_code[3] != 0x90) || (tab.sym_count != 2))
+    {
+        snprintf(t->msg, sizeof(t->msg), "omf content wrong");
+        t->err = EMCS51_ERR;
+        goto done;
+    }
+
+    if (!emcs51_symtab_test_check(t, &tab, EMCS51_SPACE_CODE, 0x04, "MAIN") ||
+        !emcs51_symtab_test_check(t, &tab, EMCS51_SPACE_IRAM, 0x30, "CNT"))
+        goto done;
+
+    line = emcs51_symtab_find_line(&tab, 0x06);
+    if ((line == NULL) || (line->line != 8) || (strcmp(emcs51_symtab_string(&tab, line->file), "BLINK") != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "omf line lookup wrong");
+        t->err = EMCS51_ERR;
+        goto done;
+    }
+
+    // 校验和错误
+    omf[omf_len - 1] ^= 0x01;
+    if (emcs51_omf51_load(NULL, omf, omf_len, NULL, NULL) != EMCS51_ERR_OBJ_FORMAT)
+    {
+        snprintf(t->msg, sizeof(t->msg), "omf checksum error not detected");
+        t->err = EMCS51_ERR;
+        goto done;
+    }
+
+    t->err = EMCS51_OK;
+
+done:
+    emcs51_symtab_deinit(&tab);
+}
@@ -5,19 +5,52 @@ void emcs51_test_inst_nop(emcs51_testing_t *t);
 void emcs51_testing_inst_sjmp_test1(emcs51_testing_t *t);
 void emcs51_testing_inst_sjmp_test2(emcs51_testing_t *t);
 void emcs51_test_inst_mov_direct_immed(emcs51_testing_t *t);
+void emcs51_test_inst_movx_movc(emcs51_testing_t *t);
+void emcs51_test_derivative(emcs51_testing_t *t);
+void emcs51_test_snapshot_cow(emcs51_testing_t *t);
+void emcs51_test_rewind(emcs51_testing_t *t);
+void emcs51_test_record_replay(emcs51_testing_t *t);
+void emcs51_test_ihex(emcs51_testing_t *t);
+void emcs51_test_symtab(emcs51_testing_t *t);
+void emcs51_test_code_bank(emcs51_testing_t *t);
+void emcs51_test_xdata_map(emcs51_testing_t *t);
+void emcs51_test_break(emcs51_testing_t *t);
+void emcs51_test_watch(emcs51_testing_t *t);
+void emcs51_test_trace(emcs51_testing_t *t);
+void emcs51_test_disasm(emcs51_testing_t *t);
+void emcs51_test_profile(emcs51_testing_t *t);
+void emcs51_test_self_profile(emcs51_testing_t *t);
+void emcs51_test_coverage(emcs51_testing_t *t);
 
 static emcs51_testing_config_t tests[] = {
     {"NOP Instruction Test", emcs51_test_inst_nop},
     {"SJMP Instruction Test1", emcs51_testing_inst_sjmp_test1},
     {"SJMP Instruction Test2", emcs51_testing_inst_sjmp_test2},
     {"MOV direct, #immediate Instruction Test", emcs51_test_inst_mov_direct_immed},
-    {NULL, NULL},
+    {"MOVX/MOVC Instruction Test", emcs51_test_inst_movx_movc},
+    {"Derivative Profile Test", emcs51_test_derivative},
+    {"XDATA Copy-on-write Snapshot Test", emcs51_test_snapshot_cow},
+    {"Rewind Test", emcs51_test_rewind},
+    {"Record Replay Test", emcs51_test_record_replay},
+    {"Intel HEX Loader Test", emcs51_test_ihex},
+    {"Symbol Table Loader Test", emcs51_test_symtab},
+    {"Code Banking Test", emcs51_test_code_bank},
+    {"XDATA Memory Map Test", emcs51_test_xdata_map},
+    {"Breakpoint Test", emcs51_test_break},
+    {"Watchpoint Test", emcs51_test_watch},
+    {"Execution Trace Test", emcs51_test_trace},
+    {"Disassembler Test", emcs51_test_disasm},
+    {"Profiler Test", emcs51_test_profile},
+    {"Self-profile Build Test", emcs51_test_self_profile},
+    {"Coverage Test", emcs51_test_coverage},
+    {"", NULL},
 };
 
-void emcs51_testing(void)
+int emcs51_testing_run(const emcs51_testing_config_t *table)
 {
-    emcs51_testing_config_t *test_cfg = &tests[0];
+    const emcs51_testing_config_t *test_cfg = table;
     emcs51_testing_t t;
+    int err = EMCS51_OK;
 
     printf("[EMCS51_testing] all tests start\r\n");
 
@@ -35,6 +68,7 @@ void emcs51_testing(void)
         if(t.err < 0)
         {
             printf("[EMCS51_testing][%s] finished with err:%d msg:%s\r\n", test_cfg->name, t.err, t.msg);
+            err = t.err;
             break;
         }
         else
@@ -47,4 +81,11 @@ void emcs51_testing(void)
     }
 
     printf("[EMCS51_testing] all tests finished\r\n");
+
+    return err;
+}
+
+int emcs51_testing(void)
+{
+    return emcs51_testing_run(tests);
 }
@@ -18,6 +18,7 @@ typedef struct EMCS51_TESTING
     emcs51_testing_config_t cfg;
 } emcs51_testing_t;
 
-void emcs51_testing(void);
+int emcs51_testing(void); // 返回第一个失败测试的错误代码，全部通过为0
+int emcs51_testing_run(const emcs51_testing_config_t *table); // 运行以空名称结尾的测试表
 
 #endif // EMCS51_TESTING_H
@@ -0,0 +1,228 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+#if EMCS51_TRACE_ENABLE
+
+#define TRACE_TEST_BLOCKS 2
+#define TRACE_TEST_REF_MAX 32
+
+static const uint8_t trace_code_memory[] = {
+    0x78, 0x05, // 0x00 MOV R0, #05H
+    0x05, 0x30, // 0x02 INC 30H
+    0xE5, 0x30, // 0x04 MOV A, 30H
+    0xA3,       // 0x06 INC DPTR
+    0xF0,       // 0x07 MOVX @DPTR, A
+    0xD8, 0xF8, // 0x08 DJNZ R0, 0x02
+    0x80, 0xFE, // 0x0A SJMP $
+};
+
+typedef struct TRACE_TEST_REF
+{
+    uint16_t pc;
+    uint8_t opcode;
+    uint32_t cycle_delta;
+} trace_test_ref_t;
+
+typedef struct TRACE_TEST_CTX
+{
+    const trace_test_ref_t *ref;
+    uint32_t ref_count;
+    uint64_t count;
+    uint64_t first_inst;
+    uint64_t next_inst;
+    uint64_t cycles;
+    uint8_t effects_ok; // INC 30H 和 MOVX 的写入都已记录
+    int err;
+} trace_test_ctx_t;
+
+typedef struct TRACE_TEST_STREAM
+{
+    uint8_t data[EMCS51_TRACE_FILE_HEADER_SIZE + TRACE_TEST_BLOCKS * EMCS51_TRACE_BLOCK_SIZE];
+    uint32_t len;
+} trace_test_stream_t;
+
+static uint8_t trace_test_blocks[TRACE_TEST_BLOCKS * EMCS51_TRACE_BLOCK_SIZE];
+static trace_test_stream_t trace_test_stream;
+
+static int emcs51_trace_test_write_cb(void *user, const uint8_t *data, uint32_t len)
+{
+    trace_test_stream_t *stream = (trace_test_stream_t *)user;
+
+    if (stream->len + len > sizeof(stream->data))
+        return 0;
+
+    memcpy(stream->data + stream->len, data, len);
+    stream->len += len;
+
+    return (int)len;
+}
+
+/*******************************************************************************
+ * @brief 解码回调：检查指令序号和周期连续，与逐条执行的参考结果一致
+ ******************************************************************************/
+static int emcs51_trace_test_record_cb(void *user, const emcs51_trace_record_t *record)
+{
+    trace_test_ctx_t *ctx = (trace_test_ctx_t *)user;
+
+    if (ctx->count == 0)
+    {
+        ctx->first_inst = record->inst;
+    }
+    else if ((record->inst != ctx->next_inst) || (record->cycles != ctx->cycles))
+    {
+        ctx->err = EMCS51_ERR;
+        return EMCS51_ERR;
+    }
+
+    if (record->inst < ctx->ref_count)
+    {
+        const trace_test_ref_t *ref = &ctx->ref[record->inst];
+
+        if ((record->pc != ref->pc) || (record->opcode != ref->opcode) || (record->cycle_delta != ref->cycle_delta))
+        {
+            ctx->err = EMCS51_ERR;
+            return EMCS51_ERR;
+        }
+    }
+
+    // 第一次循环：30H 加1后写入 XDATA 0001H
+    if ((record->inst == 1) && (record->effect_count == 1) && (record->effects[0].space == EMCS51_SPACE_IRAM) &&
+        (record->effects[0].addr == 0x30) && (record->effects[0].data == 0x01))
+        ctx->effects_ok |= 0x01;
+
+    if ((record->inst == 4) && (record->effect_count == 1) && (record->effects[0].space == EMCS51_SPACE_XDATA) &&
+        (record->effects[0].addr == 0x0001) && (record->effects[0].data == 0x01))
+        ctx->effects_ok |= 0x02;
+
+    ctx->count++;
+    ctx->next_inst = record->inst + 1;
+    ctx->cycles = record->cycles + record->cycle_delta;
+
+    return EMCS51_OK;
+}
+
+static void emcs51_trace_test_fail(emcs51_testing_t *t, const char *what, int err, const trace_test_ctx_t *ctx)
+{
+    snprintf(t->msg, sizeof(t->msg), "%s: err %s decoded %llu first %llu", what, emcs51_err_name(err), (unsigned long long)ctx->count,
+             (unsigned long long)ctx->first_inst);
+    t->err = EMCS51_ERR;
+}
+
+static void emcs51_trace_test_core(emcs51_core_t *core, uint8_t *xdata_ram, uint32_t xdata_size)
+{
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = trace_code_memory,
+        .code_len = sizeof(trace_code_memory),
+    };
+
+    emcs51_core_init(core, &config);
+    emcs51_core_set_xdata_ram(core, xdata_ram, xdata_size);
+    emcs51_general_inst_init(core);
+}
+
+#endif // EMCS51_TRACE_ENABLE
+
+/*******************************************************************************
+ * @brief 测试：执行跟踪的编码、环形覆盖和流模式
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_trace(emcs51_testing_t *t)
+{
+#if EMCS51_TRACE_ENABLE
+    emcs51_core_t ref_core;
+    emcs51_core_t core;
+    emcs51_trace_t trace;
+    trace_test_ref_t ref[TRACE_TEST_REF_MAX];
+    trace_test_ctx_t ctx;
+    uint8_t ref_xdata[0x100];
+    uint8_t xdata[0x100];
+    const uint8_t *block;
+    uint32_t len;
+    int err;
+
+    // 参考：逐条执行并记录PC、操作码和周期
+    emcs51_trace_test_core(&ref_core, ref_xdata, sizeof(ref_xdata));
+    for (uint32_t i = 0; i < TRACE_TEST_REF_MAX; i++)
+    {
+        uint64_t cycles = ref_core.cycles;
+
+        ref[i].pc = ref_core.reg.pc;
+        ref[i].opcode = trace_code_memory[ref_core.reg.pc];
+        emcs51_core_inc(&ref_core);
+        ref[i].cycle_delta = (uint32_t)(ref_core.cycles - cycles);
+    }
+
+    // RING 模式：少量指令，全部保留，包括存储器写入
+    emcs51_trace_test_core(&core, xdata, sizeof(xdata));
+    emcs51_trace_init(&trace, &core, trace_test_blocks, sizeof(trace_test_blocks), EMCS51_TRACE_MODE_RING, EMCS51_TRACE_FLAG_MEM);
+
+    for (uint32_t i = 0; i < TRACE_TEST_REF_MAX; i++)
+        emcs51_core_inc(&core);
+
+    emcs51_trace_flush(&trace);
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.ref = ref;
+    ctx.ref_count = TRACE_TEST_REF_MAX;
+
+    trace_test_stream.len = 0;
+    err = emcs51_trace_dump(&trace, emcs51_trace_test_write_cb, &trace_test_stream);
+    if (err == EMCS51_OK)
+        err = emcs51_trace_decode(trace_test_stream.data, trace_test_stream.len, emcs51_trace_test_record_cb, &ctx);
+
+    if ((err != EMCS51_OK) || (ctx.count != TRACE_TEST_REF_MAX) || (ctx.first_inst != 0) || (ctx.effects_ok != 0x03))
+    {
+        emcs51_trace_test_fail(t, "ring", err, &ctx);
+        return;
+    }
+
+    // 继续运行直到覆盖最旧的块：保留的记录连续并以最后一条指令结束
+    emcs51_core_run(&core, 40000);
+    emcs51_trace_deinit(&trace);
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.ref = ref;
+    ctx.ref_count = TRACE_TEST_REF_MAX;
+
+    trace_test_stream.len = 0;
+    err = emcs51_trace_dump(&trace, emcs51_trace_test_write_cb, &trace_test_stream);
+    if (err == EMCS51_OK)
+        err = emcs51_trace_decode(trace_test_stream.data, trace_test_stream.len, emcs51_trace_test_record_cb, &ctx);
+
+    if ((err != EMCS51_OK) || (ctx.first_inst == 0) || (ctx.next_inst != core.inst_count) || (ctx.cycles != core.cycles) ||
+        (core.trace != NULL))
+    {
+        emcs51_trace_test_fail(t, "ring wrap", err, &ctx);
+        return;
+    }
+
+    // STREAM 模式：消费者未取走时丢弃新的指令，已完成的块按顺序取出
+    emcs51_trace_test_core(&core, xdata, sizeof(xdata));
+    emcs51_trace_init(&trace, &core, trace_test_blocks, sizeof(trace_test_blocks), EMCS51_TRACE_MODE_STREAM, 0);
+    emcs51_core_run(&core, 40000);
+    emcs51_trace_flush(&trace);
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.ref = ref;
+    ctx.ref_count = TRACE_TEST_REF_MAX;
+    err = EMCS51_OK;
+
+    while ((err == EMCS51_OK) && ((block = emcs51_trace_consume(&trace, &len)) != NULL))
+    {
+        err = emcs51_trace_decode_block(block, len, emcs51_trace_test_record_cb, &ctx);
+        emcs51_trace_release(&trace);
+    }
+
+    if ((err != EMCS51_OK) || (ctx.first_inst != 0) || (trace.lost == 0) || (ctx.count + trace.lost != core.inst_count))
+    {
+        emcs51_trace_test_fail(t, "stream", err, &ctx);
+        return;
+    }
+
+    emcs51_trace_deinit(&trace);
+#endif // EMCS51_TRACE_ENABLE
+
+    t->err = EMCS51_OK;
+}
@@ -0,0 +1,109 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const uint8_t watch_code_memory[] = {
+    0x75, 0x30, 0x11, // 0x00 MOV 30H, #11H
+    0x75, 0x31, 0x22, // 0x03 MOV 31H, #22H
+    0xE5, 0x30,       // 0x06 MOV A, 30H
+    0x90, 0x01, 0x00, // 0x08 MOV DPTR, #0100H
+    0xF0,             // 0x0B MOVX @DPTR, A
+    0xE0,             // 0x0C MOVX A, @DPTR
+    0x80, 0xFE,       // 0x0D SJMP $
+};
+
+static void emcs51_watch_test_fail(emcs51_testing_t *t, emcs51_core_t *core, emcs51_watch_t *watch, const char *what)
+{
+    snprintf(t->msg, sizeof(t->msg), "%s: err %s pc 0x%04X hit %d addr 0x%04X pc 0x%04X old 0x%02X new 0x%02X", what,
+             emcs51_err_name(core->err), core->reg.pc, watch->hit.index, watch->hit.addr, watch->hit.pc, watch->hit.old_value,
+             watch->hit.new_value);
+    t->err = EMCS51_ERR;
+}
+
+/*******************************************************************************
+ * @brief 测试：IRAM 和 XDATA 观察点
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_watch(emcs51_testing_t *t)
+{
+    emcs51_core_t core;
+    emcs51_watch_t watch;
+    uint8_t xdata_ram[0x200];
+    int iram_index;
+    int xdata_index;
+    int err;
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = watch_code_memory,
+        .code_len = sizeof(watch_code_memory),
+    };
+
+    memset(xdata_ram, 0x5A, sizeof(xdata_ram));
+
+    emcs51_core_init(&core, &config);
+    emcs51_core_set_xdata_ram(&core, xdata_ram, sizeof(xdata_ram));
+    emcs51_general_inst_init(&core);
+    emcs51_watch_init(&watch, &core);
+
+    iram_index = emcs51_watch_add(&watch, EMCS51_SPACE_IRAM, 0x30, 1, EMCS51_WATCH_ACCESS);
+    xdata_index = emcs51_watch_add(&watch, EMCS51_SPACE_XDATA, 0x0100, 1, EMCS51_WATCH_WRITE);
+    if ((iram_index < 0) || (xdata_index < 0) || (emcs51_watch_add(&watch, EMCS51_SPACE_IRAM, 0xFF, 2, EMCS51_WATCH_READ) >= 0))
+    {
+        emcs51_watch_test_fail(t, &core, &watch, "add");
+        return;
+    }
+
+    // 只有被观察的写页不走快速路径
+    if ((core.xdata_wr[0x01] != NULL) || (core.xdata_rd[0x01] == NULL))
+    {
+        emcs51_watch_test_fail(t, &core, &watch, "page map");
+        return;
+    }
+
+    // 写 30H：指令执行完后停止
+    err = emcs51_core_run(&core, 1000);
+    if ((err != EMCS51_ERR_WATCHPOINT) || (core.reg.pc != 0x0003) || (watch.hit.index != iram_index) ||
+        (watch.hit.type != EMCS51_WATCH_WRITE) || (watch.hit.addr != 0x30) || (watch.hit.pc != 0x0000) || (watch.hit.old_value != 0x00) ||
+        (watch.hit.new_value != 0x11))
+    {
+        emcs51_watch_test_fail(t, &core, &watch, "iram write");
+        return;
+    }
+
+    // 写 31H 不命中，读 30H 命中
+    emcs51_watch_resume(&watch);
+    err = emcs51_core_run(&core, 1000);
+    if ((err != EMCS51_ERR_WATCHPOINT) || (core.reg.pc != 0x0008) || (watch.hit.type != EMCS51_WATCH_READ) || (watch.hit.pc != 0x0006) ||
+        (core.reg.a != 0x11))
+    {
+        emcs51_watch_test_fail(t, &core, &watch, "iram read");
+        return;
+    }
+
+    // 写 XDATA 0100H 命中，之后的读不命中
+    emcs51_watch_resume(&watch);
+    err = emcs51_core_run(&core, 1000);
+    if ((err != EMCS51_ERR_WATCHPOINT) || (core.reg.pc != 0x000C) || (watch.hit.index != xdata_index) || (watch.hit.space != EMCS51_SPACE_XDATA) ||
+        (watch.hit.addr != 0x0100) || (watch.hit.pc != 0x000B) || (watch.hit.old_value != 0x5A) || (watch.hit.new_value != 0x11) ||
+        (xdata_ram[0x100] != 0x11))
+    {
+        emcs51_watch_test_fail(t, &core, &watch, "xdata write");
+        return;
+    }
+
+    emcs51_watch_resume(&watch);
+    err = emcs51_core_run(&core, 20);
+    if ((err != EMCS51_OK) || (core.reg.pc != 0x000D) || (watch.wp[iram_index].hits != 2) || (watch.wp[xdata_index].hits != 1))
+    {
+        emcs51_watch_test_fail(t, &core, &watch, "run on");
+        return;
+    }
+
+    emcs51_watch_deinit(&watch);
+    if ((core.watch != NULL) || (core.xdata_wr[0x01] == NULL))
+    {
+        emcs51_watch_test_fail(t, &core, &watch, "deinit");
+        return;
+    }
+}
@@ -0,0 +1,173 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+static const uint8_t xdata_map_test_code_memory[] = {
+    0x75, 0x40, 0x5A, // MOV 40H, #5AH
+    0xE5, 0x40,       // MOV A, 40H
+    0x90, 0x00, 0x10, // MOV DPTR, #0010H   ; RAM
+    0xF0,             // MOVX @DPTR, A
+    0x90, 0x01, 0x50, // MOV DPTR, #0150H   ; RAM 不足一页的部分
+    0xF0,             // MOVX @DPTR, A
+    0x90, 0x80, 0x01, // MOV DPTR, #8001H   ; MMIO
+    0xF0,             // MOVX @DPTR, A
+    0x90, 0x40, 0x00, // MOV DPTR, #4000H   ; ROM，写入被忽略
+    0xF0,             // MOVX @DPTR, A
+    0x90, 0xF0, 0x00, // MOV DPTR, #0F000H  ; 未映射
+    0xF0,             // MOVX @DPTR, A
+};
+
+typedef struct XDATA_MAP_TEST_MMIO
+{
+    uint16_t last_addr;
+    uint8_t last_data;
+    uint32_t writes;
+} xdata_map_test_mmio_t;
+
+static uint8_t xdata_map_test_ram[0x180];
+static uint8_t xdata_map_test_rom[0x100];
+
+static int emcs51_xdata_map_test_mmio_write_cb(emcs51_core_t *core, void *ctx, uint16_t addr, uint8_t data)
+{
+    xdata_map_test_mmio_t *mmio = (xdata_map_test_mmio_t *)ctx;
+
+    mmio->last_addr = addr;
+    mmio->last_data = data;
+    mmio->writes++;
+
+    return EMCS51_OK;
+}
+
+static int emcs51_xdata_map_test_mmio_read_cb(emcs51_core_t *core, void *ctx, uint16_t addr, uint8_t *data)
+{
+    *data = (uint8_t)(0x70 + (addr & 0x0F));
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 测试：XDATA区页表映射RAM、ROM、MMIO和未映射地址
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_xdata_map(emcs51_testing_t *t)
+{
+    emcs51_core_t emcs51_core;
+    xdata_map_test_mmio_t mmio;
+    uint8_t data = 0;
+
+    emcs51_core_config_t emcs51_core_config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = xdata_map_test_code_memory,
+        .code_len = sizeof(xdata_map_test_code_memory),
+    };
+
+    emcs51_xdata_region_t rom = {
+        .type = EMCS51_XDATA_ROM,
+        .start = 0x4000,
+        .len = sizeof(xdata_map_test_rom),
+        .mem = xdata_map_test_rom,
+    };
+
+    emcs51_xdata_region_t uart = {
+        .type = EMCS51_XDATA_MMIO,
+        .start = 0x8000,
+        .len = 8,
+        .read_cb = emcs51_xdata_map_test_mmio_read_cb,
+        .write_cb = emcs51_xdata_map_test_mmio_write_cb,
+        .ctx = &mmio,
+    };
+
+    memset(&mmio, 0, sizeof(mmio));
+    memset(xdata_map_test_ram, 0, sizeof(xdata_map_test_ram));
+    memset(xdata_map_test_rom, 0xA5, sizeof(xdata_map_test_rom));
+
+    emcs51_core_init(&emcs51_core, &emcs51_core_config);
+    emcs51_general_inst_init(&emcs51_core);
+    emcs51_core_set_xdata_ram(&emcs51_core, xdata_map_test_ram, sizeof(xdata_map_test_ram));
+    emcs51_core_map_xdata(&emcs51_core, &rom);
+    emcs51_core_map_xdata(&emcs51_core, &uart);
+    emcs51_core_set_xdata_unmapped(&emcs51_core, EMCS51_XDATA_UNMAPPED_ERROR);
+
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        emcs51_core_inc(&emcs51_core);
+        if (emcs51_core.err < 0)
+            break;
+    }
+
+    if ((xdata_map_test_ram[0x10] != 0x5A) || (xdata_map_test_ram[0x150] != 0x5A))
+    {
+        snprintf(t->msg, sizeof(t->msg), "RAM write failed");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    if ((mmio.writes != 1) || (mmio.last_addr != 0x8001) || (mmio.last_data != 0x5A))
+    {
+        snprintf(t->msg, sizeof(t->msg), "MMIO write failed: %u writes", (unsigned)mmio.writes);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    if (xdata_map_test_rom[0] != 0xA5)
+    {
+        snprintf(t->msg, sizeof(t->msg), "ROM was written");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    if ((emcs51_core.err != EMCS51_ERR_XDATA_OUT_OF_RANGE) || (emcs51_core.reg.pc != sizeof(xdata_map_test_code_memory)))
+    {
+        snprintf(t->msg, sizeof(t->msg), "unmapped write: %s at pc 0x%04X", emcs51_err_name(emcs51_core.err), emcs51_core.reg.pc);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // 读取
+    emcs51_core.err = EMCS51_OK;
+
+    emcs51_core_read_xdata(&emcs51_core, 0x4010, &data);
+    if (data != 0xA5)
+    {
+        snprintf(t->msg, sizeof(t->msg), "ROM read 0x%02X", data);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    emcs51_core_read_xdata(&emcs51_core, 0x8003, &data);
+    if (data != 0x73)
+    {
+        snprintf(t->msg, sizeof(t->msg), "MMIO read 0x%02X", data);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    // MMIO 页内区域以外、RAM 不足一页以外的地址都按未映射处理
+    if ((emcs51_core_read_xdata(&emcs51_core, 0x8010, &data) != EMCS51_ERR_XDATA_OUT_OF_RANGE) ||
+        (emcs51_core_read_xdata(&emcs51_core, 0x0190, &data) != EMCS51_ERR_XDATA_OUT_OF_RANGE))
+    {
+        snprintf(t->msg, sizeof(t->msg), "unmapped read not reported");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    emcs51_core_set_xdata_unmapped(&emcs51_core, EMCS51_XDATA_UNMAPPED_WRAP);
+    emcs51_core_read_xdata(&emcs51_core, 0x0190, &data);
+    if (data != 0x5A)
+    {
+        snprintf(t->msg, sizeof(t->msg), "wrapped read 0x%02X", data);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    emcs51_core_set_xdata_unmapped(&emcs51_core, EMCS51_XDATA_UNMAPPED_IGNORE);
+    emcs51_core_read_xdata(&emcs51_core, 0xF000, &data);
+    if (data != 0xFF)
+    {
+        snprintf(t->msg, sizeof(t->msg), "ignored read 0x%02X", data);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    t->err = EMCS51_OK;
+}
@@ -0,0 +1,281 @@
+#define _GNU_SOURCE // usleep, MSG_NOSIGNAL
+
+#include <stdlib.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "emcs51.h"
+#include "emcs51_testing.h"
+#include "host/emcs51_gdb.h"
+
+#define GDB_TEST_TIMEOUT_MS 2000
+
+static const uint8_t gdb_test_code_memory[] = {
+    0x78, 0x05, // 0x00 MOV R0, #05H
+    0x00,       // 0x02 NOP
+    0xD8, 0xFD, // 0x03 DJNZ R0, 0x02
+    0x80, 0xFE, // 0x05 SJMP $
+};
+
+typedef struct GDB_TEST_CLIENT
+{
+    int fd;
+    char rx[EMCS51_GDB_PACKET_SIZE];
+    uint32_t rx_len;
+    char reply[EMCS51_GDB_PACKET_SIZE];
+} gdb_test_client_t;
+
+static void *emcs51_gdb_test_run_thread(void *arg)
+{
+    emcs51_gdb_run((emcs51_gdb_t *)arg);
+
+    return NULL;
+}
+
+static int emcs51_gdb_test_send_raw(gdb_test_client_t *c, const char *buf, size_t len)
+{
+    return (send(c->fd, buf, len, MSG_NOSIGNAL) == (ssize_t)len) ? EMCS51_OK : EMCS51_ERR_STREAM;
+}
+
+/*******************************************************************************
+ * @brief 接收一个报文到 c->reply，跳过应答字符，校验和正确时回复 '+'
+ ******************************************************************************/
+static int emcs51_gdb_test_recv(gdb_test_client_t *c)
+{
+    struct pollfd pfd = {.fd = c->fd, .events = POLLIN};
+
+    for (;;)
+    {
+        char *start = memchr(c->rx, '$', c->rx_len);
+        char *end = (start != NULL) ? memchr(start, '#', c->rx_len - (uint32_t)(start - c->rx)) : NULL;
+
+        if ((end != NULL) && ((uint32_t)(end - c->rx) + 3 <= c->rx_len))
+        {
+            uint32_t len = (uint32_t)(end - start - 1);
+            uint32_t used = (uint32_t)(end - c->rx) + 3;
+            unsigned expect;
+            uint8_t cs = 0;
+
+            for (uint32_t i = 0; i < len; i++)
+                cs += (uint8_t)start[1 + i];
+
+            memcpy(c->reply, start + 1, len);
+            c->reply[len] = '\0';
+
+            if ((sscanf(end + 1, "%2x", &expect) != 1) || (expect != cs))
+                return EMCS51_ERR;
+
+            memmove(c->rx, c->rx + used, c->rx_len - used);
+            c->rx_len -= used;
+
+            return emcs51_gdb_test_send_raw(c, "+", 1);
+        }
+
+        if ((c->rx_len == sizeof(c->rx)) || (poll(&pfd, 1, GDB_TEST_TIMEOUT_MS) <= 0))
+            return EMCS51_ERR_STREAM;
+
+        ssize_t n = recv(c->fd, c->rx + c->rx_len, sizeof(c->rx) - c->rx_len, 0);
+        if (n <= 0)
+            return EMCS51_ERR_STREAM;
+
+        c->rx_len += (uint32_t)n;
+    }
+}
+
+/*******************************************************************************
+ * @brief 发送报文并等待应答报文，应答与 expect 不同时失败（expect 为NULL时不比较）
+ ******************************************************************************/
+static int emcs51_gdb_test_transact(emcs51_testing_t *t, gdb_test_client_t *c, const char *payload, const char *expect)
+{
+    char packet[128];
+    uint8_t cs = 0;
+
+    for (const char *p = payload; *p; p++)
+        cs += (uint8_t)*p;
+
+    snprintf(packet, sizeof(packet), "$%s#%02x", payload, cs);
+
+    if ((emcs51_gdb_test_send_raw(c, packet, strlen(packet)) < 0) || (emcs51_gdb_test_recv(c) < 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "'%s' got no reply", payload);
+        return 0;
+    }
+
+    if ((expect != NULL) && (strcmp(c->reply, expect) != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "'%s' replied '%.40s', expected '%s'", payload, c->reply, expect);
+        return 0;
+    }
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 检查 g 报文中 R0 和 PC 的值
+ ******************************************************************************/
+static int emcs51_gdb_test_regs(emcs51_testing_t *t, gdb_test_client_t *c, const char *r0, const char *pc)
+{
+    if (!emcs51_gdb_test_transact(t, c, "g", NULL))
+        return 0;
+
+    if ((strlen(c->reply) != EMCS51_GDB_REG_COUNT * 2 + 2) || (strncmp(&c->reply[EMCS51_GDB_REG_R0 * 2], r0, 2) != 0) ||
+        (strcmp(&c->reply[EMCS51_GDB_REG_PC * 2], pc) != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "g replied '%.40s', expected R0 %s PC %s", c->reply, r0, pc);
+        return 0;
+    }
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 按调试器的顺序交互：查询、读寄存器和code区、断点、继续、单步、中断
+ ******************************************************************************/
+static int emcs51_gdb_test_session(emcs51_testing_t *t, gdb_test_client_t *c)
+{
+    if (!emcs51_gdb_test_transact(t, c, "?", "S05") || !emcs51_gdb_test_regs(t, c, "00", "0000") ||
+        !emcs51_gdb_test_transact(t, c, "m0,7", "780500d8fd80fe"))
+        return 0;
+
+    // 断点在 NOP：MOV R0 之后停止
+    if (!emcs51_gdb_test_transact(t, c, "Z0,2,1", "OK") || !emcs51_gdb_test_transact(t, c, "c", "T05swbreak:;") ||
+        !emcs51_gdb_test_regs(t, c, "05", "0200"))
+        return 0;
+
+    // 从断点处单步，不会再次命中同一断点
+    if (!emcs51_gdb_test_transact(t, c, "s", "S05") || !emcs51_gdb_test_regs(t, c, "05", "0300") ||
+        !emcs51_gdb_test_transact(t, c, "c", "T05swbreak:;") || !emcs51_gdb_test_regs(t, c, "04", "0200"))
+        return 0;
+
+    // 删除断点后停在 SJMP $，由中断请求暂停
+    if (!emcs51_gdb_test_transact(t, c, "z0,2,1", "OK"))
+        return 0;
+
+    if (emcs51_gdb_test_send_raw(c, "$c#63", 5) < 0)
+        return 0;
+
+    usleep(10000);
+
+    if ((emcs51_gdb_test_send_raw(c, "\x03", 1) < 0) || (emcs51_gdb_test_recv(c) < 0) || (strcmp(c->reply, "S02") != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "interrupt replied '%.40s'", c->reply);
+        return 0;
+    }
+
+    return emcs51_gdb_test_regs(t, c, "00", "0500") && emcs51_gdb_test_transact(t, c, "m800000,1", "00");
+}
+
+static int emcs51_gdb_test_connect(emcs51_testing_t *t, gdb_test_client_t *c, const char *path)
+{
+    struct sockaddr_un sa;
+
+    memset(c, 0, sizeof(gdb_test_client_t));
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, path);
+
+    c->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if ((c->fd < 0) || (connect(c->fd, (struct sockaddr *)&sa, sizeof(sa)) != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "connect to %s failed: %s", path, strerror(errno));
+        return 0;
+    }
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 调试器在目标运行时断开：断点必须被删除，重新连接后不会停在旧断点上
+ ******************************************************************************/
+static int emcs51_gdb_test_reconnect(emcs51_testing_t *t, gdb_test_client_t *c, const char *path)
+{
+    // 断点在 NOP，从 SJMP $ 继续运行，运行中断开
+    if (!emcs51_gdb_test_transact(t, c, "Z0,2,1", "OK") || !emcs51_gdb_test_transact(t, c, "Pd=0500", "OK") ||
+        (emcs51_gdb_test_send_raw(c, "$c#63", 5) < 0))
+        return 0;
+
+    usleep(10000);
+    close(c->fd);
+
+    if (!emcs51_gdb_test_connect(t, c, path))
+        return 0;
+
+    // 新连接使目标暂停；从头运行，经过旧断点所在的 NOP 后停在 SJMP $
+    if (!emcs51_gdb_test_transact(t, c, "?", "S02") || !emcs51_gdb_test_transact(t, c, "Pd=0000", "OK") ||
+        (emcs51_gdb_test_send_raw(c, "$c#63", 5) < 0))
+        return 0;
+
+    usleep(10000);
+
+    if ((emcs51_gdb_test_send_raw(c, "\x03", 1) < 0) || (emcs51_gdb_test_recv(c) < 0) || (strcmp(c->reply, "S02") != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "after reconnect replied '%.40s'", c->reply);
+        return 0;
+    }
+
+    return emcs51_gdb_test_regs(t, c, "00", "0500");
+}
+
+/*******************************************************************************
+ * @brief 测试：通过Unix域套接字驱动GDB远程串行协议服务
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_gdb(emcs51_testing_t *t)
+{
+    static emcs51_gdb_t gdb;
+    static gdb_test_client_t client;
+    emcs51_core_t core;
+    pthread_t run_thread;
+    char path[64];
+    int ok = 0;
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = gdb_test_code_memory,
+        .code_len = sizeof(gdb_test_code_memory),
+    };
+
+    emcs51_gdb_config_t gdb_config = {
+        .unix_path = path,
+        .burst_cycles = 100,
+    };
+
+    emcs51_core_init(&core, &config);
+    emcs51_general_inst_init(&core);
+
+    snprintf(path, sizeof(path), "/tmp/emcs51_gdb_test_%ld.sock", (long)getpid());
+
+    t->err = emcs51_gdb_init(&gdb, &core, &gdb_config);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "gdb init on %s failed", path);
+        return;
+    }
+
+    // RSP线程在初始化时已开始监听，先连接再启动仿真线程
+    if (!emcs51_gdb_test_connect(t, &client, path))
+        goto cleanup;
+
+    if (pthread_create(&run_thread, NULL, emcs51_gdb_test_run_thread, &gdb) != 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "cannot start the emulation thread");
+        goto cleanup;
+    }
+
+    ok = emcs51_gdb_test_session(t, &client) && emcs51_gdb_test_reconnect(t, &client, path);
+
+    // k 使 emcs51_gdb_run() 返回，即使仿真线程仍在运行
+    emcs51_gdb_test_send_raw(&client, "$k#6b", 5);
+    pthread_join(run_thread, NULL);
+
+cleanup:
+    if (client.fd >= 0)
+        close(client.fd);
+
+    emcs51_gdb_deinit(&gdb);
+
+    t->err = ok ? EMCS51_OK : EMCS51_ERR;
+}
@@ -0,0 +1,251 @@
+#define _GNU_SOURCE // mkdtemp, ftruncate, utimensat
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "emcs51.h"
+#include "emcs51_testing.h"
+#include "host/emcs51_image.h"
+
+static const uint8_t image_test_code_memory[] = {
+    0x75, 0x30, 0x5A, // MOV 30H, #5AH
+    0x80, 0xFE,       // SJMP $
+};
+
+static const char image_test_hex[] =
+    ":0500000075305A80FE7E\n"
+    ":00000001FF\n";
+
+// 重新生成的HEX：MOV 30H, #5AH; NOP; SJMP $
+static const char image_test_hex_rebuilt[] =
+    ":0600000075305A0080FE7D\n"
+    ":00000001FF\n";
+
+typedef struct IMAGE_TEST_DIR
+{
+    char dir[64];
+    char bin[96];
+    char hex[96];
+    char cache[96];
+    char ihx[96];
+    char ihx_cache[96];
+    char empty[96];
+    char big[96];
+} image_test_dir_t;
+
+/*******************************************************************************
+ * @brief 写入测试文件，size 大于 len 时文件尾部为空洞
+ ******************************************************************************/
+static int emcs51_image_test_write(const char *path, const void *data, size_t len, off_t size)
+{
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int ok;
+
+    if (fd < 0)
+        return EMCS51_ERR_STREAM;
+
+    ok = (write(fd, data, len) == (ssize_t)len) && (ftruncate(fd, size) == 0);
+    close(fd);
+
+    return ok ? EMCS51_OK : EMCS51_ERR_STREAM;
+}
+
+static void emcs51_image_test_cleanup(image_test_dir_t *d)
+{
+    unlink(d->bin);
+    unlink(d->hex);
+    unlink(d->cache);
+    unlink(d->ihx);
+    unlink(d->ihx_cache);
+    unlink(d->empty);
+    unlink(d->big);
+    rmdir(d->dir);
+}
+
+/*******************************************************************************
+ * @brief 两个核心共用一份映射，各自运行到 SJMP $
+ ******************************************************************************/
+static int emcs51_image_test_share(emcs51_testing_t *t, const emcs51_image_t *img)
+{
+    emcs51_core_config_t config = {0};
+    emcs51_core_t cores[2];
+
+    emcs51_image_config(img, &config);
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        emcs51_core_init(&cores[i], &config);
+        emcs51_general_inst_init(&cores[i]);
+
+        if ((emcs51_core_run(&cores[i], 10) < 0) || (cores[i].code_buffer != img->data) ||
+            (cores[i].data_ram[0x30] != 0x5A) || (cores[i].reg.pc != 0x03))
+        {
+            snprintf(t->msg, sizeof(t->msg), "core %u on source %u: pc %04X", (unsigned)i, (unsigned)img->source, cores[i].reg.pc);
+            return EMCS51_ERR;
+        }
+    }
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 测试：映射 .bin、.hex 和 .ihx，旁路缓存及其失效，多核心共享、大小限制和解除映射
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_image(emcs51_testing_t *t)
+{
+    static const uint8_t zero = 0;
+    image_test_dir_t d;
+    emcs51_image_t img = {0};
+    int err;
+
+    snprintf(d.dir, sizeof(d.dir), "/tmp/emcs51_image_XXXXXX");
+    if (mkdtemp(d.dir) == NULL)
+    {
+        snprintf(t->msg, sizeof(t->msg), "mkdtemp failed");
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    snprintf(d.bin, sizeof(d.bin), "%s/fw.bin", d.dir);
+    snprintf(d.hex, sizeof(d.hex), "%s/fw.hex", d.dir);
+    snprintf(d.cache, sizeof(d.cache), "%s/fw.hex.bin", d.dir);
+    snprintf(d.ihx, sizeof(d.ihx), "%s/fw.ihx", d.dir);
+    snprintf(d.ihx_cache, sizeof(d.ihx_cache), "%s/fw.ihx.bin", d.dir);
+    snprintf(d.empty, sizeof(d.empty), "%s/empty.bin", d.dir);
+    snprintf(d.big, sizeof(d.big), "%s/big.bin", d.dir);
+
+    t->err = EMCS51_ERR;
+
+    if ((emcs51_image_test_write(d.bin, image_test_code_memory, sizeof(image_test_code_memory), sizeof(image_test_code_memory)) < 0) ||
+        (emcs51_image_test_write(d.hex, image_test_hex, strlen(image_test_hex), (off_t)strlen(image_test_hex)) < 0) ||
+        (emcs51_image_test_write(d.ihx, image_test_hex, strlen(image_test_hex), (off_t)strlen(image_test_hex)) < 0) ||
+        (emcs51_image_test_write(d.empty, NULL, 0, 0) < 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "cannot write test files");
+        goto cleanup;
+    }
+
+    // .bin 直接映射
+    err = emcs51_image_map(&img, d.bin);
+    if ((err != EMCS51_OK) || (img.source != EMCS51_IMAGE_SOURCE_BIN) || (img.len != sizeof(image_test_code_memory)) ||
+        (memcmp(img.data, image_test_code_memory, img.len) != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "bin map err %s", emcs51_err_name(err));
+        goto cleanup;
+    }
+
+    if (emcs51_image_test_share(t, &img) < 0)
+        goto cleanup;
+
+    emcs51_image_unmap(&img);
+    if ((img.data != NULL) || (img.map != NULL) || (img.len != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "unmap must clear the image");
+        goto cleanup;
+    }
+
+    // 重复解除映射无操作
+    emcs51_image_unmap(&img);
+
+    // .hex 第一次解析并写入旁路缓存，第二次直接映射缓存
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        uint8_t source = (i == 0) ? EMCS51_IMAGE_SOURCE_HEX_PARSE : EMCS51_IMAGE_SOURCE_HEX_CACHE;
+
+        err = emcs51_image_map(&img, d.hex);
+        if ((err != EMCS51_OK) || (img.source != source) || (img.len != sizeof(image_test_code_memory)) ||
+            (memcmp(img.data, image_test_code_memory, img.len) != 0) || (access(d.cache, R_OK) != 0))
+        {
+            snprintf(t->msg, sizeof(t->msg), "hex map %u err %s source %u", (unsigned)i, emcs51_err_name(err), (unsigned)img.source);
+            goto cleanup;
+        }
+
+        if (emcs51_image_test_share(t, &img) < 0)
+            goto cleanup;
+
+        emcs51_image_unmap(&img);
+    }
+
+    // 与缓存同一时刻重新生成的HEX不能使用旧缓存
+    {
+        struct stat cache_st;
+        struct timespec times[2];
+
+        if ((stat(d.cache, &cache_st) != 0) ||
+            (emcs51_image_test_write(d.hex, image_test_hex_rebuilt, strlen(image_test_hex_rebuilt), (off_t)strlen(image_test_hex_rebuilt)) < 0))
+        {
+            snprintf(t->msg, sizeof(t->msg), "cannot rebuild %s", d.hex);
+            goto cleanup;
+        }
+
+        times[0] = cache_st.st_mtim;
+        times[1] = cache_st.st_mtim;
+        utimensat(AT_FDCWD, d.hex, times, 0);
+
+        err = emcs51_image_map(&img, d.hex);
+        if ((err != EMCS51_OK) || (img.source != EMCS51_IMAGE_SOURCE_HEX_PARSE) || (img.len != 6) || (img.data[3] != 0x00))
+        {
+            snprintf(t->msg, sizeof(t->msg), "rebuilt hex err %s source %u len %u", emcs51_err_name(err), (unsigned)img.source,
+                     (unsigned)img.len);
+            goto cleanup;
+        }
+
+        emcs51_image_unmap(&img);
+    }
+
+    // SDCC 的 .ihx 同样按Intel HEX处理
+    err = emcs51_image_map(&img, d.ihx);
+    if ((err != EMCS51_OK) || (img.source != EMCS51_IMAGE_SOURCE_HEX_PARSE) || (img.len != sizeof(image_test_code_memory)) ||
+        (memcmp(img.data, image_test_code_memory, img.len) != 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "ihx map err %s source %u", emcs51_err_name(err), (unsigned)img.source);
+        goto cleanup;
+    }
+
+    emcs51_image_unmap(&img);
+
+    // 空文件和超过 1 MiB 的文件
+    err = emcs51_image_map(&img, d.empty);
+    if ((err != EMCS51_ERR_CODE_OUT_OF_RANGE) || (img.data != NULL))
+    {
+        snprintf(t->msg, sizeof(t->msg), "empty image err %s", emcs51_err_name(err));
+        goto cleanup;
+    }
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        off_t size = EMCS51_IMAGE_MAX_SIZE + i;
+        int expect = (i == 0) ? EMCS51_OK : EMCS51_ERR_CODE_OUT_OF_RANGE;
+
+        if (emcs51_image_test_write(d.big, &zero, 1, size) < 0)
+        {
+            snprintf(t->msg, sizeof(t->msg), "cannot write %s", d.big);
+            goto cleanup;
+        }
+
+        err = emcs51_image_map(&img, d.big);
+        if ((err != expect) || ((err == EMCS51_OK) && (img.len != EMCS51_IMAGE_MAX_SIZE)))
+        {
+            snprintf(t->msg, sizeof(t->msg), "image of %ld bytes err %s", (long)size, emcs51_err_name(err));
+            goto cleanup;
+        }
+
+        emcs51_image_unmap(&img);
+    }
+
+    err = emcs51_image_map(&img, d.dir);
+    if (err == EMCS51_OK)
+    {
+        snprintf(t->msg, sizeof(t->msg), "mapping a directory must fail");
+        goto cleanup;
+    }
+
+    t->err = EMCS51_OK;
+
+cleanup:
+    emcs51_image_unmap(&img);
+    emcs51_image_test_cleanup(&d);
+}
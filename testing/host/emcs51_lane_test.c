@@ -0,0 +1,207 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+#define LANE_TEST_LANES 8
+#define LANE_TEST_XDATA_SIZE 0x200
+
+static const uint8_t lane_test_code_memory[] = {
+    0x90, 0x01, 0x00, // 0x00 MOV DPTR, #0100H
+    0xE5, 0x30,       // 0x03 MOV A, 30H
+    0xF0,             // 0x05 MOVX @DPTR, A
+    0xA3,             // 0x06 INC DPTR
+    0x05, 0x30,       // 0x07 INC 30H
+    0xE5, 0x30,       // 0x09 MOV A, 30H
+    0xD8, 0xF8,       // 0x0B DJNZ R0, 0x05，各lane的循环次数不同
+    0x78, 0x40,       // 0x0D MOV R0, #40H
+    0xF6,             // 0x0F MOV @R0, A
+    0x90, 0x01, 0x00, // 0x10 MOV DPTR, #0100H
+    0xE0,             // 0x13 MOVX A, @DPTR
+    0xC2, 0x00,       // 0x14 CLR 20H.0
+    0xD2, 0x01,       // 0x16 SETB 20H.1
+    0xD2, 0x90,       // 0x18 SETB P1.0，P1 有写入回调，回退到标量核心执行
+    0x90, 0x00, 0x00, // 0x1A MOV DPTR, #0000H
+    0x93,             // 0x1D MOVC A, @A+DPTR
+    0x75, 0xA0, 0x01, // 0x1E MOV P2, #01H
+    0x79, 0x20,       // 0x21 MOV R1, #20H
+    0xF3,             // 0x23 MOVX @R1, A
+    0xE4,             // 0x24 CLR A
+    0x83,             // 0x25 MOVC A, @A+PC
+    0xE3,             // 0x26 MOVX A, @R1
+    0x80, 0xFE,       // 0x27 SJMP $
+};
+
+typedef struct LANE_TEST_PORT
+{
+    uint32_t count;
+    uint8_t data;
+    uint8_t iram_30h; // 回调时看到的 30H，检查回退执行前IRAM已同步
+} lane_test_port_t;
+
+static emcs51_lane_core_t lane_test_lc;
+static uint8_t lane_test_xdata[LANE_TEST_LANES][LANE_TEST_XDATA_SIZE];
+static uint8_t lane_test_scalar_xdata[LANE_TEST_XDATA_SIZE];
+static lane_test_port_t lane_test_port[LANE_TEST_LANES];
+
+static int emcs51_lane_test_port_write_cb(emcs51_core_t *core, void *user, uint8_t addr, uint8_t data)
+{
+    lane_test_port_t *port = user;
+
+    port->count++;
+    port->data = data;
+    port->iram_30h = core->data_ram[0x30];
+
+    return EMCS51_OK;
+}
+
+/*******************************************************************************
+ * @brief 初始化一个运行测试程序的标量核心，R0 和 30H 取决于lane编号
+ ******************************************************************************/
+static void emcs51_lane_test_core_init(emcs51_core_t *core, uint32_t lane, uint8_t *xdata, lane_test_port_t *port)
+{
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = lane_test_code_memory,
+        .code_len = sizeof(lane_test_code_memory),
+        .user = port,
+    };
+
+    emcs51_core_init(core, &config);
+    emcs51_general_inst_init(core);
+    emcs51_core_reg_add(core, 0x90, emcs51_lane_test_port_write_cb, NULL);
+
+    memset(xdata, 0, LANE_TEST_XDATA_SIZE);
+    emcs51_core_set_xdata_ram(core, xdata, LANE_TEST_XDATA_SIZE);
+    memset(port, 0, sizeof(lane_test_port_t));
+
+    // 最后一个lane R0 为0，循环256次
+    core->data_ram[0x00] = (uint8_t)((lane + 1) % LANE_TEST_LANES);
+    core->data_ram[0x30] = (uint8_t)(lane * 3);
+}
+
+/*******************************************************************************
+ * @brief 测试：lane引擎与标量核心逐lane比较寄存器、IRAM、XDATA和计数，以及断点和覆盖率
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_lane(emcs51_testing_t *t)
+{
+    emcs51_lane_core_t *lc = &lane_test_lc;
+    emcs51_core_t scalar;
+    emcs51_core_t ref;
+    emcs51_core_t lane_state;
+    lane_test_port_t ref_port;
+    emcs51_break_t brk;
+    static emcs51_coverage_t cov;
+
+    emcs51_lane_test_core_init(&scalar, 0, lane_test_xdata[0], &lane_test_port[0]);
+
+    t->err = emcs51_lane_init(lc, &scalar, LANE_TEST_LANES);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "lane init failed");
+        return;
+    }
+
+    for (uint32_t lane = 0; lane < LANE_TEST_LANES; lane++)
+    {
+        emcs51_lane_test_core_init(&ref, lane, lane_test_xdata[lane], &lane_test_port[lane]);
+        emcs51_lane_import(lc, lane, &ref);
+    }
+
+    emcs51_lane_run(lc, 2000);
+
+    if ((lc->stats.vector_inst == 0) || (lc->stats.fallback_inst == 0) || (lc->stats.divergent_steps == 0))
+    {
+        snprintf(t->msg, sizeof(t->msg), "vector:%llu fallback:%llu divergent:%llu", (unsigned long long)lc->stats.vector_inst,
+                 (unsigned long long)lc->stats.fallback_inst, (unsigned long long)lc->stats.divergent_steps);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    lane_state = scalar;
+
+    for (uint32_t lane = 0; lane < LANE_TEST_LANES; lane++)
+    {
+        emcs51_lane_test_core_init(&ref, lane, lane_test_scalar_xdata, &ref_port);
+
+        t->err = emcs51_core_run(&ref, lc->cycles[lane]);
+        if (t->err < 0)
+        {
+            snprintf(t->msg, sizeof(t->msg), "lane %u scalar run failed", (unsigned)lane);
+            return;
+        }
+
+        emcs51_lane_export(lc, lane, &lane_state);
+
+        if ((lane_state.reg.pc != 0x27) || (lane_state.err != ref.err) || (lane_state.reg.pc != ref.reg.pc) ||
+            (lane_state.reg.a != ref.reg.a) || (lane_state.reg.b != ref.reg.b) || (lane_state.reg.sp != ref.reg.sp) ||
+            (lane_state.reg.psw != ref.reg.psw) || (lane_state.inst_count != ref.inst_count) || (lane_state.cycles != ref.cycles))
+        {
+            snprintf(t->msg, sizeof(t->msg), "lane %u pc:%04X/%04X a:%02X/%02X inst:%llu/%llu cycles:%llu/%llu", (unsigned)lane,
+                     lane_state.reg.pc, ref.reg.pc, lane_state.reg.a, ref.reg.a, (unsigned long long)lane_state.inst_count,
+                     (unsigned long long)ref.inst_count, (unsigned long long)lane_state.cycles, (unsigned long long)ref.cycles);
+            t->err = EMCS51_ERR;
+            return;
+        }
+
+        if (memcmp(lane_state.data_ram, ref.data_ram, sizeof(ref.data_ram)) != 0)
+        {
+            snprintf(t->msg, sizeof(t->msg), "lane %u data_ram differs", (unsigned)lane);
+            t->err = EMCS51_ERR;
+            return;
+        }
+
+        if (memcmp(lane_test_xdata[lane], lane_test_scalar_xdata, LANE_TEST_XDATA_SIZE) != 0)
+        {
+            snprintf(t->msg, sizeof(t->msg), "lane %u xdata differs", (unsigned)lane);
+            t->err = EMCS51_ERR;
+            return;
+        }
+
+        if ((lane_test_port[lane].count != 1) || (memcmp(&lane_test_port[lane], &ref_port, sizeof(ref_port)) != 0))
+        {
+            snprintf(t->msg, sizeof(t->msg), "lane %u P1 write count:%u 30H:%02X/%02X", (unsigned)lane, (unsigned)lane_test_port[lane].count,
+                     lane_test_port[lane].iram_30h, ref_port.iram_30h);
+            t->err = EMCS51_ERR;
+            return;
+        }
+    }
+
+    // 初始化之后添加的断点：DJNZ 有向量实现，仍须在每个lane上停止
+    emcs51_lane_test_core_init(&scalar, 0, lane_test_xdata[0], &lane_test_port[0]);
+    emcs51_lane_init(lc, &scalar, LANE_TEST_LANES);
+    emcs51_break_init(&brk, &scalar);
+    emcs51_break_add(&brk, 0x000B, NULL, NULL, 0);
+
+    emcs51_lane_run(lc, 100);
+    emcs51_break_deinit(&brk);
+
+    for (uint32_t lane = 0; lane < LANE_TEST_LANES; lane++)
+    {
+        if ((lc->err[lane] != EMCS51_ERR_BREAKPOINT) || (lc->pc[lane] != 0x000B) || (lc->inst_count[lane] != 6))
+        {
+            snprintf(t->msg, sizeof(t->msg), "lane %u breakpoint err %s pc %04X inst %llu", (unsigned)lane,
+                     emcs51_err_name(lc->err[lane]), lc->pc[lane], (unsigned long long)lc->inst_count[lane]);
+            t->err = EMCS51_ERR;
+            return;
+        }
+    }
+
+    // 挂接覆盖率时全部回退执行，每条指令都被记录
+    emcs51_lane_test_core_init(&scalar, 0, lane_test_xdata[0], &lane_test_port[0]);
+    emcs51_lane_init(lc, &scalar, LANE_TEST_LANES);
+    emcs51_coverage_init(&cov, &scalar, NULL, 0);
+
+    emcs51_lane_run(lc, 2000);
+    emcs51_coverage_deinit(&cov);
+
+    if ((lc->stats.vector_inst != 0) || (emcs51_coverage_count(&cov) != sizeof(lane_test_code_memory)))
+    {
+        snprintf(t->msg, sizeof(t->msg), "coverage vector:%llu covered:%u", (unsigned long long)lc->stats.vector_inst,
+                 (unsigned)emcs51_coverage_count(&cov));
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    t->err = EMCS51_OK;
+}
@@ -0,0 +1,128 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+#include "host/emcs51_runner.h"
+
+#define RUNNER_TEST_INSTANCES 9
+#define RUNNER_TEST_SETUP_FAIL 5 // 该实例的 setup_cb 失败
+#define RUNNER_TEST_BAD_INST 7   // 该实例从未定义的指令开始执行
+#define RUNNER_TEST_MAX_CYCLES 30000
+
+static const uint8_t runner_test_code_memory[] = {
+    0x05, 0x30, // 0x00 INC 30H，1个周期
+    0x80, 0xFC, // 0x02 SJMP 0x00，2个周期
+    0xA5,       // 0x04 未定义的指令
+};
+
+typedef struct RUNNER_TEST_INSTANCE
+{
+    uint8_t counter;   // 结束时的 30H
+    uint8_t teardowns; // teardown_cb 调用次数
+} runner_test_instance_t;
+
+static runner_test_instance_t runner_test_instances[RUNNER_TEST_INSTANCES];
+
+static int emcs51_runner_test_setup_cb(emcs51_core_t *core, uint32_t index, void *user)
+{
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = runner_test_code_memory,
+        .code_len = sizeof(runner_test_code_memory),
+        .user = &runner_test_instances[index],
+    };
+
+    if (index == RUNNER_TEST_SETUP_FAIL)
+        return EMCS51_ERR;
+
+    emcs51_core_init(core, &config);
+    emcs51_general_inst_init(core);
+
+    // 每个实例的计数器起点不同
+    core->data_ram[0x30] = (uint8_t)index;
+
+    if (index == RUNNER_TEST_BAD_INST)
+        core->reg.pc = 0x04;
+
+    return EMCS51_OK;
+}
+
+static void emcs51_runner_test_teardown_cb(emcs51_core_t *core, uint32_t index, void *user)
+{
+    runner_test_instance_t *inst = (runner_test_instance_t *)core->user;
+
+    inst->counter = core->data_ram[0x30];
+    inst->teardowns++;
+}
+
+/*******************************************************************************
+ * @brief 测试：多线程运行多个实例到周期上限，检查每个实例的结果和停止原因
+ * @param none
+ * @return none
+ ******************************************************************************/
+void emcs51_test_runner(emcs51_testing_t *t)
+{
+    emcs51_runner_result_t results[RUNNER_TEST_INSTANCES];
+    emcs51_runner_summary_t summary;
+    emcs51_runner_config_t config = {
+        .instance_count = RUNNER_TEST_INSTANCES,
+        .thread_count = 3,
+        .slice_cycles = 999,
+        .max_cycles = RUNNER_TEST_MAX_CYCLES,
+        .setup_cb = emcs51_runner_test_setup_cb,
+        .teardown_cb = emcs51_runner_test_teardown_cb,
+    };
+    uint32_t loops = RUNNER_TEST_MAX_CYCLES / 3;
+
+    memset(runner_test_instances, 0, sizeof(runner_test_instances));
+
+    t->err = emcs51_runner_run(&config, results, &summary);
+    if (t->err < 0)
+    {
+        snprintf(t->msg, sizeof(t->msg), "runner failed");
+        return;
+    }
+
+    for (uint32_t i = 0; i < RUNNER_TEST_INSTANCES; i++)
+    {
+        emcs51_runner_result_t *r = &results[i];
+        runner_test_instance_t *inst = &runner_test_instances[i];
+        uint8_t ok;
+
+        if (i == RUNNER_TEST_SETUP_FAIL)
+        {
+            ok = (r->stop_reason == EMCS51_RUNNER_STOP_SETUP) && (r->err == EMCS51_ERR) && (r->cycles == 0) && (inst->teardowns == 0);
+        }
+        else if (i == RUNNER_TEST_BAD_INST)
+        {
+            ok = (r->stop_reason == EMCS51_RUNNER_STOP_ERR) && (r->err == EMCS51_ERR_UNKNOWN_INST) &&
+                 (r->inst_count == 0) && (inst->teardowns == 1);
+        }
+        else
+        {
+            // 每圈3个周期，恰好在上限处结束于 INC 30H 之前
+            ok = (r->stop_reason == EMCS51_RUNNER_STOP_MAX_CYCLES) && (r->err == EMCS51_OK) &&
+                 (r->cycles == RUNNER_TEST_MAX_CYCLES) && (r->inst_count == (uint64_t)loops * 2) && (r->pc == 0x00) &&
+                 (r->slices == ((RUNNER_TEST_MAX_CYCLES + 998) / 999)) &&
+                 (inst->counter == (uint8_t)(i + loops)) && (inst->teardowns == 1);
+        }
+
+        if (!ok)
+        {
+            snprintf(t->msg, sizeof(t->msg), "instance %u stop:%u err:%d cycles:%llu inst:%llu slices:%u counter:%u teardowns:%u",
+                     (unsigned)i, (unsigned)r->stop_reason, r->err, (unsigned long long)r->cycles,
+                     (unsigned long long)r->inst_count, (unsigned)r->slices, (unsigned)inst->counter, (unsigned)inst->teardowns);
+            t->err = EMCS51_ERR;
+            return;
+        }
+    }
+
+    if ((summary.instance_count != RUNNER_TEST_INSTANCES) || (summary.thread_count != 3) || (summary.errors != 2) ||
+        (summary.total_cycles != (uint64_t)RUNNER_TEST_MAX_CYCLES * (RUNNER_TEST_INSTANCES - 2)))
+    {
+        snprintf(t->msg, sizeof(t->msg), "summary errors:%u cycles:%llu", (unsigned)summary.errors,
+                 (unsigned long long)summary.total_cycles);
+        t->err = EMCS51_ERR;
+        return;
+    }
+
+    t->err = EMCS51_OK;
+}
@@ -0,0 +1,27 @@
+#include "emcs51.h"
+#include "emcs51_testing.h"
+
+void emcs51_test_runner(emcs51_testing_t *t);
+void emcs51_test_lane(emcs51_testing_t *t);
+void emcs51_test_image(emcs51_testing_t *t);
+void emcs51_test_gdb(emcs51_testing_t *t);
+
+// 只能在主机上运行的测试：线程、mmap 和套接字
+static const emcs51_testing_config_t host_tests[] = {
+    {"Host Runner Test", emcs51_test_runner},
+    {"Lane Engine Test", emcs51_test_lane},
+    {"Mapped Image Test", emcs51_test_image},
+    {"GDB Stub Test", emcs51_test_gdb},
+    {"", NULL},
+};
+
+// 主机上运行全部测试，供 ctest 使用：任一测试失败时返回非0
+int main(void)
+{
+    int err = emcs51_testing();
+
+    if (err == EMCS51_OK)
+        err = emcs51_testing_run(host_tests);
+
+    return (err == EMCS51_OK) ? 0 : 1;
+}
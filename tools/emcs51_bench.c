@@ -0,0 +1,475 @@
+#include <stdlib.h>
+#include <getopt.h>
+#include <time.h>
+#include "emcs51.h"
+#include "host/emcs51_image.h"
+
+// 基准测试：对 bench/ 下预编译的8051程序，分别用各执行引擎运行固定的机器周期数，
+// 报告模拟的 MIPS、每主机秒的机器周期数和每条指令的主机纳秒数。
+// -j 输出JSON，每个结果独占一行，供 emcs51_bench_compare 和回归记录使用
+
+#ifndef EMCS51_BENCH_DIR
+#define EMCS51_BENCH_DIR "bench"
+#endif
+
+#ifndef EMCS51_BENCH_BUILD_TYPE
+#define EMCS51_BENCH_BUILD_TYPE "unknown"
+#endif
+
+#define EMCS51_BENCH_CYCLES_DEFAULT 5000000
+#define EMCS51_BENCH_LANES_DEFAULT 32
+#define EMCS51_BENCH_XDATA_SIZE 0x10000
+#define EMCS51_BENCH_PATH_MAX 1024
+
+typedef enum EMCS51_BENCH_ENGINES
+{
+    EMCS51_BENCH_ENGINE_CORE = 0, // emcs51_core_run()，含衍生型号的整块拷贝路径
+    EMCS51_BENCH_ENGINE_LANE,     // emcs51_lane_run()，所有lane运行同一程序
+    EMCS51_BENCH_ENGINE_COUNT,
+} emcs51_bench_engines_t;
+
+static const char *const emcs51_bench_engine_names[EMCS51_BENCH_ENGINE_COUNT] = {"core", "lane"};
+
+typedef struct EMCS51_BENCH_WORKLOAD
+{
+    const char *name; // 镜像为 <name>.bin，源程序为 <name>.a51
+    const char *derivative;
+    uint8_t port_sink; // 在该端口上挂写回调模拟外设，0 表示无
+} emcs51_bench_workload_t;
+
+static const emcs51_bench_workload_t emcs51_bench_workloads[] = {
+    {"blink", "8051", 0},
+    {"memset_xdata", "8051", 0},
+    {"memcpy_xdata", "AT89S52", 0},
+    {"memcpy_pdata", "8051", 0},
+    {"table_lookup", "8051", 0},
+    {"gpio_bitbang", "8051", 0x90},
+    {"mix", "8051", 0},
+};
+
+#define EMCS51_BENCH_WORKLOAD_COUNT (sizeof(emcs51_bench_workloads) / sizeof(emcs51_bench_workloads[0]))
+
+typedef struct EMCS51_BENCH_RESULT
+{
+    const emcs51_bench_workload_t *workload;
+    uint8_t engine;
+    uint32_t lanes;
+    uint32_t run;
+
+    uint64_t inst;   // 计时期间所有实例执行的指令数
+    uint64_t cycles; // 计时期间所有实例执行的机器周期数
+    double host_s;
+    int err;
+} emcs51_bench_result_t;
+
+typedef struct EMCS51_BENCH_ARGS
+{
+    const char *dir;
+    uint64_t cycles; // 计时的机器周期数，lane引擎由所有lane平分
+    uint64_t warmup; // 计时前执行的机器周期数
+    uint32_t lanes;
+    uint32_t runs;
+    uint8_t engine_mask;
+    uint8_t json;
+} emcs51_bench_args_t;
+
+// 每个实例的外设状态
+typedef struct EMCS51_BENCH_INSTANCE
+{
+    uint8_t xdata[EMCS51_BENCH_XDATA_SIZE];
+    uint64_t port_writes;
+} emcs51_bench_instance_t;
+
+static int emcs51_bench_port_write_cb(emcs51_core_t *core, void *user, uint8_t addr, uint8_t data)
+{
+    ((emcs51_bench_instance_t *)user)->port_writes++;
+
+    return EMCS51_OK;
+}
+
+static double emcs51_bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/*******************************************************************************
+ * @brief 初始化一个运行工作负载的核心
+ ******************************************************************************/
+static void emcs51_bench_core_init(emcs51_core_t *core, const emcs51_image_t *image, const emcs51_bench_workload_t *workload,
+                                   emcs51_bench_instance_t *inst)
+{
+    emcs51_core_config_t config = {0};
+
+    emcs51_image_config(image, &config);
+    config.user = inst;
+
+    emcs51_core_init(core, &config);
+    emcs51_derivative_init(core, emcs51_derivative_find(workload->derivative));
+    emcs51_core_set_xdata_ram(core, inst->xdata, sizeof(inst->xdata));
+
+    if (workload->port_sink)
+        emcs51_core_reg_add(core, workload->port_sink, emcs51_bench_port_write_cb, NULL);
+}
+
+static int emcs51_bench_run_core(const emcs51_bench_args_t *args, const emcs51_image_t *image, emcs51_bench_result_t *result)
+{
+    emcs51_core_t *core = calloc(1, sizeof(emcs51_core_t));
+    emcs51_bench_instance_t *inst = calloc(1, sizeof(emcs51_bench_instance_t));
+    uint64_t inst_count, cycles;
+    double t0;
+    int err = EMCS51_ERR;
+
+    if ((core == NULL) || (inst == NULL))
+        goto out;
+
+    emcs51_bench_core_init(core, image, result->workload, inst);
+
+    err = emcs51_core_run(core, args->warmup);
+    if (err != EMCS51_OK)
+        goto out;
+
+    inst_count = core->inst_count;
+    cycles = core->cycles;
+
+    t0 = emcs51_bench_now();
+    err = emcs51_core_run(core, args->cycles);
+    result->host_s = emcs51_bench_now() - t0;
+
+    result->inst = core->inst_count - inst_count;
+    result->cycles = core->cycles - cycles;
+    result->lanes = 1;
+
+out:
+    free(inst);
+    free(core);
+
+    return err;
+}
+
+/*******************************************************************************
+ * @brief 运行中周期数最少的lane，所有lane都已停止时返回 lane_count
+ ******************************************************************************/
+static uint32_t emcs51_bench_lane_slowest(const emcs51_lane_core_t *lc)
+{
+    uint32_t slowest = lc->lane_count;
+
+    for (uint32_t lane = 0; lane < lc->lane_count; lane++)
+    {
+        if (lc->active[lane] && ((slowest == lc->lane_count) || (lc->cycles[lane] < lc->cycles[slowest])))
+            slowest = lane;
+    }
+
+    return slowest;
+}
+
+/*******************************************************************************
+ * @brief lane引擎：各lane的状态来自同一个预热后的标量核心，每个lane都执行完
+ *        cycles / lanes 个机器周期后停止计时，总的模拟工作量与 core 引擎相当
+ * @details 最慢的运行中lane到达预算后停止，它超出预算最多为一条指令；
+ *          锁步执行时其它lane可能多执行几条指令，计入统计
+ ******************************************************************************/
+static int emcs51_bench_run_lane(const emcs51_bench_args_t *args, const emcs51_image_t *image, emcs51_bench_result_t *result)
+{
+    emcs51_core_t *core = calloc(1, sizeof(emcs51_core_t));
+    emcs51_lane_core_t *lc = calloc(1, sizeof(emcs51_lane_core_t));
+    emcs51_bench_instance_t *inst = calloc(args->lanes, sizeof(emcs51_bench_instance_t));
+    uint64_t inst_count = 0, cycles = 0, end;
+    double t0;
+    int err = EMCS51_ERR;
+
+    if ((core == NULL) || (lc == NULL) || (inst == NULL))
+        goto out;
+
+    emcs51_bench_core_init(core, image, result->workload, &inst[0]);
+
+    err = emcs51_core_run(core, args->warmup);
+    if (err != EMCS51_OK)
+        goto out;
+
+    err = emcs51_lane_init(lc, core, args->lanes);
+    if (err != EMCS51_OK)
+        goto out;
+
+    for (uint32_t lane = 0; lane < args->lanes; lane++)
+    {
+        if (lane > 0)
+            memcpy(inst[lane].xdata, inst[0].xdata, sizeof(inst[0].xdata));
+
+        emcs51_lane_set_xdata_ram(lc, lane, inst[lane].xdata, sizeof(inst[lane].xdata));
+        emcs51_lane_set_user(lc, lane, &inst[lane]);
+    }
+
+    // 回退到标量核心的整块拷贝一次执行多条指令，按各lane的指令计数统计
+    for (uint32_t lane = 0; lane < args->lanes; lane++)
+    {
+        inst_count += lc->inst_count[lane];
+        cycles += lc->cycles[lane];
+    }
+
+    end = lc->cycles[0] + (args->cycles + args->lanes - 1) / args->lanes;
+
+    t0 = emcs51_bench_now();
+    for (;;)
+    {
+        uint32_t slowest = emcs51_bench_lane_slowest(lc);
+
+        if ((slowest == lc->lane_count) || (lc->cycles[slowest] >= end))
+            break;
+
+        // 整块拷贝等一步可能走过上千个周期，逐步检查当前最慢的lane，它到达预算后再重新找最慢的lane
+        while (lc->active[slowest] && (lc->cycles[slowest] < end))
+        {
+            if (emcs51_lane_step(lc) == 0)
+                break;
+        }
+    }
+    result->host_s = emcs51_bench_now() - t0;
+
+    result->inst = 0;
+    result->cycles = 0;
+    for (uint32_t lane = 0; lane < args->lanes; lane++)
+    {
+        result->inst += lc->inst_count[lane];
+        result->cycles += lc->cycles[lane];
+
+        if ((err == EMCS51_OK) && (lc->err[lane] < 0))
+            err = lc->err[lane];
+    }
+    result->inst -= inst_count;
+    result->cycles -= cycles;
+    result->lanes = args->lanes;
+
+out:
+    free(inst);
+    free(lc);
+    free(core);
+
+    return err;
+}
+
+static int emcs51_bench_run(const emcs51_bench_args_t *args, const emcs51_image_t *image, emcs51_bench_result_t *result)
+{
+    if (result->engine == EMCS51_BENCH_ENGINE_LANE)
+        return emcs51_bench_run_lane(args, image, result);
+
+    return emcs51_bench_run_core(args, image, result);
+}
+
+static double emcs51_bench_mips(const emcs51_bench_result_t *result)
+{
+    return (result->host_s > 0) ? ((double)result->inst / result->host_s / 1e6) : 0.0;
+}
+
+static double emcs51_bench_cycles_per_s(const emcs51_bench_result_t *result)
+{
+    return (result->host_s > 0) ? ((double)result->cycles / result->host_s) : 0.0;
+}
+
+static double emcs51_bench_ns_per_inst(const emcs51_bench_result_t *result)
+{
+    return (result->inst > 0) ? (result->host_s * 1e9 / (double)result->inst) : 0.0;
+}
+
+static const char *emcs51_bench_compiler(void)
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+}
+
+static void emcs51_bench_print_header(const emcs51_bench_args_t *args)
+{
+    if (args->json)
+    {
+        printf("{\"format\":\"emcs51-bench\",\"version\":1,\n");
+        printf("\"config\":{\"build_type\":\"%s\",\"compiler\":\"%s\",\"trace\":%d,\"profile\":%d,\"self_profile\":%d,"
+               "\"cycles\":%llu,\"warmup\":%llu},\n",
+               EMCS51_BENCH_BUILD_TYPE, emcs51_bench_compiler(), EMCS51_TRACE_ENABLE, EMCS51_PROFILE_ENABLE, EMCS51_SELF_PROFILE,
+               (unsigned long long)args->cycles, (unsigned long long)args->warmup);
+        printf("\"results\":[\n");
+        return;
+    }
+
+    printf("[EMCS51][bench] build:%s compiler:%s trace:%d profile:%d self_profile:%d\r\n", EMCS51_BENCH_BUILD_TYPE,
+           emcs51_bench_compiler(), EMCS51_TRACE_ENABLE, EMCS51_PROFILE_ENABLE, EMCS51_SELF_PROFILE);
+    printf("%-14s %-6s %-9s %5s %3s %12s %12s %8s %9s %12s %8s\r\n", "workload", "engine", "derivative", "lanes", "run", "inst", "cycles",
+           "host_s", "MIPS", "cycles/s", "ns/inst");
+}
+
+static void emcs51_bench_print_result(const emcs51_bench_args_t *args, const emcs51_bench_result_t *result, uint8_t first)
+{
+    if (args->json)
+    {
+        printf("%s{\"workload\":\"%s\",\"engine\":\"%s\",\"derivative\":\"%s\",\"lanes\":%u,\"run\":%u,\"err\":%d,"
+               "\"inst\":%llu,\"cycles\":%llu,\"host_s\":%.6f,\"mips\":%.3f,\"cycles_per_s\":%.0f,\"ns_per_inst\":%.3f}",
+               first ? "" : ",\n", result->workload->name, emcs51_bench_engine_names[result->engine], result->workload->derivative,
+               (unsigned)result->lanes, (unsigned)result->run, result->err, (unsigned long long)result->inst,
+               (unsigned long long)result->cycles, result->host_s, emcs51_bench_mips(result), emcs51_bench_cycles_per_s(result),
+               emcs51_bench_ns_per_inst(result));
+        return;
+    }
+
+    if (result->err != EMCS51_OK)
+    {
+        printf("%-14s %-6s %-9s failed err:%d %s\r\n", result->workload->name, emcs51_bench_engine_names[result->engine],
+               result->workload->derivative, result->err, emcs51_err_name(result->err));
+        return;
+    }
+
+    printf("%-14s %-6s %-9s %5u %3u %12llu %12llu %8.3f %9.2f %12.0f %8.2f\r\n", result->workload->name,
+           emcs51_bench_engine_names[result->engine], result->workload->derivative, (unsigned)result->lanes, (unsigned)result->run,
+           (unsigned long long)result->inst, (unsigned long long)result->cycles, result->host_s, emcs51_bench_mips(result),
+           emcs51_bench_cycles_per_s(result), emcs51_bench_ns_per_inst(result));
+}
+
+static void emcs51_bench_usage(const char *name)
+{
+    printf("usage: %s [-d image_dir] [-c cycles] [-w warmup] [-e core|lane|all] [-l lanes] [-r runs] [-j] [-L] [workload...]\r\n", name);
+}
+
+static uint8_t emcs51_bench_selected(int argc, char **argv, const char *name)
+{
+    if (optind >= argc)
+        return 1;
+
+    for (int i = optind; i < argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    emcs51_bench_args_t args = {
+        .dir = EMCS51_BENCH_DIR,
+        .cycles = EMCS51_BENCH_CYCLES_DEFAULT,
+        .warmup = EMCS51_BENCH_CYCLES_DEFAULT / 10,
+        .lanes = EMCS51_BENCH_LANES_DEFAULT,
+        .runs = 1,
+        .engine_mask = (1 << EMCS51_BENCH_ENGINE_COUNT) - 1,
+    };
+    char path[EMCS51_BENCH_PATH_MAX];
+    uint8_t first = 1;
+    int failed = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:c:w:e:l:r:jLh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            args.dir = optarg;
+            break;
+        case 'c':
+            args.cycles = strtoull(optarg, NULL, 0);
+            break;
+        case 'w':
+            args.warmup = strtoull(optarg, NULL, 0);
+            break;
+        case 'e':
+            if (strcmp(optarg, "all") == 0)
+            {
+                args.engine_mask = (1 << EMCS51_BENCH_ENGINE_COUNT) - 1;
+                break;
+            }
+
+            args.engine_mask = 0;
+            for (uint8_t engine = 0; engine < EMCS51_BENCH_ENGINE_COUNT; engine++)
+            {
+                if (strcmp(optarg, emcs51_bench_engine_names[engine]) == 0)
+                    args.engine_mask = (uint8_t)(1 << engine);
+            }
+
+            if (args.engine_mask == 0)
+            {
+                printf("[EMCS51][bench] unknown engine %s\r\n", optarg);
+                return 1;
+            }
+            break;
+        case 'l':
+            args.lanes = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            args.runs = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'j':
+            args.json = 1;
+            break;
+        case 'L':
+            for (uint32_t i = 0; i < EMCS51_BENCH_WORKLOAD_COUNT; i++)
+                printf("%s %s\r\n", emcs51_bench_workloads[i].name, emcs51_bench_workloads[i].derivative);
+            return 0;
+        default:
+            emcs51_bench_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((args.cycles == 0) || (args.runs == 0) || (args.lanes == 0) || (args.lanes > EMCS51_LANE_MAX))
+    {
+        emcs51_bench_usage(argv[0]);
+        return 1;
+    }
+
+    emcs51_bench_print_header(&args);
+
+    for (uint32_t i = 0; i < EMCS51_BENCH_WORKLOAD_COUNT; i++)
+    {
+        const emcs51_bench_workload_t *workload = &emcs51_bench_workloads[i];
+        emcs51_image_t image;
+        int err;
+
+        if (!emcs51_bench_selected(argc, argv, workload->name))
+            continue;
+
+        snprintf(path, sizeof(path), "%s/%s.bin", args.dir, workload->name);
+        err = emcs51_image_map(&image, path);
+        if (err != EMCS51_OK)
+        {
+            fprintf(stderr, "[EMCS51][bench] load %s failed err:%d %s\r\n", path, err, emcs51_err_name(err));
+            failed = 1;
+            continue;
+        }
+
+        for (uint8_t engine = 0; engine < EMCS51_BENCH_ENGINE_COUNT; engine++)
+        {
+            if (!(args.engine_mask & (1 << engine)))
+                continue;
+
+            for (uint32_t run = 0; run < args.runs; run++)
+            {
+                emcs51_bench_result_t result = {
+                    .workload = workload,
+                    .engine = engine,
+                    .run = run,
+                };
+
+                result.err = emcs51_bench_run(&args, &image, &result);
+                if (result.err != EMCS51_OK)
+                    failed = 1;
+
+                emcs51_bench_print_result(&args, &result, first);
+                first = 0;
+                fflush(stdout);
+            }
+        }
+
+        emcs51_image_unmap(&image);
+    }
+
+    if (args.json)
+        printf("\n]}\n");
+
+    return failed;
+}
@@ -0,0 +1,462 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <math.h>
+#include "emcs51.h"
+
+// 性能回归检查：多次运行 emcs51_bench -j，按 (工作负载, 引擎, lane数) 汇总每条指令的主机纳秒数，
+// 计算中位数及其95%置信区间，与保存的基准结果比较。
+// 中位数变慢超过阈值、且两个置信区间不重叠时判为回归，退出码为1。
+// 基准文件就是 emcs51_bench -j 的输出（可以是多次运行拼接），-s 保存本次的全部样本作为新的基准
+
+#ifndef EMCS51_BENCH_EXE
+#define EMCS51_BENCH_EXE "emcs51_bench"
+#endif
+
+#define EMCS51_BENCH_COMPARE_RUNS_DEFAULT 5
+#define EMCS51_BENCH_COMPARE_THRESHOLD_DEFAULT 5.0 // 百分比
+#define EMCS51_BENCH_COMPARE_CONFIDENCE 0.95
+#define EMCS51_BENCH_COMPARE_KEY_MAX 128
+#define EMCS51_BENCH_COMPARE_NAME_MAX 32
+#define EMCS51_BENCH_COMPARE_LINE_MAX 1024
+#define EMCS51_BENCH_COMPARE_CMD_MAX 4096
+
+typedef struct EMCS51_BENCH_COMPARE_SERIES
+{
+    char workload[EMCS51_BENCH_COMPARE_NAME_MAX];
+    char engine[EMCS51_BENCH_COMPARE_NAME_MAX];
+    uint32_t lanes;
+
+    double *samples; // ns_per_inst
+    uint32_t count;
+    uint32_t size;
+
+    double median;
+    double ci_low;
+    double ci_high;
+    double confidence; // 区间实际达到的置信度，样本少于6个时低于95%
+} emcs51_bench_compare_series_t;
+
+typedef struct EMCS51_BENCH_COMPARE_SET
+{
+    emcs51_bench_compare_series_t series[EMCS51_BENCH_COMPARE_KEY_MAX];
+    uint32_t count;
+    char config[EMCS51_BENCH_COMPARE_LINE_MAX]; // 第一个 "config" 行
+} emcs51_bench_compare_set_t;
+
+static emcs51_bench_compare_set_t emcs51_bench_compare_base;
+static emcs51_bench_compare_set_t emcs51_bench_compare_cur;
+
+/*******************************************************************************
+ * @brief 取 "key":"value" 中的字符串
+ * @return 找到返回1
+ ******************************************************************************/
+static int emcs51_bench_compare_get_str(const char *line, const char *key, char *buf, size_t size)
+{
+    char pattern[64];
+    const char *p;
+    size_t n = 0;
+
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
+    p = strstr(line, pattern);
+    if (p == NULL)
+        return 0;
+
+    p += strlen(pattern);
+    while ((p[n] != '"') && (p[n] != '\0') && (n + 1 < size))
+    {
+        buf[n] = p[n];
+        n++;
+    }
+    buf[n] = '\0';
+
+    return 1;
+}
+
+/*******************************************************************************
+ * @brief 取 "key":number 中的数值
+ * @return 找到返回1
+ ******************************************************************************/
+static int emcs51_bench_compare_get_num(const char *line, const char *key, double *value)
+{
+    char pattern[64];
+    const char *p;
+    char *end;
+
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    p = strstr(line, pattern);
+    if (p == NULL)
+        return 0;
+
+    *value = strtod(p + strlen(pattern), &end);
+
+    return end != p + strlen(pattern);
+}
+
+static emcs51_bench_compare_series_t *emcs51_bench_compare_find(emcs51_bench_compare_set_t *set, const char *workload, const char *engine,
+                                                                uint32_t lanes, uint8_t create)
+{
+    emcs51_bench_compare_series_t *series;
+
+    for (uint32_t i = 0; i < set->count; i++)
+    {
+        series = &set->series[i];
+
+        if ((strcmp(series->workload, workload) == 0) && (strcmp(series->engine, engine) == 0) && (series->lanes == lanes))
+            return series;
+    }
+
+    if (!create || (set->count >= EMCS51_BENCH_COMPARE_KEY_MAX))
+        return NULL;
+
+    series = &set->series[set->count++];
+    memset(series, 0, sizeof(emcs51_bench_compare_series_t));
+    snprintf(series->workload, sizeof(series->workload), "%s", workload);
+    snprintf(series->engine, sizeof(series->engine), "%s", engine);
+    series->lanes = lanes;
+
+    return series;
+}
+
+/*******************************************************************************
+ * @brief 解析 emcs51_bench -j 输出的一行，结果行加入样本
+ * @return emcs51_err_t，失败的运行返回 EMCS51_ERR
+ ******************************************************************************/
+static int emcs51_bench_compare_parse_line(emcs51_bench_compare_set_t *set, const char *line)
+{
+    emcs51_bench_compare_series_t *series;
+    char workload[EMCS51_BENCH_COMPARE_NAME_MAX];
+    char engine[EMCS51_BENCH_COMPARE_NAME_MAX];
+    double lanes, err, ns;
+
+    if ((set->config[0] == '\0') && (strncmp(line, "\"config\":", 9) == 0))
+    {
+        snprintf(set->config, sizeof(set->config), "%s", line);
+        set->config[strcspn(set->config, "\r\n")] = '\0';
+        return EMCS51_OK;
+    }
+
+    if (!emcs51_bench_compare_get_str(line, "workload", workload, sizeof(workload)) ||
+        !emcs51_bench_compare_get_str(line, "engine", engine, sizeof(engine)) || !emcs51_bench_compare_get_num(line, "lanes", &lanes) ||
+        !emcs51_bench_compare_get_num(line, "err", &err) || !emcs51_bench_compare_get_num(line, "ns_per_inst", &ns))
+        return EMCS51_OK;
+
+    if (err != 0)
+    {
+        fprintf(stderr, "[EMCS51][bench_compare] %s/%s failed err:%d\r\n", workload, engine, (int)err);
+        return EMCS51_ERR;
+    }
+
+    series = emcs51_bench_compare_find(set, workload, engine, (uint32_t)lanes, 1);
+    if (series == NULL)
+        return EMCS51_ERR;
+
+    if (series->count == series->size)
+    {
+        uint32_t size = series->size ? series->size * 2 : 16;
+        double *samples = realloc(series->samples, size * sizeof(double));
+
+        if (samples == NULL)
+            return EMCS51_ERR;
+
+        series->samples = samples;
+        series->size = size;
+    }
+
+    series->samples[series->count++] = ns;
+
+    return EMCS51_OK;
+}
+
+static int emcs51_bench_compare_parse(emcs51_bench_compare_set_t *set, FILE *fp)
+{
+    char line[EMCS51_BENCH_COMPARE_LINE_MAX];
+    int err = EMCS51_OK;
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (emcs51_bench_compare_parse_line(set, line) != EMCS51_OK)
+            err = EMCS51_ERR;
+    }
+
+    return err;
+}
+
+static int emcs51_bench_compare_cmp(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*******************************************************************************
+ * @brief 中位数及其非参数置信区间
+ * @details 区间两端各去掉 k 个样本，k 为满足 P(B(n, 0.5) <= k) <= (1 - 置信度) / 2 的最大值，
+ *          不假设样本服从正态分布；样本少于6个时 k 为0，区间为 [最小值, 最大值]
+ ******************************************************************************/
+static void emcs51_bench_compare_stats(emcs51_bench_compare_series_t *series)
+{
+    double *x = series->samples;
+    uint32_t n = series->count;
+    double alpha = (1.0 - EMCS51_BENCH_COMPARE_CONFIDENCE) / 2.0;
+    double p = pow(0.5, n); // P(B = i)
+    double cdf = p;         // P(B <= i)
+    double cdf_k = p;       // P(B <= k)
+    uint32_t k = 0;
+
+    qsort(x, n, sizeof(double), emcs51_bench_compare_cmp);
+
+    series->median = (n & 1) ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2.0;
+
+    for (uint32_t i = 1; i < n / 2; i++)
+    {
+        p = p * (double)(n - i + 1) / (double)i;
+        if (cdf + p > alpha)
+            break;
+
+        cdf += p;
+        cdf_k = cdf;
+        k = i;
+    }
+
+    // 区间 [x(k), x(n-1-k)] 的覆盖概率为 1 - 2 * P(B <= k)
+    series->ci_low = x[k];
+    series->ci_high = x[n - 1 - k];
+    series->confidence = 1.0 - 2.0 * cdf_k;
+}
+
+/*******************************************************************************
+ * @brief 运行一次 emcs51_bench -j，结果加入当前样本
+ ******************************************************************************/
+static int emcs51_bench_compare_run(const char *cmd)
+{
+    FILE *fp = popen(cmd, "r");
+    int err;
+    int status;
+
+    if (fp == NULL)
+    {
+        fprintf(stderr, "[EMCS51][bench_compare] run %s failed\r\n", cmd);
+        return EMCS51_ERR;
+    }
+
+    err = emcs51_bench_compare_parse(&emcs51_bench_compare_cur, fp);
+    status = pclose(fp);
+
+    if (status != 0)
+    {
+        fprintf(stderr, "[EMCS51][bench_compare] %s exited with status %d\r\n", cmd, status);
+        return EMCS51_ERR;
+    }
+
+    return err;
+}
+
+static void emcs51_bench_compare_usage(const char *name)
+{
+    printf("usage: %s [-n runs] [-t threshold_percent] [-b baseline.json] [-s save.json] [-B emcs51_bench] [-- bench args...]\r\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *bench = EMCS51_BENCH_EXE;
+    const char *baseline_path = NULL;
+    const char *save_path = NULL;
+    uint32_t runs = EMCS51_BENCH_COMPARE_RUNS_DEFAULT;
+    double threshold = EMCS51_BENCH_COMPARE_THRESHOLD_DEFAULT;
+    char cmd[EMCS51_BENCH_COMPARE_CMD_MAX];
+    uint32_t regressions = 0;
+    size_t len;
+    FILE *save = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:t:b:s:B:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            runs = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            threshold = strtod(optarg, NULL);
+            break;
+        case 'b':
+            baseline_path = optarg;
+            break;
+        case 's':
+            save_path = optarg;
+            break;
+        case 'B':
+            bench = optarg;
+            break;
+        default:
+            emcs51_bench_compare_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if ((runs == 0) || (threshold < 0) || ((baseline_path == NULL) && (save_path == NULL)))
+    {
+        emcs51_bench_compare_usage(argv[0]);
+        return 2;
+    }
+
+    // 命令行：每个参数加单引号，参数中的单引号转义为 '\''
+    len = (size_t)snprintf(cmd, sizeof(cmd), "'%s' -j", bench);
+    for (int i = optind; (i < argc) && (len < sizeof(cmd)); i++)
+    {
+        len += (size_t)snprintf(cmd + len, sizeof(cmd) - len, " '");
+
+        for (const char *c = argv[i]; (*c != '\0') && (len < sizeof(cmd)); c++)
+            len += (size_t)snprintf(cmd + len, sizeof(cmd) - len, (*c == '\'') ? "'\\''" : "%c", *c);
+
+        if (len < sizeof(cmd))
+            len += (size_t)snprintf(cmd + len, sizeof(cmd) - len, "'");
+    }
+
+    if (len >= sizeof(cmd))
+    {
+        fprintf(stderr, "[EMCS51][bench_compare] command line too long\r\n");
+        return 2;
+    }
+
+    if (baseline_path != NULL)
+    {
+        FILE *fp = fopen(baseline_path, "r");
+        int err;
+
+        if (fp == NULL)
+        {
+            fprintf(stderr, "[EMCS51][bench_compare] open %s failed\r\n", baseline_path);
+            return 2;
+        }
+
+        err = emcs51_bench_compare_parse(&emcs51_bench_compare_base, fp);
+        fclose(fp);
+
+        if ((err != EMCS51_OK) || (emcs51_bench_compare_base.count == 0))
+        {
+            fprintf(stderr, "[EMCS51][bench_compare] no usable results in %s\r\n", baseline_path);
+            return 2;
+        }
+    }
+
+    if (save_path != NULL)
+    {
+        save = fopen(save_path, "w");
+        if (save == NULL)
+        {
+            fprintf(stderr, "[EMCS51][bench_compare] open %s failed\r\n", save_path);
+            return 2;
+        }
+    }
+
+    // 整个套件轮流运行，使主机负载的变化分散到所有工作负载
+    for (uint32_t run = 0; run < runs; run++)
+    {
+        fprintf(stderr, "[EMCS51][bench_compare] run %u/%u: %s\r\n", (unsigned)(run + 1), (unsigned)runs, cmd);
+
+        if (emcs51_bench_compare_run(cmd) != EMCS51_OK)
+        {
+            if (save != NULL)
+                fclose(save);
+            return 2;
+        }
+    }
+
+    for (uint32_t i = 0; i < emcs51_bench_compare_cur.count; i++)
+        emcs51_bench_compare_stats(&emcs51_bench_compare_cur.series[i]);
+
+    for (uint32_t i = 0; i < emcs51_bench_compare_base.count; i++)
+        emcs51_bench_compare_stats(&emcs51_bench_compare_base.series[i]);
+
+    if (save != NULL)
+    {
+        fprintf(save, "{\"format\":\"emcs51-bench\",\"version\":1,\n%s\n\"results\":[\n", emcs51_bench_compare_cur.config);
+
+        for (uint32_t i = 0; i < emcs51_bench_compare_cur.count; i++)
+        {
+            const emcs51_bench_compare_series_t *series = &emcs51_bench_compare_cur.series[i];
+
+            for (uint32_t j = 0; j < series->count; j++)
+            {
+                fprintf(save, "%s{\"workload\":\"%s\",\"engine\":\"%s\",\"lanes\":%u,\"run\":%u,\"err\":0,\"ns_per_inst\":%.3f}",
+                        ((i == 0) && (j == 0)) ? "" : ",\n", series->workload, series->engine, (unsigned)series->lanes, (unsigned)j,
+                        series->samples[j]);
+            }
+        }
+
+        fprintf(save, "\n]}\n");
+        if (fclose(save) != 0)
+        {
+            fprintf(stderr, "[EMCS51][bench_compare] write %s failed\r\n", save_path);
+            return 2;
+        }
+
+        printf("[EMCS51][bench_compare] saved %u series to %s\r\n", (unsigned)emcs51_bench_compare_cur.count, save_path);
+    }
+
+    if (baseline_path == NULL)
+        return 0;
+
+    if (strcmp(emcs51_bench_compare_base.config, emcs51_bench_compare_cur.config) != 0)
+    {
+        printf("[EMCS51][bench_compare] build configuration differs from baseline\r\n");
+        printf("  baseline: %s\r\n  current:  %s\r\n", emcs51_bench_compare_base.config, emcs51_bench_compare_cur.config);
+    }
+
+    printf("%-14s %-6s %5s %28s %28s %8s  %s\r\n", "workload", "engine", "lanes", "baseline ns/inst [CI]", "current ns/inst [CI]", "change",
+           "verdict");
+
+    for (uint32_t i = 0; i < emcs51_bench_compare_cur.count; i++)
+    {
+        const emcs51_bench_compare_series_t *cur = &emcs51_bench_compare_cur.series[i];
+        const emcs51_bench_compare_series_t *base = emcs51_bench_compare_find(&emcs51_bench_compare_base, cur->workload, cur->engine, cur->lanes, 0);
+        const char *verdict = "ok";
+        double change;
+
+        if (base == NULL)
+        {
+            printf("%-14s %-6s %5u %28s %9.3f [%7.3f, %7.3f] %8s  new\r\n", cur->workload, cur->engine, (unsigned)cur->lanes, "-", cur->median,
+                   cur->ci_low, cur->ci_high, "-");
+            continue;
+        }
+
+        change = (base->median > 0) ? ((cur->median / base->median - 1.0) * 100.0) : 0.0;
+
+        // 变化超过阈值且置信区间不重叠才视为显著
+        if ((change > threshold) && (cur->ci_low > base->ci_high))
+        {
+            verdict = "REGRESSION";
+            regressions++;
+        }
+        else if ((change < -threshold) && (cur->ci_high < base->ci_low))
+        {
+            verdict = "faster";
+        }
+        else if ((change > threshold) || (change < -threshold))
+        {
+            verdict = "noise";
+        }
+
+        printf("%-14s %-6s %5u %9.3f [%7.3f, %7.3f] %9.3f [%7.3f, %7.3f] %+7.1f%%  %s\r\n", cur->workload, cur->engine, (unsigned)cur->lanes,
+               base->median, base->ci_low, base->ci_high, cur->median, cur->ci_low, cur->ci_high, change, verdict);
+    }
+
+    for (uint32_t i = 0; i < emcs51_bench_compare_base.count; i++)
+    {
+        const emcs51_bench_compare_series_t *base = &emcs51_bench_compare_base.series[i];
+
+        if (emcs51_bench_compare_find(&emcs51_bench_compare_cur, base->workload, base->engine, base->lanes, 0) == NULL)
+            printf("%-14s %-6s %5u %9.3f [%7.3f, %7.3f] %28s %8s  missing\r\n", base->workload, base->engine, (unsigned)base->lanes,
+                   base->median, base->ci_low, base->ci_high, "-", "-");
+    }
+
+    printf("[EMCS51][bench_compare] runs:%u baseline_runs:%u threshold:%.1f%% confidence:%.0f%% regressions:%u\r\n", (unsigned)runs,
+           emcs51_bench_compare_base.count ? (unsigned)emcs51_bench_compare_base.series[0].count : 0, threshold,
+           (emcs51_bench_compare_cur.count ? emcs51_bench_compare_cur.series[0].confidence : 0) * 100.0, (unsigned)regressions);
+
+    return (regressions > 0) ? 1 : 0;
+}
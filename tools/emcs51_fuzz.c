@@ -0,0 +1,361 @@
+#include <stdlib.h>
+#include <getopt.h>
+#include <time.h>
+#include "emcs51.h"
+#include "host/emcs51_image.h"
+
+// 模糊测试入口：每次执行恢复初始化后的快照，将输入作为串口接收字节或P1引脚送入固件，
+// 覆盖率边计数表放在 libFuzzer 的 extra counters 段中。
+//   libFuzzer: clang -fsanitize=fuzzer -DEMCS51_FUZZ_LIBFUZZER ...，参数由环境变量给出：
+//              EMCS51_FUZZ_IMAGE（必需）、EMCS51_FUZZ_MODE=uart|port、EMCS51_FUZZ_CYCLES、
+//              EMCS51_FUZZ_WARMUP、EMCS51_FUZZ_DERIVATIVE
+//   独立运行:  重放输入文件，或以随机输入测量每秒执行次数
+
+#define EMCS51_FUZZ_SCON 0x98
+#define EMCS51_FUZZ_SCON_RI 0x01
+#define EMCS51_FUZZ_SBUF 0x99
+#define EMCS51_FUZZ_PORT 0x90 // P1
+#define EMCS51_FUZZ_SLICE_CYCLES 256
+#define EMCS51_FUZZ_CYCLES_DEFAULT 20000
+
+typedef enum EMCS51_FUZZ_MODES
+{
+    EMCS51_FUZZ_MODE_UART = 0, // 固件取走上一字节（RI 清零）后送入下一字节
+    EMCS51_FUZZ_MODE_PORT,     // 每个时间片改变一次 P1 引脚
+} emcs51_fuzz_modes_t;
+
+typedef struct EMCS51_FUZZ_CONFIG
+{
+    const char *image_path;
+    const emcs51_derivative_t *derivative;
+    uint8_t mode;        // emcs51_fuzz_modes_t
+    uint64_t max_cycles; // 每次执行的周期上限
+    uint64_t warmup;     // 保存快照前执行的周期数，跳过启动代码
+} emcs51_fuzz_config_t;
+
+typedef struct EMCS51_FUZZ
+{
+    emcs51_fuzz_config_t config;
+    emcs51_image_t image;
+    emcs51_core_t core;
+    emcs51_snapshot_t snap;
+    emcs51_coverage_t cov;
+    uint8_t xdata[0x10000];
+    uint8_t xdata_copy[0x10000];
+
+    const uint8_t *input;
+    size_t len;
+    size_t pos;
+    uint8_t port; // P1 引脚
+
+    uint64_t execs;
+} emcs51_fuzz_t;
+
+static emcs51_fuzz_t emcs51_fuzz;
+
+#ifdef EMCS51_FUZZ_LIBFUZZER
+__attribute__((used, section("__libfuzzer_extra_counters")))
+#endif
+static uint8_t emcs51_fuzz_edges[EMCS51_COVERAGE_MAP_SIZE_DEFAULT];
+
+static int emcs51_fuzz_port_read_cb(emcs51_core_t *core, void *user, uint8_t addr, uint8_t *data)
+{
+    *data = ((emcs51_fuzz_t *)user)->port;
+
+    return EMCS51_OK;
+}
+
+static void emcs51_fuzz_input_cb(emcs51_core_t *core, void *user, const emcs51_input_t *input)
+{
+    if (input->type == EMCS51_INPUT_UART_RX)
+    {
+        core->data_ram[EMCS51_FUZZ_SBUF] = input->data;
+        core->data_ram[EMCS51_FUZZ_SCON] |= EMCS51_FUZZ_SCON_RI;
+    }
+}
+
+/*******************************************************************************
+ * @brief 加载镜像，执行预热周期后保存快照并开始记录覆盖率
+ ******************************************************************************/
+static int emcs51_fuzz_setup(emcs51_fuzz_t *fz, const emcs51_fuzz_config_t *config)
+{
+    emcs51_core_config_t core_config = {0};
+    int err;
+
+    fz->config = *config;
+
+    err = emcs51_image_map(&fz->image, config->image_path);
+    if (err != EMCS51_OK)
+        return err;
+
+    emcs51_image_config(&fz->image, &core_config);
+    core_config.user = fz;
+
+    emcs51_core_init(&fz->core, &core_config);
+    emcs51_derivative_init(&fz->core, config->derivative);
+    emcs51_core_set_xdata_ram(&fz->core, fz->xdata, sizeof(fz->xdata));
+    emcs51_core_reg_add(&fz->core, EMCS51_FUZZ_PORT, NULL, emcs51_fuzz_port_read_cb);
+    emcs51_core_set_input_cb(&fz->core, emcs51_fuzz_input_cb);
+
+    fz->port = 0xFF;
+    if (config->warmup > 0)
+    {
+        err = emcs51_core_run(&fz->core, config->warmup);
+        if (err < 0)
+            return err;
+    }
+
+    emcs51_snapshot_init(&fz->snap, EMCS51_SNAPSHOT_COW, fz->xdata_copy, sizeof(fz->xdata_copy));
+    err = emcs51_snapshot_take(&fz->core, &fz->snap);
+    if (err != EMCS51_OK)
+        return err;
+
+    return emcs51_coverage_init(&fz->cov, &fz->core, emcs51_fuzz_edges, sizeof(emcs51_fuzz_edges));
+}
+
+/*******************************************************************************
+ * @brief 执行一个输入：恢复快照后按时间片运行，输入送完且被取走后再运行一个时间片
+ * @return 核心的错误码
+ ******************************************************************************/
+static int emcs51_fuzz_exec(emcs51_fuzz_t *fz, const uint8_t *data, size_t size)
+{
+    emcs51_core_t *core = &fz->core;
+    uint64_t end;
+    uint8_t done = 0;
+    int err = EMCS51_OK;
+
+    emcs51_snapshot_restore(core, &fz->snap);
+    emcs51_coverage_begin(&fz->cov);
+
+    fz->input = data;
+    fz->len = size;
+    fz->pos = 0;
+    fz->port = 0xFF;
+    fz->execs++;
+
+    end = core->cycles + fz->config.max_cycles;
+
+    while ((core->cycles < end) && !done)
+    {
+        if (fz->config.mode == EMCS51_FUZZ_MODE_PORT)
+        {
+            if (fz->pos < fz->len)
+                fz->port = fz->input[fz->pos++];
+
+            done = (fz->pos >= fz->len);
+        }
+        else
+        {
+            uint8_t ri = core->data_ram[EMCS51_FUZZ_SCON] & EMCS51_FUZZ_SCON_RI;
+
+            if (!ri && (fz->pos < fz->len))
+                emcs51_core_raise_input(core, EMCS51_INPUT_UART_RX, EMCS51_FUZZ_SBUF, fz->input[fz->pos++]);
+            else if (!ri)
+                done = 1;
+        }
+
+        err = emcs51_core_run(core, EMCS51_FUZZ_SLICE_CYCLES);
+        if (err < 0)
+            break;
+    }
+
+    // 程序跑飞或越界访问视为崩溃，交由 libFuzzer 保存输入；未实现的指令只结束本次执行
+    if ((err == EMCS51_ERR_CODE_OUT_OF_RANGE) || (err == EMCS51_ERR_XDATA_OUT_OF_RANGE))
+    {
+        printf("[EMCS51][fuzz] crash err:%d %s pc:0x%04X\r\n", err, emcs51_err_name(err), core->reg.pc);
+        abort();
+    }
+
+    return err;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    emcs51_fuzz_exec(&emcs51_fuzz, data, size);
+
+    return 0;
+}
+
+#ifdef EMCS51_FUZZ_LIBFUZZER
+
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    emcs51_fuzz_config_t config = {
+        .derivative = &emcs51_derivative_8051,
+        .mode = EMCS51_FUZZ_MODE_UART,
+        .max_cycles = EMCS51_FUZZ_CYCLES_DEFAULT,
+    };
+    const char *env;
+    int err;
+
+    config.image_path = getenv("EMCS51_FUZZ_IMAGE");
+    if (config.image_path == NULL)
+    {
+        printf("[EMCS51][fuzz] EMCS51_FUZZ_IMAGE is not set\r\n");
+        exit(1);
+    }
+
+    if (((env = getenv("EMCS51_FUZZ_MODE")) != NULL) && (strcmp(env, "port") == 0))
+        config.mode = EMCS51_FUZZ_MODE_PORT;
+    if ((env = getenv("EMCS51_FUZZ_CYCLES")) != NULL)
+        config.max_cycles = strtoull(env, NULL, 0);
+    if ((env = getenv("EMCS51_FUZZ_WARMUP")) != NULL)
+        config.warmup = strtoull(env, NULL, 0);
+    if (((env = getenv("EMCS51_FUZZ_DERIVATIVE")) != NULL) && (emcs51_derivative_find(env) != NULL))
+        config.derivative = emcs51_derivative_find(env);
+
+    err = emcs51_fuzz_setup(&emcs51_fuzz, &config);
+    if (err != EMCS51_OK)
+    {
+        printf("[EMCS51][fuzz] setup failed err:%d %s\r\n", err, emcs51_err_name(err));
+        exit(1);
+    }
+
+    return 0;
+}
+
+#else
+
+static void emcs51_fuzz_usage(const char *name)
+{
+    printf("usage: %s [-n runs] [-l max_len] [-r seed] [-c cycles] [-w warmup] [-m uart|port] [-d derivative] image.bin|image.hex|image.ihx [input...]\r\n", name);
+}
+
+static int emcs51_fuzz_run_file(const char *path)
+{
+    static uint8_t data[0x10000];
+    FILE *fp = fopen(path, "rb");
+    size_t len;
+    int err;
+
+    if (fp == NULL)
+    {
+        printf("[EMCS51][fuzz] open %s failed\r\n", path);
+        return 1;
+    }
+
+    len = fread(data, 1, sizeof(data), fp);
+    fclose(fp);
+
+    err = emcs51_fuzz_exec(&emcs51_fuzz, data, len);
+    printf("[EMCS51][fuzz] %s: %u bytes err:%d %s pc:0x%04X\r\n", path, (unsigned)len, err, emcs51_err_name(err), emcs51_fuzz.core.reg.pc);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    emcs51_fuzz_config_t config = {
+        .derivative = &emcs51_derivative_8051,
+        .mode = EMCS51_FUZZ_MODE_UART,
+        .max_cycles = EMCS51_FUZZ_CYCLES_DEFAULT,
+    };
+    static uint8_t data[0x10000];
+    uint64_t runs = 10000;
+    uint32_t max_len = 64;
+    uint32_t seed = 1;
+    struct timespec t0, t1;
+    double host;
+    int opt;
+    int err;
+
+    while ((opt = getopt(argc, argv, "n:l:r:c:w:m:d:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            runs = strtoull(optarg, NULL, 0);
+            break;
+        case 'l':
+            max_len = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            seed = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            config.max_cycles = strtoull(optarg, NULL, 0);
+            break;
+        case 'w':
+            config.warmup = strtoull(optarg, NULL, 0);
+            break;
+        case 'm':
+            config.mode = (strcmp(optarg, "port") == 0) ? EMCS51_FUZZ_MODE_PORT : EMCS51_FUZZ_MODE_UART;
+            break;
+        case 'd':
+            config.derivative = emcs51_derivative_find(optarg);
+            if (config.derivative == NULL)
+            {
+                printf("[EMCS51][fuzz] unknown derivative %s\r\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            emcs51_fuzz_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((optind >= argc) || (max_len > sizeof(data)) || (seed == 0))
+    {
+        emcs51_fuzz_usage(argv[0]);
+        return 1;
+    }
+
+    config.image_path = argv[optind++];
+
+    err = emcs51_fuzz_setup(&emcs51_fuzz, &config);
+    if (err != EMCS51_OK)
+    {
+        printf("[EMCS51][fuzz] setup failed err:%d %s\r\n", err, emcs51_err_name(err));
+        return 1;
+    }
+
+    // 重放输入文件，如 libFuzzer 保存的崩溃用例
+    if (optind < argc)
+    {
+        for (; optind < argc; optind++)
+        {
+            if (emcs51_fuzz_run_file(argv[optind]) != 0)
+                return 1;
+        }
+
+        return 0;
+    }
+
+    // 随机输入，测量快照恢复加覆盖率记录的执行速度
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    for (uint64_t i = 0; i < runs; i++)
+    {
+        uint32_t len = (max_len > 0) ? (seed % (max_len + 1)) : 0;
+
+        for (uint32_t j = 0; j < len; j++)
+        {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            data[j] = (uint8_t)seed;
+        }
+
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+
+        emcs51_fuzz_exec(&emcs51_fuzz, data, len);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    host = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    printf("[EMCS51][fuzz] execs:%llu host:%.3fs %.0f exec/s code:%u bytes edges:%u\r\n", (unsigned long long)emcs51_fuzz.execs, host,
+           (host > 0) ? ((double)emcs51_fuzz.execs / host) : 0.0, (unsigned)emcs51_coverage_count(&emcs51_fuzz.cov),
+           (unsigned)emcs51_coverage_edge_count(&emcs51_fuzz.cov));
+    emcs51_snapshot_dump_stats(&emcs51_fuzz.snap);
+
+    emcs51_coverage_deinit(&emcs51_fuzz.cov);
+    emcs51_image_unmap(&emcs51_fuzz.image);
+
+    return 0;
+}
+
+#endif // EMCS51_FUZZ_LIBFUZZER
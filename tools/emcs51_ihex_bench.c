@@ -0,0 +1,117 @@
+#include <stdlib.h>
+#include <time.h>
+#include "emcs51.h"
+
+#define IHEX_BENCH_IMAGE_SIZE 0x10000
+#define IHEX_BENCH_RECORD_LEN 32
+
+/*******************************************************************************
+ * @brief 生成一条HEX记录
+ * @return 写入的字符数
+ ******************************************************************************/
+static uint32_t ihex_bench_put_record(char *out, uint8_t type, uint16_t addr, const uint8_t *data, uint8_t len)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t sum = (uint8_t)(len + (addr >> 8) + (addr & 0xFF) + type);
+    uint32_t n = 0;
+
+    out[n++] = ':';
+    out[n++] = hex[len >> 4];
+    out[n++] = hex[len & 0x0F];
+    out[n++] = hex[addr >> 12];
+    out[n++] = hex[(addr >> 8) & 0x0F];
+    out[n++] = hex[(addr >> 4) & 0x0F];
+    out[n++] = hex[addr & 0x0F];
+    out[n++] = hex[type >> 4];
+    out[n++] = hex[type & 0x0F];
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        sum += data[i];
+        out[n++] = hex[data[i] >> 4];
+        out[n++] = hex[data[i] & 0x0F];
+    }
+
+    sum = (uint8_t)(0x100 - sum);
+    out[n++] = hex[sum >> 4];
+    out[n++] = hex[sum & 0x0F];
+    out[n++] = '\r';
+    out[n++] = '\n';
+
+    return n;
+}
+
+static double ihex_bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 200;
+    uint32_t chunk_size = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 4096;
+    uint8_t *image = malloc(IHEX_BENCH_IMAGE_SIZE);
+    uint8_t *code = malloc(IHEX_BENCH_IMAGE_SIZE);
+    char *text = malloc(((IHEX_BENCH_IMAGE_SIZE / IHEX_BENCH_RECORD_LEN) + 2) * (13 + (IHEX_BENCH_RECORD_LEN * 2)));
+    uint32_t text_len = 0;
+    emcs51_ihex_t ih;
+    double start, elapsed;
+
+    if ((image == NULL) || (code == NULL) || (text == NULL) || (iterations == 0) || (chunk_size == 0))
+    {
+        printf("usage: %s [iterations] [chunk_size]\r\n", argv[0]);
+        return 1;
+    }
+
+    srand(51);
+    for (uint32_t i = 0; i < IHEX_BENCH_IMAGE_SIZE; i++)
+        image[i] = (uint8_t)rand();
+
+    for (uint32_t addr = 0; addr < IHEX_BENCH_IMAGE_SIZE; addr += IHEX_BENCH_RECORD_LEN)
+        text_len += ihex_bench_put_record(&text[text_len], EMCS51_IHEX_DATA, (uint16_t)addr, &image[addr], IHEX_BENCH_RECORD_LEN);
+
+    text_len += ihex_bench_put_record(&text[text_len], EMCS51_IHEX_EOF, 0, NULL, 0);
+
+    start = ihex_bench_now();
+
+    for (uint32_t it = 0; it < iterations; it++)
+    {
+        emcs51_ihex_init_buffer(&ih, code, IHEX_BENCH_IMAGE_SIZE);
+
+        for (uint32_t pos = 0; pos < text_len; pos += chunk_size)
+        {
+            uint32_t n = ((text_len - pos) < chunk_size) ? (text_len - pos) : chunk_size;
+
+            emcs51_ihex_feed(&ih, &text[pos], n);
+        }
+
+        if (emcs51_ihex_finish(&ih) != EMCS51_OK)
+        {
+            printf("[EMCS51][ihex_bench] line %u: %s\r\n", (unsigned)ih.line, emcs51_err_name(ih.err));
+            return 1;
+        }
+    }
+
+    elapsed = ihex_bench_now() - start;
+
+    if (memcmp(image, code, IHEX_BENCH_IMAGE_SIZE) != 0)
+    {
+        printf("[EMCS51][ihex_bench] loaded image mismatch\r\n");
+        return 1;
+    }
+
+    printf("[EMCS51][ihex_bench] %u x %u KiB image (%u bytes of text, %u byte chunks)\r\n",
+           (unsigned)iterations, IHEX_BENCH_IMAGE_SIZE / 1024, (unsigned)text_len, (unsigned)chunk_size);
+    printf("[EMCS51][ihex_bench] %.3f ms/image, %.1f MB/s of text\r\n",
+           (elapsed * 1e3) / iterations, ((double)text_len * iterations) / (elapsed * 1e6));
+
+    free(image);
+    free(code);
+    free(text);
+
+    return 0;
+}
@@ -0,0 +1,474 @@
+#include <stdlib.h>
+#include <getopt.h>
+#include "emcs51.h"
+#include "host/emcs51_runner.h"
+#include "host/emcs51_image.h"
+#include "host/emcs51_gdb.h"
+#include "host/emcs51_trace_writer.h"
+
+#define EMCS51_RUN_TRACE_STREAM_SIZE (4u << 20) // STREAM 模式的块缓冲大小
+#define EMCS51_RUN_PROFILE_TOP 20               // 剖析报告中列出的指令地址数
+
+typedef struct EMCS51_RUN_ARGS
+{
+    const uint8_t *code;
+    uint32_t code_len;
+    uint32_t xdata_size;
+    const emcs51_derivative_t *derivative;
+
+    // 跟踪第0个实例
+    const char *trace_path;
+    uint32_t trace_size; // RING 模式的块缓冲大小，0 表示 STREAM 模式
+    uint8_t trace_flags;
+#if EMCS51_TRACE_ENABLE
+    uint8_t *trace_buffer;
+    emcs51_trace_t trace;
+    emcs51_trace_writer_t trace_writer;
+#endif
+
+    // 剖析第0个实例
+    const char *profile_path;   // 平面剖析报告
+    const char *collapsed_path; // 折叠调用栈
+#if EMCS51_PROFILE_ENABLE
+    emcs51_profile_t *profile;
+#endif
+    emcs51_symtab_t *symtab; // NULL 表示未加载符号
+
+    // 第0个实例的已执行地址区间
+    const char *coverage_path;
+    emcs51_coverage_t *coverage;
+
+    uint8_t self_profile; // 结束时打印第0个实例的自剖析结果
+} emcs51_run_args_t;
+
+typedef struct EMCS51_RUN_INSTANCE
+{
+    uint8_t *xdata;
+} emcs51_run_instance_t;
+
+#if EMCS51_TRACE_ENABLE
+/*******************************************************************************
+ * @brief 开始跟踪：RING 模式结束时输出最近的块，STREAM 模式由写入线程持续输出
+ ******************************************************************************/
+static int emcs51_run_trace_start(emcs51_core_t *core, emcs51_run_args_t *args)
+{
+    uint32_t size = args->trace_size ? args->trace_size : EMCS51_RUN_TRACE_STREAM_SIZE;
+    uint8_t mode = args->trace_size ? EMCS51_TRACE_MODE_RING : EMCS51_TRACE_MODE_STREAM;
+    int err;
+
+    args->trace_buffer = malloc(size);
+    if (args->trace_buffer == NULL)
+        return EMCS51_ERR;
+
+    err = emcs51_trace_init(&args->trace, core, args->trace_buffer, size, mode, args->trace_flags);
+    if ((err == EMCS51_OK) && (mode == EMCS51_TRACE_MODE_STREAM))
+        err = emcs51_trace_writer_start(&args->trace_writer, &args->trace, args->trace_path);
+
+    if (err != EMCS51_OK)
+    {
+        args->trace_path = NULL;
+        core->trace = NULL;
+        free(args->trace_buffer);
+        printf("[EMCS51][run] trace start failed: %s\r\n", emcs51_err_name(err));
+    }
+
+    return err;
+}
+
+static void emcs51_run_trace_stop(emcs51_run_args_t *args)
+{
+    FILE *fp;
+    int err;
+
+    emcs51_trace_deinit(&args->trace);
+
+    if (args->trace.mode == EMCS51_TRACE_MODE_STREAM)
+    {
+        err = emcs51_trace_writer_stop(&args->trace_writer);
+    }
+    else
+    {
+        fp = fopen(args->trace_path, "wb");
+        err = (fp == NULL) ? EMCS51_ERR_STREAM : emcs51_trace_dump(&args->trace, emcs51_record_file_write_cb, fp);
+        if ((fp != NULL) && (fclose(fp) != 0))
+            err = EMCS51_ERR_STREAM;
+    }
+
+    printf("[EMCS51][run] trace %s: %llu inst, %llu lost, err:%d %s\r\n", args->trace_path, (unsigned long long)args->trace.records,
+           (unsigned long long)args->trace.lost, err, emcs51_err_name(err));
+
+    free(args->trace_buffer);
+}
+#endif // EMCS51_TRACE_ENABLE
+
+#if EMCS51_PROFILE_ENABLE
+/*******************************************************************************
+ * @brief 结束剖析并写出报告
+ ******************************************************************************/
+static void emcs51_run_profile_write(emcs51_run_args_t *args, const char *path, uint8_t collapsed)
+{
+    FILE *fp = fopen(path, "wb");
+    int err = EMCS51_ERR_STREAM;
+
+    if (fp != NULL)
+    {
+        if (collapsed)
+            err = emcs51_profile_collapsed(args->profile, args->symtab, emcs51_record_file_write_cb, fp);
+        else
+            err = emcs51_profile_report(args->profile, args->symtab, EMCS51_RUN_PROFILE_TOP, emcs51_record_file_write_cb, fp);
+
+        if (fclose(fp) != 0)
+            err = EMCS51_ERR_STREAM;
+    }
+
+    printf("[EMCS51][run] profile %s: err:%d %s\r\n", path, err, emcs51_err_name(err));
+}
+
+static void emcs51_run_profile_stop(emcs51_run_args_t *args)
+{
+    emcs51_profile_deinit(args->profile);
+
+    if (args->profile_path != NULL)
+        emcs51_run_profile_write(args, args->profile_path, 0);
+
+    if (args->collapsed_path != NULL)
+        emcs51_run_profile_write(args, args->collapsed_path, 1);
+
+    free(args->profile);
+    args->profile = NULL;
+}
+#endif // EMCS51_PROFILE_ENABLE
+
+/*******************************************************************************
+ * @brief 结束覆盖率记录并写出已执行的地址区间
+ ******************************************************************************/
+static void emcs51_run_coverage_stop(emcs51_run_args_t *args)
+{
+    FILE *fp = fopen(args->coverage_path, "wb");
+    int err = EMCS51_ERR_STREAM;
+
+    emcs51_coverage_deinit(args->coverage);
+
+    if (fp != NULL)
+    {
+        err = emcs51_coverage_ranges(args->coverage, emcs51_record_file_write_cb, fp);
+
+        if (fclose(fp) != 0)
+            err = EMCS51_ERR_STREAM;
+    }
+
+    printf("[EMCS51][run] coverage %s: %u bytes err:%d %s\r\n", args->coverage_path, (unsigned)emcs51_coverage_count(args->coverage), err,
+           emcs51_err_name(err));
+
+    free(args->coverage);
+    args->coverage = NULL;
+}
+
+static int emcs51_run_setup_cb(emcs51_core_t *core, uint32_t index, void *user)
+{
+    emcs51_run_args_t *args = (emcs51_run_args_t *)user;
+    emcs51_run_instance_t *inst = calloc(1, sizeof(emcs51_run_instance_t));
+
+    if (inst == NULL)
+        return EMCS51_ERR;
+
+    emcs51_core_config_t config = {
+        .code_type = EMCS51_CODE_BUFFER,
+        .code_buffer = args->code,
+        .code_len = args->code_len,
+        .user = inst,
+    };
+
+    emcs51_core_init(core, &config);
+    emcs51_derivative_init(core, args->derivative);
+
+    if (args->xdata_size)
+    {
+        inst->xdata = malloc(args->xdata_size);
+        if (inst->xdata == NULL)
+            return EMCS51_ERR;
+
+        memset(inst->xdata, 0xFF, args->xdata_size);
+        emcs51_core_set_xdata_ram(core, inst->xdata, args->xdata_size);
+    }
+
+#if EMCS51_PROFILE_ENABLE
+    if ((index == 0) && ((args->profile_path != NULL) || (args->collapsed_path != NULL)))
+    {
+        args->profile = malloc(sizeof(emcs51_profile_t));
+        if (args->profile == NULL)
+            return EMCS51_ERR;
+
+        emcs51_profile_init(args->profile, core);
+    }
+#endif
+
+    if ((index == 0) && (args->coverage_path != NULL))
+    {
+        args->coverage = malloc(sizeof(emcs51_coverage_t));
+        if (args->coverage == NULL)
+            return EMCS51_ERR;
+
+        emcs51_coverage_init(args->coverage, core, NULL, 0);
+    }
+
+#if EMCS51_TRACE_ENABLE
+    if ((index == 0) && (args->trace_path != NULL))
+        return emcs51_run_trace_start(core, args);
+#endif
+
+    return EMCS51_OK;
+}
+
+static void emcs51_run_teardown_cb(emcs51_core_t *core, uint32_t index, void *user)
+{
+    emcs51_run_instance_t *inst = (emcs51_run_instance_t *)core->user;
+    emcs51_run_args_t *args = (emcs51_run_args_t *)user;
+
+#if EMCS51_PROFILE_ENABLE
+    if ((index == 0) && (args->profile != NULL) && (core->profile == args->profile))
+        emcs51_run_profile_stop(args);
+#endif
+
+    if ((index == 0) && (args->coverage != NULL) && (core->coverage == args->coverage))
+        emcs51_run_coverage_stop(args);
+
+#if EMCS51_SELF_PROFILE
+    if ((index == 0) && args->self_profile)
+        emcs51_core_self_profile_dump(core);
+#endif
+
+#if EMCS51_TRACE_ENABLE
+
+    if ((index == 0) && (args->trace_path != NULL) && (core->trace == &args->trace))
+        emcs51_run_trace_stop(args);
+#endif
+
+    if (inst == NULL)
+        return;
+
+    free(inst->xdata);
+    free(inst);
+}
+
+static void emcs51_run_usage(const char *name)
+{
+    printf("usage: %s [-n instances] [-j threads] [-k slice_cycles] [-c max_cycles] [-x xdata_size] [-d derivative] [-f osc_hz] [-g port|-G unix_path] [-t trace_file [-T ring_kib] [-m]] [-p profile_file] [-P collapsed_file] [-s symbols.cdb|object.omf] [-C cover_file] [-S] [-v] image.bin|image.hex|image.ihx\r\n", name);
+}
+
+/*******************************************************************************
+ * @brief 单实例在GDB服务下运行，直到调试器发送 k
+ ******************************************************************************/
+static int emcs51_run_gdb(emcs51_run_args_t *args, emcs51_gdb_config_t *gdb_config)
+{
+    emcs51_core_t *core = calloc(1, sizeof(emcs51_core_t));
+    emcs51_gdb_t *gdb = calloc(1, sizeof(emcs51_gdb_t));
+    int err = EMCS51_ERR;
+
+    if ((core == NULL) || (gdb == NULL) || (emcs51_run_setup_cb(core, 0, args) != EMCS51_OK))
+        goto out;
+
+    err = emcs51_gdb_init(gdb, core, gdb_config);
+    if (err != EMCS51_OK)
+    {
+        printf("[EMCS51][run] gdb listen failed\r\n");
+        goto out;
+    }
+
+    if (gdb_config->unix_path)
+        printf("[EMCS51][run] gdb listening on %s\r\n", gdb_config->unix_path);
+    else
+        printf("[EMCS51][run] gdb listening on 127.0.0.1:%u\r\n", (unsigned)gdb_config->port);
+    fflush(stdout);
+
+    err = emcs51_gdb_run(gdb);
+    emcs51_gdb_deinit(gdb);
+
+    printf("[EMCS51][run] gdb session ended err:%d %s pc:0x%04X cycles:%llu inst:%llu\r\n", err, emcs51_err_name(err), core->reg.pc,
+           (unsigned long long)core->cycles, (unsigned long long)core->inst_count);
+
+out:
+    if (core != NULL)
+        emcs51_run_teardown_cb(core, 0, args);
+    free(gdb);
+    free(core);
+
+    return err;
+}
+
+int main(int argc, char **argv)
+{
+    emcs51_runner_config_t config = {
+        .instance_count = 1,
+        .thread_count = 0,
+        .slice_cycles = 10000,
+        .max_cycles = 1000000,
+        .setup_cb = emcs51_run_setup_cb,
+        .teardown_cb = emcs51_run_teardown_cb,
+    };
+    emcs51_run_args_t args = {
+        .xdata_size = 0x10000,
+        .derivative = &emcs51_derivative_8051,
+    };
+    emcs51_gdb_config_t gdb_config = {0};
+    int use_gdb = 0;
+    emcs51_runner_summary_t summary;
+    emcs51_runner_result_t *results;
+    int verbose = 0;
+    emcs51_image_t image;
+    emcs51_symtab_t symtab;
+    const char *symbol_path = NULL;
+    int opt;
+    int err;
+
+    while ((opt = getopt(argc, argv, "n:j:k:c:x:d:f:g:G:t:T:mp:P:s:C:Svh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            config.instance_count = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'j':
+            config.thread_count = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'k':
+            config.slice_cycles = strtoull(optarg, NULL, 0);
+            break;
+        case 'c':
+            config.max_cycles = strtoull(optarg, NULL, 0);
+            break;
+        case 'x':
+            args.xdata_size = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            args.derivative = emcs51_derivative_find(optarg);
+            if (args.derivative == NULL)
+            {
+                printf("[EMCS51][run] unknown derivative %s\r\n", optarg);
+                return 1;
+            }
+            break;
+        case 'f':
+            config.osc_hz = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'g':
+            gdb_config.port = (uint16_t)strtoul(optarg, NULL, 0);
+            use_gdb = 1;
+            break;
+        case 'G':
+            gdb_config.unix_path = optarg;
+            use_gdb = 1;
+            break;
+        case 't':
+            args.trace_path = optarg;
+            break;
+        case 'T':
+            args.trace_size = (uint32_t)strtoul(optarg, NULL, 0) * 1024;
+            break;
+        case 'm':
+            args.trace_flags |= EMCS51_TRACE_FLAG_MEM;
+            break;
+        case 'p':
+        case 'P':
+#if EMCS51_PROFILE_ENABLE
+            if (opt == 'p')
+                args.profile_path = optarg;
+            else
+                args.collapsed_path = optarg;
+#else
+            printf("[EMCS51][run] -%c needs a build with EMCS51_PROFILE_ENABLE=1\r\n", opt);
+            return 1;
+#endif
+            break;
+        case 's':
+            symbol_path = optarg;
+            break;
+        case 'C':
+            args.coverage_path = optarg;
+            break;
+        case 'S':
+#if EMCS51_SELF_PROFILE
+            args.self_profile = 1;
+#else
+            printf("[EMCS51][run] -S needs a build with EMCS51_SELF_PROFILE=1\r\n");
+            return 1;
+#endif
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            emcs51_run_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if ((optind >= argc) || (config.max_cycles == 0) || (args.xdata_size > 0x10000))
+    {
+        emcs51_run_usage(argv[0]);
+        return 1;
+    }
+
+    err = emcs51_image_map(&image, argv[optind]);
+    if (err != EMCS51_OK)
+    {
+        printf("[EMCS51][run] load %s failed: %s\r\n", argv[optind], emcs51_err_name(err));
+        return 1;
+    }
+
+    args.code = image.data;
+    args.code_len = image.len;
+
+    emcs51_symtab_init(&symtab);
+    if (symbol_path != NULL)
+    {
+        err = emcs51_image_load_symbols(&symtab, symbol_path);
+        if (err != EMCS51_OK)
+        {
+            printf("[EMCS51][run] load %s failed: %s\r\n", symbol_path, emcs51_err_name(err));
+            return 1;
+        }
+
+        args.symtab = &symtab;
+    }
+
+    config.user = &args;
+
+    if (use_gdb)
+    {
+        err = emcs51_run_gdb(&args, &gdb_config);
+        emcs51_symtab_deinit(&symtab);
+        emcs51_image_unmap(&image);
+        return (err < 0) ? 2 : 0;
+    }
+
+    results = calloc(config.instance_count, sizeof(emcs51_runner_result_t));
+    if (results == NULL)
+        return 1;
+
+    err = emcs51_runner_run(&config, results, &summary);
+    if (err < 0)
+    {
+        printf("[EMCS51][run] runner failed err:%d %s\r\n", err, emcs51_err_name(err));
+        return 1;
+    }
+
+    if (verbose)
+    {
+        for (uint32_t i = 0; i < config.instance_count; i++)
+        {
+            printf("[EMCS51][run] #%u stop:%u err:%d %s pc:0x%04X cycles:%llu inst:%llu slices:%u\r\n",
+                   (unsigned)i, (unsigned)results[i].stop_reason, results[i].err, emcs51_err_name(results[i].err),
+                   results[i].pc, (unsigned long long)results[i].cycles, (unsigned long long)results[i].inst_count,
+                   (unsigned)results[i].slices);
+        }
+    }
+
+    emcs51_runner_dump_summary(&summary);
+
+    free(results);
+    emcs51_symtab_deinit(&symtab);
+    emcs51_image_unmap(&image);
+
+    return (summary.errors > 0) ? 2 : 0;
+}
@@ -0,0 +1,189 @@
+#include <stdlib.h>
+#include <getopt.h>
+#include "emcs51.h"
+#include "host/emcs51_image.h"
+
+typedef struct EMCS51_TRACE_DUMP
+{
+    emcs51_disasm_t dis;
+    const uint8_t *code; // 程序映像，NULL 时只输出助记符
+    uint32_t code_len;
+    uint64_t limit;     // 最多输出的指令数，0 表示不限
+    uint64_t count;
+    uint64_t next_inst; // 下一块应有的起始指令序号，用于发现丢失的块
+    uint8_t quiet;
+} emcs51_trace_dump_t;
+
+static const char *const emcs51_trace_dump_space_names[] = {"code", "iram", "sfr", "xdata"};
+
+static int emcs51_trace_dump_record_cb(void *user, const emcs51_trace_record_t *record)
+{
+    emcs51_trace_dump_t *dump = (emcs51_trace_dump_t *)user;
+    char text[EMCS51_DISASM_TEXT_MAX];
+
+    if ((dump->limit != 0) && (dump->count >= dump->limit))
+        return EMCS51_ERR;
+
+    if ((dump->count > 0) && (record->inst != dump->next_inst))
+        printf("... %llu inst lost\r\n", (unsigned long long)(record->inst - dump->next_inst));
+
+    dump->count++;
+    dump->next_inst = record->inst + 1;
+
+    if (dump->quiet)
+        return EMCS51_OK;
+
+    // 映像中的指令与跟踪的操作码不同时（分组切换或自修改），只输出助记符
+    if ((dump->code != NULL) && ((uint32_t)record->pc + emcs51_disasm_length(record->opcode) <= dump->code_len) &&
+        (dump->code[record->pc] == record->opcode))
+        emcs51_disasm_inst(&dump->dis, record->pc, &dump->code[record->pc], text, sizeof(text));
+    else
+        snprintf(text, sizeof(text), "%s", emcs51_disasm_mnemonic(record->opcode));
+
+    printf("%10llu %12llu %04X %02X %-24s +%u", (unsigned long long)record->inst, (unsigned long long)record->cycles, record->pc,
+           record->opcode, text, (unsigned)record->cycle_delta);
+
+    for (uint8_t i = 0; i < record->effect_count; i++)
+    {
+        const emcs51_trace_effect_t *effect = &record->effects[i];
+        const char *space = (effect->space < 4) ? emcs51_trace_dump_space_names[effect->space] : "?";
+
+        printf(" %s[%04X]=%02X", space, effect->addr, effect->data);
+    }
+
+    if (record->effect_truncated)
+        printf(" ...");
+
+    printf("\r\n");
+
+    return EMCS51_OK;
+}
+
+static void emcs51_trace_dump_usage(const char *name)
+{
+    printf("usage: %s [-n max_inst] [-d derivative] [-i image.bin|image.hex|image.ihx] [-s symbols.cdb|object.omf] [-q] trace_file\r\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    static emcs51_trace_dump_t dump;
+    static uint8_t block[0x10000];
+    const emcs51_derivative_t *derivative = &emcs51_derivative_8051;
+    static emcs51_symtab_t symtab;
+    emcs51_image_t image = {0};
+    const char *image_path = NULL;
+    const char *symbol_path = NULL;
+    uint32_t blocks = 0;
+    uint32_t len;
+    FILE *fp;
+    int opt;
+    int err = EMCS51_OK;
+
+    while ((opt = getopt(argc, argv, "n:d:i:s:qh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            dump.limit = strtoull(optarg, NULL, 0);
+            break;
+        case 'd':
+            derivative = emcs51_derivative_find(optarg);
+            if (derivative == NULL)
+            {
+                printf("[EMCS51][trace_dump] unknown derivative %s\r\n", optarg);
+                return 1;
+            }
+            break;
+        case 'i':
+            image_path = optarg;
+            break;
+        case 's':
+            symbol_path = optarg;
+            break;
+        case 'q':
+            dump.quiet = 1;
+            break;
+        default:
+            emcs51_trace_dump_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        emcs51_trace_dump_usage(argv[0]);
+        return 1;
+    }
+
+    if (image_path != NULL)
+    {
+        err = emcs51_image_map(&image, image_path);
+        if (err < 0)
+        {
+            printf("[EMCS51][trace_dump] load %s failed, err:%d %s\r\n", image_path, err, emcs51_err_name(err));
+            return 1;
+        }
+
+        dump.code = image.data;
+        dump.code_len = image.len;
+    }
+
+    emcs51_symtab_init(&symtab);
+    if (symbol_path != NULL)
+    {
+        err = emcs51_image_load_symbols(&symtab, symbol_path);
+        if (err < 0)
+        {
+            printf("[EMCS51][trace_dump] load %s failed, err:%d %s\r\n", symbol_path, err, emcs51_err_name(err));
+            return 1;
+        }
+    }
+
+    emcs51_disasm_init(&dump.dis, derivative, (symbol_path != NULL) ? &symtab : NULL);
+
+    fp = fopen(argv[optind], "rb");
+    if (fp == NULL)
+    {
+        printf("[EMCS51][trace_dump] open %s failed\r\n", argv[optind]);
+        return 1;
+    }
+
+    if ((fread(block, 1, EMCS51_TRACE_FILE_HEADER_SIZE, fp) != EMCS51_TRACE_FILE_HEADER_SIZE) ||
+        (memcmp(block, EMCS51_TRACE_MAGIC, 7) != 0) || (block[7] != EMCS51_TRACE_VERSION))
+    {
+        printf("[EMCS51][trace_dump] %s is not a trace file\r\n", argv[optind]);
+        fclose(fp);
+        return 1;
+    }
+
+    // 逐块读取，块头中有块长度
+    while (fread(block, 1, EMCS51_TRACE_BLOCK_HEADER_SIZE, fp) == EMCS51_TRACE_BLOCK_HEADER_SIZE)
+    {
+        len = emcs51_trace_block_len(block);
+        if ((len < EMCS51_TRACE_BLOCK_HEADER_SIZE) ||
+            (fread(block + EMCS51_TRACE_BLOCK_HEADER_SIZE, 1, len - EMCS51_TRACE_BLOCK_HEADER_SIZE, fp) != len - EMCS51_TRACE_BLOCK_HEADER_SIZE))
+        {
+            err = EMCS51_ERR_TRACE_FORMAT;
+            break;
+        }
+
+        err = emcs51_trace_decode_block(block, len, emcs51_trace_dump_record_cb, &dump);
+        if (err < 0)
+            break;
+
+        blocks++;
+    }
+
+    fclose(fp);
+    emcs51_symtab_deinit(&symtab);
+    emcs51_image_unmap(&image);
+
+    // 达到 -n 上限时回调返回 EMCS51_ERR
+    if ((err == EMCS51_ERR) && (dump.limit != 0) && (dump.count >= dump.limit))
+        err = EMCS51_OK;
+
+    printf("[EMCS51][trace_dump] blocks:%u inst:%llu err:%d %s\r\n", (unsigned)blocks, (unsigned long long)dump.count, err,
+           emcs51_err_name(err));
+
+    return (err < 0) ? 2 : 0;
+}